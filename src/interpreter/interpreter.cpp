@@ -1,7 +1,10 @@
 #include "interpreter.h"
+#include "compiler.h"
 #include "module.h"
+#include "output.h"
 #include "sequence.h"
 #include "util.h"
+#include "virtual_machine.h"
 
 #include <cstdlib>
 
@@ -12,17 +15,29 @@ using namespace Ishlang;
 // -------------------------------------------------------------
 
 // -------------------------------------------------------------
-Interpreter::ParserCB::ParserCB(Environment::SharedPtr env, IdenType &lastResult, bool &batch)
+Interpreter::ParserCB::ParserCB(Environment::SharedPtr env, IdenType &lastResult, bool &batch, bool &byteCode, Optimizer &optimizer, bool &dump)
     : env(env)
     , lastResult(lastResult)
     , batch(batch)
+    , byteCode(byteCode)
+    , optimizer(optimizer)
+    , dump(dump)
 {}
 
 // -------------------------------------------------------------
 void Interpreter::ParserCB::operator()(CodeNode::SharedPtr &code) {
     if (code) {
-        Value result = code->eval(env);
-        if (!batch) { std::cout << result << '\n'; }
+        code = optimizer.optimize(code);
+        if (dump) {
+            Optimizer::dump(code, Output::stream());
+            Output::newline();
+        }
+
+        Value result = byteCode ? VirtualMachine::run(*Compiler::compile(code), env) : code->eval(env);
+        if (!batch) {
+            Output::stream() << result;
+            Output::newline();
+        }
         env->set(lastResult, result);
     }
 }
@@ -50,28 +65,40 @@ Interpreter::BatchScope::~BatchScope() {
 
 // -------------------------------------------------------------
 Interpreter::Interpreter(bool batch, const std::string &path)
-    : parser_()
+    : context_()
+    , parser_()
     , env_(Environment::make())
     , prompt_(">>")
     , contPrompt_("..")
     , lastResult_(Environment::idenTable().mapName("*"))
     , batch_(batch)
-    , parserCB_(env_, lastResult_, batch_)
+    , byteCode_(false)
+    , dump_(false)
+    , optimizer_()
+    , parserCB_(env_, lastResult_, batch_, byteCode_, optimizer_, dump_)
     , helpDict_()
 {
     env_->def(lastResult_, Value::Null);
     initPath(path);
 }
 
+// -------------------------------------------------------------
+Interpreter::~Interpreter() {
+    // Release values under the context tracking them
+    Context::Scope scope(context_);
+    env_->clear();
+}
+
 // -------------------------------------------------------------
 bool Interpreter::readEvalPrintLoop() {
+    Context::Scope scope(context_);
     std::string expr;
     for (;;) {
         try {
-            std::cout << (parser_.hasIncompleteExpr() ? contPrompt_ : prompt_) << ' ';
+            Output::stream() << (parser_.hasIncompleteExpr() ? contPrompt_ : prompt_) << ' ';
             std::getline(std::cin, expr);
             if (std::cin.eof()) {
-                std::cout << '\n';
+                Output::newline();
                 break;
             }
             else if (isREPLCommand(expr)) {
@@ -95,12 +122,14 @@ bool Interpreter::readEvalPrintLoop() {
 
 // -------------------------------------------------------------
 void Interpreter::loadFile(const std::string &filename) {
+    Context::Scope scope(context_);
     auto _ = BatchScope(batch_, true);
     parser_.readFile(filename, parserCB_);
 }
 
 // -------------------------------------------------------------
 bool Interpreter::evalExpr(const std::string &expression) {
+    Context::Scope scope(context_);
     try {
         parser_.readMulti(expression, parserCB_);
         if (parser_.hasIncompleteExpr()) {
@@ -121,6 +150,7 @@ bool Interpreter::evalExpr(const std::string &expression) {
 
 // -------------------------------------------------------------
 void Interpreter::setArguments(char ** argv, int begin, int end) {
+    Context::Scope scope(context_);
     Sequence arguments;
     for (int i = begin; i < end; ++i) {
         arguments.push(Value(argv[i]));
@@ -184,10 +214,12 @@ void Interpreter::handleREPLCommand(const std::string &expr) {
     }
     else if (cmd == ":help") {
         if (size == 1) {
-            std::cout << helpDict_.topics() << std::endl;
+            Output::write(helpDict_.topics());
+            Output::newline();
         }
         else if (size == 2) {
-            std::cout << helpDict_.lookup(cmdTokens.front()) << std::endl;
+            Output::write(helpDict_.lookup(cmdTokens.front()));
+            Output::newline();
         }
         else {
             throw InvalidCommand(cmd, "too many arguments");
@@ -208,7 +240,8 @@ void Interpreter::describe(const std::string &name) const {
         value.userObject().describe();
     }
     else {
-        std::cout << "Name '" << name << "' is not a user type or object\n";
+        Output::stream() << "Name '" << name << "' is not a user type or object";
+        Output::newline();
     }
 }
 
@@ -218,11 +251,11 @@ void Interpreter::initPath(const std::string &path) {
     if (envPath) {
         const std::string envPathStr(envPath);
         if (!envPathStr.empty()) {
-            ModuleStorage::addPaths(envPathStr);
+            context_.moduleStorage().addPaths(envPathStr);
         }
     }
 
     if (!path.empty()) {
-        ModuleStorage::addPaths(path);
+        context_.moduleStorage().addPaths(path);
     }
 }
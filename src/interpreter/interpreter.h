@@ -1,16 +1,21 @@
 #ifndef ISHLANG_INTERPRETER_H
 #define ISHLANG_INTERPRETER_H
 
+#include "context.h"
 #include "iden_table.h"
 #include "environment.h"
 #include "interpreter_help.h"
+#include "optimizer.h"
 #include "parser.h"
 
 namespace Ishlang {
 
+    // Interpreters own their context, several may evaluate at once on
+    // different threads. Each one is used by one thread at a time.
     class Interpreter {
     public:
         Interpreter(bool batch, const std::string &path = "");
+        ~Interpreter();
         Interpreter(const Interpreter &) = delete;
 
         const Interpreter &operator=(const Interpreter &) = delete;
@@ -20,6 +25,9 @@ namespace Ishlang {
         bool evalExpr(const std::string &expression);
 
         void setArguments(char ** argv, int begin, int end);
+        inline void setByteCode(bool flag);
+        inline void setOptimizeLevel(unsigned level);
+        inline void setDump(bool flag);
 
     private:
         bool isREPLCommand(const std::string &expr) const;
@@ -31,13 +39,16 @@ namespace Ishlang {
 
     private:
         struct ParserCB {
-            ParserCB(Environment::SharedPtr env, IdenType &lastResult, bool &batch);
+            ParserCB(Environment::SharedPtr env, IdenType &lastResult, bool &batch, bool &byteCode, Optimizer &optimizer, bool &dump);
             void operator()(CodeNode::SharedPtr &code);
 
         private:
             Environment::SharedPtr  env;
             IdenType               &lastResult;
             const bool             &batch;
+            const bool             &byteCode;
+            Optimizer              &optimizer;
+            const bool             &dump;
         };
 
     private:
@@ -54,6 +65,7 @@ namespace Ishlang {
         };
 
     private:
+        Context                context_;
         Parser                 parser_;
         Environment::SharedPtr env_;
 
@@ -61,12 +73,30 @@ namespace Ishlang {
         std::string contPrompt_;
         IdenType    lastResult_;
         bool        batch_;
+        bool        byteCode_;
+        bool        dump_;
+        Optimizer   optimizer_;
 
         ParserCB parserCB_;
 
         HelpDict helpDict_;
     };
 
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline void Interpreter::setByteCode(bool flag) {
+        byteCode_ = flag;
+    }
+
+    inline void Interpreter::setOptimizeLevel(unsigned level) {
+        optimizer_.setLevel(level);
+    }
+
+    inline void Interpreter::setDump(bool flag) {
+        dump_ = flag;
+    }
+
 } // Int
 
 #endif // ISHLANG_INTERPRETER_H
@@ -56,6 +56,7 @@ void HelpDict::populateDict(Dict &dict) {
     tmp.emplace("charop", help_charop());
     tmp.emplace("pair", help_pair());
     tmp.emplace("array", help_array());
+    tmp.emplace("ndarray", help_ndarray());
     tmp.emplace("hashmap", help_hashmap());
     tmp.emplace("orderedmap", help_orderedmap());
     tmp.emplace("range", help_range());
@@ -77,8 +78,8 @@ Every expression in ishlang evaluates to a value.
 A value can hold any of the following types:
 
   none int real char bool string pair
-  array hashmap orderedmap range file closure
-  usertype userobject
+  array ndarray hashmap orderedmap range file closure
+  usertype userobject future generator iterator
 
 Examples:
        none: null
@@ -89,6 +90,7 @@ Examples:
      string: "hello"
        pair: (pair 1 2)
       array: (array 1 2)
+    ndarray: (ndarray (array 1 2))
     hashmap: (hashmap (pair 1 100))
  orderedmap: (orderedmap (pair 1 100))
       range: (range 10)
@@ -96,6 +98,9 @@ Examples:
     closure: (lambda () 42)
    usertype: (struct Foo (bar))
  userobject: (makeinstance Foo)
+     future: (spawn (+ 1 2))
+  generator: (upto 10), upto defined with generator
+   iterator: (iter (array 1 2))
 
 Type checking functions:
   istypeof - check expression type matches any of provided types
@@ -141,6 +146,13 @@ Variadic Operations: + - * / % ^
   Example:
     (+ 1 2 3) <=> (+ (+ 1 2) 3)
 
+  Array operands are applied elementwise and produce a new array.
+  Arrays must be the same size, and a number operand is applied
+  to every element. Ndarray operands work the same way, must have
+  the same shape, and do not support %.
+  Example:
+    (* (array 1 2 3) 2) <=> (array 2 4 6)
+
 Binary operations: += -= *= /= %= ^=
   (<op> <name> <expression>)
 
@@ -261,6 +273,7 @@ User Defined Functions:
 
   * Functions can be nested
   * Functions can be recursive
+  * Calls in tail position run in constant stack space
 
   Example
     (defun add (x y)
@@ -277,6 +290,26 @@ Lambda Expressions / Closures:
 
   Example
     (lambda (x) (+ x 1))
+
+Generators:
+  (generator <param_list>
+    <body>)
+
+  (yield <expr>)
+
+  * A generator is a closure, calling it returns a generator value
+    and the body runs lazily, suspended at each yield
+  * Yield must be a statement of the body, or of progn, block, if,
+    when, unless, cond, loop, while or foreach statements of the body
+  * Generators are consumed by foreach, map, filter, reduce, all,
+    any and sum, one item at a time
+  * Copies of a generator value share its position
+
+  Example
+    (var upto (generator (n)
+      (loop (var i 0) (< i n) (+= i 1)
+        (yield i))))
+    (sum (upto 10))
 )";
 }
 
@@ -488,6 +521,9 @@ Array Operations
    arrsort - Sort array
              (arrsort <array> [<descending>])
 
+arrbsearch - Binary search for position of value in sorted array, -1 if not found
+             (arrbsearch <array> <value> [<descending>])
+
     arrrev - Reverse array
              (arrrev <array>)
 
@@ -504,6 +540,59 @@ See ":help generic" for information on array generic functions support.
 )";
 }
 
+const char *HelpDict::help_ndarray() {
+    return R"(
+Ndarray Operations
+------------------
+N dimensional arrays of reals stored row major. Rows, slices,
+transposes and reshapes are views sharing the elements of the
+ndarray they come from. Use clone to make an independent copy.
+A shape is an integer or an array of integers.
+
+    ndarray - Make an ndarray from nested arrays of numbers, or from an array and a shape
+              (ndarray <array> [<shape>])
+
+     ndfill - Make an ndarray from shape and fill value, default fill value is 0
+              (ndfill <shape> [<fill_value>])
+
+    ndshape - Return ndarray shape as an array of integers
+              (ndshape <ndarray>)
+
+  ndreshape - Return ndarray with a new shape and the same number of elements
+              (ndreshape <ndarray> <shape>)
+
+ndtranspose - Return transpose of ndarray
+              (ndtranspose <ndarray>)
+
+    ndslice - Return slice of ndarray along an axis, end excluded
+              (ndslice <ndarray> <axis> <begin> <end>)
+
+      ndget - Return element at index, one position per dimension
+              (ndget <ndarray> <position> [<position> ...])
+
+      ndset - Set element at index, one position per dimension
+              (ndset <ndarray> <position> [<position> ...] <value>)
+
+   ndmatmul - Return matrix product of a matrix and a matrix or vector
+              (ndmatmul <ndarray> <ndarray>)
+
+      ndsum - Return sum of elements, or an ndarray of sums along an axis
+              (ndsum <ndarray> [<axis>])
+
+  ndtoarray - Convert ndarray to nested arrays of reals
+              (ndtoarray <ndarray>)
+
+Loop
+----
+Use foreach to loop over the rows of an ndarray
+  (foreach <var> <ndarray>
+    <body>)
+
+See ":help arith" for elementwise arithmetic on ndarrays.
+See ":help generic" for information on ndarray generic functions support.
+)";
+}
+
 const char *HelpDict::help_hashmap() {
     return R"(
 Hashmap Operations
@@ -609,6 +698,21 @@ Orderedmap Operations
     omritems - Return array of orderedmap reverse key/value pairs
                (omritems <orderedmap>)
 
+     omfloor - Return greatest orderedmap key less than or equal to key, null if none
+               (omfloor <orderedmap> <key>)
+
+      omceil - Return least orderedmap key greater than or equal to key, null if none
+               (omceil <orderedmap> <key>)
+
+     omlower - Return greatest orderedmap key less than key, null if none
+               (omlower <orderedmap> <key>)
+
+    omhigher - Return least orderedmap key greater than key, null if none
+               (omhigher <orderedmap> <key>)
+
+     omrange - Return array of orderedmap key/value pairs with keys in range [lo, hi)
+               (omrange <orderedmap> <lo> <hi>)
+
 See ":help generic" for information on orderedmap generic functions support.
 )";
 }
@@ -654,23 +758,23 @@ const char *HelpDict::help_generic() {
     return R"(
 Generic Functions
 -----------------
-      len - Length of string, array, hashmap, orderedmap, pair or range
+      len - Length of string, array, ndarray, hashmap, orderedmap, pair, range or iterator
             (len <object>)
 
-    empty - Is string, array, hashmap, orderedmap, pair or range empty?
+    empty - Is string, array, ndarray, hashmap, orderedmap, pair or range empty?
             (empty <object>)
 
-      get - Get value at index, key or member from string, array, hashmap, orderedmap, pair or userobject
+      get - Get value at index, key or member from string, array, ndarray, hashmap, orderedmap, pair or userobject
             (get <object> <key> [<default_return>])
 
-            * For string, pair and array, key must be an integer
+            * For string, pair, array and ndarray, key must be an integer
             * For userobject, key must be a member name/symbol or a string
             * The parameter default_return applies to hashmap and orderedmap, and is ignored otherwise
 
-      set - Set value at index, key or member for string, array, hashmap, orderedmap or userobject
+      set - Set value at index, key or member for string, array, ndarray, hashmap, orderedmap or userobject
             (set <object> <key> <value>)
 
-            * For string and array, key must be an integer
+            * For string, array and ndarray, key must be an integer
             * For userobject, key must be a member name/symbol or a string
 
     clear - Clear string, array, hashmap, orderedmap
@@ -696,13 +800,77 @@ Generic Functions
   reverse - Reverse string or array
             (reverse <obj>)
 
-      sum - Sum array, pair or range
+      sum - Sum array, ndarray, pair, range, generator or iterator
             (sum <obj>)
 
     apply - Apply function to array, pair or range
             (apply <ftn> <obj>)
 
             * Length of <ftn> parameters must match <obj> length
+
+      map - Map function over string, array, pair, hashmap, orderedmap or range
+            (map <obj> <ftn>)
+
+            * A string maps to a string and <ftn> must return characters
+            * An array or range maps to an array, a pair to a pair
+            * For hashmap and orderedmap, <ftn> is called with key value pairs,
+              must return pairs and the result is a map of the same kind
+
+   filter - Filter string, array, hashmap, orderedmap or range by predicate
+            (filter <obj> <predicate>)
+
+            * <predicate> must return a boolean
+
+   reduce - Reduce string, array, pair, hashmap, orderedmap or range with function
+            (reduce <obj> <init> <ftn>)
+
+            * <ftn> is called with the accumulated value, starting with <init>, and the next item
+
+      all - Does predicate hold for all items of string, array, pair, hashmap, orderedmap or range?
+            (all <obj> <predicate>)
+
+      any - Does predicate hold for any item of string, array, pair, hashmap, orderedmap or range?
+            (any <obj> <predicate>)
+
+     pmap - Parallel map
+            (pmap <obj> <ftn>)
+
+  pfilter - Parallel filter
+            (pfilter <obj> <predicate>)
+
+  preduce - Parallel reduce
+            (preduce <obj> <init> <ftn>)
+
+            * Arrays and ranges are split in chunks run on a thread pool, other
+              objects are processed like map, filter and reduce
+            * Results keep the order of the items
+            * The preduce function must be associative
+            * Functions run concurrently and must not modify shared variables or objects
+
+     iter - Make an iterator over string, array, ndarray, hashmap, orderedmap, range, file or generator
+            (iter <obj>)
+
+     imap - Lazily map function over iterator or iterable object
+            (imap <obj> <ftn>)
+
+  ifilter - Lazily filter iterator or iterable object by predicate
+            (ifilter <obj> <predicate>)
+
+    itake - Lazily take first count items of iterator or iterable object
+            (itake <obj> <count>)
+
+     izip - Lazily pair items of two iterators or iterable objects
+            (izip <obj1> <obj2>)
+
+ienumerate - Lazily pair items of iterator or iterable object with their index
+            (ienumerate <obj>)
+
+  collect - Collect remaining items of iterator or iterable object into an array
+            (collect <obj>)
+
+            * Adapters run in a single pass when the result is consumed by
+              foreach, sum, len, map, filter, reduce, all, any or collect
+            * Copies of an iterator share its position, items are consumed once
 )";
 }
 
@@ -713,11 +881,17 @@ Math Functions
     abs - Return absolute value of number
           (abs <number>)
 
-    min - Return minimum of numbers
+    min - Return minimum of numbers, or of the numbers in an array or ndarray
           (min <number> <number> [<number> ...])
+          (min <array>)
+          (min <ndarray>)
 
-    max - Return maximum of numbers
+    max - Return maximum of numbers, or of the numbers in an array or ndarray
           (max <number> <number> [<number> ...])
+          (max <array>)
+          (max <ndarray>)
+
+          * The minimum or maximum of an empty array is null
 
    sign - Return sign of number
           (sign <number>)
@@ -807,6 +981,29 @@ Misc Functions
            * Allowed count range is [1, 1000000000]
            * The summary is a flag to print a time summary, defaults to true
            * The summary will show count, total, mean
+
+      gc - Run the cycle collector, return number of objects reclaimed
+           (gc)
+
+ gcstats - Return hashmap of collector counters
+           (gcstats)
+
+           * Counters are collections, reclaimed, tracked and threshold
+
+   spawn - Evaluate expression as a task on the thread pool, return its future
+           (spawn <expr>)
+
+           * The expression is evaluated in its own scope
+           * Local variables are copied when spawned, assignments to them are not shared
+           * Tasks run concurrently and must not modify shared variables or objects
+
+   await - Wait for a future and return its value
+           (await <future>)
+
+           * An error raised by the task is raised again by await
+
+awaitall - Wait for an array of futures and return an array of their values
+           (awaitall <array>)
 )";
 }
 
@@ -860,15 +1057,16 @@ File IO
      fopen - Open a file for reading or writing
              (fopen <filename> <mode>])
 
-             * Mode must be one of 'r' (read), 'w' (write) or 'a' (append)
+             * Mode must be one of 'r' (read), 'w' (write), 'a' (append)
+               or 'm' (memory mapped read)
              * Use foreach to iterate over lines in a file
              * Use withfile to open a file, do work and close file
 
     fclose - Close file
              (fclose <file>)
 
-    fflush - Flush file
-             (fflush <file>)
+    fflush - Flush file, or standard output when no file is given
+             (fflush [<file>])
 
    fisopen - Is file open?
              (fisopen <file>)
@@ -885,12 +1083,32 @@ File IO
    freadln - Read line
              (freadln <file>)
 
+  freadall - Read rest of file into a string
+             (freadall <file>)
+
     fwrite - Write character or string
              (fwrite <file> <char_or_str>)
 
   fwriteln - Write character or string followed by newline
              (fwriteln <file> <char_or_str>)
 
+   csvopen - Open a csv file for reading, default delimiter is ','
+             (csvopen <filename> [<delimiter>])
+
+             * Foreach over a csv file yields one array of fields per row
+
+csvreadrow - Read next csv row as an array, null at end of file
+             (csvreadrow <file> [<delimiter>])
+
+   csvrows - Read remaining csv rows as an array of arrays
+             (csvrows <file> [<delimiter>])
+
+   csvcols - Read remaining csv rows as an array of columns
+             (csvcols <file> [<delimiter>])
+
+             * Numeric fields become numbers, others strings
+             * Quoted fields are strings, "" stands for a quote
+
    fexists - Does file exist?
              (fexists <filename>)
 
@@ -32,6 +32,7 @@ namespace Ishlang {
         static const char *help_charop();
         static const char *help_pair();
         static const char *help_array();
+        static const char *help_ndarray();
         static const char *help_hashmap();
         static const char *help_orderedmap();
         static const char *help_range();
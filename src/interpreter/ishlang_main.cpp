@@ -1,4 +1,5 @@
 #include "interpreter.h"
+#include "thread_pool.h"
 
 #include <cstdlib>
 #include <iostream>
@@ -12,6 +13,10 @@ public:
         , program()
         , interactive(false)
         , batch(false)
+        , byteCode(false)
+        , optimizeLevel(0)
+        , dump(false)
+        , threads(0)
         , filename()
         , expression()
         , argsBegin(argc)
@@ -29,6 +34,10 @@ private:
                 if      (arg == "-h") { usage(); }
                 else if (arg == "-i") { interactive = true; }
                 else if (arg == "-b") { batch = true; }
+                else if (arg == "-c") { byteCode = true; }
+                else if (arg.starts_with("-O")) { optimizeLevel = readOptimizeLevel(arg); }
+                else if (arg == "-d") { dump = true; }
+                else if (arg == "-j") { threads = readThreads(i); }
                 else if (arg == "-p") { path = readArgValue("path", i); }
                 else if (arg == "-f") { filename = readArgValue("file", i); }
                 else if (arg == "-e") { expression = readArgValue("expression", i); }
@@ -46,12 +55,16 @@ private:
 private:
     void usage() {
         std::cerr << "Usage:\n"
-                  << '\t' << program << " [-h] [-i] [-b] [-p] [-f file] [-e expr] [-a arg1 ... argN]\n"
+                  << '\t' << program << " [-h] [-i] [-b] [-c] [-O[level]] [-d] [-j threads] [-p] [-f file] [-e expr] [-a arg1 ... argN]\n"
                   << '\n'
                   << "Options:\n"
                   << '\t' << "-h : Print usage\n"
                   << '\t' << "-i : Enter interactive mode\n"
                   << '\t' << "-b : Run in batch mode\n"
+                  << '\t' << "-c : Compile to byte code and run on virtual machine\n"
+                  << '\t' << "-O : Optimize code before running it, level 0 to 2, -O alone is level 1\n"
+                  << '\t' << "-d : Print code before running it, as optimized\n"
+                  << '\t' << "-j : Threads running parallel builtins and spawned tasks, defaults to machine cores\n"
                   << '\t' << "-p : Import path\n"
                   << '\t' << "-f : Run code file\n"
                   << '\t' << "-e : Execute expression, after running file, before entering interactive mode\n"
@@ -66,6 +79,27 @@ private:
         return 0;
     }
 
+    std::size_t readThreads(int &i) {
+        const std::string value = readArgValue("threads", i);
+        try {
+            std::size_t pos = 0;
+            const auto threads = std::stoul(value, &pos);
+            if (pos == value.size() && threads > 0) { return threads; }
+        }
+        catch (const std::exception &) {
+        }
+        argError(std::string("Invalid thread count '") + value + "'");
+        return 0;
+    }
+
+    unsigned readOptimizeLevel(const std::string &arg) {
+        const auto value = arg.substr(2);
+        if (value.empty()) { return 1; }
+        if (value.size() == 1 && value[0] >= '0' && value[0] <= '2') { return value[0] - '0'; }
+        argError(std::string("Invalid optimization level '") + value + "'");
+        return 0;
+    }
+
     void argError(const std::string &msg) {
         std::cerr << "\nError: " << msg << "\n\n";
         usage();
@@ -78,6 +112,10 @@ public:
     std::string program;
     bool        interactive;
     bool        batch;
+    bool        byteCode;
+    unsigned    optimizeLevel;
+    bool        dump;
+    std::size_t threads;
     std::string path;
     std::string filename;
     std::string expression;
@@ -86,12 +124,16 @@ public:
 
 int main(int argc, char** argv) {
     Arguments args(argc, argv);
+    Ishlang::ThreadPool::configure(args.threads);
 
     bool const forceInteractive = (args.filename.empty() && args.expression.empty() && !args.interactive);
     bool const forceBatch = (!args.filename.empty() && !args.interactive);
 
     Ishlang::Interpreter interpreter(args.batch || forceBatch, args.path);
     interpreter.setArguments(args.argv, args.argsBegin, args.argc);
+    interpreter.setByteCode(args.byteCode);
+    interpreter.setOptimizeLevel(args.optimizeLevel);
+    interpreter.setDump(args.dump);
 
     if (!args.filename.empty()) {
         try {
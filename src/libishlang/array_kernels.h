@@ -0,0 +1,336 @@
+#ifndef ISHLANG_ARRAY_KERNELS_H
+#define ISHLANG_ARRAY_KERNELS_H
+
+#include "value.h"
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Ishlang {
+
+    // Loops over packed integer and real arrays. Sums, searches and the
+    // elementwise operations the vector unit supports run two lanes per
+    // SSE2 instruction, the rest and the tails are scalar.
+    class ArrayKernels {
+    public:
+        using Long   = Value::Long;
+        using Double = Value::Double;
+
+    public:
+        static inline Long sum(std::span<const Long> vals);
+
+        // Reals are summed in four lanes added together at the end, so the
+        // result may differ in the last bits from a left to right sum.
+        static inline Double sum(std::span<const Double> vals);
+
+        template <typename NumType>
+        static inline std::size_t count(std::span<const NumType> vals, NumType item);
+
+        template <typename NumType>
+        static inline std::optional<std::size_t> find(std::span<const NumType> vals, NumType item, std::size_t pos = 0);
+
+        // y[i] += a * x[i]
+        static inline void axpy(std::span<Double> y, Double a, std::span<const Double> x);
+
+        // Sum of lhs[i] * rhs[i], in four lanes like the sum of reals.
+        static inline Double dot(std::span<const Double> lhs, std::span<const Double> rhs);
+
+        // lhs[i] = op(lhs[i], rhs[i])
+        template <typename NumType, typename Op>
+        static inline void apply(std::span<NumType> lhs, std::span<const NumType> rhs, Op op);
+
+        // lhs[i] = op(lhs[i], rhs)
+        template <typename NumType, typename Op>
+        static inline void apply(std::span<NumType> lhs, NumType rhs, Op op);
+
+    private:
+#if defined(__SSE2__)
+        static inline unsigned equalMask(const Long *vals, __m128i item);
+        static inline unsigned equalMask(const Double *vals, __m128d item);
+
+        template <typename NumType, typename Op>
+        static constexpr bool vectorOp();
+
+        template <typename Op>
+        static inline __m128i vectorApply(__m128i lhs, __m128i rhs, Op op);
+
+        template <typename Op>
+        static inline __m128d vectorApply(__m128d lhs, __m128d rhs, Op op);
+#endif
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline auto ArrayKernels::sum(std::span<const Long> vals) -> Long {
+        const Long *data = vals.data();
+        const std::size_t size = vals.size();
+        std::size_t i = 0;
+        Long total = 0;
+#if defined(__SSE2__)
+        __m128i acc0 = _mm_setzero_si128();
+        __m128i acc1 = _mm_setzero_si128();
+        for (; i + 4 <= size; i += 4) {
+            acc0 = _mm_add_epi64(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+            acc1 = _mm_add_epi64(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 2)));
+        }
+        alignas(16) Long lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes), _mm_add_epi64(acc0, acc1));
+        total = lanes[0] + lanes[1];
+#endif
+        for (; i < size; ++i) {
+            total += data[i];
+        }
+        return total;
+    }
+
+    inline auto ArrayKernels::sum(std::span<const Double> vals) -> Double {
+        const Double *data = vals.data();
+        const std::size_t size = vals.size();
+        std::size_t i = 0;
+        Double total = 0.0;
+        if (size >= 4) {
+#if defined(__SSE2__)
+            __m128d acc0 = _mm_setzero_pd();
+            __m128d acc1 = _mm_setzero_pd();
+            for (; i + 4 <= size; i += 4) {
+                acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data + i));
+                acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data + i + 2));
+            }
+            alignas(16) Double lanes[2];
+            _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+            total = lanes[0] + lanes[1];
+#else
+            Double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+            for (; i + 4 <= size; i += 4) {
+                lanes[0] += data[i];
+                lanes[1] += data[i + 1];
+                lanes[2] += data[i + 2];
+                lanes[3] += data[i + 3];
+            }
+            total = (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+#endif
+        }
+        for (; i < size; ++i) {
+            total += data[i];
+        }
+        return total;
+    }
+
+    inline void ArrayKernels::axpy(std::span<Double> y, Double a, std::span<const Double> x) {
+        Double *out = y.data();
+        const Double *in = x.data();
+        const std::size_t size = y.size();
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        const __m128d scale = _mm_set1_pd(a);
+        for (; i + 4 <= size; i += 4) {
+            const __m128d y0 = _mm_add_pd(_mm_loadu_pd(out + i), _mm_mul_pd(scale, _mm_loadu_pd(in + i)));
+            const __m128d y1 = _mm_add_pd(_mm_loadu_pd(out + i + 2), _mm_mul_pd(scale, _mm_loadu_pd(in + i + 2)));
+            _mm_storeu_pd(out + i, y0);
+            _mm_storeu_pd(out + i + 2, y1);
+        }
+#endif
+        for (; i < size; ++i) {
+            out[i] += a * in[i];
+        }
+    }
+
+    inline auto ArrayKernels::dot(std::span<const Double> lhs, std::span<const Double> rhs) -> Double {
+        const Double *a = lhs.data();
+        const Double *b = rhs.data();
+        const std::size_t size = lhs.size();
+        std::size_t i = 0;
+        Double total = 0.0;
+        if (size >= 4) {
+#if defined(__SSE2__)
+            __m128d acc0 = _mm_setzero_pd();
+            __m128d acc1 = _mm_setzero_pd();
+            for (; i + 4 <= size; i += 4) {
+                acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+            }
+            alignas(16) Double lanes[2];
+            _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+            total = lanes[0] + lanes[1];
+#else
+            Double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+            for (; i + 4 <= size; i += 4) {
+                lanes[0] += a[i] * b[i];
+                lanes[1] += a[i + 1] * b[i + 1];
+                lanes[2] += a[i + 2] * b[i + 2];
+                lanes[3] += a[i + 3] * b[i + 3];
+            }
+            total = (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+#endif
+        }
+        for (; i < size; ++i) {
+            total += a[i] * b[i];
+        }
+        return total;
+    }
+
+    template <typename NumType>
+    inline std::size_t ArrayKernels::count(std::span<const NumType> vals, NumType item) {
+        static_assert(std::is_same_v<NumType, Long> || std::is_same_v<NumType, Double>);
+
+        const NumType *data = vals.data();
+        const std::size_t size = vals.size();
+        std::size_t i = 0;
+        std::size_t total = 0;
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<NumType, Long>) {
+            const __m128i needle = _mm_set1_epi64x(item);
+            for (; i + 2 <= size; i += 2) {
+                total += std::popcount(equalMask(data + i, needle));
+            }
+        }
+        else {
+            const __m128d needle = _mm_set1_pd(item);
+            for (; i + 2 <= size; i += 2) {
+                total += std::popcount(equalMask(data + i, needle));
+            }
+        }
+#endif
+        for (; i < size; ++i) {
+            total += data[i] == item;
+        }
+        return total;
+    }
+
+    template <typename NumType>
+    inline std::optional<std::size_t> ArrayKernels::find(std::span<const NumType> vals, NumType item, std::size_t pos) {
+        static_assert(std::is_same_v<NumType, Long> || std::is_same_v<NumType, Double>);
+
+        const NumType *data = vals.data();
+        const std::size_t size = vals.size();
+        std::size_t i = pos;
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<NumType, Long>) {
+            const __m128i needle = _mm_set1_epi64x(item);
+            for (; i + 2 <= size; i += 2) {
+                if (const auto mask = equalMask(data + i, needle)) {
+                    return i + std::countr_zero(mask);
+                }
+            }
+        }
+        else {
+            const __m128d needle = _mm_set1_pd(item);
+            for (; i + 2 <= size; i += 2) {
+                if (const auto mask = equalMask(data + i, needle)) {
+                    return i + std::countr_zero(mask);
+                }
+            }
+        }
+#endif
+        for (; i < size; ++i) {
+            if (data[i] == item) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <typename NumType, typename Op>
+    inline void ArrayKernels::apply(std::span<NumType> lhs, std::span<const NumType> rhs, Op op) {
+        NumType *out = lhs.data();
+        const NumType *in = rhs.data();
+        const std::size_t size = lhs.size();
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        if constexpr (vectorOp<NumType, Op>()) {
+            if constexpr (std::is_same_v<NumType, Long>) {
+                for (; i + 2 <= size; i += 2) {
+                    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(out + i));
+                    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), vectorApply(a, b, op));
+                }
+            }
+            else {
+                for (; i + 2 <= size; i += 2) {
+                    _mm_storeu_pd(out + i, vectorApply(_mm_loadu_pd(out + i), _mm_loadu_pd(in + i), op));
+                }
+            }
+        }
+#endif
+        for (; i < size; ++i) {
+            out[i] = op(out[i], in[i]);
+        }
+    }
+
+    template <typename NumType, typename Op>
+    inline void ArrayKernels::apply(std::span<NumType> lhs, NumType rhs, Op op) {
+        NumType *out = lhs.data();
+        const std::size_t size = lhs.size();
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        if constexpr (vectorOp<NumType, Op>()) {
+            if constexpr (std::is_same_v<NumType, Long>) {
+                const __m128i b = _mm_set1_epi64x(rhs);
+                for (; i + 2 <= size; i += 2) {
+                    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(out + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), vectorApply(a, b, op));
+                }
+            }
+            else {
+                const __m128d b = _mm_set1_pd(rhs);
+                for (; i + 2 <= size; i += 2) {
+                    _mm_storeu_pd(out + i, vectorApply(_mm_loadu_pd(out + i), b, op));
+                }
+            }
+        }
+#endif
+        for (; i < size; ++i) {
+            out[i] = op(out[i], rhs);
+        }
+    }
+
+#if defined(__SSE2__)
+    inline unsigned ArrayKernels::equalMask(const Long *vals, __m128i item) {
+        // No 64 bit compare in SSE2, a lane is equal when both of its 32 bit halves are.
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(vals)), item);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+    }
+
+    inline unsigned ArrayKernels::equalMask(const Double *vals, __m128d item) {
+        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(vals), item)));
+    }
+
+    template <typename NumType, typename Op>
+    constexpr bool ArrayKernels::vectorOp() {
+        if constexpr (std::is_same_v<NumType, Long>) {
+            return std::is_same_v<Op, std::plus<Long>> || std::is_same_v<Op, std::minus<Long>>;
+        }
+        else {
+            return std::is_same_v<Op, std::plus<Double>> || std::is_same_v<Op, std::minus<Double>> ||
+                   std::is_same_v<Op, std::multiplies<Double>> || std::is_same_v<Op, std::divides<Double>>;
+        }
+    }
+
+    template <typename Op>
+    inline __m128i ArrayKernels::vectorApply(__m128i lhs, __m128i rhs, Op) {
+        if constexpr (std::is_same_v<Op, std::plus<Long>>) { return _mm_add_epi64(lhs, rhs); }
+        else                                               { return _mm_sub_epi64(lhs, rhs); }
+    }
+
+    template <typename Op>
+    inline __m128d ArrayKernels::vectorApply(__m128d lhs, __m128d rhs, Op) {
+        if constexpr (std::is_same_v<Op, std::plus<Double>>)            { return _mm_add_pd(lhs, rhs); }
+        else if constexpr (std::is_same_v<Op, std::minus<Double>>)      { return _mm_sub_pd(lhs, rhs); }
+        else if constexpr (std::is_same_v<Op, std::multiplies<Double>>) { return _mm_mul_pd(lhs, rhs); }
+        else                                                            { return _mm_div_pd(lhs, rhs); }
+    }
+#endif
+
+}
+
+#endif // ISHLANG_ARRAY_KERNELS_H
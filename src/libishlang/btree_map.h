@@ -0,0 +1,709 @@
+#ifndef ISHLANG_BTREE_MAP_H
+#define ISHLANG_BTREE_MAP_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace Ishlang {
+
+    // Ordered map stored as a B+ tree. Entries are kept sorted in arrays of
+    // up to LeafCapacity entries and the leaves are linked in key order, so
+    // that ordered iteration walks arrays rather than tree nodes. Inner nodes
+    // only hold separator keys and children.
+    //
+    // Unlike std::map, any insertion or removal invalidates iterators.
+    template <typename Key, typename Mapped, typename Compare = std::less<Key>>
+    class BTreeMap {
+    public:
+        using key_type    = Key;
+        using mapped_type = Mapped;
+        using value_type  = std::pair<Key, Mapped>;
+        using size_type   = std::size_t;
+
+        static constexpr size_type LeafCapacity  = 32;
+        static constexpr size_type InnerCapacity = 32;
+
+        template <bool IsConst>
+        class Iterator;
+
+        using iterator               = Iterator<false>;
+        using const_iterator         = Iterator<true>;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    public:
+        BTreeMap() noexcept = default;
+        BTreeMap(const BTreeMap &other);
+        BTreeMap(BTreeMap &&other) noexcept;
+        ~BTreeMap();
+
+        BTreeMap &operator=(const BTreeMap &other);
+        BTreeMap &operator=(BTreeMap &&other) noexcept;
+
+        inline iterator find(const Key &key);
+        inline const_iterator find(const Key &key) const;
+
+        // First entry not less than key, and first entry greater than key.
+        inline const_iterator lower_bound(const Key &key) const;
+        inline const_iterator upper_bound(const Key &key) const;
+
+        inline Mapped &operator[](const Key &key);
+
+        // Inserts when the key is not in the map yet.
+        inline std::pair<iterator, bool> emplace(const Key &key, const Mapped &mapped);
+
+        size_type erase(const Key &key);
+        void clear() noexcept;
+
+        inline size_type size() const noexcept;
+        inline bool empty() const noexcept;
+
+        inline iterator begin() noexcept;
+        inline iterator end() noexcept;
+        inline const_iterator begin() const noexcept;
+        inline const_iterator end() const noexcept;
+
+        inline const_reverse_iterator rbegin() const noexcept;
+        inline const_reverse_iterator rend() const noexcept;
+
+    private:
+        struct Node {
+            bool          leaf;
+            std::uint16_t count = 0;
+        };
+
+        // One spare slot lets a node overflow before it is split.
+        struct Leaf : Node {
+            Leaf() : Node{true} {}
+
+            Leaf                                     *prev = nullptr;
+            Leaf                                     *next = nullptr;
+            std::array<value_type, LeafCapacity + 1>  entries;
+        };
+
+        struct Inner : Node {
+            Inner() : Node{false} {}
+
+            std::array<Key, InnerCapacity + 1>    keys;
+            std::array<Node *, InnerCapacity + 2> children;
+        };
+
+        struct Split {
+            Key   key;
+            Node *right = nullptr;
+        };
+
+        static constexpr size_type MinLeafCount  = LeafCapacity / 2;
+        static constexpr size_type MinInnerCount = InnerCapacity / 2;
+
+    public:
+        template <bool IsConst>
+        class Iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type        = BTreeMap::value_type;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = std::conditional_t<IsConst, const value_type *, value_type *>;
+            using reference         = std::conditional_t<IsConst, const value_type &, value_type &>;
+
+            Iterator() noexcept = default;
+
+            template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+            Iterator(const Iterator<OtherConst> &other) noexcept
+                : leaf_(other.leaf_)
+                , index_(other.index_)
+            {}
+
+            reference operator*() const noexcept { return leaf_->entries[index_]; }
+            pointer operator->() const noexcept { return &leaf_->entries[index_]; }
+
+            Iterator &operator++() noexcept {
+                if (++index_ == leaf_->count && leaf_->next) {
+                    leaf_ = leaf_->next;
+                    index_ = 0;
+                }
+                return *this;
+            }
+
+            Iterator operator++(int) noexcept {
+                Iterator tmp(*this);
+                ++*this;
+                return tmp;
+            }
+
+            Iterator &operator--() noexcept {
+                if (index_ == 0) {
+                    leaf_ = leaf_->prev;
+                    index_ = leaf_->count;
+                }
+                --index_;
+                return *this;
+            }
+
+            Iterator operator--(int) noexcept {
+                Iterator tmp(*this);
+                --*this;
+                return tmp;
+            }
+
+            friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept {
+                return lhs.leaf_ == rhs.leaf_ && lhs.index_ == rhs.index_;
+            }
+
+            friend bool operator!=(const Iterator &lhs, const Iterator &rhs) noexcept {
+                return !(lhs == rhs);
+            }
+
+        private:
+            friend class BTreeMap;
+            friend class Iterator<!IsConst>;
+
+            Iterator(Leaf *leaf, size_type index) noexcept
+                : leaf_(leaf)
+                , index_(index)
+            {}
+
+        private:
+            Leaf      *leaf_ = nullptr;
+            size_type  index_ = 0;
+        };
+
+    private:
+        inline bool equivalent(const Key &lhs, const Key &rhs) const;
+
+        inline size_type leafPosition(const Leaf &leaf, const Key &key) const;
+        inline size_type childPosition(const Inner &inner, const Key &key) const;
+
+        inline Leaf *findLeaf(const Key &key) const;
+        inline std::pair<Leaf *, size_type> locate(const Key &key) const;
+        inline iterator normalize(Leaf *leaf, size_type index) const noexcept;
+
+        // Inserts the entry unless the key is present already, and returns
+        // the entry for the key.
+        std::pair<value_type *, bool> insertRoot(const Key &key, const Mapped &mapped);
+        std::pair<value_type *, bool> insert(Node *node, const Key &key, const Mapped &mapped, Split &split);
+        std::pair<value_type *, bool> insertLeaf(Leaf &leaf, const Key &key, const Mapped &mapped, Split &split);
+        void insertChild(Inner &inner, size_type pos, Split &split);
+
+        bool erase(Node *node, const Key &key);
+        void rebalance(Inner &parent, size_type pos);
+        void rebalanceLeaves(Inner &parent, size_type pos);
+        void rebalanceInners(Inner &parent, size_type pos);
+        static inline void removeChild(Inner &parent, size_type pos);
+
+        Node *clone(const Node *node, Leaf *&lastLeaf);
+        static void destroy(Node *node) noexcept;
+
+    private:
+        Node      *root_ = nullptr;
+        Leaf      *head_ = nullptr;
+        Leaf      *tail_ = nullptr;
+        size_type  size_ = 0;
+
+        [[no_unique_address]] Compare less_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    template <typename K, typename M, typename C>
+    BTreeMap<K, M, C>::BTreeMap(const BTreeMap &other) {
+        if (other.root_) {
+            Leaf *lastLeaf = nullptr;
+            root_ = clone(other.root_, lastLeaf);
+            tail_ = lastLeaf;
+            size_ = other.size_;
+        }
+    }
+
+    template <typename K, typename M, typename C>
+    BTreeMap<K, M, C>::BTreeMap(BTreeMap &&other) noexcept
+        : root_(std::exchange(other.root_, nullptr))
+        , head_(std::exchange(other.head_, nullptr))
+        , tail_(std::exchange(other.tail_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    {}
+
+    template <typename K, typename M, typename C>
+    BTreeMap<K, M, C>::~BTreeMap() {
+        clear();
+    }
+
+    template <typename K, typename M, typename C>
+    auto BTreeMap<K, M, C>::operator=(const BTreeMap &other) -> BTreeMap & {
+        if (this != &other) {
+            BTreeMap tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    template <typename K, typename M, typename C>
+    auto BTreeMap<K, M, C>::operator=(BTreeMap &&other) noexcept -> BTreeMap & {
+        if (this != &other) {
+            clear();
+            root_ = std::exchange(other.root_, nullptr);
+            head_ = std::exchange(other.head_, nullptr);
+            tail_ = std::exchange(other.tail_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::find(const K &key) -> iterator {
+        const auto [leaf, pos] = locate(key);
+        return leaf && pos < leaf->count && equivalent(leaf->entries[pos].first, key) ? iterator(leaf, pos) : end();
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::find(const K &key) const -> const_iterator {
+        const auto [leaf, pos] = locate(key);
+        return leaf && pos < leaf->count && equivalent(leaf->entries[pos].first, key) ? const_iterator(leaf, pos) : end();
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::lower_bound(const K &key) const -> const_iterator {
+        const auto [leaf, pos] = locate(key);
+        return leaf ? normalize(leaf, pos) : end();
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::upper_bound(const K &key) const -> const_iterator {
+        auto [leaf, pos] = locate(key);
+        if (!leaf) {
+            return end();
+        }
+        if (pos < leaf->count && equivalent(leaf->entries[pos].first, key)) {
+            ++pos;
+        }
+        return normalize(leaf, pos);
+    }
+
+    template <typename K, typename M, typename C>
+    inline M &BTreeMap<K, M, C>::operator[](const K &key) {
+        return insertRoot(key, M()).first->second;
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::emplace(const K &key, const M &mapped) -> std::pair<iterator, bool> {
+        const bool inserted = insertRoot(key, mapped).second;
+        return {find(key), inserted};
+    }
+
+    template <typename K, typename M, typename C>
+    auto BTreeMap<K, M, C>::erase(const K &key) -> size_type {
+        if (!root_ || !erase(root_, key)) {
+            return 0;
+        }
+
+        --size_;
+        if (root_->count == 0) {
+            Node *oldRoot = root_;
+            if (root_->leaf) {
+                root_ = nullptr;
+                head_ = nullptr;
+                tail_ = nullptr;
+            }
+            else {
+                root_ = static_cast<Inner *>(oldRoot)->children[0];
+            }
+            oldRoot->count = 0;
+            destroy(oldRoot);
+        }
+        return 1;
+    }
+
+    template <typename K, typename M, typename C>
+    void BTreeMap<K, M, C>::clear() noexcept {
+        Node *root = std::exchange(root_, nullptr);
+        head_ = nullptr;
+        tail_ = nullptr;
+        size_ = 0;
+        destroy(root);
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::size() const noexcept -> size_type {
+        return size_;
+    }
+
+    template <typename K, typename M, typename C>
+    inline bool BTreeMap<K, M, C>::empty() const noexcept {
+        return size_ == 0;
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::begin() noexcept -> iterator {
+        return iterator(head_, 0);
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::end() noexcept -> iterator {
+        return iterator(tail_, tail_ ? tail_->count : 0);
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::begin() const noexcept -> const_iterator {
+        return const_iterator(head_, 0);
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::end() const noexcept -> const_iterator {
+        return const_iterator(tail_, tail_ ? tail_->count : 0);
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::rbegin() const noexcept -> const_reverse_iterator {
+        return const_reverse_iterator(end());
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::rend() const noexcept -> const_reverse_iterator {
+        return const_reverse_iterator(begin());
+    }
+
+    template <typename K, typename M, typename C>
+    inline bool BTreeMap<K, M, C>::equivalent(const K &lhs, const K &rhs) const {
+        return !less_(lhs, rhs) && !less_(rhs, lhs);
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::leafPosition(const Leaf &leaf, const K &key) const -> size_type {
+        const auto first = leaf.entries.begin();
+        return std::lower_bound(first, first + leaf.count, key,
+                                [this](const value_type &entry, const K &k) { return less_(entry.first, k); }) - first;
+    }
+
+    // Child i holds the keys from separator i - 1, inclusive, up to
+    // separator i.
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::childPosition(const Inner &inner, const K &key) const -> size_type {
+        const auto first = inner.keys.begin();
+        return std::upper_bound(first, first + inner.count, key,
+                                [this](const K &k, const K &sep) { return less_(k, sep); }) - first;
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::findLeaf(const K &key) const -> Leaf * {
+        Node *node = root_;
+        while (node && !node->leaf) {
+            const auto &inner = *static_cast<Inner *>(node);
+            node = inner.children[childPosition(inner, key)];
+        }
+        return static_cast<Leaf *>(node);
+    }
+
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::locate(const K &key) const -> std::pair<Leaf *, size_type> {
+        Leaf *leaf = findLeaf(key);
+        return {leaf, leaf ? leafPosition(*leaf, key) : 0};
+    }
+
+    // A position past the last entry of a leaf is the start of the next one.
+    template <typename K, typename M, typename C>
+    inline auto BTreeMap<K, M, C>::normalize(Leaf *leaf, size_type index) const noexcept -> iterator {
+        if (index == leaf->count && leaf->next) {
+            return iterator(leaf->next, 0);
+        }
+        return iterator(leaf, index);
+    }
+
+    template <typename K, typename M, typename C>
+    auto BTreeMap<K, M, C>::insertRoot(const K &key, const M &mapped) -> std::pair<value_type *, bool> {
+        if (!root_) {
+            Leaf *leaf = new Leaf();
+            root_ = leaf;
+            head_ = leaf;
+            tail_ = leaf;
+        }
+
+        Split split;
+        const auto result = insert(root_, key, mapped, split);
+        if (split.right) {
+            Inner *newRoot = new Inner();
+            newRoot->keys[0] = std::move(split.key);
+            newRoot->children[0] = root_;
+            newRoot->children[1] = split.right;
+            newRoot->count = 1;
+            root_ = newRoot;
+        }
+        if (result.second) {
+            ++size_;
+        }
+        return result;
+    }
+
+    template <typename K, typename M, typename C>
+    auto BTreeMap<K, M, C>::insert(Node *node, const K &key, const M &mapped, Split &split) -> std::pair<value_type *, bool> {
+        if (node->leaf) {
+            return insertLeaf(*static_cast<Leaf *>(node), key, mapped, split);
+        }
+
+        auto &inner = *static_cast<Inner *>(node);
+        const size_type pos = childPosition(inner, key);
+        const auto result = insert(inner.children[pos], key, mapped, split);
+        if (split.right) {
+            insertChild(inner, pos, split);
+        }
+        return result;
+    }
+
+    template <typename K, typename M, typename C>
+    auto BTreeMap<K, M, C>::insertLeaf(Leaf &leaf, const K &key, const M &mapped, Split &split) -> std::pair<value_type *, bool> {
+        const size_type pos = leafPosition(leaf, key);
+        if (pos < leaf.count && equivalent(leaf.entries[pos].first, key)) {
+            return {&leaf.entries[pos], false};
+        }
+
+        const auto first = leaf.entries.begin();
+        std::move_backward(first + pos, first + leaf.count, first + leaf.count + 1);
+        leaf.entries[pos] = value_type(key, mapped);
+        if (++leaf.count <= LeafCapacity) {
+            return {&leaf.entries[pos], true};
+        }
+
+        Leaf *right = new Leaf();
+        const size_type keep = leaf.count / 2;
+        std::move(first + keep, first + leaf.count, right->entries.begin());
+        std::fill(first + keep, first + leaf.count, value_type());
+        right->count = leaf.count - keep;
+        leaf.count = keep;
+
+        right->prev = &leaf;
+        right->next = leaf.next;
+        if (leaf.next) { leaf.next->prev = right; }
+        else           { tail_ = right; }
+        leaf.next = right;
+
+        split.key = right->entries[0].first;
+        split.right = right;
+        return {pos < keep ? &leaf.entries[pos] : &right->entries[pos - keep], true};
+    }
+
+    // Adds the split off sibling of child pos, splitting this node in turn
+    // when it overflows.
+    template <typename K, typename M, typename C>
+    void BTreeMap<K, M, C>::insertChild(Inner &inner, size_type pos, Split &split) {
+        const auto keys = inner.keys.begin();
+        const auto children = inner.children.begin();
+        std::move_backward(keys + pos, keys + inner.count, keys + inner.count + 1);
+        std::move_backward(children + pos + 1, children + inner.count + 1, children + inner.count + 2);
+        inner.keys[pos] = std::move(split.key);
+        inner.children[pos + 1] = split.right;
+        split.right = nullptr;
+        if (++inner.count <= InnerCapacity) {
+            return;
+        }
+
+        Inner *right = new Inner();
+        const size_type mid = inner.count / 2;
+        std::move(keys + mid + 1, keys + inner.count, right->keys.begin());
+        std::copy(children + mid + 1, children + inner.count + 1, right->children.begin());
+        right->count = inner.count - mid - 1;
+
+        split.key = std::move(inner.keys[mid]);
+        split.right = right;
+        std::fill(keys + mid, keys + inner.count, K());
+        inner.count = mid;
+    }
+
+    template <typename K, typename M, typename C>
+    bool BTreeMap<K, M, C>::erase(Node *node, const K &key) {
+        if (node->leaf) {
+            auto &leaf = *static_cast<Leaf *>(node);
+            const size_type pos = leafPosition(leaf, key);
+            if (pos == leaf.count || !equivalent(leaf.entries[pos].first, key)) {
+                return false;
+            }
+
+            const auto first = leaf.entries.begin();
+            std::move(first + pos + 1, first + leaf.count, first + pos);
+            leaf.entries[--leaf.count] = value_type();
+            return true;
+        }
+
+        auto &inner = *static_cast<Inner *>(node);
+        const size_type pos = childPosition(inner, key);
+        if (!erase(inner.children[pos], key)) {
+            return false;
+        }
+
+        const Node *child = inner.children[pos];
+        if (child->count < (child->leaf ? MinLeafCount : MinInnerCount)) {
+            rebalance(inner, pos);
+        }
+        return true;
+    }
+
+    template <typename K, typename M, typename C>
+    void BTreeMap<K, M, C>::rebalance(Inner &parent, size_type pos) {
+        if (parent.children[pos]->leaf) {
+            rebalanceLeaves(parent, pos);
+        }
+        else {
+            rebalanceInners(parent, pos);
+        }
+    }
+
+    // Refills an underflowing leaf from a sibling, or merges it with one.
+    template <typename K, typename M, typename C>
+    void BTreeMap<K, M, C>::rebalanceLeaves(Inner &parent, size_type pos) {
+        auto &child = *static_cast<Leaf *>(parent.children[pos]);
+
+        if (pos > 0) {
+            auto &left = *static_cast<Leaf *>(parent.children[pos - 1]);
+            if (left.count > MinLeafCount) {
+                const auto first = child.entries.begin();
+                std::move_backward(first, first + child.count, first + child.count + 1);
+                child.entries[0] = std::move(left.entries[left.count - 1]);
+                left.entries[--left.count] = value_type();
+                ++child.count;
+                parent.keys[pos - 1] = child.entries[0].first;
+                return;
+            }
+        }
+
+        if (pos < parent.count) {
+            auto &right = *static_cast<Leaf *>(parent.children[pos + 1]);
+            if (right.count > MinLeafCount) {
+                child.entries[child.count++] = std::move(right.entries[0]);
+                const auto first = right.entries.begin();
+                std::move(first + 1, first + right.count, first);
+                right.entries[--right.count] = value_type();
+                parent.keys[pos] = right.entries[0].first;
+                return;
+            }
+        }
+
+        // Merge the right one of the pair into the left one
+        const size_type leftPos = pos > 0 ? pos - 1 : pos;
+        auto &left = *static_cast<Leaf *>(parent.children[leftPos]);
+        auto *right = static_cast<Leaf *>(parent.children[leftPos + 1]);
+        std::move(right->entries.begin(), right->entries.begin() + right->count, left.entries.begin() + left.count);
+        left.count += right->count;
+        right->count = 0;
+
+        left.next = right->next;
+        if (right->next) { right->next->prev = &left; }
+        else             { tail_ = &left; }
+
+        removeChild(parent, leftPos);
+        destroy(right);
+    }
+
+    // Rotates a key through the parent from a sibling, or merges with one
+    // pulling the separator down.
+    template <typename K, typename M, typename C>
+    void BTreeMap<K, M, C>::rebalanceInners(Inner &parent, size_type pos) {
+        auto &child = *static_cast<Inner *>(parent.children[pos]);
+
+        if (pos > 0) {
+            auto &left = *static_cast<Inner *>(parent.children[pos - 1]);
+            if (left.count > MinInnerCount) {
+                const auto keys = child.keys.begin();
+                const auto children = child.children.begin();
+                std::move_backward(keys, keys + child.count, keys + child.count + 1);
+                std::move_backward(children, children + child.count + 1, children + child.count + 2);
+                child.keys[0] = std::move(parent.keys[pos - 1]);
+                child.children[0] = left.children[left.count];
+                ++child.count;
+                parent.keys[pos - 1] = std::move(left.keys[left.count - 1]);
+                left.keys[--left.count] = K();
+                return;
+            }
+        }
+
+        if (pos < parent.count) {
+            auto &right = *static_cast<Inner *>(parent.children[pos + 1]);
+            if (right.count > MinInnerCount) {
+                child.keys[child.count] = std::move(parent.keys[pos]);
+                child.children[++child.count] = right.children[0];
+                parent.keys[pos] = std::move(right.keys[0]);
+
+                const auto keys = right.keys.begin();
+                const auto children = right.children.begin();
+                std::move(keys + 1, keys + right.count, keys);
+                std::move(children + 1, children + right.count + 1, children);
+                right.keys[--right.count] = K();
+                return;
+            }
+        }
+
+        const size_type leftPos = pos > 0 ? pos - 1 : pos;
+        auto &left = *static_cast<Inner *>(parent.children[leftPos]);
+        auto *right = static_cast<Inner *>(parent.children[leftPos + 1]);
+        left.keys[left.count] = std::move(parent.keys[leftPos]);
+        std::move(right->keys.begin(), right->keys.begin() + right->count, left.keys.begin() + left.count + 1);
+        std::copy(right->children.begin(), right->children.begin() + right->count + 1, left.children.begin() + left.count + 1);
+        left.count += right->count + 1;
+        right->count = 0;
+
+        removeChild(parent, leftPos);
+        destroy(right);
+    }
+
+    // Drops separator pos and child pos + 1.
+    template <typename K, typename M, typename C>
+    inline void BTreeMap<K, M, C>::removeChild(Inner &parent, size_type pos) {
+        const auto keys = parent.keys.begin();
+        const auto children = parent.children.begin();
+        std::move(keys + pos + 1, keys + parent.count, keys + pos);
+        std::move(children + pos + 2, children + parent.count + 1, children + pos + 1);
+        parent.keys[--parent.count] = K();
+    }
+
+    template <typename K, typename M, typename C>
+    auto BTreeMap<K, M, C>::clone(const Node *node, Leaf *&lastLeaf) -> Node * {
+        if (node->leaf) {
+            const auto &leaf = *static_cast<const Leaf *>(node);
+            Leaf *copy = new Leaf();
+            std::copy(leaf.entries.begin(), leaf.entries.begin() + leaf.count, copy->entries.begin());
+            copy->count = leaf.count;
+            copy->prev = lastLeaf;
+            if (lastLeaf) { lastLeaf->next = copy; }
+            else          { head_ = copy; }
+            lastLeaf = copy;
+            return copy;
+        }
+
+        const auto &inner = *static_cast<const Inner *>(node);
+        Inner *copy = new Inner();
+        std::copy(inner.keys.begin(), inner.keys.begin() + inner.count, copy->keys.begin());
+        for (size_type i = 0; i <= inner.count; ++i) {
+            copy->children[i] = clone(inner.children[i], lastLeaf);
+        }
+        copy->count = inner.count;
+        return copy;
+    }
+
+    template <typename K, typename M, typename C>
+    void BTreeMap<K, M, C>::destroy(Node *node) noexcept {
+        if (!node) {
+            return;
+        }
+        if (node->leaf) {
+            delete static_cast<Leaf *>(node);
+        }
+        else {
+            // Inner nodes emptied by a merge or a root collapse gave their
+            // children away.
+            auto *inner = static_cast<Inner *>(node);
+            if (inner->count > 0) {
+                for (size_type i = 0; i <= inner->count; ++i) {
+                    destroy(inner->children[i]);
+                }
+            }
+            delete inner;
+        }
+    }
+
+}
+
+#endif	// ISHLANG_BTREE_MAP_H
@@ -0,0 +1,102 @@
+#include "byte_code.h"
+#include "environment.h"
+
+#include <iomanip>
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+ByteCode::ByteCode(std::shared_ptr<CodeNode> root)
+    : root_(root)
+    , code_()
+    , constants_()
+    , nodes_()
+    , idens_()
+    , protos_()
+    , layouts_()
+    , numRegisters_(0)
+{}
+
+// -------------------------------------------------------------
+void ByteCode::disassemble(std::ostream &out) const {
+    for (std::size_t pc = 0; pc < code_.size(); ++pc) {
+        const auto &inst = code_[pc];
+        out << std::setw(4) << pc << ' ' << std::left << std::setw(12) << opCodeName(inst.op) << std::right;
+        switch (inst.op) {
+        case GetVar:
+        case DefVar:
+        case SetVar:
+            out << " r" << inst.a << ' ' << Environment::idenTable().getName(idens_[inst.b]);
+            break;
+
+        case CheckNumVar:
+            out << ' ' << Environment::idenTable().getName(idens_[inst.b]);
+            break;
+
+        case ArithAssign:
+            out << " r" << inst.a << ' ' << Environment::idenTable().getName(idens_[inst.b]) << ' ' << static_cast<char>(inst.sub);
+            break;
+
+        case LoadConst:
+        case LoadLiteral:
+            out << " r" << inst.a << ' ' << constants_[inst.b];
+            break;
+
+        case Arith:
+            out << " r" << inst.a << " r" << inst.b << ' ' << inst.c << ' ' << static_cast<char>(inst.sub);
+            break;
+
+        case Compare:
+            out << " r" << inst.a << " r" << inst.b << " r" << inst.c << ' ' << static_cast<char>(inst.sub);
+            break;
+
+        case Jump:
+        case PushEnv:
+            out << ' ' << inst.b;
+            break;
+
+        case PushHandler:
+            out << ' ' << inst.b << ' ' << inst.c;
+            break;
+
+        case JumpIfFalse:
+        case JumpIfTrue:
+            out << " r" << inst.a << ' ' << inst.b;
+            break;
+
+        case Call:
+        case TailCall:
+            out << " r" << inst.a << " r" << inst.b << ' ' << inst.c;
+            break;
+
+        case Not:
+        case Negate:
+            out << " r" << inst.a << " r" << inst.b;
+            break;
+
+        case MakeClosure:
+        case Eval:
+            out << " r" << inst.a << " #" << inst.b;
+            break;
+
+        case PopEnv:
+        case PopHandler:
+            break;
+
+        default:
+            out << " r" << inst.a;
+            break;
+        }
+        out << '\n';
+    }
+}
+
+// -------------------------------------------------------------
+const char *ByteCode::opCodeName(OpCode op) {
+#define ISHLANG_BYTE_CODE_NAME(NAME) #NAME,
+    static const char *names[] = {
+        ISHLANG_BYTE_CODE_OPS(ISHLANG_BYTE_CODE_NAME)
+    };
+#undef ISHLANG_BYTE_CODE_NAME
+    return op < NumOpCodes ? names[op] : "Unknown";
+}
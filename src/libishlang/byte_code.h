@@ -0,0 +1,149 @@
+#ifndef ISHLANG_BYTE_CODE_H
+#define ISHLANG_BYTE_CODE_H
+
+#include "iden_table.h"
+#include "scope_layout.h"
+#include "value.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Ishlang {
+
+    class CodeNode;
+
+    // Instruction set, kept in one list so the opcode enum and the
+    // virtual machine dispatch table cannot get out of sync.
+#define ISHLANG_BYTE_CODE_OPS(OP)               \
+    OP(LoadNull)                                \
+    OP(LoadBool)                                \
+    OP(LoadConst)                               \
+    OP(LoadLiteral)                             \
+    OP(GetVar)                                  \
+    OP(DefVar)                                  \
+    OP(SetVar)                                  \
+    OP(CheckNumVar)                             \
+    OP(ArithAssign)                             \
+    OP(CheckNumber)                             \
+    OP(CheckArith)                              \
+    OP(Arith)                                   \
+    OP(Compare)                                 \
+    OP(Not)                                     \
+    OP(Negate)                                  \
+    OP(Jump)                                    \
+    OP(JumpIfFalse)                             \
+    OP(JumpIfTrue)                              \
+    OP(PushEnv)                                 \
+    OP(PopEnv)                                  \
+    OP(PushHandler)                             \
+    OP(PopHandler)                              \
+    OP(MakeClosure)                             \
+    OP(Call)                                    \
+    OP(TailCall)                                \
+    OP(Eval)                                    \
+    OP(Return)
+
+    class ByteCode {
+    public:
+        using SharedPtr = std::shared_ptr<const ByteCode>;
+        using Register  = std::uint32_t;
+        using IdenList  = ScopeLayout::IdenList;
+
+#define ISHLANG_BYTE_CODE_ENUM(NAME) NAME,
+        enum OpCode : std::uint8_t {
+            ISHLANG_BYTE_CODE_OPS(ISHLANG_BYTE_CODE_ENUM)
+            NumOpCodes
+        };
+#undef ISHLANG_BYTE_CODE_ENUM
+
+        // Operand a is the destination register unless noted otherwise,
+        // sub carries small immediates (operation type, check kind, bool).
+        struct Instruction {
+            OpCode        op;
+            std::uint8_t  sub;
+            Register      a;
+            std::uint32_t b;
+            std::uint32_t c;
+        };
+
+        // Closure prototype, the body is compiled once and shared by
+        // every closure created from it.
+        struct Proto {
+            IdenList                  params;
+            std::shared_ptr<CodeNode> body;
+            ScopeLayout::SharedPtr    layout;
+            SharedPtr                 code;
+        };
+
+        // JumpIfFalse/JumpIfTrue sub values, select the exception
+        // raised when the tested register is not a boolean.
+        enum BoolCheck : std::uint8_t {
+            OperandCheck    = 0,
+            ExpressionCheck = 1,
+        };
+
+    public:
+        ByteCode(std::shared_ptr<CodeNode> root);
+
+        inline const std::vector<Instruction> &instructions() const noexcept;
+        inline std::size_t numRegisters() const noexcept;
+
+        inline const Value &constant(std::uint32_t index) const;
+        inline const CodeNode *node(std::uint32_t index) const;
+        inline IdenType iden(std::uint32_t index) const;
+        inline const Proto &proto(std::uint32_t index) const;
+        inline const ScopeLayout::SharedPtr &layout(std::uint32_t index) const;
+
+        void disassemble(std::ostream &out) const;
+
+        static const char *opCodeName(OpCode op);
+
+    private:
+        friend class Compiler;
+
+        std::shared_ptr<CodeNode> root_;
+        std::vector<Instruction>  code_;
+        std::vector<Value>        constants_;
+        std::vector<const CodeNode *> nodes_;
+        std::vector<IdenType>     idens_;
+        std::vector<Proto>        protos_;
+        std::vector<ScopeLayout::SharedPtr> layouts_;
+        std::size_t               numRegisters_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline const std::vector<ByteCode::Instruction> &ByteCode::instructions() const noexcept {
+        return code_;
+    }
+
+    inline std::size_t ByteCode::numRegisters() const noexcept {
+        return numRegisters_;
+    }
+
+    inline const Value &ByteCode::constant(std::uint32_t index) const {
+        return constants_[index];
+    }
+
+    inline const CodeNode *ByteCode::node(std::uint32_t index) const {
+        return nodes_[index];
+    }
+
+    inline IdenType ByteCode::iden(std::uint32_t index) const {
+        return idens_[index];
+    }
+
+    inline auto ByteCode::proto(std::uint32_t index) const -> const Proto & {
+        return protos_[index];
+    }
+
+    inline const ScopeLayout::SharedPtr &ByteCode::layout(std::uint32_t index) const {
+        return layouts_[index];
+    }
+
+}
+
+#endif	// ISHLANG_BYTE_CODE_H
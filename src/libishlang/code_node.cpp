@@ -1,16 +1,26 @@
 #include "code_node.h"
+#include "array_kernels.h"
 #include "code_node_util.h"
+#include "context.h"
+#include "csv_reader.h"
+#include "dense_array.h"
 #include "exception.h"
 #include "file_io.h"
+#include "future.h"
+#include "garbage_collector.h"
+#include "generator.h"
 #include "generic_functions.h"
+#include "iterator.h"
 #include "lambda.h"
 #include "math_functions.h"
 #include "module.h"
+#include "output.h"
 #include "parser.h"
 #include "sequence.h"
 #include "util.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <chrono>
 #include <cmath>
@@ -18,7 +28,6 @@
 #include <filesystem>
 #include <functional>
 #include <limits>
-#include <iomanip>
 #include <iostream>
 #include <random>
 #include <ranges>
@@ -27,6 +36,19 @@ using namespace Ishlang;
 
 namespace fs = std::filesystem;
 
+// -------------------------------------------------------------
+Routine CodeNode::generate(Environment::SharedPtr env) const {
+    eval(env);
+    co_return;
+}
+
+// -------------------------------------------------------------
+Literal::Literal(const Value &value)
+    : CodeNode()
+    , value_(value.isString() && !value.isImmutable() ? Value::immutableText(value.text()) : value)
+    , readOnly_(false)
+{}
+
 // -------------------------------------------------------------
 IsType::IsType(CodeNode::SharedPtr expr, Value::TypeList types)
   : CodeNode()
@@ -105,50 +127,333 @@ Value Assert::exec(Environment::SharedPtr env) const {
 ArithOp::ArithOp(Type type, CodeNode::SharedPtrList operands)
     : VariadicOp(operands)
     , type_(type)
+    , feedback_()
 {
     assert(operands_.size() >= 2);
 }
 
 Value ArithOp::exec(Environment::SharedPtr env) const {
     if (!operands_.empty()) {
-        const auto values = evalOperands(env, operands_, Value::eInteger, Value::eReal);
+        switch (feedback_.quickened()) {
+        case Value::eInteger: return execQuickened<Value::Long>(env);
+        case Value::eReal:    return execQuickened<Value::Double>(env);
+        default:
+            break;
+        }
 
-        const bool real = std::ranges::any_of(values, [](const Value & v) { return v.isReal(); });
-        switch (type_) {
-        case Add:
-            if (real) { return accum<Value::Double>(values, std::plus<Value::Double>()); }
-            else      { return accum<Value::Long>(values, std::plus<Value::Long>()); }
-                
-        case Sub:
-            if (real) { return accum<Value::Double>(values, std::minus<Value::Double>()); }
-            else      { return accum<Value::Long>(values, std::minus<Value::Long>()); }
-                
-        case Mul:
-            if (real) { return accum<Value::Double>(values, std::multiplies<Value::Double>()); }
-            else      { return accum<Value::Long>(values, std::multiplies<Value::Long>()); }
-                
-        case Div:
-            if (real) {
-                if (isDivByZero<Value::Double>(values)) { throw DivByZero(); }
-                return accum<Value::Double>(values, std::divides<Value::Double>());
+        const auto values = evalOperands(env, operands_, Value::eInteger, Value::eReal, Value::eArray, Value::eNdArray);
+        if (values.size() <= MaxQuickenedOperands) {
+            feedback_.record(numberType(values));
+        }
+        return apply(type_, values);
+    }
+    return Value::Zero;
+}
+
+template <typename NumType>
+Value ArithOp::execQuickened(Environment::SharedPtr env) const {
+    constexpr auto numType = std::is_same_v<NumType, Value::Double> ? Value::eReal : Value::eInteger;
+
+    std::array<NumType, MaxQuickenedOperands> nums;
+    for (std::size_t i = 0; i < operands_.size(); ++i) {
+        auto value = evalOperand(env, operands_[i], Value::eInteger, Value::eReal, Value::eArray, Value::eNdArray);
+        if (value.type() != numType) {
+            feedback_.deoptimize();
+
+            std::vector<Value> values;
+            values.reserve(operands_.size());
+            for (std::size_t k = 0; k < i; ++k) { values.emplace_back(nums[k]); }
+            values.push_back(std::move(value));
+            for (++i; i < operands_.size(); ++i) {
+                values.push_back(evalOperand(env, operands_[i], Value::eInteger, Value::eReal, Value::eArray, Value::eNdArray));
             }
-            else {
-                if (isDivByZero<Value::Long>(values)) { throw DivByZero(); }
-                return accum<Value::Long>(values, std::divides<Value::Long>());
+            return apply(type_, values);
+        }
+
+        if constexpr (numType == Value::eReal) { nums[i] = value.real(); }
+        else                                   { nums[i] = value.integer(); }
+    }
+    return applyNumbers<NumType>(type_, std::span<const NumType>(nums.data(), operands_.size()));
+}
+
+template <typename NumType, typename Num>
+Value ArithOp::applyNumbers(Type type, std::span<const Num> nums) {
+    const auto fold = [nums](auto op) {
+        return Value(std::accumulate(
+                         nums.begin() + 1,
+                         nums.end(),
+                         number<NumType>(nums.front()),
+                         [op](NumType a, const Num &num) { return op(a, number<NumType>(num)); }));
+    };
+    const auto divByZero = [nums]() {
+        return std::any_of(nums.begin() + 1, nums.end(), [](const Num &num) {
+            if constexpr (std::is_same_v<NumType, Value::Double>) { return Util::isZero(number<NumType>(num)); }
+            else                                                  { return number<NumType>(num) == 0; }
+        });
+    };
+
+    switch (type) {
+    case Add: return fold(std::plus<NumType>());
+    case Sub: return fold(std::minus<NumType>());
+    case Mul: return fold(std::multiplies<NumType>());
+
+    case Div:
+        if (divByZero()) { throw DivByZero(); }
+        return fold(std::divides<NumType>());
+
+    case Mod:
+        if constexpr (std::is_same_v<NumType, Value::Double>) {
+            throw InvalidOperandType(Value::typeToString(Value::eInteger), Value::typeToString(Value::eReal));
+        }
+        else {
+            if (divByZero()) { throw DivByZero(); }
+            return fold(std::modulus<NumType>());
+        }
+
+    case Pow:
+        return Value(std::accumulate(
+                         nums.begin() + 1,
+                         nums.end(),
+                         Value::Double(number<NumType>(nums.front())),
+                         [](Value::Double a, const Num &num) { return power(a, Value::Double(number<NumType>(num))); }));
+    }
+    return Value::Zero;
+}
+
+Value ArithOp::apply(Type type, std::span<const Value> values) {
+    bool real = false;
+    for (const auto &value : values) {
+        if (value.isReal()) {
+            real = true;
+        }
+        else if (value.isArray()) {
+            return elementwise(type, values);
+        }
+        else if (value.isNdArray()) {
+            return Value(ndElementwise(type, values));
+        }
+        else if (!value.isInt()) {
+            throw InvalidOperandType(typesToString(Value::eInteger, Value::eReal, Value::eArray, Value::eNdArray), value.typeToString());
+        }
+    }
+
+    return real
+        ? applyNumbers<Value::Double>(type, values)
+        : applyNumbers<Value::Long>(type, values);
+}
+
+Value::Type ArithOp::numberType(std::span<const Value> values) noexcept {
+    const auto type = values.front().type();
+    if (type != Value::eInteger && type != Value::eReal) {
+        return Value::eNone;
+    }
+    for (const auto &value : values.subspan(1)) {
+        if (value.type() != type) {
+            return Value::eNone;
+        }
+    }
+    return type;
+}
+
+Value ArithOp::elementwise(Type type, std::span<const Value> values) {
+    std::optional<std::size_t> size;
+    bool packed = true;
+    bool real = type == Pow;
+    for (const auto &value : values) {
+        if (value.isArray()) {
+            const auto &arr = value.array();
+            if (size && *size != arr.size()) {
+                throw InvalidExpression("Mismatched array sizes in arithmetic");
             }
+            size = arr.size();
+            packed = packed && arr.packing() != Sequence::Boxed;
+            real = real || arr.packing() == Sequence::PackedReals;
+        }
+        else if (value.isReal()) {
+            real = true;
+        }
+        else if (!value.isInt()) {
+            throw InvalidOperandType(typesToString(Value::eInteger, Value::eReal, Value::eArray), value.typeToString());
+        }
+    }
 
-        case Mod:
-            if (real) {
-                throw InvalidOperandType(Value::typeToString(Value::eInteger), Value::typeToString(Value::eReal));
+    if (packed) {
+        return real
+            ? Value(packedElementwise<Value::Double>(type, values, *size))
+            : Value(packedElementwise<Value::Long>(type, values, *size));
+    }
+
+    Sequence::Vector result;
+    result.reserve(*size);
+    std::vector<Value> args(values.begin(), values.end());
+    for (std::size_t i = 0; i < *size; ++i) {
+        for (std::size_t k = 0; k < values.size(); ++k) {
+            if (values[k].isArray()) {
+                args[k] = values[k].array().get(i);
+            }
+        }
+        result.push_back(apply(type, args));
+    }
+    return Value(Sequence(std::move(result)));
+}
+
+template <typename NumType>
+Sequence ArithOp::packedElementwise(Type type, std::span<const Value> values, std::size_t size) {
+    using Numbers = std::vector<NumType>;
+
+    if constexpr (std::is_same_v<NumType, Value::Double>) {
+        if (type == Mod) {
+            throw InvalidOperandType(Value::typeToString(Value::eInteger), Value::typeToString(Value::eReal));
+        }
+    }
+
+    auto scalar = [](const Value &value) -> NumType {
+        if constexpr (std::is_same_v<NumType, Value::Double>) { return value.real(); }
+        else                                                  { return value.integer(); }
+    };
+
+    // Array operand as numbers of the result type, integers converted to reals.
+    auto numbers = [](const Sequence &arr, Numbers &scratch) -> std::span<const NumType> {
+        if constexpr (std::is_same_v<NumType, Value::Double>) {
+            if (arr.packing() == Sequence::PackedReals) {
+                return arr.reals();
             }
-            if (isDivByZero<Value::Long>(values)) { throw DivByZero(); }
-            return accum<Value::Long>(values, std::modulus<Value::Long>());
+            scratch.assign(arr.integers().begin(), arr.integers().end());
+            return scratch;
+        }
+        else {
+            return arr.integers();
+        }
+    };
+
+    auto isZero = [](NumType num) {
+        if constexpr (std::is_same_v<NumType, Value::Double>) { return Util::isZero(num); }
+        else                                                  { return num == 0; }
+    };
 
+    const bool divides = type == Div || type == Mod;
+
+    Numbers result;
+    Numbers scratch;
+    if (values.front().isArray()) {
+        const auto lhs = numbers(values.front().array(), scratch);
+        result.assign(lhs.begin(), lhs.end());
+    }
+    else {
+        result.assign(size, scalar(values.front()));
+    }
+
+    for (const auto &value : values.subspan(1)) {
+        if (value.isArray()) {
+            const auto rhs = numbers(value.array(), scratch);
+            if (divides && std::ranges::any_of(rhs, isZero)) { throw DivByZero(); }
+            applyKernel(type, std::span<NumType>(result), rhs);
+        }
+        else {
+            const NumType rhs = scalar(value);
+            if (divides && isZero(rhs)) { throw DivByZero(); }
+            applyKernel(type, std::span<NumType>(result), rhs);
+        }
+    }
+
+    return Sequence::packed(std::move(result));
+}
+
+DenseArray ArithOp::ndElementwise(Type type, std::span<const Value> values) {
+    if (type == Mod) {
+        throw InvalidOperandType(Value::typeToString(Value::eInteger), Value::typeToString(Value::eNdArray));
+    }
+
+    const DenseArray::Shape *shape = nullptr;
+    for (const auto &value : values) {
+        if (value.isNdArray()) {
+            if (shape && *shape != value.ndArray().shape()) {
+                throw InvalidExpression("Mismatched ndarray shapes in arithmetic");
+            }
+            shape = &value.ndArray().shape();
+        }
+        else if (!value.isNumber()) {
+            throw InvalidOperandType(typesToString(Value::eInteger, Value::eReal, Value::eNdArray), value.typeToString());
+        }
+    }
+
+    DenseArray::Buffer result;
+    DenseArray::Buffer scratch;
+    if (values.front().isNdArray()) {
+        const auto lhs = values.front().ndArray().values(scratch);
+        result.assign(lhs.begin(), lhs.end());
+    }
+    else {
+        result.assign(std::accumulate(shape->begin(), shape->end(), std::size_t(1), std::multiplies<std::size_t>()), values.front().real());
+    }
+
+    for (const auto &value : values.subspan(1)) {
+        if (value.isNdArray()) {
+            const auto rhs = value.ndArray().values(scratch);
+            if (type == Div && std::ranges::any_of(rhs, [](Value::Double num) { return Util::isZero(num); })) { throw DivByZero(); }
+            applyKernel(type, std::span<Value::Double>(result), rhs);
+        }
+        else {
+            const Value::Double rhs = value.real();
+            if (type == Div && Util::isZero(rhs)) { throw DivByZero(); }
+            applyKernel(type, std::span<Value::Double>(result), rhs);
+        }
+    }
+
+    return DenseArray(*shape, std::move(result));
+}
+
+template <typename NumType, typename Rhs>
+void ArithOp::applyKernel(Type type, std::span<NumType> lhs, Rhs rhs) {
+    switch (type) {
+    case Add: ArrayKernels::apply(lhs, rhs, std::plus<NumType>());       break;
+    case Sub: ArrayKernels::apply(lhs, rhs, std::minus<NumType>());      break;
+    case Mul: ArrayKernels::apply(lhs, rhs, std::multiplies<NumType>()); break;
+    case Div: ArrayKernels::apply(lhs, rhs, std::divides<NumType>());    break;
+    case Mod:
+        if constexpr (std::is_same_v<NumType, Value::Long>) {
+            ArrayKernels::apply(lhs, rhs, std::modulus<NumType>());
+        }
+        break;
+    case Pow:
+        if constexpr (std::is_same_v<NumType, Value::Double>) {
+            ArrayKernels::apply(lhs, rhs, power);
+        }
+        break;
+    }
+}
+
+// -------------------------------------------------------------
+BinaryArithOp::BinaryArithOp(Type type, CodeNode::SharedPtrList operands)
+    : ArithOp(type, operands)
+{
+    assert(operands_.size() == 2);
+}
+
+Value BinaryArithOp::exec(Environment::SharedPtr env) const {
+    const Value values[] = {
+        evalOperand(env, operands_[0], Value::eInteger, Value::eReal, Value::eArray, Value::eNdArray),
+        evalOperand(env, operands_[1], Value::eInteger, Value::eReal, Value::eArray, Value::eNdArray)
+    };
+
+    if (values[0].isInt() && values[1].isInt()) {
+        const auto lhs = values[0].integer();
+        const auto rhs = values[1].integer();
+        switch (type_) {
+        case Add: return Value(lhs + rhs);
+        case Sub: return Value(lhs - rhs);
+        case Mul: return Value(lhs * rhs);
+        case Div:
+            if (rhs == 0) { throw DivByZero(); }
+            return Value(lhs / rhs);
+        case Mod:
+            if (rhs == 0) { throw DivByZero(); }
+            return Value(lhs % rhs);
         case Pow:
-            return accum<Value::Double>(values, power);
+            break;
         }
     }
-    return Value::Zero;
+    return apply(type_, values);
 }
 
 // -------------------------------------------------------------
@@ -156,12 +461,13 @@ ArithAssignOp::ArithAssignOp(Type type, const std::string &name, CodeNode::Share
     : CodeNode()
     , type_(type)
     , iden_(Environment::idenTable().mapName(name))
+    , address_()
     , delta_(delta)
 {}
 
 Value ArithAssignOp::exec(Environment::SharedPtr env) const {
     if (delta_) {
-        const auto & nameVal = env->get(iden_);
+        const auto & nameVal = address_.isLexical() ? env->getAt(address_, iden_) : env->get(iden_);
         if (!nameVal.isNumber()) {
             throw InvalidExpressionType(typesToString(Value::eInteger, Value::eReal), nameVal.typeToString());
         }
@@ -209,7 +515,7 @@ Value ArithAssignOp::exec(Environment::SharedPtr env) const {
             updtVal = Value(std::pow(nameVal.real(), deltaVal.real()));
             break;
         }
-        return env->set(iden_, updtVal);
+        return address_.isLexical() ? env->setAt(address_, iden_, updtVal) : env->set(iden_, updtVal);
     }
     return Value::Null;
 }
@@ -218,28 +524,35 @@ Value ArithAssignOp::exec(Environment::SharedPtr env) const {
 CompOp::CompOp(Type type, CodeNode::SharedPtr lhs, CodeNode::SharedPtr rhs)
     : BinaryOp(lhs, rhs)
     , type_(type)
-{}
+{
+    if (lhs_) { lhs_->markReadOnly(); }
+    if (rhs_) { rhs_->markReadOnly(); }
+}
 
 Value CompOp::exec(Environment::SharedPtr env) const {
     if (lhs_ && rhs_) {
         const Value lhsVal = lhs_->eval(env);
         const Value rhsVal = rhs_->eval(env);
-        
-        if (lhsVal.type() != rhsVal.type()) {
-            if (!lhsVal.isNumber() || !rhsVal.isNumber()) {
-                throw IncompatibleTypes(op2str(type_), lhsVal.typeToString(), rhsVal.typeToString());
-            }
-        }
+        return apply(type_, lhsVal, rhsVal);
+    }
+    return Value::False;
+}
 
-        switch (type_) {
-            case EQ: return Value(lhsVal == rhsVal);
-            case NE: return Value(lhsVal != rhsVal);
-            case LT: return Value(lhsVal < rhsVal);
-            case GT: return Value(lhsVal > rhsVal);
-            case LE: return Value(lhsVal <= rhsVal);
-            case GE: return Value(lhsVal >= rhsVal);
+Value CompOp::apply(Type type, const Value &lhsVal, const Value &rhsVal) {
+    if (lhsVal.type() != rhsVal.type()) {
+        if (!lhsVal.isNumber() || !rhsVal.isNumber()) {
+            throw IncompatibleTypes(op2str(type), lhsVal.typeToString(), rhsVal.typeToString());
         }
     }
+
+    switch (type) {
+        case EQ: return Value(lhsVal == rhsVal);
+        case NE: return Value(lhsVal != rhsVal);
+        case LT: return Value(lhsVal < rhsVal);
+        case GT: return Value(lhsVal > rhsVal);
+        case LE: return Value(lhsVal <= rhsVal);
+        case GE: return Value(lhsVal >= rhsVal);
+    }
     return Value::False;
 }
 
@@ -316,6 +629,7 @@ Value NegativeOf::exec(Environment::SharedPtr env) const {
 ProgN::ProgN(CodeNode::SharedPtrList exprs)
     : CodeNode()
     , exprs_(exprs)
+    , yields_(std::ranges::any_of(exprs_, [](const auto &expr) { return expr && expr->yields(); }))
 {}
 
 Value ProgN::exec(Environment::SharedPtr env) const {
@@ -323,40 +637,73 @@ Value ProgN::exec(Environment::SharedPtr env) const {
         Value result;
         for (CodeNode::SharedPtrList::const_iterator iter = exprs_.begin(); iter != exprs_.end(); ++iter) {
             result = (*iter)->eval(env);
+            if (ControlSignal::pending()) { break; }
         }
         return result;
     }
     return Value::Null;
 }
 
+Routine ProgN::generate(Environment::SharedPtr env) const {
+    for (const auto &expr : exprs_) {
+        if (expr->yields()) {
+            auto routine = expr->generate(env);
+            while (routine.resume()) { co_yield routine.value(); }
+        }
+        else {
+            expr->eval(env);
+        }
+        if (ControlSignal::pending()) { break; }
+    }
+}
+
+void ProgN::propagateSignals(ControlSignal::Mask signals) {
+    for (auto &expr : exprs_) {
+        expr->propagateSignals(signals);
+    }
+}
+
+void ProgN::markTailPosition() {
+    if (!exprs_.empty()) { exprs_.back()->markTailPosition(); }
+}
+
 // -------------------------------------------------------------
-Block::Block(CodeNode::SharedPtrList exprs)
+Block::Block(CodeNode::SharedPtrList exprs, ScopeLayout::SharedPtr layout)
     : ProgN(exprs)
+    , layout_(layout)
 {}
 
 Value Block::exec(Environment::SharedPtr env) const {
-    auto blockEnv = Environment::make(env);
+    auto blockEnv = Environment::makeScope(env, layout_);
     return ProgN::exec(blockEnv);
 }
 
+Routine Block::generate(Environment::SharedPtr env) const {
+    return ProgN::generate(Environment::makeScope(env, layout_));
+}
+
 // -------------------------------------------------------------
-If::If(CodeNode::SharedPtr pred, CodeNode::SharedPtr tCode)
+If::If(CodeNode::SharedPtr pred, CodeNode::SharedPtr tCode, ScopeLayout::SharedPtr layout)
     : CodeNode()
     , pred_(pred)
     , tCode_(tCode)
     , fCode_()
+    , layout_(layout)
+    , yields_(tCode_ && tCode_->yields())
 {}
 
-If::If(CodeNode::SharedPtr pred, CodeNode::SharedPtr tCode, CodeNode::SharedPtr fCode)
+If::If(CodeNode::SharedPtr pred, CodeNode::SharedPtr tCode, CodeNode::SharedPtr fCode, ScopeLayout::SharedPtr layout)
     : CodeNode()
     , pred_(pred)
     , tCode_(tCode)
     , fCode_(fCode)
+    , layout_(layout)
+    , yields_((tCode_ && tCode_->yields()) || (fCode_ && fCode_->yields()))
 {}
 
 Value If::exec(Environment::SharedPtr env) const {
     if (pred_) {
-        auto ifEnv = Environment::make(env);
+        auto ifEnv = Environment::makeScope(env, layout_);
 
         const Value pVal = evalExpression(ifEnv, pred_, Value::eBoolean);
         if (pVal.boolean()) {
@@ -369,10 +716,33 @@ Value If::exec(Environment::SharedPtr env) const {
     return Value::Null;
 }
 
+Routine If::generate(Environment::SharedPtr env) const {
+    if (pred_) {
+        auto ifEnv = Environment::makeScope(env, layout_);
+
+        const auto &code = evalExpression(ifEnv, pred_, Value::eBoolean).boolean() ? tCode_ : fCode_;
+        if (code) {
+            auto routine = code->generate(ifEnv);
+            while (routine.resume()) { co_yield routine.value(); }
+        }
+    }
+}
+
+void If::propagateSignals(ControlSignal::Mask signals) {
+    if (tCode_) { tCode_->propagateSignals(signals); }
+    if (fCode_) { fCode_->propagateSignals(signals); }
+}
+
+void If::markTailPosition() {
+    if (tCode_) { tCode_->markTailPosition(); }
+    if (fCode_) { fCode_->markTailPosition(); }
+}
+
 // -------------------------------------------------------------
 Cond::Cond(CodeNode::SharedPtrPairs cases)
     : CodeNode()
     , cases_(cases)
+    , yields_(std::ranges::any_of(cases_, [](const auto &c) { return c.second && c.second->yields(); }))
 {}
 
 Value Cond::exec(Environment::SharedPtr env) const {
@@ -390,26 +760,159 @@ Value Cond::exec(Environment::SharedPtr env) const {
     return Value::Null;
 }
 
+Routine Cond::generate(Environment::SharedPtr env) const {
+    for (const auto &[pred, code] : cases_) {
+        if (!pred) { throw InvalidExpression("Null condition"); }
+
+        if (evalExpression(env, pred, Value::eBoolean).boolean()) {
+            if (code) {
+                auto routine = code->generate(env);
+                while (routine.resume()) { co_yield routine.value(); }
+            }
+            break;
+        }
+    }
+}
+
+void Cond::propagateSignals(ControlSignal::Mask signals) {
+    for (auto &[pred, code] : cases_) {
+        if (code) { code->propagateSignals(signals); }
+    }
+}
+
+void Cond::markTailPosition() {
+    for (auto &[pred, code] : cases_) {
+        if (code) { code->markTailPosition(); }
+    }
+}
+
+// -------------------------------------------------------------
+void Break::propagateSignals(ControlSignal::Mask signals) {
+    signal_ = signal_ || (signals & ControlSignal::Break);
+}
+
+Value Break::exec(Environment::SharedPtr /*env*/) const {
+    if (!signal_) { throw Except(); }
+    ControlSignal::raise(ControlSignal::Break);
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+void Continue::propagateSignals(ControlSignal::Mask signals) {
+    signal_ = signal_ || (signals & ControlSignal::Continue);
+}
+
+Value Continue::exec(Environment::SharedPtr /*env*/) const {
+    if (!signal_) { throw Except(); }
+    ControlSignal::raise(ControlSignal::Continue);
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+Return::Return(CodeNode::SharedPtr expr)
+    : CodeNode()
+    , expr_(expr)
+    , signal_(false)
+{}
+
+void Return::propagateSignals(ControlSignal::Mask signals) {
+    signal_ = signal_ || (signals & ControlSignal::Return);
+}
+
+void Return::markTailPosition() {
+    if (expr_) { expr_->markTailPosition(); }
+}
+
+Value Return::exec(Environment::SharedPtr env) const {
+    Value value = expr_ ? expr_->eval(env) : Value::Null;
+    if (!signal_) { throw Except{std::move(value)}; }
+    ControlSignal::raise(ControlSignal::Return);
+    return value;
+}
+
+// -------------------------------------------------------------
+Yield::Yield(CodeNode::SharedPtr expr)
+    : CodeNode()
+    , expr_(expr)
+{}
+
+Value Yield::exec(Environment::SharedPtr /*env*/) const {
+    throw InvalidExpression("yield must be a statement of a generator body");
+}
+
+Routine Yield::generate(Environment::SharedPtr env) const {
+    const Value value = expr_ ? expr_->eval(env) : Value::Null;
+    co_yield value;
+}
+
+// -------------------------------------------------------------
+namespace {
+
+    // Consumes the signal left by an iteration of a loop body, returns
+    // false when the loop must stop. A pending return is left for the
+    // enclosing function.
+    inline bool continueLoop() {
+        const auto signal = ControlSignal::pending();
+        if (signal == ControlSignal::None) { return true; }
+        if (signal != ControlSignal::Return) { ControlSignal::clear(); }
+        return signal == ControlSignal::Continue;
+    }
+
+    // Evaluates one iteration of a loop body, returns false when the loop
+    // must stop. Break and continue are consumed here, a pending return is
+    // left for the enclosing function.
+    inline bool evalLoopBody(const CodeNode &body, Environment::SharedPtr env, Value &result) {
+        GarbageCollector::current().safePoint();
+        try {
+            result = body.eval(env);
+        }
+        catch (const Continue::Except &) {
+            result = Value::Null;
+            return true;
+        }
+        return continueLoop();
+    }
+
+    // Runs one iteration of a loop body of a generator, signals are left
+    // for continueLoop.
+    Routine generateLoopBody(const CodeNode &body, Environment::SharedPtr env) {
+        GarbageCollector::current().safePoint();
+        try {
+            auto routine = body.generate(env);
+            while (routine.resume()) { co_yield routine.value(); }
+        }
+        catch (const Continue::Except &) {
+        }
+    }
+
+}
+
 // -------------------------------------------------------------
-Loop::Loop(CodeNode::SharedPtr decl, CodeNode::SharedPtr cond, CodeNode::SharedPtr next, CodeNode::SharedPtr body)
+Loop::Loop(CodeNode::SharedPtr decl, CodeNode::SharedPtr cond, CodeNode::SharedPtr next, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout)
     : CodeNode()
     , decl_(decl)
     , cond_(cond)
     , next_(next)
     , body_(body)
-{}
+    , layout_(layout)
+{
+    if (body_) { body_->propagateSignals(ControlSignal::Break | ControlSignal::Continue); }
+}
 
-Loop::Loop(CodeNode::SharedPtr cond, CodeNode::SharedPtr body)
+Loop::Loop(CodeNode::SharedPtr cond, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout)
     : CodeNode()
     , decl_()
     , cond_(cond)
     , next_()
     , body_(body)
-{}
+    , layout_(layout)
+{
+    if (body_) { body_->propagateSignals(ControlSignal::Break | ControlSignal::Continue); }
+}
 
 Value Loop::exec(Environment::SharedPtr env) const {
     if (cond_ && body_) {
-        auto loopEnv = Environment::make(env);
+        auto loopEnv = Environment::makeScope(env, layout_);
         
         Value result;
         Value condVal;
@@ -420,7 +923,7 @@ Value Loop::exec(Environment::SharedPtr env) const {
                 condVal = evalExpression(loopEnv, cond_, Value::eBoolean);
                 if (!condVal.boolean()) { break; }
 
-                result = body_->eval(loopEnv);
+                if (!evalLoopBody(*body_, loopEnv, result)) { break; }
                 if (next_) { next_->eval(loopEnv); }
             }
         }
@@ -432,21 +935,47 @@ Value Loop::exec(Environment::SharedPtr env) const {
     return Value::Null;
 }
 
+Routine Loop::generate(Environment::SharedPtr env) const {
+    if (cond_ && body_) {
+        auto loopEnv = Environment::makeScope(env, layout_);
+
+        try {
+            if (decl_) { decl_->eval(loopEnv); }
+            while (evalExpression(loopEnv, cond_, Value::eBoolean).boolean()) {
+                auto body = generateLoopBody(*body_, loopEnv);
+                while (body.resume()) { co_yield body.value(); }
+
+                if (!continueLoop()) { break; }
+                if (next_) { next_->eval(loopEnv); }
+            }
+        }
+        catch (const Break::Except &) {}
+    }
+}
+
+void Loop::propagateSignals(ControlSignal::Mask signals) {
+    // Break and continue bind to this loop, only return passes through
+    if (body_) { body_->propagateSignals(signals & ControlSignal::Return); }
+}
+
 // -------------------------------------------------------------
-While::While(CodeNode::SharedPtr cond, CodeNode::SharedPtr body)
+While::While(CodeNode::SharedPtr cond, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout)
     : CodeNode()
     , cond_(cond)
     , body_(body)
-{}
+    , layout_(layout)
+{
+    if (body_) { body_->propagateSignals(ControlSignal::Break | ControlSignal::Continue); }
+}
 
 Value While::exec(Environment::SharedPtr env) const {
     if (cond_ && body_) {
-        auto whileEnv = Environment::make(env);
+        auto whileEnv = Environment::makeScope(env, layout_);
 
         Value result;
         try {
             while (evalExpression(whileEnv, cond_, Value::eBoolean).boolean()) {
-                result = body_->eval(whileEnv);
+                if (!evalLoopBody(*body_, whileEnv, result)) { break; }
             }
         }
         catch (const Break::Except &) { return Value::Null; }
@@ -457,21 +986,63 @@ Value While::exec(Environment::SharedPtr env) const {
     return Value::Null;
 }
 
+Routine While::generate(Environment::SharedPtr env) const {
+    if (cond_ && body_) {
+        auto whileEnv = Environment::makeScope(env, layout_);
+
+        try {
+            while (evalExpression(whileEnv, cond_, Value::eBoolean).boolean()) {
+                auto body = generateLoopBody(*body_, whileEnv);
+                while (body.resume()) { co_yield body.value(); }
+
+                if (!continueLoop()) { break; }
+            }
+        }
+        catch (const Break::Except &) {}
+    }
+}
+
+void While::propagateSignals(ControlSignal::Mask signals) {
+    if (body_) { body_->propagateSignals(signals & ControlSignal::Return); }
+}
+
 // -------------------------------------------------------------
-Foreach::Foreach(const std::string &name, CodeNode::SharedPtr container, CodeNode::SharedPtr body)
+Foreach::Foreach(const std::string &name, CodeNode::SharedPtr container, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout)
     : CodeNode()
     , iden_(Environment::idenTable().mapName(name))
+    , address_()
     , container_(container)
     , body_(body)
-{}
+    , layout_(layout)
+    , feedback_()
+{
+    // The loop variable is the first slot of a resolved foreach scope
+    if (layout_ && !layout_->elided() && layout_->iden(0) == iden_) {
+        address_ = VarAddress{0, 0};
+    }
+    if (body_) { body_->propagateSignals(ControlSignal::Break | ControlSignal::Continue); }
+}
+
+void Foreach::propagateSignals(ControlSignal::Mask signals) {
+    if (body_) { body_->propagateSignals(signals & ControlSignal::Return); }
+}
 
 Value Foreach::exec(Environment::SharedPtr env) const {
     if (container_ && body_) {
-        auto loopEnv = Environment::make(env);
-        loopEnv->def(iden_, Value::Null);
+        auto loopEnv = Environment::make(env, layout_);
+        if (address_.isLexical()) { loopEnv->defAt(address_.slot, Value::Null); }
+        else                      { loopEnv->def(iden_, Value::Null); }
 
         try {
             auto contValue = container_->eval(loopEnv);
+            if (const auto quickened = feedback_.quickened(); quickened != Value::eNone) {
+                if (contValue.type() == quickened) {
+                    return quickened == Value::eArray ? impl(loopEnv, contValue.array()) : implRange(loopEnv, contValue.range());
+                }
+                feedback_.deoptimize();
+            }
+
+            feedback_.record(anyOfType(contValue.type(), Value::eArray, Value::eRange) ? contValue.type() : Value::eNone);
             switch (contValue.type()) {
             case Value::eString:     return impl(loopEnv, contValue.text());
             case Value::eArray:      return impl(loopEnv, contValue.array());
@@ -479,9 +1050,12 @@ Value Foreach::exec(Environment::SharedPtr env) const {
             case Value::eOrderedMap: return impl(loopEnv, contValue.orderedMap());
             case Value::eRange:      return implRange(loopEnv, contValue.range());
             case Value::eFile:       return implFile(loopEnv, contValue.file());
+            case Value::eNdArray:    return impl(loopEnv, contValue.ndArray());
+            case Value::eGenerator:  return implNext(loopEnv, contValue.generator());
+            case Value::eIterator:   return implNext(loopEnv, contValue.iterator());
             default:
                 throw InvalidExpressionType(
-                    typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::eFile),
+                    typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::eFile, Value::eNdArray, Value::eGenerator, Value::eIterator),
                     contValue.typeToString());
             }
         }
@@ -491,18 +1065,39 @@ Value Foreach::exec(Environment::SharedPtr env) const {
     return Value::Null;
 }
 
+Routine Foreach::generate(Environment::SharedPtr env) const {
+    if (container_ && body_) {
+        auto loopEnv = Environment::make(env, layout_);
+        if (address_.isLexical()) { loopEnv->defAt(address_.slot, Value::Null); }
+        else                      { loopEnv->def(iden_, Value::Null); }
+
+        try {
+            const auto items = Iterator::from(container_->eval(loopEnv));
+            while (auto item = items.next()) {
+                setItem(*loopEnv, *item);
+
+                auto body = generateLoopBody(*body_, loopEnv);
+                while (body.resume()) { co_yield body.value(); }
+
+                if (!continueLoop()) { break; }
+            }
+        }
+        catch (const Break::Except &) {}
+    }
+}
+
 template <typename Container>
 Value Foreach::impl(Environment::SharedPtr loopEnv, const Container &container) const {
     Value result = Value::Null;
     for (const auto &item : container) {
         if constexpr (std::is_same_v<Container, Hashtable> ||
                       std::is_same_v<Container, OrderedTable>) {
-            loopEnv->set(iden_, Value(ValuePair(item.first, item.second)));
+            setItem(*loopEnv, Value(ValuePair(item.first, item.second)));
         }
         else {
-            loopEnv->set(iden_, item);
+            setItem(*loopEnv, item);
         }
-        result = body_->eval(loopEnv);
+        if (!evalLoopBody(*body_, loopEnv, result)) { break; }
     }
     return result;
 }
@@ -511,30 +1106,76 @@ Value Foreach::implRange(Environment::SharedPtr loopEnv, const IntegerRange &ran
     Value result = Value::Null;
     auto gen = range.generator();
     while (auto i = gen.next()) {
-        loopEnv->set(iden_, Value(*i));
-        result = body_->eval(loopEnv);
+        setItem(*loopEnv, Value(*i));
+        if (!evalLoopBody(*body_, loopEnv, result)) { break; }
     }
     return result;
 }
 
 Value Foreach::implFile(Environment::SharedPtr loopEnv, FileStruct &file) const {
     Value result = Value::Null;
+    if (const auto delimiter = file.csvDelimiter()) {
+        CsvReader reader(file, *delimiter);
+        while (auto optRow = reader.readRow()) {
+            setItem(*loopEnv, Value(std::move(*optRow)));
+            if (!evalLoopBody(*body_, loopEnv, result)) { break; }
+        }
+        return result;
+    }
     while (auto optLine = file.readln()) {
-        loopEnv->set(iden_, Value(std::move(*optLine)));
-        result = body_->eval(loopEnv);
+        setItem(*loopEnv, Value(std::move(*optLine)));
+        if (!evalLoopBody(*body_, loopEnv, result)) { break; }
     }
     return result;
 }
 
+template <typename Source>
+Value Foreach::implNext(Environment::SharedPtr loopEnv, const Source &source) const {
+    Value result = Value::Null;
+    while (auto item = source.next()) {
+        setItem(*loopEnv, *item);
+        if (!evalLoopBody(*body_, loopEnv, result)) { break; }
+    }
+    return result;
+}
+
+inline void Foreach::setItem(Environment &loopEnv, const Value &item) const {
+    if (address_.isLexical()) { loopEnv.setAt(address_, iden_, item); }
+    else                      { loopEnv.set(iden_, item); }
+}
+
 // -------------------------------------------------------------
-LambdaExpr::LambdaExpr(const ParamList &params, CodeNode::SharedPtr body)
+LambdaExpr::LambdaExpr(const ParamList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout)
+  : LambdaExpr(params, body, layout, true)
+{}
+
+LambdaExpr::LambdaExpr(const ParamList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout, bool tailCalls)
   : CodeNode()
-  , params_(params)
+  , params_()
   , body_(body)
-{}
+  , layout_(layout)
+{
+    params_.reserve(params.size());
+    for (const auto &param : params) {
+        params_.push_back(Environment::idenTable().mapName(param));
+    }
+    if (body_) {
+        body_->propagateSignals(ControlSignal::Return);
+        if (tailCalls) { body_->markTailPosition(); }
+    }
+}
 
 Value LambdaExpr::exec(Environment::SharedPtr env) const {
-    return Value(Lambda(params_, body_, env));
+    return Value(Lambda(params_, body_, env, layout_));
+}
+
+// -------------------------------------------------------------
+GeneratorExpr::GeneratorExpr(const ParamList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout)
+    : LambdaExpr(params, body, layout, false)
+{}
+
+Value GeneratorExpr::exec(Environment::SharedPtr env) const {
+    return Value(Lambda::generator(params_, body_, env, layout_));
 }
 
 // -------------------------------------------------------------
@@ -542,24 +1183,35 @@ LambdaApp::LambdaApp(CodeNode::SharedPtr closure, SharedPtrList args)
     : CodeNode()
     , closure_(closure)
     , argExprs_(args)
-    , closureVar_(Value::Null)
+    , tail_(false)
 {}
 
 Value LambdaApp::exec(Environment::SharedPtr env) const {
-    if (!closureVar_.isClosure() && closure_) {
-        closureVar_ = evalExpression(env, closure_, Value::eClosure);
+    if (closure_) {
+        return call(env, evalExpression(env, closure_, Value::eClosure));
     }
+    return Value::Null;
+}
 
-    Lambda::ArgList args(argExprs_.size());
-    std::transform(argExprs_.begin(), argExprs_.end(), args.begin(), [&env](auto const & arg) { return arg->eval(env); });
+Value LambdaApp::call(Environment::SharedPtr env, const Value &closure) const {
+    Lambda::ArgBuffer args(argExprs_.size());
+    for (std::size_t i = 0; i < argExprs_.size(); ++i) {
+        args[i] = argExprs_[i]->eval(env);
+    }
 
-    return closureVar_.closure().exec(args);
+    if (tail_) {
+        // Made by the lambda running this body, once the body returns
+        Lambda::deferCall(closure, args.args());
+        return Value::Null;
+    }
+    return closure.closure().exec(args.args());
 }
 
 // -------------------------------------------------------------
-FunctionExpr::FunctionExpr(const std::string &name, const ParamList &params, CodeNode::SharedPtr body)
-    : LambdaExpr(params, body)
+FunctionExpr::FunctionExpr(const std::string &name, const ParamList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout)
+    : LambdaExpr(params, body, layout)
     , iden_(Environment::idenTable().mapName(name))
+    , address_()
 {}
 
 Value FunctionExpr::exec(Environment::SharedPtr env) const {
@@ -567,18 +1219,43 @@ Value FunctionExpr::exec(Environment::SharedPtr env) const {
     if (!lambdaVal.isClosure()) {
         throw InvalidExpressionType(Value::typeToString(Value::eClosure), lambdaVal.typeToString());
     }
-    return env->def(iden_, lambdaVal);
+    return address_.isLexical() ? env->defAt(address_.slot, lambdaVal) : env->def(iden_, lambdaVal);
 }
 
 // -------------------------------------------------------------
 FunctionApp::FunctionApp(const std::string &name, SharedPtrList args)
     : LambdaApp(CodeNode::SharedPtr(), args)
     , iden_(Environment::idenTable().mapName(name))
+    , address_()
 {}
 
 Value FunctionApp::exec(Environment::SharedPtr env) const {
-    closureVar_ = env->get(iden_);
-    return LambdaApp::exec(env);
+    // A copy, evaluating the arguments may redefine the function
+    const Value closure = address_.isLexical() ? env->getAt(address_, iden_) : env->get(iden_);
+    return call(env, closure);
+}
+
+// -------------------------------------------------------------
+InlinedCall::InlinedCall(const FunctionApp &call, CodeNode::SharedPtr callee, CodeNode::SharedPtr body)
+    : FunctionApp(call)
+    , callee_(callee)
+    , body_(body)
+{}
+
+Value InlinedCall::exec(Environment::SharedPtr env) const {
+    const Value closure = env->get(iden());
+    if (!closure.isClosure() || closure.closure().body() != callee_) {
+        // Redefined since, call whatever the name holds now
+        return call(env, closure);
+    }
+
+    Lambda::ArgBuffer args(argExprs_.size());
+    for (std::size_t i = 0; i < argExprs_.size(); ++i) {
+        args[i] = argExprs_[i]->eval(env);
+    }
+
+    const InlineParam::Scope scope(args.args());
+    return body_->eval(env);
 }
 
 // -------------------------------------------------------------
@@ -586,13 +1263,34 @@ Print::Print(bool newline, CodeNode::SharedPtrList exprs)
     : CodeNode()
     , newline_(newline)
     , exprs_(exprs)
-{}
+{
+    for (auto &expr : exprs_) {
+        expr->markReadOnly();
+    }
+}
+
+Value Print::exec(Environment::SharedPtr env) const {
+    if (RefCount::atomic()) {
+        // Other threads may print, the line is written under the output
+        // lock once evaluated, as evaluating may wait for those threads
+        std::vector<Value> values;
+        values.reserve(exprs_.size());
+        for (const auto &expr : exprs_) {
+            values.push_back(expr->eval(env));
+        }
+
+        Output::Lock lock;
+        for (const auto &value : values) {
+            Value::print(value);
+        }
+        if (newline_) { Output::newline(); }
+        return Value::Null;
+    }
 
-Value Print::exec(Environment::SharedPtr env) const {
     for (const auto &expr : exprs_) {
         Value::print(expr->eval(env));
     }
-    if (newline_) { std::cout << std::endl; }
+    if (newline_) { Output::newline(); }
     return Value::Null;
 }
 
@@ -664,6 +1362,7 @@ MakeInstance::MakeInstance(const std::string &name, const NameSharedPtrs &initLi
     : CodeNode()
     , iden_(Environment::idenTable().mapName(name))
     , initList_(initList)
+    , slotHints_(initList.size())
 {}
 
 Value MakeInstance::exec(Environment::SharedPtr env) const {
@@ -671,15 +1370,19 @@ Value MakeInstance::exec(Environment::SharedPtr env) const {
     if (!structValue.isUserType()) {
         throw InvalidExpressionType(Value::typeToString(Value::eUserType), structValue.typeToString());
     }
-    return Value(Instance(structValue.userType(), makeInitArgs(env)));
-}
 
-Instance::InitArgs MakeInstance::makeInitArgs(Environment::SharedPtr &env) const {
-    Instance::InitArgs initArgs;
-    for (const auto &nameSharedPtr : initList_) {
-        initArgs.emplace(nameSharedPtr.first, nameSharedPtr.second->eval(env));
+    const auto &type = structValue.userType();
+    Instance instance(type);
+    for (std::size_t i = 0; i < initList_.size(); ++i) {
+        const auto &[name, expr] = initList_[i];
+        Value value = expr->eval(env);
+        const auto slot = type.slot(name, slotHints_[i].load());
+        if (slot != Struct::NoSlot) {
+            instance.setSlot(slot, value);
+            slotHints_[i].store(slot);
+        }
     }
-    return initArgs;
+    return Value(std::move(instance));
 }
 
 // -------------------------------------------------------------
@@ -704,12 +1407,13 @@ GetMember::GetMember(CodeNode::SharedPtr expr, const std::string &name)
     : CodeNode()
     , expr_(expr)
     , name_(name)
+    , slotHint_()
 {}
 
 Value GetMember::exec(Environment::SharedPtr env) const {
     if (expr_) {
         const Value value = evalOperand(env, expr_, Value::eUserObject);
-        return Generic::get(value.userObject(), name_);
+        return Generic::get(value.userObject(), name_, slotHint_);
     }
     return Value::Null;
 }
@@ -720,13 +1424,14 @@ SetMember::SetMember(CodeNode::SharedPtr expr, const std::string &name, CodeNode
     , expr_(expr)
     , name_(name)
     , newValExpr_(newValExpr)
+    , slotHint_()
 {}
 
 Value SetMember::exec(Environment::SharedPtr env) const {
     if (expr_ && newValExpr_) {
         Value instanceValue = evalOperand(env, expr_, Value::eUserObject);
         Value newValue = newValExpr_->eval(env);
-        Generic::set(instanceValue.userObject(), name_, newValue);
+        Generic::set(instanceValue.userObject(), name_, slotHint_, newValue);
         return newValue;
     }
     return Value::Null;
@@ -736,7 +1441,9 @@ Value SetMember::exec(Environment::SharedPtr env) const {
 StringLen::StringLen(CodeNode::SharedPtr expr)
     : CodeNode()
     , expr_(expr)
-{}
+{
+    if (expr_) { expr_->markReadOnly(); }
+}
 
 Value StringLen::exec(Environment::SharedPtr env) const {
     if (expr_) {
@@ -751,7 +1458,9 @@ StringGet::StringGet(CodeNode::SharedPtr str, CodeNode::SharedPtr pos)
     : CodeNode()
     , str_(str)
     , pos_(pos)
-{}
+{
+    if (str_) { str_->markReadOnly(); }
+}
 
 Value StringGet::exec(Environment::SharedPtr env) const {
     if (str_ && pos_) {
@@ -784,7 +1493,9 @@ StringCat::StringCat(CodeNode::SharedPtr str, CodeNode::SharedPtr other)
     : CodeNode()
     , str_(str)
     , other_(other)
-{}
+{
+    if (other_) { other_->markReadOnly(); }
+}
 
 Value StringCat::exec(Environment::SharedPtr env) const {
     if (str_ && other_) {
@@ -810,14 +1521,18 @@ SubString::SubString(CodeNode::SharedPtr str, CodeNode::SharedPtr pos)
     , str_(str)
     , pos_(pos)
     , len_()
-{}
+{
+    if (str_) { str_->markReadOnly(); }
+}
 
 SubString::SubString(CodeNode::SharedPtr str, CodeNode::SharedPtr pos, CodeNode::SharedPtr len)
     : CodeNode()
     , str_(str)
     , pos_(pos)
     , len_(len)
-{}
+{
+    if (str_) { str_->markReadOnly(); }
+}
 
 Value SubString::exec(Environment::SharedPtr env) const {
     if (str_ && pos_) {
@@ -848,18 +1563,23 @@ StringFind::StringFind(CodeNode::SharedPtr str, CodeNode::SharedPtr chr)
     , str_(str)
     , chr_(chr)
     , pos_()
-{}
+{
+    if (str_) { str_->markReadOnly(); }
+}
 
 StringFind::StringFind(CodeNode::SharedPtr str, CodeNode::SharedPtr chr, CodeNode::SharedPtr pos)
     : CodeNode()
     , str_(str)
     , chr_(chr)
     , pos_(pos)
-{}
+{
+    if (str_) { str_->markReadOnly(); }
+}
 
 Value StringFind::exec(Environment::SharedPtr env) const {
     if (str_ && chr_) {
-        return Generic::find(evalOperand(env, str_, Value::eString).text(),
+        const Value str = evalOperand(env, str_, Value::eString);
+        return Generic::find(str.text(),
                              chr_->eval(env),
                              pos_ ? pos_->eval(env) : Value::Zero);
     }
@@ -871,11 +1591,14 @@ StringCount::StringCount(CodeNode::SharedPtr str, CodeNode::SharedPtr chr)
     : CodeNode()
     , str_(str)
     , chr_(chr)
-{}
+{
+    if (str_) { str_->markReadOnly(); }
+}
 
 Value StringCount::exec(Environment::SharedPtr env) const {
     if (str_ && chr_) {
-        return Generic::count(evalOperand(env, str_, Value::eString).text(),
+        const Value str = evalOperand(env, str_, Value::eString);
+        return Generic::count(str.text(),
                               chr_->eval(env));
     }
     return Value::Null;
@@ -886,7 +1609,10 @@ StringCompare::StringCompare(CodeNode::SharedPtr lhs, CodeNode::SharedPtr rhs)
     : CodeNode()
     , lhs_(lhs)
     , rhs_(rhs)
-{}
+{
+    if (lhs_) { lhs_->markReadOnly(); }
+    if (rhs_) { rhs_->markReadOnly(); }
+}
 
 Value StringCompare::exec(Environment::SharedPtr env) const {
     if (lhs_ && rhs_) {
@@ -1015,18 +1741,18 @@ Value MakeArraySG::exec(Environment::SharedPtr env) const {
         const auto size = evalOperand(env, size_, Value::eInteger);
         const auto rawSize = size.integer();
 
-        Sequence seq(rawSize, Value::Null);
+        Sequence::Vector items;
         if (rawSize > 0) {
             const auto gclo = evalOperand(env, genFtn_, Value::eClosure);
 
             const auto & gftn = gclo.closure();
-            const Lambda::ArgList args;
 
+            items.reserve(rawSize);
             for (Value::Long i = 0; i < rawSize; ++i) {
-                seq.set(i, gftn.exec(args));
+                items.push_back(gftn.exec(Lambda::Args()));
             }
         }
-        return Value(std::move(seq));
+        return Value(Sequence(std::move(items)));
     }
     return Value::Null;
 }
@@ -1155,6 +1881,25 @@ Value ArrayCount::exec(Environment::SharedPtr env) const {
     return Value::Null;
 }
 
+// -------------------------------------------------------------
+ArrayBinarySearch::ArrayBinarySearch(CodeNode::SharedPtr arr, CodeNode::SharedPtr val, CodeNode::SharedPtr descending)
+    : CodeNode()
+    , arr_(arr)
+    , val_(val)
+    , desc_(descending)
+{}
+
+Value ArrayBinarySearch::exec(Environment::SharedPtr env) const {
+    if (arr_ && val_) {
+        const Value arr = evalOperand(env, arr_, Value::eArray);
+        const Value val = val_->eval(env);
+        const Value desc = desc_ ? evalOperand(env, desc_, Value::eBoolean) : Value::False;
+        const auto result = arr.array().binarySearch(val, desc.boolean());
+        return result ? Value(Value::Long(*result)) : Value(-1ll);
+    }
+    return Value::Null;
+}
+
 // -------------------------------------------------------------
 ArraySort::ArraySort(CodeNode::SharedPtr arr, CodeNode::SharedPtr descending)
     : CodeNode()
@@ -1328,7 +2073,7 @@ ImportModule::ImportModule(const std::string &name, const std::string &asName)
 {}
 
 Value ImportModule::exec(Environment::SharedPtr env) const {
-    auto modulePtr = ModuleStorage::getOrCreate(name_);
+    auto modulePtr = Context::modules().getOrCreate(name_);
     if (modulePtr) {
         return modulePtr->import(env, asName_.empty() ? Module::OptionalName() : Module::OptionalName(asName_));
     }
@@ -1351,7 +2096,7 @@ FromModuleImport::FromModuleImport(const std::string &name, const NameAndAsList
 {}
 
 Value FromModuleImport::exec(Environment::SharedPtr env) const {
-    auto modulePtr = ModuleStorage::getOrCreate(name_);
+    auto modulePtr = Context::modules().getOrCreate(name_);
     if (modulePtr) {
         return modulePtr->aliases(env, aliasList_);
     }
@@ -1365,7 +2110,8 @@ Random::Random(CodeNode::SharedPtr max)
 {}
 
 Value Random::exec(Environment::SharedPtr env) const {
-    static auto randFtn = std::mt19937(std::random_device()());
+    // A generator per thread, interpreters and pool threads draw independently
+    static thread_local auto randFtn = std::mt19937(std::random_device()());
     static const auto maxRand = static_cast<Value::Long>(randFtn.max());
 
     Value::Long rand = static_cast<Value::Long>(randFtn());
@@ -1775,6 +2521,48 @@ namespace Ishlang {
     template class MapItemsImpl<OrderedTable, ReverseOrder>;
 }
 
+// -------------------------------------------------------------
+OrderedMapNearest::OrderedMapNearest(Type type, CodeNode::SharedPtr tblExpr, CodeNode::SharedPtr keyExpr)
+    : CodeNode()
+    , type_(type)
+    , tblExpr_(tblExpr)
+    , keyExpr_(keyExpr)
+{}
+
+Value OrderedMapNearest::exec(Environment::SharedPtr env) const {
+    if (tblExpr_ && keyExpr_) {
+        const Value m = evalOperand(env, tblExpr_, Value::eOrderedMap);
+        const Value key = keyExpr_->eval(env);
+        const auto &table = m.orderedMap();
+        switch (type_) {
+        case Floor:   return table.floor(key);
+        case Ceiling: return table.ceiling(key);
+        case Lower:   return table.lower(key);
+        case Higher:  return table.higher(key);
+        }
+        throw InvalidExpression("unknown ordered map nearest type", std::string(1, char(type_)));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+OrderedMapRange::OrderedMapRange(CodeNode::SharedPtr tblExpr, CodeNode::SharedPtr loExpr, CodeNode::SharedPtr hiExpr)
+    : CodeNode()
+    , tblExpr_(tblExpr)
+    , loExpr_(loExpr)
+    , hiExpr_(hiExpr)
+{}
+
+Value OrderedMapRange::exec(Environment::SharedPtr env) const {
+    if (tblExpr_ && loExpr_ && hiExpr_) {
+        const Value m = evalOperand(env, tblExpr_, Value::eOrderedMap);
+        const Value lo = loExpr_->eval(env);
+        const Value hi = hiExpr_->eval(env);
+        return Value(m.orderedMap().range(lo, hi));
+    }
+    return Value::Null;
+}
+
 // -------------------------------------------------------------
 MakePair::MakePair(CodeNode::SharedPtr firstExpr, CodeNode::SharedPtr secondExpr)
     : CodeNode()
@@ -1847,80 +2635,420 @@ Value MakeRange::exec(Environment::SharedPtr env) const {
 }
 
 // -------------------------------------------------------------
-template <typename R>
-RangeGetter<R>::RangeGetter(CodeNode::SharedPtr rng, Getter && getter)
+template <typename R>
+RangeGetter<R>::RangeGetter(CodeNode::SharedPtr rng, Getter && getter)
+    : CodeNode()
+    , rng_(rng)
+    , getter_(std::move(getter))
+{}
+
+template <typename R>
+Value RangeGetter<R>::exec(Environment::SharedPtr env) const {
+    if (rng_) {
+        const auto rng = evalOperand(env, rng_, Value::eRange);
+
+        if constexpr (std::is_same_v<R, Value>) {
+            return getter_(rng.range());
+        }
+        else {
+            return Value(getter_(rng.range()));
+        }
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+RangeBegin::RangeBegin(CodeNode::SharedPtr rng)
+    : RangeGetter<Value::Long>(rng, &IntegerRange::begin)
+{}
+
+// -------------------------------------------------------------
+RangeEnd::RangeEnd(CodeNode::SharedPtr rng)
+    : RangeGetter<Value::Long>(rng, &IntegerRange::end)
+{}
+
+// -------------------------------------------------------------
+RangeStep::RangeStep(CodeNode::SharedPtr rng)
+    : RangeGetter<Value::Long>(rng, &IntegerRange::step)
+{}
+
+// -------------------------------------------------------------
+RangeLen::RangeLen(CodeNode::SharedPtr rng)
+    : RangeGetter<Value>(
+        rng,
+        [](const IntegerRange & r) {
+            return Generic::length(r);
+        })
+{}
+
+// -------------------------------------------------------------
+namespace {
+
+    inline std::size_t toIndex(const Value &value, const char *what) {
+        if (value.integer() < 0) {
+            throw OutOfRange(Exception::format("ndarray %s", what));
+        }
+        return static_cast<std::size_t>(value.integer());
+    }
+
+    // Shape given as an integer or an array of integers.
+    DenseArray::Shape toShape(const Value &value) {
+        DenseArray::Shape shape;
+        if (value.isInt()) {
+            shape.push_back(toIndex(value, "shape"));
+        }
+        else {
+            for (const auto &dim : value.array()) {
+                if (!dim.isInt()) {
+                    throw InvalidOperandType(Value::typeToString(Value::eInteger), dim.typeToString());
+                }
+                shape.push_back(toIndex(dim, "shape"));
+            }
+        }
+        return shape;
+    }
+
+    std::vector<std::size_t> evalIndex(Environment::SharedPtr env, const CodeNode::SharedPtrList &exprs) {
+        std::vector<std::size_t> index;
+        index.reserve(exprs.size());
+        for (const auto &expr : exprs) {
+            index.push_back(toIndex(evalOperand(env, expr, Value::eInteger), "index"));
+        }
+        return index;
+    }
+
+}
+
+// -------------------------------------------------------------
+MakeNdArray::MakeNdArray(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtr shapeExpr)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+    , shapeExpr_(shapeExpr)
+{}
+
+Value MakeNdArray::exec(Environment::SharedPtr env) const {
+    if (arrExpr_) {
+        const auto arr = evalOperand(env, arrExpr_, Value::eArray);
+        auto nd = DenseArray::fromSequence(arr.array());
+        if (shapeExpr_) {
+            nd = nd.reshape(toShape(evalOperand(env, shapeExpr_, Value::eInteger, Value::eArray)));
+        }
+        return Value(std::move(nd));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArrayFill::NdArrayFill(CodeNode::SharedPtr shapeExpr, CodeNode::SharedPtr fillExpr)
+    : CodeNode()
+    , shapeExpr_(shapeExpr)
+    , fillExpr_(fillExpr)
+{}
+
+Value NdArrayFill::exec(Environment::SharedPtr env) const {
+    if (shapeExpr_) {
+        const auto shape = toShape(evalOperand(env, shapeExpr_, Value::eInteger, Value::eArray));
+        const auto fill = fillExpr_ ? evalOperand(env, fillExpr_, Value::eInteger, Value::eReal).real() : 0.0;
+        return Value(DenseArray(shape, fill));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArrayShape::NdArrayShape(CodeNode::SharedPtr arrExpr)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+{}
+
+Value NdArrayShape::exec(Environment::SharedPtr env) const {
+    if (arrExpr_) {
+        const auto nd = evalOperand(env, arrExpr_, Value::eNdArray);
+        const auto &shape = nd.ndArray().shape();
+        return Value(Sequence::packed(Sequence::Integers(shape.begin(), shape.end())));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArrayReshape::NdArrayReshape(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtr shapeExpr)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+    , shapeExpr_(shapeExpr)
+{}
+
+Value NdArrayReshape::exec(Environment::SharedPtr env) const {
+    if (arrExpr_ && shapeExpr_) {
+        const auto nd = evalOperand(env, arrExpr_, Value::eNdArray);
+        const auto shape = toShape(evalOperand(env, shapeExpr_, Value::eInteger, Value::eArray));
+        return Value(nd.ndArray().reshape(shape));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArrayTranspose::NdArrayTranspose(CodeNode::SharedPtr arrExpr)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+{}
+
+Value NdArrayTranspose::exec(Environment::SharedPtr env) const {
+    if (arrExpr_) {
+        const auto nd = evalOperand(env, arrExpr_, Value::eNdArray);
+        return Value(nd.ndArray().transpose());
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArraySlice::NdArraySlice(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtr axisExpr, CodeNode::SharedPtr beginExpr, CodeNode::SharedPtr endExpr)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+    , axisExpr_(axisExpr)
+    , beginExpr_(beginExpr)
+    , endExpr_(endExpr)
+{}
+
+Value NdArraySlice::exec(Environment::SharedPtr env) const {
+    if (arrExpr_ && axisExpr_ && beginExpr_ && endExpr_) {
+        const auto nd = evalOperand(env, arrExpr_, Value::eNdArray);
+        const auto axis = toIndex(evalOperand(env, axisExpr_, Value::eInteger), "slice axis");
+        const auto begin = toIndex(evalOperand(env, beginExpr_, Value::eInteger), "slice bounds");
+        const auto end = toIndex(evalOperand(env, endExpr_, Value::eInteger), "slice bounds");
+        return Value(nd.ndArray().slice(axis, begin, end));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArrayGet::NdArrayGet(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtrList indexExprs)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+    , indexExprs_(indexExprs)
+{}
+
+Value NdArrayGet::exec(Environment::SharedPtr env) const {
+    if (arrExpr_) {
+        const auto nd = evalOperand(env, arrExpr_, Value::eNdArray);
+        return Value(nd.ndArray().at(evalIndex(env, indexExprs_)));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArraySet::NdArraySet(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtrList indexExprs, CodeNode::SharedPtr valueExpr)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+    , indexExprs_(indexExprs)
+    , valueExpr_(valueExpr)
+{}
+
+Value NdArraySet::exec(Environment::SharedPtr env) const {
+    if (arrExpr_ && valueExpr_) {
+        auto nd = evalOperand(env, arrExpr_, Value::eNdArray);
+        const auto index = evalIndex(env, indexExprs_);
+        const auto value = evalOperand(env, valueExpr_, Value::eInteger, Value::eReal);
+        nd.ndArray().at(index) = value.real();
+        return value;
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArrayMatMul::NdArrayMatMul(CodeNode::SharedPtr lhsExpr, CodeNode::SharedPtr rhsExpr)
+    : CodeNode()
+    , lhsExpr_(lhsExpr)
+    , rhsExpr_(rhsExpr)
+{}
+
+Value NdArrayMatMul::exec(Environment::SharedPtr env) const {
+    if (lhsExpr_ && rhsExpr_) {
+        const auto lhs = evalOperand(env, lhsExpr_, Value::eNdArray);
+        const auto rhs = evalOperand(env, rhsExpr_, Value::eNdArray);
+        return Value(DenseArray::matmul(lhs.ndArray(), rhs.ndArray()));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArraySum::NdArraySum(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtr axisExpr)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+    , axisExpr_(axisExpr)
+{}
+
+Value NdArraySum::exec(Environment::SharedPtr env) const {
+    if (arrExpr_) {
+        const auto nd = evalOperand(env, arrExpr_, Value::eNdArray);
+        if (axisExpr_) {
+            const auto axis = toIndex(evalOperand(env, axisExpr_, Value::eInteger), "sum axis");
+            return Value(nd.ndArray().sum(axis));
+        }
+        return Value(nd.ndArray().sum());
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+NdArrayToArray::NdArrayToArray(CodeNode::SharedPtr arrExpr)
+    : CodeNode()
+    , arrExpr_(arrExpr)
+{}
+
+Value NdArrayToArray::exec(Environment::SharedPtr env) const {
+    if (arrExpr_) {
+        const auto nd = evalOperand(env, arrExpr_, Value::eNdArray);
+        return Value(nd.ndArray().toSequence());
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+Expand::Expand(CodeNode::SharedPtrList exprs)
+    : CodeNode()
+    , exprs_(exprs)
+{}
+
+Value Expand::exec(Environment::SharedPtr env) const {
+    std::vector<Value> values;
+    for (const auto &expr : exprs_) {
+        const auto val = evalOperand(env, expr, Value::eRange);
+
+        auto gen = val.range().generator();
+        while (auto i = gen.next()) {
+            values.push_back(Value(*i));
+        }
+    }
+    return Value(Sequence(std::move(values)));
+}
+
+// -------------------------------------------------------------
+MakeIterator::MakeIterator(CodeNode::SharedPtr obj)
+    : CodeNode()
+    , obj_(obj)
+{}
+
+Value MakeIterator::exec(Environment::SharedPtr env) const {
+    if (obj_) {
+        return Value(Iterator::from(obj_->eval(env)));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+IteratorMap::IteratorMap(CodeNode::SharedPtr obj, CodeNode::SharedPtr ftn)
     : CodeNode()
-    , rng_(rng)
-    , getter_(std::move(getter))
+    , obj_(obj)
+    , ftn_(ftn)
 {}
 
-template <typename R>
-Value RangeGetter<R>::exec(Environment::SharedPtr env) const {
-    if (rng_) {
-        const auto rng = evalOperand(env, rng_, Value::eRange);
-
-        if constexpr (std::is_same_v<R, Value>) {
-            return getter_(rng.range());
-        }
-        else {
-            return Value(getter_(rng.range()));
-        }
+Value IteratorMap::exec(Environment::SharedPtr env) const {
+    if (obj_ && ftn_) {
+        const auto items = Iterator::from(obj_->eval(env));
+        const auto ftnVal = evalOperand(env, ftn_, Value::eClosure);
+        return Value(items.map(ftnVal.closure()));
     }
     return Value::Null;
 }
 
 // -------------------------------------------------------------
-RangeBegin::RangeBegin(CodeNode::SharedPtr rng)
-    : RangeGetter<Value::Long>(rng, &IntegerRange::begin)
+IteratorFilter::IteratorFilter(CodeNode::SharedPtr obj, CodeNode::SharedPtr pred)
+    : CodeNode()
+    , obj_(obj)
+    , pred_(pred)
 {}
 
+Value IteratorFilter::exec(Environment::SharedPtr env) const {
+    if (obj_ && pred_) {
+        const auto items = Iterator::from(obj_->eval(env));
+        const auto predVal = evalOperand(env, pred_, Value::eClosure);
+        return Value(items.filter(predVal.closure()));
+    }
+    return Value::Null;
+}
+
 // -------------------------------------------------------------
-RangeEnd::RangeEnd(CodeNode::SharedPtr rng)
-    : RangeGetter<Value::Long>(rng, &IntegerRange::end)
+IteratorTake::IteratorTake(CodeNode::SharedPtr obj, CodeNode::SharedPtr count)
+    : CodeNode()
+    , obj_(obj)
+    , count_(count)
 {}
 
+Value IteratorTake::exec(Environment::SharedPtr env) const {
+    if (obj_ && count_) {
+        const auto items = Iterator::from(obj_->eval(env));
+        const auto countVal = evalOperand(env, count_, Value::eInteger);
+        if (countVal.integer() < 0) { throw InvalidExpression("itake count negative"); }
+        return Value(items.take(static_cast<std::size_t>(countVal.integer())));
+    }
+    return Value::Null;
+}
+
 // -------------------------------------------------------------
-RangeStep::RangeStep(CodeNode::SharedPtr rng)
-    : RangeGetter<Value::Long>(rng, &IntegerRange::step)
+IteratorZip::IteratorZip(CodeNode::SharedPtr first, CodeNode::SharedPtr second)
+    : CodeNode()
+    , first_(first)
+    , second_(second)
 {}
 
+Value IteratorZip::exec(Environment::SharedPtr env) const {
+    if (first_ && second_) {
+        const auto first = Iterator::from(first_->eval(env));
+        const auto second = Iterator::from(second_->eval(env));
+        return Value(first.zip(second));
+    }
+    return Value::Null;
+}
+
 // -------------------------------------------------------------
-RangeLen::RangeLen(CodeNode::SharedPtr rng)
-    : RangeGetter<Value>(
-        rng,
-        [](const IntegerRange & r) {
-            return Generic::length(r);
-        })
+IteratorEnumerate::IteratorEnumerate(CodeNode::SharedPtr obj)
+    : CodeNode()
+    , obj_(obj)
 {}
 
+Value IteratorEnumerate::exec(Environment::SharedPtr env) const {
+    if (obj_) {
+        return Value(Iterator::from(obj_->eval(env)).enumerate());
+    }
+    return Value::Null;
+}
+
 // -------------------------------------------------------------
-Expand::Expand(CodeNode::SharedPtrList exprs)
+IteratorCollect::IteratorCollect(CodeNode::SharedPtr obj)
     : CodeNode()
-    , exprs_(exprs)
+    , obj_(obj)
 {}
 
-Value Expand::exec(Environment::SharedPtr env) const {
-    std::vector<Value> values;
-    for (const auto &expr : exprs_) {
-        const auto val = evalOperand(env, expr, Value::eRange);
+Value IteratorCollect::exec(Environment::SharedPtr env) const {
+    if (obj_) {
+        const auto items = Iterator::from(obj_->eval(env));
 
-        auto gen = val.range().generator();
-        while (auto i = gen.next()) {
-            values.push_back(Value(*i));
+        Sequence::Vector values;
+        while (auto item = items.next()) {
+            values.push_back(std::move(*item));
         }
+        return Value(Sequence(std::move(values)));
     }
-    return Value(Sequence(std::move(values)));
+    return Value::Null;
 }
 
 // -------------------------------------------------------------
 GenericLen::GenericLen(CodeNode::SharedPtr object)
     : CodeNode()
     , object_(object)
+    , feedback_()
 {}
 
 Value GenericLen::exec(Environment::SharedPtr env) const {
     if (object_) {
         auto objVal = object_->eval(env);
+        if (const auto quickened = feedback_.quickened(); quickened != Value::eNone) {
+            if (objVal.type() == quickened) {
+                return quickened == Value::eArray ? Generic::length(objVal.array()) : Generic::length(objVal.text());
+            }
+            feedback_.deoptimize();
+        }
+
+        feedback_.record(anyOfType(objVal.type(), Value::eArray, Value::eString) ? objVal.type() : Value::eNone);
         switch (objVal.type()) {
         case Value::eString:     return Generic::length(objVal.text());
         case Value::eArray:      return Generic::length(objVal.array());
@@ -1928,9 +3056,11 @@ Value GenericLen::exec(Environment::SharedPtr env) const {
         case Value::eOrderedMap: return Generic::length(objVal.orderedMap());
         case Value::eRange:      return Generic::length(objVal.range());
         case Value::ePair:       return Generic::length(objVal.pair());
+        case Value::eNdArray:    return Generic::length(objVal.ndArray());
+        case Value::eIterator:   return Generic::length(objVal.iterator());
         default:
             throw InvalidOperandType(
-                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::ePair),
+                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::ePair, Value::eNdArray, Value::eIterator),
                 objVal.typeToString());
         }
     }
@@ -1953,9 +3083,10 @@ Value GenericEmpty::exec(Environment::SharedPtr env) const {
         case Value::eOrderedMap: return Generic::empty(objVal.orderedMap());
         case Value::eRange:      return Generic::empty(objVal.range());
         case Value::ePair:       return Generic::empty(objVal.pair());
+        case Value::eNdArray:    return Generic::empty(objVal.ndArray());
         default:
             throw InvalidOperandType(
-                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::ePair),
+                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::ePair, Value::eNdArray),
                 objVal.typeToString());
         }
     }
@@ -1968,11 +3099,23 @@ GenericGet::GenericGet(CodeNode::SharedPtr object, CodeNode::SharedPtr key, Code
     , object_(object)
     , key_(key)
     , defaultRet_(defaultRet)
+    , slotHint_()
+    , feedback_()
 {}
 
 Value GenericGet::exec(Environment::SharedPtr env) const {
     if (object_ && key_) {
         auto objVal = object_->eval(env);
+        if (const auto quickened = feedback_.quickened(); quickened != Value::eNone) {
+            if (objVal.type() == quickened) {
+                return quickened == Value::eArray
+                    ? Generic::get(objVal.array(), key_->eval(env))
+                    : Generic::get(objVal.hashMap(), key_->eval(env), defaultRet_ ? defaultRet_->eval(env) : Value::Null);
+            }
+            feedback_.deoptimize();
+        }
+
+        feedback_.record(anyOfType(objVal.type(), Value::eArray, Value::eHashMap) ? objVal.type() : Value::eNone);
         switch (objVal.type()) {
         case Value::eString:
             return Generic::get(objVal.text(), key_->eval(env));
@@ -1988,15 +3131,18 @@ Value GenericGet::exec(Environment::SharedPtr env) const {
 
         case Value::eUserObject:
             return key_->isIdentifier()
-                ? Generic::get(objVal.userObject(), key_->identifierName())
-                : Generic::get(objVal.userObject(), key_->eval(env));
+                ? Generic::get(objVal.userObject(), key_->identifierName(), slotHint_)
+                : Generic::get(objVal.userObject(), key_->eval(env), slotHint_);
 
         case Value::ePair:
             return Generic::get(objVal.pair(), key_->eval(env));
 
+        case Value::eNdArray:
+            return Generic::get(objVal.ndArray(), key_->eval(env));
+
         default:
             throw InvalidOperandType(
-                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eUserObject, Value::ePair),
+                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eUserObject, Value::ePair, Value::eNdArray),
                 objVal.typeToString());
         }
     }
@@ -2009,6 +3155,8 @@ GenericSet::GenericSet(CodeNode::SharedPtr object, CodeNode::SharedPtr key, Code
     , object_(object)
     , key_(key)
     , value_(value)
+    , slotHint_()
+    , feedback_()
 {}
 
 Value GenericSet::exec(Environment::SharedPtr env) const {
@@ -2016,6 +3164,16 @@ Value GenericSet::exec(Environment::SharedPtr env) const {
         auto objVal = object_->eval(env);
         auto value = value_->eval(env);
 
+        if (const auto quickened = feedback_.quickened(); quickened != Value::eNone) {
+            if (objVal.type() == quickened) {
+                if (quickened == Value::eArray) { Generic::set(objVal.array(), key_->eval(env), value); }
+                else                            { Generic::set(objVal.hashMap(), key_->eval(env), value); }
+                return value;
+            }
+            feedback_.deoptimize();
+        }
+
+        feedback_.record(anyOfType(objVal.type(), Value::eArray, Value::eHashMap) ? objVal.type() : Value::eNone);
         switch (objVal.type()) {
         case Value::eString:
             Generic::set(objVal.text(), key_->eval(env), value);
@@ -2035,16 +3193,20 @@ Value GenericSet::exec(Environment::SharedPtr env) const {
 
         case Value::eUserObject:
             if (key_->isIdentifier()) {
-                Generic::set(objVal.userObject(), key_->identifierName(), value);
+                Generic::set(objVal.userObject(), key_->identifierName(), slotHint_, value);
             }
             else {
-                Generic::set(objVal.userObject(), key_->eval(env), value);
+                Generic::set(objVal.userObject(), key_->eval(env), slotHint_, value);
             }
             break;
 
+        case Value::eNdArray:
+            Generic::set(objVal.ndArray(), key_->eval(env), value);
+            break;
+
         default:
             throw InvalidOperandType(
-                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eUserObject),
+                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eUserObject, Value::eNdArray),
                 objVal.typeToString());
         }
 
@@ -2188,12 +3350,15 @@ Value GenericSum::exec(Environment::SharedPtr env) const {
     if (obj_) {
         Value obj = obj_->eval(env);
         switch (obj.type()) {
-        case Value::eArray: return Generic::sum(obj.array());
-        case Value::eRange: return Generic::sum(obj.range());
-        case Value::ePair:  return Generic::sum(obj.pair());
+        case Value::eArray:     return Generic::sum(obj.array());
+        case Value::eRange:     return Generic::sum(obj.range());
+        case Value::ePair:      return Generic::sum(obj.pair());
+        case Value::eNdArray:   return Generic::sum(obj.ndArray());
+        case Value::eGenerator: return Generic::sum(obj.generator());
+        case Value::eIterator:  return Generic::sum(obj.iterator());
         default:
             throw InvalidOperandType(
-                typesToString(Value::eArray, Value::eRange, Value::ePair),
+                typesToString(Value::eArray, Value::eRange, Value::ePair, Value::eNdArray, Value::eGenerator, Value::eIterator),
                 obj.typeToString());
         }
     }
@@ -2226,11 +3391,171 @@ Value GenericApply::exec(Environment::SharedPtr env) const {
 }
 
 // -------------------------------------------------------------
-TimeIt::TimeIt(CodeNode::SharedPtr expr, CodeNode::SharedPtr count, CodeNode::SharedPtr summary)
+GenericMap::GenericMap(CodeNode::SharedPtr obj, CodeNode::SharedPtr ftn, bool parallel)
+    : CodeNode()
+    , obj_(obj)
+    , ftn_(ftn)
+    , parallel_(parallel)
+{}
+
+Value GenericMap::exec(Environment::SharedPtr env) const {
+    if (obj_ && ftn_) {
+        const auto obj = obj_->eval(env);
+        const auto ftnVal = evalOperand(env, ftn_, Value::eClosure);
+        const auto &ftn = ftnVal.closure();
+
+        switch (obj.type()) {
+        case Value::eString:     return Generic::map(obj.text(), ftn);
+        case Value::eArray:      return parallel_ ? Generic::pmap(obj.array(), ftn) : Generic::map(obj.array(), ftn);
+        case Value::ePair:       return Generic::map(obj.pair(), ftn);
+        case Value::eHashMap:    return Generic::map(obj.hashMap(), ftn);
+        case Value::eOrderedMap: return Generic::map(obj.orderedMap(), ftn);
+        case Value::eRange:      return parallel_ ? Generic::pmap(obj.range(), ftn) : Generic::map(obj.range(), ftn);
+        case Value::eGenerator:  return Generic::map(obj.generator(), ftn);
+        case Value::eIterator:   return Generic::map(obj.iterator(), ftn);
+        default:
+            throw InvalidOperandType(
+                typesToString(Value::eString, Value::eArray, Value::ePair, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::eGenerator, Value::eIterator),
+                obj.typeToString());
+        }
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+GenericFilter::GenericFilter(CodeNode::SharedPtr obj, CodeNode::SharedPtr pred, bool parallel)
+    : CodeNode()
+    , obj_(obj)
+    , pred_(pred)
+    , parallel_(parallel)
+{}
+
+Value GenericFilter::exec(Environment::SharedPtr env) const {
+    if (obj_ && pred_) {
+        const auto obj = obj_->eval(env);
+        const auto predVal = evalOperand(env, pred_, Value::eClosure);
+        const auto &pred = predVal.closure();
+
+        switch (obj.type()) {
+        case Value::eString:     return Generic::filter(obj.text(), pred);
+        case Value::eArray:      return parallel_ ? Generic::pfilter(obj.array(), pred) : Generic::filter(obj.array(), pred);
+        case Value::eHashMap:    return Generic::filter(obj.hashMap(), pred);
+        case Value::eOrderedMap: return Generic::filter(obj.orderedMap(), pred);
+        case Value::eRange:      return parallel_ ? Generic::pfilter(obj.range(), pred) : Generic::filter(obj.range(), pred);
+        case Value::eGenerator:  return Generic::filter(obj.generator(), pred);
+        case Value::eIterator:   return Generic::filter(obj.iterator(), pred);
+        default:
+            throw InvalidOperandType(
+                typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::eGenerator, Value::eIterator),
+                obj.typeToString());
+        }
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+GenericReduce::GenericReduce(CodeNode::SharedPtr obj, CodeNode::SharedPtr init, CodeNode::SharedPtr ftn, bool parallel)
+    : CodeNode()
+    , obj_(obj)
+    , init_(init)
+    , ftn_(ftn)
+    , parallel_(parallel)
+{}
+
+Value GenericReduce::exec(Environment::SharedPtr env) const {
+    if (obj_ && init_ && ftn_) {
+        const auto obj = obj_->eval(env);
+        const auto init = init_->eval(env);
+        const auto ftnVal = evalOperand(env, ftn_, Value::eClosure);
+        const auto &ftn = ftnVal.closure();
+
+        switch (obj.type()) {
+        case Value::eString:     return Generic::reduce(obj.text(), init, ftn);
+        case Value::eArray:      return parallel_ ? Generic::preduce(obj.array(), init, ftn) : Generic::reduce(obj.array(), init, ftn);
+        case Value::ePair:       return Generic::reduce(obj.pair(), init, ftn);
+        case Value::eHashMap:    return Generic::reduce(obj.hashMap(), init, ftn);
+        case Value::eOrderedMap: return Generic::reduce(obj.orderedMap(), init, ftn);
+        case Value::eRange:      return parallel_ ? Generic::preduce(obj.range(), init, ftn) : Generic::reduce(obj.range(), init, ftn);
+        case Value::eGenerator:  return Generic::reduce(obj.generator(), init, ftn);
+        case Value::eIterator:   return Generic::reduce(obj.iterator(), init, ftn);
+        default:
+            throw InvalidOperandType(
+                typesToString(Value::eString, Value::eArray, Value::ePair, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::eGenerator, Value::eIterator),
+                obj.typeToString());
+        }
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+GenericAll::GenericAll(CodeNode::SharedPtr obj, CodeNode::SharedPtr pred)
+    : CodeNode()
+    , obj_(obj)
+    , pred_(pred)
+{}
+
+Value GenericAll::exec(Environment::SharedPtr env) const {
+    if (obj_ && pred_) {
+        const auto obj = obj_->eval(env);
+        const auto predVal = evalOperand(env, pred_, Value::eClosure);
+        const auto &pred = predVal.closure();
+
+        switch (obj.type()) {
+        case Value::eString:     return Generic::all(obj.text(), pred);
+        case Value::eArray:      return Generic::all(obj.array(), pred);
+        case Value::ePair:       return Generic::all(obj.pair(), pred);
+        case Value::eHashMap:    return Generic::all(obj.hashMap(), pred);
+        case Value::eOrderedMap: return Generic::all(obj.orderedMap(), pred);
+        case Value::eRange:      return Generic::all(obj.range(), pred);
+        case Value::eGenerator:  return Generic::all(obj.generator(), pred);
+        case Value::eIterator:   return Generic::all(obj.iterator(), pred);
+        default:
+            throw InvalidOperandType(
+                typesToString(Value::eString, Value::eArray, Value::ePair, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::eGenerator, Value::eIterator),
+                obj.typeToString());
+        }
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+GenericAny::GenericAny(CodeNode::SharedPtr obj, CodeNode::SharedPtr pred)
+    : CodeNode()
+    , obj_(obj)
+    , pred_(pred)
+{}
+
+Value GenericAny::exec(Environment::SharedPtr env) const {
+    if (obj_ && pred_) {
+        const auto obj = obj_->eval(env);
+        const auto predVal = evalOperand(env, pred_, Value::eClosure);
+        const auto &pred = predVal.closure();
+
+        switch (obj.type()) {
+        case Value::eString:     return Generic::any(obj.text(), pred);
+        case Value::eArray:      return Generic::any(obj.array(), pred);
+        case Value::ePair:       return Generic::any(obj.pair(), pred);
+        case Value::eHashMap:    return Generic::any(obj.hashMap(), pred);
+        case Value::eOrderedMap: return Generic::any(obj.orderedMap(), pred);
+        case Value::eRange:      return Generic::any(obj.range(), pred);
+        case Value::eGenerator:  return Generic::any(obj.generator(), pred);
+        case Value::eIterator:   return Generic::any(obj.iterator(), pred);
+        default:
+            throw InvalidOperandType(
+                typesToString(Value::eString, Value::eArray, Value::ePair, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::eGenerator, Value::eIterator),
+                obj.typeToString());
+        }
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+TimeIt::TimeIt(CodeNode::SharedPtr expr, CodeNode::SharedPtr count, CodeNode::SharedPtr summary, ScopeLayout::SharedPtr layout)
     : CodeNode()
     , expr_(expr)
     , count_(count)
     , summary_(summary)
+    , layout_(layout)
 {}
 
 Value TimeIt::exec(Environment::SharedPtr env) const {
@@ -2238,11 +3563,11 @@ Value TimeIt::exec(Environment::SharedPtr env) const {
         const auto count = std::min( std::max(count_ ? evalOperand(env, count_, Value::eInteger).integer() : 1ll, 1ll), 1000000000ll);
         const auto summary = summary_ ? evalOperand(env, summary_, Value::eBoolean).boolean() : true;
 
-        auto tEnv = Environment::make(env);
+        auto tEnv = Environment::makeScope(env, layout_);
 
         auto const start = std::chrono::high_resolution_clock::now();
         for (Value::Long i = 0; i < count; ++i) {
-            tEnv->clear();
+            if (tEnv != env) { tEnv->clear(); }
             expr_->eval(tEnv);
         }
         auto const end = std::chrono::high_resolution_clock::now();
@@ -2251,19 +3576,104 @@ Value TimeIt::exec(Environment::SharedPtr env) const {
         const auto mean = total / static_cast<double>(count);
 
         if (summary) {
-            std::cout << "\nTimeIt Summary / Microseconds"
-                      << "\n-----------------------------"
-                      << "\n  count: " << count
-                      << "\n  total: " << total
-                      << "\n   mean: " << std::fixed << std::setprecision(6) << mean
-                      << "\n"
-                      << std::endl;
+            Output::Lock lock;
+            Output::write("\nTimeIt Summary / Microseconds"
+                          "\n-----------------------------"
+                          "\n  count: ");
+            Output::write(count);
+            Output::write("\n  total: ");
+            Output::write(total);
+            Output::write("\n   mean: ");
+            Output::write(mean);
+            Output::write('\n');
+            Output::newline();
         }
         return Value(mean);
     }
     return Value::Null;
 }
 
+// -------------------------------------------------------------
+Spawn::Spawn(CodeNode::SharedPtr expr, ScopeLayout::SharedPtr layout)
+    : CodeNode()
+    , expr_(expr)
+    , layout_(layout)
+{}
+
+Value Spawn::exec(Environment::SharedPtr env) const {
+    if (expr_) {
+        // The task runs on a copy of the caller's frames, it sees the values
+        // variables have when spawned and does not race later assignments
+        return Value(Future::spawn(
+            [expr = expr_, env = Environment::makeScope(Environment::capture(env), layout_)]() {
+                return expr->eval(env);
+            }));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+Await::Await(CodeNode::SharedPtr future)
+    : CodeNode()
+    , future_(future)
+{}
+
+Value Await::exec(Environment::SharedPtr env) const {
+    if (future_) {
+        return evalOperand(env, future_, Value::eFuture).future().await();
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+AwaitAll::AwaitAll(CodeNode::SharedPtr futures)
+    : CodeNode()
+    , futures_(futures)
+{}
+
+Value AwaitAll::exec(Environment::SharedPtr env) const {
+    if (futures_) {
+        const auto futures = evalOperand(env, futures_, Value::eArray);
+        const auto &arr = futures.array();
+
+        Sequence::Vector results;
+        results.reserve(arr.size());
+        for (std::size_t i = 0; i < arr.size(); ++i) {
+            const auto future = arr.get(i);
+            if (!future.isFuture()) {
+                throw InvalidOperandType(Value::typeToString(Value::eFuture), future.typeToString());
+            }
+            results.push_back(future.future().await());
+        }
+        return Value(Sequence(std::move(results)));
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+GarbageCollect::GarbageCollect()
+    : CodeNode()
+{}
+
+Value GarbageCollect::exec(Environment::SharedPtr) const {
+    return Value(static_cast<Value::Long>(GarbageCollector::current().collect()));
+}
+
+// -------------------------------------------------------------
+GarbageStats::GarbageStats()
+    : CodeNode()
+{}
+
+Value GarbageStats::exec(Environment::SharedPtr) const {
+    const auto &stats = GarbageCollector::current().stats();
+    Hashtable table;
+    table.set(Value("collections"), Value(static_cast<Value::Long>(stats.collections)));
+    table.set(Value("reclaimed"),   Value(static_cast<Value::Long>(stats.reclaimed)));
+    table.set(Value("tracked"),     Value(static_cast<Value::Long>(stats.tracked)));
+    table.set(Value("threshold"),   Value(static_cast<Value::Long>(stats.threshold)));
+    return Value(table);
+}
+
 // -------------------------------------------------------------
 FileOpen::FileOpen(CodeNode::SharedPtr filename, CodeNode::SharedPtr mode)
     : FileOp(filename)
@@ -2306,7 +3716,10 @@ Value FileFlush::exec(Environment::SharedPtr env) const {
         file.flush();
         return Value(file.isOpen());
     }
-    return Value::Null;
+
+    // Without a file flush standard output
+    Output::flush();
+    return Value::True;
 }
 
 // -------------------------------------------------------------
@@ -2380,11 +3793,29 @@ Value FileReadLn::exec(Environment::SharedPtr env) const {
     return Value::Null;
 }
 
+// -------------------------------------------------------------
+FileReadAll::FileReadAll(CodeNode::SharedPtr file)
+    : FileOp(file)
+{}
+
+Value FileReadAll::exec(Environment::SharedPtr env) const {
+    if (file_) {
+        auto fileVal = evalOperand(env, file_, Value::eFile);
+        auto optS = fileVal.file().readAll();
+        if (optS) {
+            return Value(std::move(*optS));
+        }
+    }
+    return Value::Null;
+}
+
 // -------------------------------------------------------------
 FileWrite::FileWrite(CodeNode::SharedPtr file, CodeNode::SharedPtr charOrStr)
     : FileOp(file)
     , charOrStr_(charOrStr)
-{}
+{
+    if (charOrStr_) { charOrStr_->markReadOnly(); }
+}
 
 Value FileWrite::exec(Environment::SharedPtr env) const {
     if (file_ && charOrStr_) {
@@ -2405,7 +3836,9 @@ Value FileWrite::exec(Environment::SharedPtr env) const {
 FileWriteLn::FileWriteLn(CodeNode::SharedPtr file, CodeNode::SharedPtr str)
     : FileOp(file)
     , str_(str)
-{}
+{
+    if (str_) { str_->markReadOnly(); }
+}
 
 Value FileWriteLn::exec(Environment::SharedPtr env) const {
     if (file_ && str_) {
@@ -2449,10 +3882,59 @@ Value FileRemove::exec(Environment::SharedPtr env) const {
 }
 
 // -------------------------------------------------------------
-WithFile::WithFile(const std::string &name, CodeNode::SharedPtr file, CodeNode::SharedPtr body)
+CsvOpen::CsvOpen(CodeNode::SharedPtr filename, CodeNode::SharedPtr delimiter)
+    : FileOp(filename)
+    , delimiter_(delimiter)
+{}
+
+Value CsvOpen::exec(Environment::SharedPtr env) const {
+    if (file_) {
+        auto fname = evalOperand(env, file_, Value::eString).text();
+        const auto delimiter = delimiter_
+            ? evalOperand(env, delimiter_, Value::eCharacter).character()
+            : CsvReader::DefaultDelimiter;
+        return Value(FileParams{.filename=std::move(fname), .mode=FileMode::Map, .csvDelimiter=delimiter});
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+CsvRead::CsvRead(Type type, CodeNode::SharedPtr file, CodeNode::SharedPtr delimiter)
+    : FileOp(file)
+    , type_(type)
+    , delimiter_(delimiter)
+{}
+
+Value CsvRead::exec(Environment::SharedPtr env) const {
+    if (file_) {
+        auto fileVal = evalOperand(env, file_, Value::eFile);
+        auto &file = fileVal.file();
+        const auto delimiter = delimiter_
+            ? evalOperand(env, delimiter_, Value::eCharacter).character()
+            : file.csvDelimiter().value_or(CsvReader::DefaultDelimiter);
+
+        CsvReader reader(file, delimiter);
+        switch (type_) {
+        case Row:
+            if (auto optRow = reader.readRow()) {
+                return Value(std::move(*optRow));
+            }
+            return Value::Null;
+        case Rows:
+            return Value(reader.readRows());
+        case Columns:
+            return Value(reader.readColumns());
+        }
+    }
+    return Value::Null;
+}
+
+// -------------------------------------------------------------
+WithFile::WithFile(const std::string &name, CodeNode::SharedPtr file, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout)
     : FileOp(file)
     , iden_(Environment::idenTable().mapName(name))
     , body_(body)
+    , layout_(layout)
 {}
 
 Value WithFile::exec(Environment::SharedPtr env) const {
@@ -2460,7 +3942,7 @@ Value WithFile::exec(Environment::SharedPtr env) const {
         auto fileVal = evalOperand(env, file_, Value::eFile);
 
         try {
-            auto withEnv = Environment::make(env);
+            auto withEnv = Environment::make(env, layout_);
             withEnv->def(iden_, fileVal);
 
             auto result = body_->eval(withEnv);
@@ -2484,6 +3966,14 @@ MathFunction::MathFunction(Type type, CodeNode::SharedPtrList operands)
 }
 
 Value MathFunction::exec(Environment::SharedPtr env) const {
+    if ((type_ == Min || type_ == Max) && operands_.size() == 1) {
+        const Value arr = evalOperand(env, operands_[0], Value::eArray, Value::eNdArray);
+        if (arr.isNdArray()) {
+            return type_ == Min ? arr.ndArray().min() : arr.ndArray().max();
+        }
+        return type_ == Min ? arr.array().min() : arr.array().max();
+    }
+
     if (!operands_.empty()) {
         const auto values = evalOperands(env, operands_, Value::eInteger, Value::eReal);
 
@@ -8,12 +8,15 @@
 #include "instance.h"
 #include "integer_range.h"
 #include "struct.h"
+#include "type_feedback.h"
 #include "value.h"
 #include "value_pair.h"
 
 #include <cassert>
 #include <functional>
 #include <numeric>
+#include <span>
+#include <utility>
 
 namespace Ishlang {
 
@@ -33,14 +36,23 @@ namespace Ishlang {
     // -------------------------------------------------------------
     class Literal : public CodeNode {
     public:
-        Literal(const Value &value) : CodeNode(), value_(value) {}
+        Literal(const Value &value);
         virtual ~Literal() {}
 
+        virtual bool isLiteral() const override { return true; }
+        virtual const Value &literalValue() const override { return value_; }
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual void markReadOnly() override { readOnly_ = true; }
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+
     protected:
-        virtual Value exec(Environment::SharedPtr /*env*/) const override { return value_.clone(); }
+        virtual Value exec(Environment::SharedPtr /*env*/) const override { return readOnly_ ? value_ : value_.clone(); }
 
     private:
         Value value_;
+        bool  readOnly_;
     };
 
     // -------------------------------------------------------------
@@ -104,6 +116,10 @@ namespace Ishlang {
         Variable(const std::string &name) : CodeNode(), iden_(Environment::idenTable().mapName(name)) {}
         virtual ~Variable() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+
     public:
         virtual bool isIdentifier() const override {
             return true;
@@ -113,11 +129,17 @@ namespace Ishlang {
             return Environment::idenTable().getName(iden_);
         }
 
+        IdenType iden() const noexcept { return iden_; }
+        VarAddress &address() noexcept { return address_; }
+
     protected:
-        virtual Value exec(Environment::SharedPtr env) const override { return env->get(iden_); }
+        virtual Value exec(Environment::SharedPtr env) const override {
+            return address_.isLexical() ? env->getAt(address_, iden_) : env->get(iden_);
+        }
 
     private:
-        IdenType iden_;
+        IdenType   iden_;
+        VarAddress address_;
     };
 
     // -------------------------------------------------------------
@@ -125,12 +147,23 @@ namespace Ishlang {
     public:
         Define(const std::string &name, CodeNode::SharedPtr code) : CodeNode(), iden_(Environment::idenTable().mapName(name)), code_(code) {}
         virtual ~Define() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
+        IdenType iden() const noexcept { return iden_; }
+        VarAddress &address() noexcept { return address_; }
         
     protected:
-        virtual Value exec(Environment::SharedPtr env) const override { return env->def(iden_, code_ ? code_->eval(env) : Value::Null); }
+        virtual Value exec(Environment::SharedPtr env) const override {
+            const Value value = code_ ? code_->eval(env) : Value::Null;
+            return address_.isLexical() ? env->defAt(address_.slot, value) : env->def(iden_, value);
+        }
 
     private:
         IdenType            iden_;
+        VarAddress          address_;
         CodeNode::SharedPtr code_;
     };
     
@@ -140,11 +173,22 @@ namespace Ishlang {
         Assign(const std::string &name, CodeNode::SharedPtr code) : CodeNode(), iden_(Environment::idenTable().mapName(name)), code_(code) {}
         virtual ~Assign() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
+        IdenType iden() const noexcept { return iden_; }
+        VarAddress &address() noexcept { return address_; }
+
     protected:
-        virtual Value exec(Environment::SharedPtr env) const override { return env->set(iden_, code_ ? code_->eval(env) : Value::Null); }
+        virtual Value exec(Environment::SharedPtr env) const override {
+            const Value value = code_ ? code_->eval(env) : Value::Null;
+            return address_.isLexical() ? env->setAt(address_, iden_, value) : env->set(iden_, value);
+        }
         
     private:
         IdenType            iden_;
+        VarAddress          address_;
         CodeNode::SharedPtr code_;
     };
 
@@ -190,37 +234,60 @@ namespace Ishlang {
         ArithOp(Type type, CodeNode::SharedPtrList operands);
         virtual ~ArithOp() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+
+        static Value apply(Type type, std::span<const Value> values);
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
+        // Literal of the result when all operands are numeric literals.
+        CodeNode::SharedPtr fold(Optimizer &optimizer);
+
     private:
-        template <typename NumType, typename AccumOp>
-        static inline Value accum(const std::vector<Value> &vals, AccumOp op) {
-            if constexpr (std::is_same_v<NumType, Value::Double>) {
-                return Value(std::accumulate(
-                                 vals.begin() + 1,
-                                 vals.end(),
-                                 vals.front().real(),
-                                 [op](NumType a, const Value &v) { return op(a, v.real()); }));
-            }
-            else {
-                static_assert(std::is_same_v<NumType, Value::Long>);
-                return Value(std::accumulate(
-                                 vals.begin() + 1,
-                                 vals.end(),
-                                 vals.front().integer(),
-                                 [op](NumType a, const Value &v) { return op(a, v.integer()); }));
-            }
-        }
+        // Operands of quickened nodes are evaluated unboxed, nodes with
+        // more operands are not quickened.
+        static constexpr std::size_t MaxQuickenedOperands = 8;
+
+        // Operands all of NumType's value type, evaluated without boxing.
+        // Any other operand deoptimizes and goes through apply.
+        template <typename NumType>
+        Value execQuickened(Environment::SharedPtr env) const;
+
+        // Operands all integers, or reals when NumType is Double. Operands
+        // are values, or numbers unboxed by execQuickened.
+        template <typename NumType, typename Num>
+        static Value applyNumbers(Type type, std::span<const Num> nums);
+
+        // Type shared by all operands when integer or real, eNone otherwise.
+        static Value::Type numberType(std::span<const Value> values) noexcept;
+
+        // Array operands apply elementwise, arrays must be the same size
+        // and scalar operands apply to every element.
+        static Value elementwise(Type type, std::span<const Value> values);
 
         template <typename NumType>
-        static inline bool isDivByZero(const std::vector<Value> &vals) {
-            if constexpr (std::is_same_v<NumType, Value::Double>) {
-                return std::any_of(vals.begin() + 1, vals.end(), [](const Value &v) { return Util::isZero(v.real()); });
+        static Sequence packedElementwise(Type type, std::span<const Value> values, std::size_t size);
+
+        // As above for ndarray operands, which must have the same shape.
+        static DenseArray ndElementwise(Type type, std::span<const Value> values);
+
+        // lhs[i] = lhs[i] op rhs[i], or lhs[i] op rhs for a scalar rhs.
+        template <typename NumType, typename Rhs>
+        static void applyKernel(Type type, std::span<NumType> lhs, Rhs rhs);
+
+        // Operand as NumType, from a value or a number already unboxed.
+        template <typename NumType, typename Num>
+        static inline NumType number(const Num &num) {
+            if constexpr (std::is_same_v<Num, Value>) {
+                if constexpr (std::is_same_v<NumType, Value::Double>) { return num.real(); }
+                else                                                  { return num.integer(); }
             }
             else {
-                static_assert(std::is_same_v<NumType, Value::Long>);
-                return std::any_of(vals.begin() + 1, vals.end(), [](const Value &v) { return v.integer() == 0; });
+                return num;
             }
         }
 
@@ -228,8 +295,26 @@ namespace Ishlang {
             return std::pow(a, v);
         }
 
-    private:
+    protected:
         Type type_;
+
+    private:
+        mutable TypeFeedback feedback_;
+    };
+
+    // -------------------------------------------------------------
+    // Arithmetic on two operands, made by the optimizer. Integers are
+    // computed directly, other operands go through ArithOp::apply
+    // without building an operand vector.
+    class BinaryArithOp : public ArithOp {
+    public:
+        BinaryArithOp(Type type, CodeNode::SharedPtrList operands);
+        virtual ~BinaryArithOp() {}
+
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
     };
 
     // -------------------------------------------------------------
@@ -248,12 +333,20 @@ namespace Ishlang {
         ArithAssignOp(Type type, const std::string &name, CodeNode::SharedPtr delta);
         virtual ~ArithAssignOp() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
+        IdenType iden() const noexcept { return iden_; }
+        VarAddress &address() noexcept { return address_; }
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
     private:
         Type type_;
         IdenType iden_;
+        VarAddress address_;
         CodeNode::SharedPtr delta_;
     };
     
@@ -272,6 +365,13 @@ namespace Ishlang {
     public:
         CompOp(Type type, CodeNode::SharedPtr lhs, CodeNode::SharedPtr rhs);
         virtual ~CompOp() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+
+        static Value apply(Type type, const Value &lhsVal, const Value &rhsVal);
         
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
@@ -294,6 +394,11 @@ namespace Ishlang {
     public:
         LogicOp(Type type, CodeNode::SharedPtrList operands);
         virtual ~LogicOp() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
         
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
@@ -308,6 +413,11 @@ namespace Ishlang {
         Not(CodeNode::SharedPtr operand);
         virtual ~Not() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
     };
@@ -318,6 +428,11 @@ namespace Ishlang {
         NegativeOf(CodeNode::SharedPtr operand);
         virtual ~NegativeOf() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
     };
@@ -327,38 +442,67 @@ namespace Ishlang {
     public:
         ProgN(CodeNode::SharedPtrList exprs);
         virtual ~ProgN() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
+        virtual void markTailPosition() override;
+        virtual bool yields() const override { return yields_; }
+        virtual Routine generate(Environment::SharedPtr env) const override;
         
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
         
-    private:
+    protected:
         CodeNode::SharedPtrList exprs_;
+        bool                    yields_;
     };
 
     // -------------------------------------------------------------
     class Block : public ProgN {
     public:
-        Block(CodeNode::SharedPtrList exprs);
+        Block(CodeNode::SharedPtrList exprs, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~Block() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+        virtual Routine generate(Environment::SharedPtr env) const override;
         
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        ScopeLayout::SharedPtr layout_;
     };
 
     // -------------------------------------------------------------
     class If : public CodeNode {
     public:
-        If(CodeNode::SharedPtr pred, CodeNode::SharedPtr tCode);
-        If(CodeNode::SharedPtr pred, CodeNode::SharedPtr tCode, CodeNode::SharedPtr fCode);
+        If(CodeNode::SharedPtr pred, CodeNode::SharedPtr tCode, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
+        If(CodeNode::SharedPtr pred, CodeNode::SharedPtr tCode, CodeNode::SharedPtr fCode, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~If() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
+        virtual void markTailPosition() override;
+        virtual bool yields() const override { return yields_; }
+        virtual Routine generate(Environment::SharedPtr env) const override;
         
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
         
     private:
-        CodeNode::SharedPtr pred_;
-        CodeNode::SharedPtr tCode_;
-        CodeNode::SharedPtr fCode_;
+        CodeNode::SharedPtr    pred_;
+        CodeNode::SharedPtr    tCode_;
+        CodeNode::SharedPtr    fCode_;
+        ScopeLayout::SharedPtr layout_;
+        bool                   yields_;
     };
     
     // -------------------------------------------------------------
@@ -366,12 +510,22 @@ namespace Ishlang {
     public:
         Cond(CodeNode::SharedPtrPairs cases);
         virtual ~Cond() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual CodeNode::SharedPtr inlineCopy(Optimizer &optimizer) const override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
+        virtual void markTailPosition() override;
+        virtual bool yields() const override { return yields_; }
+        virtual Routine generate(Environment::SharedPtr env) const override;
         
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
         
     private:
         CodeNode::SharedPtrPairs cases_;
+        bool                     yields_;
     };
 
     // -------------------------------------------------------------
@@ -380,50 +534,143 @@ namespace Ishlang {
         struct Except {};
         
     public:
-        Break() {}
+        Break() : signal_(false) {}
         virtual ~Break() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
         
     protected:
-        virtual Value exec(Environment::SharedPtr /*env*/) const override { throw Except(); }
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        bool signal_;
+    };
+
+    // -------------------------------------------------------------
+    class Continue : public CodeNode {
+    public:
+        struct Except {};
+
+    public:
+        Continue() : signal_(false) {}
+        virtual ~Continue() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        bool signal_;
+    };
+
+    // -------------------------------------------------------------
+    class Return : public CodeNode {
+    public:
+        struct Except {
+            Value value;
+        };
+
+    public:
+        Return(CodeNode::SharedPtr expr);
+        virtual ~Return() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
+        virtual void markTailPosition() override;
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr expr_;
+        bool                signal_;
+    };
+
+    // -------------------------------------------------------------
+    // Suspends the generator running it, a statement of generator bodies.
+    class Yield : public CodeNode {
+    public:
+        Yield(CodeNode::SharedPtr expr);
+        virtual ~Yield() {}
+
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+        virtual bool yields() const override { return true; }
+        virtual Routine generate(Environment::SharedPtr env) const override;
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr expr_;
     };
 
     // -------------------------------------------------------------
     class Loop : public CodeNode {
     public:
-        Loop(CodeNode::SharedPtr decl, CodeNode::SharedPtr cond, CodeNode::SharedPtr next, CodeNode::SharedPtr body);
-        Loop(CodeNode::SharedPtr cond, CodeNode::SharedPtr body);
+        Loop(CodeNode::SharedPtr decl, CodeNode::SharedPtr cond, CodeNode::SharedPtr next, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
+        Loop(CodeNode::SharedPtr cond, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~Loop() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
+        virtual bool yields() const override { return body_ && body_->yields(); }
+        virtual Routine generate(Environment::SharedPtr env) const override;
         
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
         
     private:
-        CodeNode::SharedPtr decl_;
-        CodeNode::SharedPtr cond_;
-        CodeNode::SharedPtr next_;
-        CodeNode::SharedPtr body_;
+        CodeNode::SharedPtr    decl_;
+        CodeNode::SharedPtr    cond_;
+        CodeNode::SharedPtr    next_;
+        CodeNode::SharedPtr    body_;
+        ScopeLayout::SharedPtr layout_;
     };
 
     // -------------------------------------------------------------
     class While : public CodeNode {
     public:
-        While(CodeNode::SharedPtr cond, CodeNode::SharedPtr body);
+        While(CodeNode::SharedPtr cond, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~While() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
+        virtual bool yields() const override { return body_ && body_->yields(); }
+        virtual Routine generate(Environment::SharedPtr env) const override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
     private:
-        CodeNode::SharedPtr cond_;
-        CodeNode::SharedPtr body_;
+        CodeNode::SharedPtr    cond_;
+        CodeNode::SharedPtr    body_;
+        ScopeLayout::SharedPtr layout_;
     };
 
     // -------------------------------------------------------------
     class Foreach : public CodeNode {
     public:
-        Foreach(const std::string &name, CodeNode::SharedPtr container, CodeNode::SharedPtr body);
+        Foreach(const std::string &name, CodeNode::SharedPtr container, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~Foreach() {}
 
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+        virtual void propagateSignals(ControlSignal::Mask signals) override;
+        virtual bool yields() const override { return body_ && body_->yields(); }
+        virtual Routine generate(Environment::SharedPtr env) const override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
@@ -434,24 +681,56 @@ namespace Ishlang {
         Value implRange(Environment::SharedPtr loopEnv, const IntegerRange &range) const;
         Value implFile(Environment::SharedPtr loopEnv, FileStruct &file) const;
 
+        // Generators and iterators, items drawn until exhausted
+        template <typename Source>
+        Value implNext(Environment::SharedPtr loopEnv, const Source &source) const;
+
+        inline void setItem(Environment &loopEnv, const Value &item) const;
+
     private:
-        IdenType            iden_;
-        CodeNode::SharedPtr container_;
-        CodeNode::SharedPtr body_;
+        IdenType               iden_;
+        VarAddress             address_;
+        CodeNode::SharedPtr    container_;
+        CodeNode::SharedPtr    body_;
+        ScopeLayout::SharedPtr layout_;
+        mutable TypeFeedback   feedback_;
     };
 
     // -------------------------------------------------------------
     class LambdaExpr : public CodeNode {
     public:
-        LambdaExpr(const ParamList &params, CodeNode::SharedPtr body);
+        LambdaExpr(const ParamList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~LambdaExpr() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
     protected:
+        // Generator bodies run statement by statement, their calls are
+        // not left in tail position.
+        LambdaExpr(const ParamList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout, bool tailCalls);
+
         virtual Value exec(Environment::SharedPtr env) const override;
 
-    private:
-        ParamList           params_;
-        CodeNode::SharedPtr body_;
+    protected:
+        ScopeLayout::IdenList  params_;
+        CodeNode::SharedPtr    body_;
+        ScopeLayout::SharedPtr layout_;
+    };
+
+    // -------------------------------------------------------------
+    // Closure returning a generator over its body when called.
+    class GeneratorExpr : public LambdaExpr {
+    public:
+        GeneratorExpr(const ParamList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
+        virtual ~GeneratorExpr() {}
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual void dump(std::ostream &out) const override;
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
     };
 
     // -------------------------------------------------------------
@@ -460,28 +739,42 @@ namespace Ishlang {
         LambdaApp(CodeNode::SharedPtr closure, SharedPtrList args);
         virtual ~LambdaApp() {}
 
+        virtual void markTailPosition() override { tail_ = true; }
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
+        Value call(Environment::SharedPtr env, const Value &closure) const;
+
     private:
         CodeNode::SharedPtr closure_;
-        SharedPtrList       argExprs_;
 
     protected:
-        mutable Value closureVar_;
+        SharedPtrList       argExprs_;
+        bool                tail_;
     };
 
     // -------------------------------------------------------------
     class FunctionExpr : public LambdaExpr {
     public:
-        FunctionExpr(const std::string &name, const ParamList &params, CodeNode::SharedPtr body);
+        FunctionExpr(const std::string &name, const ParamList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~FunctionExpr() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
+        IdenType iden() const noexcept { return iden_; }
+        VarAddress &address() noexcept { return address_; }
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
     private:
-        IdenType iden_;
+        IdenType   iden_;
+        VarAddress address_;
     };
 
     // -------------------------------------------------------------
@@ -490,11 +783,74 @@ namespace Ishlang {
         FunctionApp(const std::string &name, SharedPtrList args);
         virtual ~FunctionApp() {}
 
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const override;
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
+        IdenType iden() const noexcept { return iden_; }
+        VarAddress &address() noexcept { return address_; }
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
     private:
-        IdenType iden_;
+        IdenType   iden_;
+        VarAddress address_;
+    };
+
+    // -------------------------------------------------------------
+    // Parameter of a function inlined by the optimizer, reads the argument
+    // evaluated by the inlined call.
+    class InlineParam : public CodeNode {
+    public:
+        // Arguments read by the parameters of an inlined body, set while
+        // the body evaluates.
+        class Scope {
+        public:
+            explicit Scope(std::span<const Value> args) : outer_(std::exchange(args_, args)) {}
+            ~Scope() { args_ = outer_; }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            std::span<const Value> outer_;
+        };
+
+    public:
+        InlineParam(IdenType iden, std::size_t index) : CodeNode(), iden_(iden), index_(index) {}
+        virtual ~InlineParam() {}
+
+        virtual void dump(std::ostream &out) const override;
+
+    protected:
+        virtual Value exec(Environment::SharedPtr /*env*/) const override { return args_[index_]; }
+
+    private:
+        static constinit inline thread_local std::span<const Value> args_;
+
+        IdenType    iden_;
+        std::size_t index_;
+    };
+
+    // -------------------------------------------------------------
+    // Call to a small function defined at the top level, made by the
+    // optimizer. The function body is evaluated in place of the call while
+    // the name still holds the function, calls are made as usual otherwise.
+    class InlinedCall : public FunctionApp {
+    public:
+        InlinedCall(const FunctionApp &call, CodeNode::SharedPtr callee, CodeNode::SharedPtr body);
+        virtual ~InlinedCall() {}
+
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr callee_;
+        CodeNode::SharedPtr body_;
     };
 
     // -------------------------------------------------------------
@@ -503,6 +859,9 @@ namespace Ishlang {
         Print(bool newline, CodeNode::SharedPtrList exprs);
         virtual ~Print() {}
 
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+        virtual void dump(std::ostream &out) const override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
@@ -571,11 +930,12 @@ namespace Ishlang {
         virtual Value exec(Environment::SharedPtr env) const override;
 
     private:
-        Instance::InitArgs makeInitArgs(Environment::SharedPtr &env) const;
+        using SlotHints = std::vector<Struct::SlotHint>;
 
     private:
-        IdenType       iden_;
-        NameSharedPtrs initList_;
+        IdenType          iden_;
+        NameSharedPtrs    initList_;
+        mutable SlotHints slotHints_;
     };
 
     // -------------------------------------------------------------
@@ -604,6 +964,7 @@ namespace Ishlang {
     private:
         CodeNode::SharedPtr expr_;
         std::string         name_;
+        mutable Struct::SlotHint slotHint_;
     };
 
     // -------------------------------------------------------------
@@ -619,6 +980,7 @@ namespace Ishlang {
         CodeNode::SharedPtr expr_;
         std::string         name_;
         CodeNode::SharedPtr newValExpr_;
+        mutable Struct::SlotHint slotHint_;
     };
 
     // -------------------------------------------------------------
@@ -922,6 +1284,21 @@ namespace Ishlang {
         CodeNode::SharedPtr val_;
     };
 
+    // -------------------------------------------------------------
+    class ArrayBinarySearch : public CodeNode {
+    public:
+        ArrayBinarySearch(CodeNode::SharedPtr arr, CodeNode::SharedPtr val, CodeNode::SharedPtr descending);
+        virtual ~ArrayBinarySearch() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr arr_;
+        CodeNode::SharedPtr val_;
+        CodeNode::SharedPtr desc_;
+    };
+
     // -------------------------------------------------------------
     class ArraySort : public CodeNode {
     public:
@@ -1315,6 +1692,44 @@ namespace Ishlang {
     using OrderedMapItems = MapItemsImpl<OrderedTable>;
     using OrderedMapReverseItems = MapItemsImpl<OrderedTable, ReverseOrder>;
 
+    // -------------------------------------------------------------
+    class OrderedMapNearest : public CodeNode {
+    public:
+        enum Type {
+            Floor   = 'f',
+            Ceiling = 'c',
+            Lower   = 'l',
+            Higher  = 'h',
+        };
+
+    public:
+        OrderedMapNearest(Type type, CodeNode::SharedPtr tblExpr, CodeNode::SharedPtr keyExpr);
+        virtual ~OrderedMapNearest() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        Type                type_;
+        CodeNode::SharedPtr tblExpr_;
+        CodeNode::SharedPtr keyExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class OrderedMapRange : public CodeNode {
+    public:
+        OrderedMapRange(CodeNode::SharedPtr tblExpr, CodeNode::SharedPtr loExpr, CodeNode::SharedPtr hiExpr);
+        virtual ~OrderedMapRange() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr tblExpr_;
+        CodeNode::SharedPtr loExpr_;
+        CodeNode::SharedPtr hiExpr_;
+    };
+
     // -------------------------------------------------------------
     class MakePair : public CodeNode {
     public:
@@ -1417,6 +1832,160 @@ namespace Ishlang {
         virtual ~RangeLen() {}
     };
 
+    // -------------------------------------------------------------
+    class MakeNdArray : public CodeNode {
+    public:
+        MakeNdArray(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtr shapeExpr);
+        virtual ~MakeNdArray() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr arrExpr_;
+        CodeNode::SharedPtr shapeExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArrayFill : public CodeNode {
+    public:
+        NdArrayFill(CodeNode::SharedPtr shapeExpr, CodeNode::SharedPtr fillExpr);
+        virtual ~NdArrayFill() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr shapeExpr_;
+        CodeNode::SharedPtr fillExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArrayShape : public CodeNode {
+    public:
+        NdArrayShape(CodeNode::SharedPtr arrExpr);
+        virtual ~NdArrayShape() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr arrExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArrayReshape : public CodeNode {
+    public:
+        NdArrayReshape(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtr shapeExpr);
+        virtual ~NdArrayReshape() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr arrExpr_;
+        CodeNode::SharedPtr shapeExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArrayTranspose : public CodeNode {
+    public:
+        NdArrayTranspose(CodeNode::SharedPtr arrExpr);
+        virtual ~NdArrayTranspose() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr arrExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArraySlice : public CodeNode {
+    public:
+        NdArraySlice(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtr axisExpr, CodeNode::SharedPtr beginExpr, CodeNode::SharedPtr endExpr);
+        virtual ~NdArraySlice() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr arrExpr_;
+        CodeNode::SharedPtr axisExpr_;
+        CodeNode::SharedPtr beginExpr_;
+        CodeNode::SharedPtr endExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArrayGet : public CodeNode {
+    public:
+        NdArrayGet(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtrList indexExprs);
+        virtual ~NdArrayGet() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr     arrExpr_;
+        CodeNode::SharedPtrList indexExprs_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArraySet : public CodeNode {
+    public:
+        NdArraySet(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtrList indexExprs, CodeNode::SharedPtr valueExpr);
+        virtual ~NdArraySet() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr     arrExpr_;
+        CodeNode::SharedPtrList indexExprs_;
+        CodeNode::SharedPtr     valueExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArrayMatMul : public CodeNode {
+    public:
+        NdArrayMatMul(CodeNode::SharedPtr lhsExpr, CodeNode::SharedPtr rhsExpr);
+        virtual ~NdArrayMatMul() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr lhsExpr_;
+        CodeNode::SharedPtr rhsExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArraySum : public CodeNode {
+    public:
+        NdArraySum(CodeNode::SharedPtr arrExpr, CodeNode::SharedPtr axisExpr);
+        virtual ~NdArraySum() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr arrExpr_;
+        CodeNode::SharedPtr axisExpr_;
+    };
+
+    // -------------------------------------------------------------
+    class NdArrayToArray : public CodeNode {
+    public:
+        NdArrayToArray(CodeNode::SharedPtr arrExpr);
+        virtual ~NdArrayToArray() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr arrExpr_;
+    };
+
     // -------------------------------------------------------------
     // Expand
     class Expand : public CodeNode {
@@ -1431,6 +2000,103 @@ namespace Ishlang {
         CodeNode::SharedPtrList exprs_;
     };
 
+    // -------------------------------------------------------------
+    // Iterator adapters are lazy, items are drawn through the whole
+    // chain one at a time by the consumer
+    class MakeIterator : public CodeNode {
+    public:
+        MakeIterator(CodeNode::SharedPtr obj);
+        virtual ~MakeIterator() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+    };
+
+    // -------------------------------------------------------------
+    class IteratorMap : public CodeNode {
+    public:
+        IteratorMap(CodeNode::SharedPtr obj, CodeNode::SharedPtr ftn);
+        virtual ~IteratorMap() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+        CodeNode::SharedPtr ftn_;
+    };
+
+    // -------------------------------------------------------------
+    class IteratorFilter : public CodeNode {
+    public:
+        IteratorFilter(CodeNode::SharedPtr obj, CodeNode::SharedPtr pred);
+        virtual ~IteratorFilter() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+        CodeNode::SharedPtr pred_;
+    };
+
+    // -------------------------------------------------------------
+    class IteratorTake : public CodeNode {
+    public:
+        IteratorTake(CodeNode::SharedPtr obj, CodeNode::SharedPtr count);
+        virtual ~IteratorTake() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+        CodeNode::SharedPtr count_;
+    };
+
+    // -------------------------------------------------------------
+    class IteratorZip : public CodeNode {
+    public:
+        IteratorZip(CodeNode::SharedPtr first, CodeNode::SharedPtr second);
+        virtual ~IteratorZip() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr first_;
+        CodeNode::SharedPtr second_;
+    };
+
+    // -------------------------------------------------------------
+    class IteratorEnumerate : public CodeNode {
+    public:
+        IteratorEnumerate(CodeNode::SharedPtr obj);
+        virtual ~IteratorEnumerate() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+    };
+
+    // -------------------------------------------------------------
+    class IteratorCollect : public CodeNode {
+    public:
+        IteratorCollect(CodeNode::SharedPtr obj);
+        virtual ~IteratorCollect() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+    };
+
     // -------------------------------------------------------------
     class GenericLen : public CodeNode {
     public:
@@ -1442,6 +2108,7 @@ namespace Ishlang {
 
     private:
         CodeNode::SharedPtr object_;
+        mutable TypeFeedback feedback_;
     };
 
     // -------------------------------------------------------------
@@ -1470,6 +2137,8 @@ namespace Ishlang {
         CodeNode::SharedPtr object_;
         CodeNode::SharedPtr key_;
         CodeNode::SharedPtr defaultRet_;
+        mutable Struct::SlotHint slotHint_;
+        mutable TypeFeedback feedback_;
     };
 
     // -------------------------------------------------------------
@@ -1485,6 +2154,8 @@ namespace Ishlang {
         CodeNode::SharedPtr object_;
         CodeNode::SharedPtr key_;
         CodeNode::SharedPtr value_;
+        mutable Struct::SlotHint slotHint_;
+        mutable TypeFeedback feedback_;
     };
 
     // -------------------------------------------------------------
@@ -1583,19 +2254,155 @@ namespace Ishlang {
         CodeNode::SharedPtr args_;
     };
 
+    // -------------------------------------------------------------
+    class GenericMap : public CodeNode {
+    public:
+        GenericMap(CodeNode::SharedPtr obj, CodeNode::SharedPtr ftn, bool parallel = false);
+        virtual ~GenericMap() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+        CodeNode::SharedPtr ftn_;
+        bool                parallel_;
+    };
+
+    // -------------------------------------------------------------
+    class GenericFilter : public CodeNode {
+    public:
+        GenericFilter(CodeNode::SharedPtr obj, CodeNode::SharedPtr pred, bool parallel = false);
+        virtual ~GenericFilter() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+        CodeNode::SharedPtr pred_;
+        bool                parallel_;
+    };
+
+    // -------------------------------------------------------------
+    class GenericReduce : public CodeNode {
+    public:
+        GenericReduce(CodeNode::SharedPtr obj, CodeNode::SharedPtr init, CodeNode::SharedPtr ftn, bool parallel = false);
+        virtual ~GenericReduce() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+        CodeNode::SharedPtr init_;
+        CodeNode::SharedPtr ftn_;
+        bool                parallel_;
+    };
+
+    // -------------------------------------------------------------
+    class GenericAll : public CodeNode {
+    public:
+        GenericAll(CodeNode::SharedPtr obj, CodeNode::SharedPtr pred);
+        virtual ~GenericAll() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+        CodeNode::SharedPtr pred_;
+    };
+
+    // -------------------------------------------------------------
+    class GenericAny : public CodeNode {
+    public:
+        GenericAny(CodeNode::SharedPtr obj, CodeNode::SharedPtr pred);
+        virtual ~GenericAny() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr obj_;
+        CodeNode::SharedPtr pred_;
+    };
+
     // -------------------------------------------------------------
     class TimeIt : public CodeNode {
     public:
-        TimeIt(CodeNode::SharedPtr expr, CodeNode::SharedPtr ntimes = CodeNode::SharedPtr(), CodeNode::SharedPtr showSummary = CodeNode::SharedPtr());
+        TimeIt(CodeNode::SharedPtr expr,
+               CodeNode::SharedPtr ntimes = CodeNode::SharedPtr(),
+               CodeNode::SharedPtr showSummary = CodeNode::SharedPtr(),
+               ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~TimeIt() {}
 
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
     private:
-        CodeNode::SharedPtr expr_;
-        CodeNode::SharedPtr count_;
-        CodeNode::SharedPtr summary_;
+        CodeNode::SharedPtr    expr_;
+        CodeNode::SharedPtr    count_;
+        CodeNode::SharedPtr    summary_;
+        ScopeLayout::SharedPtr layout_;
+    };
+
+    // -------------------------------------------------------------
+    class Spawn : public CodeNode {
+    public:
+        Spawn(CodeNode::SharedPtr expr, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
+        virtual ~Spawn() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr    expr_;
+        ScopeLayout::SharedPtr layout_;
+    };
+
+    // -------------------------------------------------------------
+    class Await : public CodeNode {
+    public:
+        Await(CodeNode::SharedPtr future);
+        virtual ~Await() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr future_;
+    };
+
+    // -------------------------------------------------------------
+    class AwaitAll : public CodeNode {
+    public:
+        AwaitAll(CodeNode::SharedPtr futures);
+        virtual ~AwaitAll() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr futures_;
+    };
+
+    // -------------------------------------------------------------
+    class GarbageCollect : public CodeNode {
+    public:
+        GarbageCollect();
+        virtual ~GarbageCollect() {}
+
+        virtual Value exec(Environment::SharedPtr env) const override;
+    };
+
+    // -------------------------------------------------------------
+    class GarbageStats : public CodeNode {
+    public:
+        GarbageStats();
+        virtual ~GarbageStats() {}
+
+        virtual Value exec(Environment::SharedPtr env) const override;
     };
 
     // -------------------------------------------------------------
@@ -1681,6 +2488,16 @@ namespace Ishlang {
         virtual Value exec(Environment::SharedPtr env) const override;
     };
 
+    // -------------------------------------------------------------
+    class FileReadAll : public FileOp {
+    public:
+        FileReadAll(CodeNode::SharedPtr file);
+        virtual ~FileReadAll() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+    };
+
     // -------------------------------------------------------------
     class FileWrite : public FileOp {
     public:
@@ -1727,18 +2544,53 @@ namespace Ishlang {
         virtual Value exec(Environment::SharedPtr env) const override;
     };
 
+    // -------------------------------------------------------------
+    class CsvOpen : public FileOp {
+    public:
+        CsvOpen(CodeNode::SharedPtr filename, CodeNode::SharedPtr delimiter = CodeNode::SharedPtr());
+        virtual ~CsvOpen() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        CodeNode::SharedPtr delimiter_;
+    };
+
+    // -------------------------------------------------------------
+    class CsvRead : public FileOp {
+    public:
+        enum Type {
+            Row,
+            Rows,
+            Columns
+        };
+
+    public:
+        CsvRead(Type type, CodeNode::SharedPtr file, CodeNode::SharedPtr delimiter = CodeNode::SharedPtr());
+        virtual ~CsvRead() {}
+
+    protected:
+        virtual Value exec(Environment::SharedPtr env) const override;
+
+    private:
+        Type                type_;
+        CodeNode::SharedPtr delimiter_;
+    };
+
     // -------------------------------------------------------------
     class WithFile : public FileOp {
     public:
-        WithFile(const std::string &name, CodeNode::SharedPtr file, CodeNode::SharedPtr body);
+        WithFile(const std::string &name, CodeNode::SharedPtr file, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
         virtual ~WithFile() {}
 
     protected:
         virtual Value exec(Environment::SharedPtr env) const override;
 
     private:
-        IdenType            iden_;
-        CodeNode::SharedPtr body_;
+        IdenType               iden_;
+        CodeNode::SharedPtr    body_;
+        ScopeLayout::SharedPtr layout_;
     };
 
     // -------------------------------------------------------------
@@ -1,15 +1,46 @@
 #ifndef ISHLANG_CODE_NODE_BASES_H
 #define ISHLANG_CODE_NODE_BASES_H
 
+#include "byte_code.h"
 #include "environment.h"
+#include "routine.h"
 
 #include <memory>
 #include <optional>
+#include <ostream>
 #include <string>
 #include <vector>
 
 namespace Ishlang {
 
+    class Compiler;
+    class Optimizer;
+
+    // -------------------------------------------------------------
+    // Break, continue or return pending in the current thread. Nodes in
+    // statement position of a loop or function body report these exits
+    // here instead of throwing, sequencing nodes stop at a pending signal
+    // and the enclosing loop or function consumes it.
+    class ControlSignal {
+    public:
+        enum Type : unsigned {
+            None     = 0,
+            Break    = 1,
+            Continue = 2,
+            Return   = 4
+        };
+
+        using Mask = unsigned;
+
+    public:
+        static Type pending() noexcept { return pending_; }
+        static void raise(Type signal) noexcept { pending_ = signal; }
+        static void clear() noexcept { pending_ = None; }
+
+    private:
+        static constinit inline thread_local Type pending_ = None;
+    };
+
     // -------------------------------------------------------------
     class CodeNode {
     public:
@@ -46,6 +77,52 @@ namespace Ishlang {
             return Empty;
         }
 
+        virtual bool isLiteral() const {
+            return false;
+        }
+
+        virtual const Value &literalValue() const {
+            return Value::Null;
+        }
+
+        virtual void compile(Compiler &compiler, ByteCode::Register dst) const;
+
+        // Called by the optimizer, optimizes the subtrees held in place and
+        // returns a replacement for the node, or null to keep it.
+        virtual SharedPtr optimize(Optimizer &optimizer);
+
+        // Copy of the node for inlining at a call site, with parameters read
+        // from the arguments of the call. Null for nodes not inlined.
+        virtual SharedPtr inlineCopy(Optimizer &optimizer) const;
+
+        // Prints the node as an expression, nodes without their own form
+        // print their class name.
+        virtual void dump(std::ostream &out) const;
+
+        // Called by loops and functions on the nodes in statement position
+        // of their body, with the signals these nodes may report.
+        virtual void propagateSignals(ControlSignal::Mask /*signals*/) {}
+
+        // Called by functions on the node in tail position of their body,
+        // nodes whose value is that of a subexpression pass it on. Calls in
+        // tail position are deferred to the calling lambda.
+        virtual void markTailPosition() {}
+
+        // Called by nodes that only read the value of an operand, literals
+        // then hand out their immutable storage instead of a fresh copy.
+        virtual void markReadOnly() {}
+
+        // True for yield and for statements holding a yield in statement
+        // position. Generator bodies run these through generate, other
+        // statements are evaluated.
+        virtual bool yields() const {
+            return false;
+        }
+
+        // Runs the node as a statement of a generator body, suspending at
+        // each value yielded. Evaluates the node by default.
+        virtual Routine generate(Environment::SharedPtr env) const;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const = 0;
     };
@@ -60,6 +137,8 @@ namespace Ishlang {
 
         virtual ~UnaryOp() {}
 
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override = 0;
 
@@ -78,6 +157,8 @@ namespace Ishlang {
 
         virtual ~BinaryOp() {}
 
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override = 0;
 
@@ -96,6 +177,8 @@ namespace Ishlang {
 
         virtual ~VariadicOp() {}
 
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override = 0;
 
@@ -113,6 +196,8 @@ namespace Ishlang {
 
         virtual ~FileOp() {}
 
+        virtual CodeNode::SharedPtr optimize(Optimizer &optimizer) override;
+
     protected:
         virtual Value exec(Environment::SharedPtr env) const override = 0;
 
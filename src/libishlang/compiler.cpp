@@ -0,0 +1,488 @@
+#include "compiler.h"
+#include "code_node.h"
+#include "code_node_util.h"
+#include "exception.h"
+
+#include <cassert>
+#include <limits>
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+//                          COMPILER
+// -------------------------------------------------------------
+
+// -------------------------------------------------------------
+Compiler::Compiler(CodeNode::SharedPtr root)
+    : code_(std::make_shared<ByteCode>(root))
+    , topRegister_(0)
+    , envDepth_(0)
+    , envPushed_()
+    , loops_()
+{}
+
+// -------------------------------------------------------------
+ByteCode::SharedPtr Compiler::compile(CodeNode::SharedPtr code) {
+    Compiler compiler(code);
+    const auto result = compiler.allocRegister();
+    if (code) {
+        compiler.compileNode(*code, result);
+    }
+    else {
+        compiler.emit(ByteCode::LoadNull, result);
+    }
+    return compiler.finish(result);
+}
+
+// -------------------------------------------------------------
+ByteCode::SharedPtr Compiler::finish(Register result) {
+    assert(envDepth_ == 0);
+    assert(loops_.empty());
+    emit(ByteCode::Return, result);
+    return code_;
+}
+
+// -------------------------------------------------------------
+void Compiler::compileNode(const CodeNode &node, Register dst) {
+    node.compile(*this, dst);
+}
+
+// -------------------------------------------------------------
+void Compiler::compileEval(const CodeNode &node, Register dst) {
+    const auto index = code_->nodes_.size();
+    code_->nodes_.push_back(&node);
+    emit(ByteCode::Eval, dst, static_cast<std::uint32_t>(index));
+}
+
+// -------------------------------------------------------------
+auto Compiler::allocRegister() -> Register {
+    return allocRegisters(1);
+}
+
+// -------------------------------------------------------------
+auto Compiler::allocRegisters(std::size_t count) -> Register {
+    const auto first = topRegister_;
+    topRegister_ += static_cast<Register>(count);
+    if (topRegister_ > code_->numRegisters_) {
+        code_->numRegisters_ = topRegister_;
+    }
+    return first;
+}
+
+// -------------------------------------------------------------
+std::size_t Compiler::emit(OpCode op, Register a, std::uint32_t b, std::uint32_t c, std::uint8_t sub) {
+    code_->code_.push_back(ByteCode::Instruction{op, sub, a, b, c});
+    return code_->code_.size() - 1;
+}
+
+// -------------------------------------------------------------
+std::size_t Compiler::emitJump(OpCode op, Register a, std::uint8_t sub) {
+    return emit(op, a, std::numeric_limits<std::uint32_t>::max(), 0, sub);
+}
+
+// -------------------------------------------------------------
+void Compiler::patchJump(std::size_t at) {
+    patchJump(at, here());
+}
+
+// -------------------------------------------------------------
+void Compiler::patchJump(std::size_t at, std::size_t target) {
+    code_->code_[at].b = static_cast<std::uint32_t>(target);
+}
+
+// -------------------------------------------------------------
+std::uint32_t Compiler::addConstant(const Value &value) {
+    code_->constants_.push_back(value);
+    return static_cast<std::uint32_t>(code_->constants_.size() - 1);
+}
+
+// -------------------------------------------------------------
+std::uint32_t Compiler::addIden(IdenType iden) {
+    auto &idens = code_->idens_;
+    for (std::size_t i = 0; i < idens.size(); ++i) {
+        if (idens[i] == iden) { return static_cast<std::uint32_t>(i); }
+    }
+    idens.push_back(iden);
+    return static_cast<std::uint32_t>(idens.size() - 1);
+}
+
+// -------------------------------------------------------------
+std::uint32_t Compiler::addProto(const ByteCode::IdenList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout) {
+    code_->protos_.push_back(ByteCode::Proto{params, body, layout, compile(body)});
+    return static_cast<std::uint32_t>(code_->protos_.size() - 1);
+}
+
+// -------------------------------------------------------------
+std::uint32_t Compiler::addLayout(ScopeLayout::SharedPtr layout) {
+    code_->layouts_.push_back(layout);
+    return static_cast<std::uint32_t>(code_->layouts_.size() - 1);
+}
+
+// -------------------------------------------------------------
+void Compiler::pushEnv(const ScopeLayout::SharedPtr &layout) {
+    // Elided scopes keep evaluating in the enclosing environment, the
+    // frames pushed here must match the ones the parser resolved against.
+    const bool push = !ScopeLayout::elides(layout);
+    if (push) {
+        emit(ByteCode::PushEnv, 0, addLayout(layout));
+        ++envDepth_;
+    }
+    envPushed_.push_back(push);
+}
+
+// -------------------------------------------------------------
+void Compiler::popEnv() {
+    assert(!envPushed_.empty());
+    if (envPushed_.back()) {
+        assert(envDepth_ > 0);
+        emit(ByteCode::PopEnv);
+        --envDepth_;
+    }
+    envPushed_.pop_back();
+}
+
+// -------------------------------------------------------------
+void Compiler::beginLoop() {
+    // The handler resumes break and continue raised by nodes left to the tree walker
+    const auto handler = emitJump(ByteCode::PushHandler);
+    loops_.push_back(LoopContext{envDepth_, handler, {}, {}});
+}
+
+// -------------------------------------------------------------
+void Compiler::endLoop(std::size_t breakTarget, std::size_t continueTarget) {
+    assert(!loops_.empty());
+    const auto &loop = loops_.back();
+    patchJump(loop.handler, breakTarget);
+    code_->code_[loop.handler].c = static_cast<std::uint32_t>(continueTarget);
+    for (auto jump : loop.breakJumps) {
+        patchJump(jump, breakTarget);
+    }
+    for (auto jump : loop.continueJumps) {
+        patchJump(jump, continueTarget);
+    }
+    loops_.pop_back();
+    emit(ByteCode::PopHandler);
+}
+
+// -------------------------------------------------------------
+void Compiler::emitBreak() {
+    emitLoopExit(&LoopContext::breakJumps);
+}
+
+// -------------------------------------------------------------
+void Compiler::emitContinue() {
+    emitLoopExit(&LoopContext::continueJumps);
+}
+
+// -------------------------------------------------------------
+void Compiler::emitLoopExit(std::vector<std::size_t> LoopContext::*jumps) {
+    assert(!loops_.empty());
+    auto &loop = loops_.back();
+    for (auto depth = envDepth_; depth > loop.envDepth; --depth) {
+        emit(ByteCode::PopEnv);
+    }
+    (loop.*jumps).push_back(emitJump(ByteCode::Jump));
+}
+
+// -------------------------------------------------------------
+//                      NODE LOWERING
+// -------------------------------------------------------------
+
+// -------------------------------------------------------------
+void CodeNode::compile(Compiler &compiler, ByteCode::Register dst) const {
+    compiler.compileEval(*this, dst);
+}
+
+// -------------------------------------------------------------
+void Literal::compile(Compiler &compiler, ByteCode::Register dst) const {
+    const bool scalar = anyOfType(value_.type(), Value::eNone, Value::eInteger, Value::eReal, Value::eCharacter, Value::eBoolean);
+    const auto op = scalar || readOnly_ ? ByteCode::LoadConst : ByteCode::LoadLiteral;
+    compiler.emit(op, dst, compiler.addConstant(value_));
+}
+
+// -------------------------------------------------------------
+void Variable::compile(Compiler &compiler, ByteCode::Register dst) const {
+    compiler.emit(ByteCode::GetVar, dst, compiler.addIden(iden_));
+}
+
+// -------------------------------------------------------------
+void Define::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (code_) { compiler.compileNode(*code_, dst); }
+    else       { compiler.emit(ByteCode::LoadNull, dst); }
+    compiler.emit(ByteCode::DefVar, dst, compiler.addIden(iden_));
+}
+
+// -------------------------------------------------------------
+void Assign::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (code_) { compiler.compileNode(*code_, dst); }
+    else       { compiler.emit(ByteCode::LoadNull, dst); }
+    compiler.emit(ByteCode::SetVar, dst, compiler.addIden(iden_));
+}
+
+// -------------------------------------------------------------
+void ArithOp::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (operands_.empty()) {
+        compiler.emit(ByteCode::LoadConst, dst, compiler.addConstant(Value::Zero));
+        return;
+    }
+
+    const auto mark = compiler.topRegister();
+    const auto base = compiler.allocRegisters(operands_.size());
+    for (std::size_t i = 0; i < operands_.size(); ++i) {
+        const auto reg = base + static_cast<ByteCode::Register>(i);
+        compiler.compileNode(*operands_[i], reg);
+        compiler.emit(ByteCode::CheckArith, reg);
+    }
+    compiler.emit(ByteCode::Arith, dst, base, static_cast<std::uint32_t>(operands_.size()), static_cast<std::uint8_t>(type_));
+    compiler.freeRegisters(mark);
+}
+
+// -------------------------------------------------------------
+void ArithAssignOp::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (delta_) {
+        const auto iden = compiler.addIden(iden_);
+        compiler.emit(ByteCode::CheckNumVar, 0, iden);
+        compiler.compileNode(*delta_, dst);
+        compiler.emit(ByteCode::CheckNumber, dst);
+        compiler.emit(ByteCode::ArithAssign, dst, iden, 0, static_cast<std::uint8_t>(type_));
+    }
+    else {
+        compiler.emit(ByteCode::LoadNull, dst);
+    }
+}
+
+// -------------------------------------------------------------
+void CompOp::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (lhs_ && rhs_) {
+        const auto mark = compiler.topRegister();
+        const auto rhs = compiler.allocRegister();
+        compiler.compileNode(*lhs_, dst);
+        compiler.compileNode(*rhs_, rhs);
+        compiler.emit(ByteCode::Compare, dst, dst, rhs, static_cast<std::uint8_t>(type_));
+        compiler.freeRegisters(mark);
+    }
+    else {
+        compiler.emit(ByteCode::LoadBool, dst, 0, 0, false);
+    }
+}
+
+// -------------------------------------------------------------
+void LogicOp::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (operands_.empty()) {
+        compiler.emit(ByteCode::LoadBool, dst, 0, 0, false);
+        return;
+    }
+
+    const bool conjunction = type_ == Conjunction;
+    const auto shortCircuit = conjunction ? ByteCode::JumpIfFalse : ByteCode::JumpIfTrue;
+
+    std::vector<std::size_t> exits;
+    for (const auto &operand : operands_) {
+        compiler.compileNode(*operand, dst);
+        exits.push_back(compiler.emitJump(shortCircuit, dst, ByteCode::OperandCheck));
+    }
+    compiler.emit(ByteCode::LoadBool, dst, 0, 0, conjunction);
+    const auto end = compiler.emitJump(ByteCode::Jump);
+    for (auto exit : exits) { compiler.patchJump(exit); }
+    compiler.emit(ByteCode::LoadBool, dst, 0, 0, !conjunction);
+    compiler.patchJump(end);
+}
+
+// -------------------------------------------------------------
+void Not::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (operand_) {
+        compiler.compileNode(*operand_, dst);
+        compiler.emit(ByteCode::Not, dst, dst);
+    }
+    else {
+        compiler.emit(ByteCode::LoadBool, dst, 0, 0, false);
+    }
+}
+
+// -------------------------------------------------------------
+void NegativeOf::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (operand_) {
+        compiler.compileNode(*operand_, dst);
+        compiler.emit(ByteCode::Negate, dst, dst);
+    }
+    else {
+        compiler.emit(ByteCode::LoadNull, dst);
+    }
+}
+
+// -------------------------------------------------------------
+void ProgN::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (exprs_.empty()) {
+        compiler.emit(ByteCode::LoadNull, dst);
+    }
+    for (const auto &expr : exprs_) {
+        compiler.compileNode(*expr, dst);
+    }
+}
+
+// -------------------------------------------------------------
+void Block::compile(Compiler &compiler, ByteCode::Register dst) const {
+    compiler.pushEnv(layout_);
+    ProgN::compile(compiler, dst);
+    compiler.popEnv();
+}
+
+// -------------------------------------------------------------
+void If::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (!pred_) {
+        compiler.emit(ByteCode::LoadNull, dst);
+        return;
+    }
+
+    compiler.pushEnv(layout_);
+    compiler.compileNode(*pred_, dst);
+    const auto toElse = compiler.emitJump(ByteCode::JumpIfFalse, dst, ByteCode::ExpressionCheck);
+    if (tCode_) { compiler.compileNode(*tCode_, dst); }
+    else        { compiler.emit(ByteCode::LoadNull, dst); }
+    const auto toEnd = compiler.emitJump(ByteCode::Jump);
+    compiler.patchJump(toElse);
+    if (fCode_) { compiler.compileNode(*fCode_, dst); }
+    else        { compiler.emit(ByteCode::LoadNull, dst); }
+    compiler.patchJump(toEnd);
+    compiler.popEnv();
+}
+
+// -------------------------------------------------------------
+void Cond::compile(Compiler &compiler, ByteCode::Register dst) const {
+    std::vector<std::size_t> toEnd;
+    for (const auto &[pred, code] : cases_) {
+        if (!pred) { throw InvalidExpression("Null condition"); }
+
+        compiler.compileNode(*pred, dst);
+        const auto toNext = compiler.emitJump(ByteCode::JumpIfFalse, dst, ByteCode::ExpressionCheck);
+        if (code) { compiler.compileNode(*code, dst); }
+        else      { compiler.emit(ByteCode::LoadNull, dst); }
+        toEnd.push_back(compiler.emitJump(ByteCode::Jump));
+        compiler.patchJump(toNext);
+    }
+    compiler.emit(ByteCode::LoadNull, dst);
+    for (auto jump : toEnd) { compiler.patchJump(jump); }
+}
+
+// -------------------------------------------------------------
+void Break::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (compiler.inLoop()) {
+        compiler.emitBreak();
+    }
+    else {
+        CodeNode::compile(compiler, dst);
+    }
+}
+
+// -------------------------------------------------------------
+void Continue::compile(Compiler &compiler, ByteCode::Register dst) const {
+    if (compiler.inLoop()) {
+        compiler.emitContinue();
+    }
+    else {
+        CodeNode::compile(compiler, dst);
+    }
+}
+
+// -------------------------------------------------------------
+void Return::compile(Compiler &compiler, ByteCode::Register dst) const {
+    // The parser only accepts return inside functions, whose bodies
+    // compile to their own byte code, so returning ends the call.
+    if (expr_) { compiler.compileNode(*expr_, dst); }
+    else       { compiler.emit(ByteCode::LoadNull, dst); }
+    compiler.emit(ByteCode::Return, dst);
+}
+
+// -------------------------------------------------------------
+void Loop::compile(Compiler &compiler, ByteCode::Register dst) const {
+    compiler.emit(ByteCode::LoadNull, dst);
+    if (!cond_ || !body_) { return; }
+
+    const auto mark = compiler.topRegister();
+    const auto cond = compiler.allocRegister();
+
+    compiler.pushEnv(layout_);
+    compiler.beginLoop();
+    if (decl_) { compiler.compileNode(*decl_, cond); }
+
+    const auto top = compiler.here();
+    compiler.compileNode(*cond_, cond);
+    const auto toExit = compiler.emitJump(ByteCode::JumpIfFalse, cond, ByteCode::ExpressionCheck);
+    compiler.compileNode(*body_, dst);
+    const auto toNext = compiler.emitJump(ByteCode::Jump);
+
+    // Continue clears the iteration result before moving on
+    const auto continueTarget = compiler.here();
+    compiler.emit(ByteCode::LoadNull, dst);
+    compiler.patchJump(toNext);
+    if (next_) { compiler.compileNode(*next_, cond); }
+    compiler.patchJump(compiler.emitJump(ByteCode::Jump), top);
+
+    const auto breakTarget = compiler.here();
+    compiler.emit(ByteCode::LoadNull, dst);
+    compiler.patchJump(toExit);
+    compiler.endLoop(breakTarget, continueTarget);
+    compiler.popEnv();
+
+    compiler.freeRegisters(mark);
+}
+
+// -------------------------------------------------------------
+void While::compile(Compiler &compiler, ByteCode::Register dst) const {
+    compiler.emit(ByteCode::LoadNull, dst);
+    if (!cond_ || !body_) { return; }
+
+    const auto mark = compiler.topRegister();
+    const auto cond = compiler.allocRegister();
+
+    compiler.pushEnv(layout_);
+    compiler.beginLoop();
+
+    const auto top = compiler.here();
+    compiler.compileNode(*cond_, cond);
+    const auto toExit = compiler.emitJump(ByteCode::JumpIfFalse, cond, ByteCode::ExpressionCheck);
+    compiler.compileNode(*body_, dst);
+    compiler.patchJump(compiler.emitJump(ByteCode::Jump), top);
+
+    // Continue clears the iteration result before testing the condition
+    const auto continueTarget = compiler.here();
+    compiler.emit(ByteCode::LoadNull, dst);
+    compiler.patchJump(compiler.emitJump(ByteCode::Jump), top);
+
+    const auto breakTarget = compiler.here();
+    compiler.emit(ByteCode::LoadNull, dst);
+    compiler.patchJump(toExit);
+    compiler.endLoop(breakTarget, continueTarget);
+    compiler.popEnv();
+
+    compiler.freeRegisters(mark);
+}
+
+// -------------------------------------------------------------
+void LambdaExpr::compile(Compiler &compiler, ByteCode::Register dst) const {
+    compiler.emit(ByteCode::MakeClosure, dst, compiler.addProto(params_, body_, layout_));
+}
+
+// -------------------------------------------------------------
+void GeneratorExpr::compile(Compiler &compiler, ByteCode::Register dst) const {
+    // Generator bodies suspend at yields, they run on the tree walker
+    compiler.compileEval(*this, dst);
+}
+
+// -------------------------------------------------------------
+void FunctionExpr::compile(Compiler &compiler, ByteCode::Register dst) const {
+    LambdaExpr::compile(compiler, dst);
+    compiler.emit(ByteCode::DefVar, dst, compiler.addIden(iden_));
+}
+
+// -------------------------------------------------------------
+void FunctionApp::compile(Compiler &compiler, ByteCode::Register dst) const {
+    const auto mark = compiler.topRegister();
+    const auto base = compiler.allocRegisters(argExprs_.size() + 1);
+    compiler.emit(ByteCode::GetVar, base, compiler.addIden(iden_));
+    for (std::size_t i = 0; i < argExprs_.size(); ++i) {
+        compiler.compileNode(*argExprs_[i], base + 1 + static_cast<ByteCode::Register>(i));
+    }
+    compiler.emit(tail_ ? ByteCode::TailCall : ByteCode::Call, dst, base, static_cast<std::uint32_t>(argExprs_.size()));
+    compiler.freeRegisters(mark);
+}
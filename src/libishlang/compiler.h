@@ -0,0 +1,96 @@
+#ifndef ISHLANG_COMPILER_H
+#define ISHLANG_COMPILER_H
+
+#include "byte_code.h"
+#include "code_node_bases.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Ishlang {
+
+    // Lowers a CodeNode tree to register based byte code. Nodes lower
+    // themselves through CodeNode::compile, anything without a dedicated
+    // lowering is emitted as an Eval instruction that runs the tree walker.
+    class Compiler {
+    public:
+        using Register = ByteCode::Register;
+        using OpCode   = ByteCode::OpCode;
+
+    public:
+        static ByteCode::SharedPtr compile(CodeNode::SharedPtr code);
+
+    public:
+        void compileNode(const CodeNode &node, Register dst);
+        void compileEval(const CodeNode &node, Register dst);
+
+        Register allocRegister();
+        Register allocRegisters(std::size_t count);
+        inline Register topRegister() const noexcept;
+        inline void freeRegisters(Register mark) noexcept;
+
+        std::size_t emit(OpCode op, Register a = 0, std::uint32_t b = 0, std::uint32_t c = 0, std::uint8_t sub = 0);
+        std::size_t emitJump(OpCode op, Register a = 0, std::uint8_t sub = 0);
+        void patchJump(std::size_t at);
+        void patchJump(std::size_t at, std::size_t target);
+        inline std::size_t here() const noexcept;
+
+        std::uint32_t addConstant(const Value &value);
+        std::uint32_t addIden(IdenType iden);
+        std::uint32_t addProto(const ByteCode::IdenList &params, CodeNode::SharedPtr body, ScopeLayout::SharedPtr layout);
+        std::uint32_t addLayout(ScopeLayout::SharedPtr layout);
+
+        void pushEnv(const ScopeLayout::SharedPtr &layout);
+        void popEnv();
+
+        void beginLoop();
+        void endLoop(std::size_t breakTarget, std::size_t continueTarget);
+        inline bool inLoop() const noexcept;
+        void emitBreak();
+        void emitContinue();
+
+    private:
+        explicit Compiler(CodeNode::SharedPtr root);
+
+        ByteCode::SharedPtr finish(Register result);
+
+    private:
+        struct LoopContext {
+            std::size_t              envDepth;
+            std::size_t              handler;
+            std::vector<std::size_t> breakJumps;
+            std::vector<std::size_t> continueJumps;
+        };
+
+        void emitLoopExit(std::vector<std::size_t> LoopContext::*jumps);
+
+        std::shared_ptr<ByteCode> code_;
+        Register                  topRegister_;
+        std::size_t               envDepth_;
+        std::vector<bool>         envPushed_;
+        std::vector<LoopContext>  loops_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline auto Compiler::topRegister() const noexcept -> Register {
+        return topRegister_;
+    }
+
+    inline void Compiler::freeRegisters(Register mark) noexcept {
+        topRegister_ = mark;
+    }
+
+    inline std::size_t Compiler::here() const noexcept {
+        return code_->code_.size();
+    }
+
+    inline bool Compiler::inLoop() const noexcept {
+        return !loops_.empty();
+    }
+
+}
+
+#endif	// ISHLANG_COMPILER_H
@@ -0,0 +1,42 @@
+#include "context.h"
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+Context::Context()
+    : collector_()
+    , modules_()
+{}
+
+// -------------------------------------------------------------
+Context::~Context() {
+    // Module values are released and cycles freed under this collector,
+    // objects still referenced from outside are left to their counts.
+    Scope scope(this);
+    modules_.clear();
+    collector_.collect();
+    collector_.release();
+}
+
+// -------------------------------------------------------------
+ModuleStorage &Context::modules() {
+    if (installed_) { return installed_->modules_; }
+
+    static ModuleStorage process;
+    return process;
+}
+
+// -------------------------------------------------------------
+Context::Scope::Scope(Context *context) noexcept
+    : previous_(installed_)
+    , previousCollector_(GarbageCollector::current_)
+{
+    installed_ = context;
+    GarbageCollector::current_ = context ? &context->collector_ : nullptr;
+}
+
+// -------------------------------------------------------------
+Context::Scope::~Scope() {
+    installed_ = previous_;
+    GarbageCollector::current_ = previousCollector_;
+}
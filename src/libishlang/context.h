@@ -0,0 +1,80 @@
+#ifndef ISHLANG_CONTEXT_H
+#define ISHLANG_CONTEXT_H
+
+#include "garbage_collector.h"
+#include "module.h"
+
+namespace Ishlang {
+
+    // State of one interpreter: the modules it loaded and their search
+    // paths, and the collector of its reference cycles. A context is
+    // installed on the thread evaluating its code, so interpreters on
+    // different threads share no mutable state but the identifier table
+    // and standard output. Code run outside of any context uses process
+    // wide modules and collector.
+    //
+    // Evaluation does not modify code trees, so parsed code may be shared
+    // between contexts. A process evaluating on several threads must call
+    // RefCount::enableAtomic before starting them.
+    class Context {
+    public:
+        class Scope;
+
+    public:
+        Context();
+        ~Context();
+
+        Context(const Context &) = delete;
+        Context &operator=(const Context &) = delete;
+
+        inline ModuleStorage &moduleStorage() noexcept;
+        inline GarbageCollector &collector() noexcept;
+
+    public:
+        // Context installed on this thread, null outside of any.
+        static inline Context *installed() noexcept;
+
+        // Modules of the installed context, or the process wide ones.
+        static ModuleStorage &modules();
+
+    private:
+        GarbageCollector collector_;
+        ModuleStorage    modules_;
+
+        static constinit inline thread_local Context *installed_ = nullptr;
+    };
+
+    // Installs a context on this thread for its lifetime, null for the
+    // process wide state, and restores the previous one afterwards.
+    class Context::Scope {
+    public:
+        explicit Scope(Context *context) noexcept;
+        explicit Scope(Context &context) noexcept : Scope(&context) {}
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Context          *previous_;
+        GarbageCollector *previousCollector_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline ModuleStorage &Context::moduleStorage() noexcept {
+        return modules_;
+    }
+
+    inline GarbageCollector &Context::collector() noexcept {
+        return collector_;
+    }
+
+    inline Context *Context::installed() noexcept {
+        return installed_;
+    }
+
+}
+
+#endif // ISHLANG_CONTEXT_H
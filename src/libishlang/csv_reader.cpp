@@ -0,0 +1,155 @@
+#include "csv_reader.h"
+#include "exception.h"
+
+#include <charconv>
+#include <utility>
+#include <vector>
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+CsvReader::CsvReader(FileStruct &file, char delimiter)
+    : file_(file)
+    , delimiter_(delimiter)
+    , scratch_()
+    , quoted_()
+    , lineNo_(0)
+    , width_(0)
+{}
+
+// -------------------------------------------------------------
+template <typename Ftn>
+bool CsvReader::readFields(Ftn &&ftn) {
+    std::optional<std::string_view> line;
+    do {
+        line = file_.readlnView(scratch_);
+        if (!line) { return false; }
+        ++lineNo_;
+        if (!line->empty() && line->back() == '\r') { line->remove_suffix(1); }
+    } while (line->empty());
+
+    const std::string_view text = *line;
+    std::size_t pos = 0;
+    std::size_t col = 0;
+    while (true) {
+        if (pos < text.size() && text[pos] == '"') {
+            pos = splitQuoted(text, pos);
+            ftn(col++, Value(quoted_));
+        }
+        else {
+            auto end = text.find(delimiter_, pos);
+            if (end == std::string_view::npos) { end = text.size(); }
+            ftn(col++, parseField(text.substr(pos, end - pos)));
+            pos = end;
+        }
+
+        if (pos >= text.size()) { break; }
+        ++pos;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------
+std::optional<Sequence> CsvReader::readRow() {
+    Sequence::Vector fields;
+    fields.reserve(width_);
+    if (!readFields([&fields](std::size_t, Value &&field) { fields.push_back(std::move(field)); })) {
+        return std::nullopt;
+    }
+    width_ = fields.size();
+    return std::make_optional<Sequence>(std::move(fields));
+}
+
+// -------------------------------------------------------------
+Sequence CsvReader::readRows() {
+    Sequence::Vector rows;
+    while (auto row = readRow()) {
+        rows.emplace_back(std::move(*row));
+    }
+    return Sequence(std::move(rows));
+}
+
+// -------------------------------------------------------------
+Sequence CsvReader::readColumns() {
+    std::vector<Sequence> columns;
+    bool first = true;
+    std::size_t count = 0;
+
+    const auto mismatch = [this, &columns](std::size_t fields) {
+        return InvalidExpression(Exception::format("csv line %zu has %zu fields, expected %zu",
+                                                   lineNo_, fields, columns.size()));
+    };
+
+    while (true) {
+        count = 0;
+        const bool more = readFields(
+            [&](std::size_t col, Value &&field) {
+                if (first) {
+                    columns.emplace_back();
+                }
+                else if (col >= columns.size()) {
+                    throw mismatch(col + 1);
+                }
+                columns[col].push(field);
+                ++count;
+            });
+        if (!more) { break; }
+        if (count != columns.size()) { throw mismatch(count); }
+        first = false;
+    }
+
+    Sequence::Vector result;
+    result.reserve(columns.size());
+    for (auto &column : columns) {
+        result.emplace_back(std::move(column));
+    }
+    return Sequence(std::move(result));
+}
+
+// -------------------------------------------------------------
+Value CsvReader::parseField(std::string_view field) {
+    if (!field.empty()) {
+        const char c = field.front();
+        if ((c >= '0' && c <= '9') || c == '-' || c == '.') {
+            const char *begin = field.data();
+            const char *end = begin + field.size();
+
+            Value::Long i = 0;
+            if (auto [ptr, ec] = std::from_chars(begin, end, i); ec == std::errc() && ptr == end) {
+                return Value(i);
+            }
+
+            Value::Double r = 0.0;
+            if (auto [ptr, ec] = std::from_chars(begin, end, r); ec == std::errc() && ptr == end) {
+                return Value(r);
+            }
+        }
+    }
+    return Value(std::string(field));
+}
+
+// -------------------------------------------------------------
+std::size_t CsvReader::splitQuoted(std::string_view line, std::size_t pos) {
+    quoted_.clear();
+    ++pos;
+    while (true) {
+        const auto quote = line.find('"', pos);
+        if (quote == std::string_view::npos) {
+            throw InvalidExpression(Exception::format("Unterminated quoted field on csv line %zu", lineNo_));
+        }
+        quoted_.append(line.substr(pos, quote - pos));
+        pos = quote + 1;
+        if (pos < line.size() && line[pos] == '"') {
+            quoted_.push_back('"');
+            ++pos;
+        }
+        else {
+            break;
+        }
+    }
+
+    if (pos < line.size() && line[pos] != delimiter_) {
+        throw InvalidExpression(Exception::format("Unexpected character after quoted field on csv line %zu", lineNo_));
+    }
+    return pos;
+}
@@ -0,0 +1,57 @@
+#ifndef ISHLANG_CSV_READER_H
+#define ISHLANG_CSV_READER_H
+
+#include "file_io.h"
+#include "sequence.h"
+#include "value.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Ishlang {
+
+    // Reads delimited rows from a file, one line per row. Fields that
+    // parse fully as integers or reals become numbers, other fields and
+    // fields in double quotes are strings. Quoted fields may contain the
+    // delimiter, and a doubled quote stands for a quote. Lines are viewed
+    // in place in mapped files, so only the fields themselves are copied.
+    class CsvReader {
+    public:
+        static constexpr char DefaultDelimiter = ',';
+
+    public:
+        CsvReader(FileStruct &file, char delimiter = DefaultDelimiter);
+
+        // Next row as an array of fields, null at end of file.
+        std::optional<Sequence> readRow();
+
+        // Remaining rows as an array of arrays.
+        Sequence readRows();
+
+        // Remaining rows as one array per column, packed when a column
+        // holds only integers or only reals. Rows must have equal lengths.
+        Sequence readColumns();
+
+    public:
+        static Value parseField(std::string_view field);
+
+    private:
+        template <typename Ftn>
+        bool readFields(Ftn &&ftn);
+
+        std::size_t splitQuoted(std::string_view line, std::size_t pos);
+
+    private:
+        FileStruct  &file_;
+        char         delimiter_;
+        std::string  scratch_;
+        std::string  quoted_;
+        std::size_t  lineNo_;
+        std::size_t  width_;
+    };
+
+}
+
+#endif // ISHLANG_CSV_READER_H
@@ -0,0 +1,396 @@
+#include "dense_array.h"
+#include "array_kernels.h"
+#include "exception.h"
+#include "sequence.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+using namespace Ishlang;
+
+namespace {
+
+    // Rows, columns and inner dimension of the blocks multiplied at a time,
+    // a block of the right hand side fits in the L2 cache.
+    constexpr std::size_t RowBlock   = 64;
+    constexpr std::size_t InnerBlock = 128;
+    constexpr std::size_t ColBlock   = 256;
+
+    void flatten(const Sequence &seq, const DenseArray::Shape &shape, std::size_t dim, DenseArray::Buffer &data) {
+        if (seq.size() != shape[dim]) {
+            throw InvalidExpression("ndarray expects nested arrays of equal lengths");
+        }
+
+        if (dim + 1 == shape.size()) {
+            switch (seq.packing()) {
+            case Sequence::PackedReals:
+                data.insert(data.end(), seq.reals().begin(), seq.reals().end());
+                break;
+
+            case Sequence::PackedIntegers:
+                data.insert(data.end(), seq.integers().begin(), seq.integers().end());
+                break;
+
+            case Sequence::Boxed:
+                for (const auto &item : seq) {
+                    if (!item.isNumber()) {
+                        throw InvalidOperandType(Value::typeToString(Value::eReal), item.typeToString());
+                    }
+                    data.push_back(item.real());
+                }
+                break;
+            }
+        }
+        else {
+            for (const auto &item : seq) {
+                if (!item.isArray()) {
+                    throw InvalidOperandType(Value::typeToString(Value::eArray), item.typeToString());
+                }
+                flatten(item.array(), shape, dim + 1, data);
+            }
+        }
+    }
+
+}
+
+// -------------------------------------------------------------
+template <typename Ftn>
+void DenseArray::walk(Ftn &&ftn) const {
+    const std::size_t total = elements();
+    if (total == 0) {
+        return;
+    }
+
+    Buffer &buffer = *buffer_;
+    const std::size_t last = rank() - 1;
+    const std::ptrdiff_t innerStride = strides_[last];
+    const std::size_t innerSize = shape_[last];
+
+    std::vector<std::size_t> index(rank(), 0);
+    std::ptrdiff_t offset = offset_;
+    for (std::size_t done = 0; done < total; done += innerSize) {
+        for (std::size_t j = 0; j < innerSize; ++j) {
+            ftn(buffer[offset + static_cast<std::ptrdiff_t>(j) * innerStride]);
+        }
+
+        for (std::size_t d = last; d-- > 0; ) {
+            offset += strides_[d];
+            if (++index[d] < shape_[d]) {
+                break;
+            }
+            offset -= strides_[d] * static_cast<std::ptrdiff_t>(shape_[d]);
+            index[d] = 0;
+        }
+    }
+}
+
+// -------------------------------------------------------------
+DenseArray::DenseArray()
+    : DenseArray(Shape{0})
+{}
+
+DenseArray::DenseArray(const Shape &shape, Double fill)
+    : DenseArray(shape, Buffer(product(shape), fill))
+{}
+
+DenseArray::DenseArray(const Shape &shape, Buffer &&data)
+    : buffer_(std::make_shared<Buffer>(std::move(data)))
+    , shape_(shape)
+    , strides_(rowMajor(shape))
+    , offset_(0)
+{
+    if (shape_.empty()) {
+        throw InvalidExpression("ndarray shape cannot be empty");
+    }
+    if (buffer_->size() != product(shape_)) {
+        throw InvalidExpression("ndarray data size does not match shape");
+    }
+}
+
+// -------------------------------------------------------------
+DenseArray DenseArray::fromSequence(const Sequence &seq) {
+    Shape shape{seq.size()};
+    for (auto items = seq.empty() ? Value::Null : seq.get(0); items.isArray(); ) {
+        shape.push_back(items.array().size());
+        items = items.array().empty() ? Value::Null : items.array().get(0);
+    }
+
+    Buffer data;
+    data.reserve(product(shape));
+    flatten(seq, shape, 0, data);
+    return DenseArray(shape, std::move(data));
+}
+
+Sequence DenseArray::toSequence() const {
+    if (rank() == 1) {
+        Buffer scratch;
+        const auto vals = values(scratch);
+        return Sequence::packed(Sequence::Reals(vals.begin(), vals.end()));
+    }
+
+    Sequence::Vector rows;
+    rows.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i) {
+        rows.push_back(Value(take(0, i).toSequence()));
+    }
+    return Sequence(std::move(rows));
+}
+
+// -------------------------------------------------------------
+bool DenseArray::operator==(const DenseArray &rhs) const {
+    if (shape_ != rhs.shape_) {
+        return false;
+    }
+
+    Buffer lhsScratch;
+    Buffer rhsScratch;
+    return std::ranges::equal(values(lhsScratch), rhs.values(rhsScratch));
+}
+
+// -------------------------------------------------------------
+bool DenseArray::contiguous() const noexcept {
+    std::ptrdiff_t stride = 1;
+    for (std::size_t d = rank(); d-- > 0; ) {
+        if (shape_[d] != 1 && strides_[d] != stride) {
+            return false;
+        }
+        stride *= shape_[d];
+    }
+    return true;
+}
+
+// -------------------------------------------------------------
+Value DenseArray::get(std::size_t idx) const {
+    if (idx >= size()) {
+        throw OutOfRange("ndarray get access");
+    }
+    if (rank() == 1) {
+        return Value((*buffer_)[offset_ + static_cast<std::ptrdiff_t>(idx) * strides_[0]]);
+    }
+    return Value(take(0, idx));
+}
+
+void DenseArray::set(std::size_t idx, const Value &value) {
+    if (idx >= size()) {
+        throw OutOfRange("ndarray set access");
+    }
+
+    if (value.isNumber()) {
+        if (rank() == 1) {
+            (*buffer_)[offset_ + static_cast<std::ptrdiff_t>(idx) * strides_[0]] = value.real();
+        }
+        else {
+            const Double num = value.real();
+            take(0, idx).walk([num](Double &elem) { elem = num; });
+        }
+    }
+    else if (value.isNdArray() && rank() > 1) {
+        const auto row = take(0, idx);
+        if (row.shape_ != value.ndArray().shape_) {
+            throw InvalidExpression("Mismatched ndarray shapes in set");
+        }
+
+        // Copied first, the source may be a view of this array
+        const auto src = value.ndArray().copy();
+        auto iter = src.buffer_->begin();
+        row.walk([&iter](Double &elem) { elem = *iter++; });
+    }
+    else {
+        auto expected = Value::typeToString(Value::eInteger) + '|' + Value::typeToString(Value::eReal);
+        if (rank() > 1) { expected += '|' + Value::typeToString(Value::eNdArray); }
+        throw InvalidOperandType(expected, value.typeToString());
+    }
+}
+
+// -------------------------------------------------------------
+auto DenseArray::at(std::span<const std::size_t> index) const -> Double {
+    return (*buffer_)[offsetOf(index)];
+}
+
+auto DenseArray::at(std::span<const std::size_t> index) -> Double & {
+    return (*buffer_)[offsetOf(index)];
+}
+
+// -------------------------------------------------------------
+DenseArray DenseArray::take(std::size_t axis, std::size_t idx) const {
+    assert(rank() > 1 && axis < rank() && idx < shape_[axis]);
+
+    DenseArray view(*this);
+    view.offset_ += static_cast<std::ptrdiff_t>(idx) * strides_[axis];
+    view.shape_.erase(view.shape_.begin() + axis);
+    view.strides_.erase(view.strides_.begin() + axis);
+    return view;
+}
+
+DenseArray DenseArray::slice(std::size_t axis, std::size_t begin, std::size_t end) const {
+    if (axis >= rank()) {
+        throw OutOfRange("ndarray slice axis");
+    }
+    if (begin > end || end > shape_[axis]) {
+        throw OutOfRange("ndarray slice bounds");
+    }
+
+    DenseArray view(*this);
+    view.offset_ += static_cast<std::ptrdiff_t>(begin) * strides_[axis];
+    view.shape_[axis] = end - begin;
+    return view;
+}
+
+DenseArray DenseArray::transpose() const {
+    DenseArray view(*this);
+    std::reverse(view.shape_.begin(), view.shape_.end());
+    std::reverse(view.strides_.begin(), view.strides_.end());
+    return view;
+}
+
+DenseArray DenseArray::reshape(const Shape &shape) const {
+    if (shape.empty() || product(shape) != elements()) {
+        throw InvalidExpression("ndarray reshape size does not match");
+    }
+
+    if (!contiguous()) {
+        return copy().reshape(shape);
+    }
+
+    DenseArray view(*this);
+    view.shape_ = shape;
+    view.strides_ = rowMajor(shape);
+    return view;
+}
+
+// -------------------------------------------------------------
+DenseArray DenseArray::copy() const {
+    Buffer scratch;
+    const auto vals = values(scratch);
+    return DenseArray(shape_, scratch.empty() ? Buffer(vals.begin(), vals.end()) : std::move(scratch));
+}
+
+// -------------------------------------------------------------
+auto DenseArray::values(Buffer &scratch) const -> std::span<const Double> {
+    if (contiguous()) {
+        return std::span<const Double>(buffer_->data() + offset_, elements());
+    }
+
+    scratch.clear();
+    scratch.reserve(elements());
+    walk([&scratch](Double elem) { scratch.push_back(elem); });
+    return scratch;
+}
+
+// -------------------------------------------------------------
+auto DenseArray::sum() const -> Double {
+    Buffer scratch;
+    return ArrayKernels::sum(values(scratch));
+}
+
+Value DenseArray::min() const {
+    Buffer scratch;
+    const auto vals = values(scratch);
+    return vals.empty() ? Value::Null : Value(*std::min_element(vals.begin(), vals.end()));
+}
+
+Value DenseArray::max() const {
+    Buffer scratch;
+    const auto vals = values(scratch);
+    return vals.empty() ? Value::Null : Value(*std::max_element(vals.begin(), vals.end()));
+}
+
+DenseArray DenseArray::sum(std::size_t axis) const {
+    if (axis >= rank()) {
+        throw OutOfRange("ndarray sum axis");
+    }
+    if (rank() == 1) {
+        throw InvalidExpression("ndarray sum along an axis needs two or more dimensions");
+    }
+
+    Shape shape(shape_);
+    shape.erase(shape.begin() + axis);
+
+    Buffer total(product(shape), 0.0);
+    Buffer scratch;
+    for (std::size_t k = 0; k < shape_[axis]; ++k) {
+        ArrayKernels::apply(std::span<Double>(total), take(axis, k).values(scratch), std::plus<Double>());
+    }
+    return DenseArray(shape, std::move(total));
+}
+
+// -------------------------------------------------------------
+DenseArray DenseArray::matmul(const DenseArray &lhs, const DenseArray &rhs) {
+    if (lhs.rank() != 2 || rhs.rank() > 2) {
+        throw InvalidExpression("ndarray matmul expects a matrix times a matrix or a vector");
+    }
+
+    const std::size_t rows  = lhs.shape_[0];
+    const std::size_t inner = lhs.shape_[1];
+    const std::size_t cols  = rhs.rank() == 2 ? rhs.shape_[1] : 1;
+    if (rhs.shape_[0] != inner) {
+        throw InvalidExpression("Mismatched ndarray shapes in matmul");
+    }
+
+    Buffer lhsScratch;
+    Buffer rhsScratch;
+    const auto a = lhs.values(lhsScratch);
+    const auto b = rhs.values(rhsScratch);
+    Buffer c(rows * cols, 0.0);
+
+    if (rhs.rank() == 1) {
+        for (std::size_t i = 0; i < rows; ++i) {
+            c[i] = ArrayKernels::dot(a.subspan(i * inner, inner), b);
+        }
+        return DenseArray(Shape{rows}, std::move(c));
+    }
+
+    // Rows of c accumulate scaled rows of b, blocked so that the rows of b
+    // in use stay cached across the rows of a.
+    for (std::size_t i0 = 0; i0 < rows; i0 += RowBlock) {
+        const std::size_t i1 = std::min(i0 + RowBlock, rows);
+        for (std::size_t k0 = 0; k0 < inner; k0 += InnerBlock) {
+            const std::size_t k1 = std::min(k0 + InnerBlock, inner);
+            for (std::size_t j0 = 0; j0 < cols; j0 += ColBlock) {
+                const std::size_t width = std::min(j0 + ColBlock, cols) - j0;
+                for (std::size_t i = i0; i < i1; ++i) {
+                    const std::span<Double> out(c.data() + i * cols + j0, width);
+                    for (std::size_t k = k0; k < k1; ++k) {
+                        ArrayKernels::axpy(out, a[i * inner + k], b.subspan(k * cols + j0, width));
+                    }
+                }
+            }
+        }
+    }
+    return DenseArray(Shape{rows, cols}, std::move(c));
+}
+
+// -------------------------------------------------------------
+auto DenseArray::rowMajor(const Shape &shape) -> Strides {
+    Strides strides(shape.size());
+    std::ptrdiff_t stride = 1;
+    for (std::size_t d = shape.size(); d-- > 0; ) {
+        strides[d] = stride;
+        stride *= shape[d];
+    }
+    return strides;
+}
+
+std::size_t DenseArray::product(const Shape &shape) {
+    std::size_t total = 1;
+    for (const auto dim : shape) {
+        total *= dim;
+    }
+    return total;
+}
+
+std::ptrdiff_t DenseArray::offsetOf(std::span<const std::size_t> index) const {
+    if (index.size() != rank()) {
+        throw InvalidExpression("ndarray index does not match rank");
+    }
+
+    std::ptrdiff_t offset = offset_;
+    for (std::size_t d = 0; d < rank(); ++d) {
+        if (index[d] >= shape_[d]) {
+            throw OutOfRange("ndarray element access");
+        }
+        offset += static_cast<std::ptrdiff_t>(index[d]) * strides_[d];
+    }
+    return offset;
+}
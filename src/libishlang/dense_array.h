@@ -0,0 +1,200 @@
+#ifndef ISHLANG_DENSE_ARRAY_H
+#define ISHLANG_DENSE_ARRAY_H
+
+#include "util.h"
+#include "value.h"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace Ishlang {
+
+    class Sequence;
+
+    // N dimensional array of reals stored row major in a buffer shared by
+    // the array and its views. Rows, slices, transposes and reshapes of a
+    // contiguous array are views with their own shape, strides and offset
+    // into the buffer, so writing through a view writes the array.
+    // Arithmetic and copies produce new contiguous arrays.
+    class DenseArray {
+    public:
+        using Double  = Value::Double;
+        using Shape   = std::vector<std::size_t>;
+        using Strides = std::vector<std::ptrdiff_t>;
+        using Buffer  = std::vector<Double>;
+
+        class ConstIterator;
+
+    public:
+        DenseArray();
+        DenseArray(const Shape &shape, Double fill = 0.0);
+        DenseArray(const Shape &shape, Buffer &&data);
+
+        // Nested arrays of numbers of equal lengths, their nesting is the shape.
+        static DenseArray fromSequence(const Sequence &seq);
+        Sequence toSequence() const;
+
+        bool operator==(const DenseArray &rhs) const;
+        inline bool operator!=(const DenseArray &rhs) const;
+
+        inline bool operator<(const DenseArray &rhs) const;
+        inline bool operator>(const DenseArray &rhs) const;
+        inline bool operator<=(const DenseArray &rhs) const;
+        inline bool operator>=(const DenseArray &rhs) const;
+
+        // Length of the first dimension.
+        inline std::size_t size() const noexcept;
+        inline bool empty() const noexcept;
+        inline std::size_t elements() const noexcept;
+        inline std::size_t rank() const noexcept;
+        inline const Shape &shape() const noexcept;
+
+        // Elements laid out row major, possibly at an offset into the buffer.
+        bool contiguous() const noexcept;
+
+        // Item of the first dimension, a real for one dimensional arrays
+        // and a view of a row otherwise. Setting a row takes a number to
+        // fill it or an array of its shape.
+        Value get(std::size_t idx) const;
+        void set(std::size_t idx, const Value &value);
+
+        Double at(std::span<const std::size_t> index) const;
+        Double &at(std::span<const std::size_t> index);
+
+        // Views
+        DenseArray take(std::size_t axis, std::size_t idx) const;
+        DenseArray slice(std::size_t axis, std::size_t begin, std::size_t end) const;
+        DenseArray transpose() const;
+        DenseArray reshape(const Shape &shape) const;
+
+        // Contiguous copy not sharing the buffer.
+        DenseArray copy() const;
+
+        // Elements in row major order, copied only when not contiguous.
+        std::span<const Double> values(Buffer &scratch) const;
+
+        Double sum() const;
+        Value min() const;
+        Value max() const;
+
+        // Sum along an axis, which is removed from the shape.
+        DenseArray sum(std::size_t axis) const;
+
+        // Matrix product of two dimensional arrays, or of a two dimensional
+        // array and a vector.
+        static DenseArray matmul(const DenseArray &lhs, const DenseArray &rhs);
+
+        // Items of the first dimension, as returned by get.
+        inline ConstIterator begin() const noexcept;
+        inline ConstIterator end() const noexcept;
+
+    public:
+        friend inline std::ostream &operator<<(std::ostream &out, const DenseArray &arr);
+
+    private:
+        static Strides rowMajor(const Shape &shape);
+        static std::size_t product(const Shape &shape);
+
+        template <typename Ftn>
+        void walk(Ftn &&ftn) const;
+
+        std::ptrdiff_t offsetOf(std::span<const std::size_t> index) const;
+
+    private:
+        std::shared_ptr<Buffer> buffer_;
+        Shape                   shape_;
+        Strides                 strides_;
+        std::ptrdiff_t          offset_;
+    };
+
+    // -------------------------------------------------------------
+    class DenseArray::ConstIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Value;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = Value;
+
+    public:
+        ConstIterator() = default;
+        ConstIterator(const DenseArray *arr, std::size_t idx) : arr_(arr), idx_(idx) {}
+
+        Value operator*() const { return arr_->get(idx_); }
+
+        ConstIterator &operator++() { ++idx_; return *this; }
+        ConstIterator operator++(int) { auto tmp = *this; ++idx_; return tmp; }
+
+        friend bool operator==(const ConstIterator &lhs, const ConstIterator &rhs) { return lhs.idx_ == rhs.idx_; }
+
+    private:
+        const DenseArray *arr_ = nullptr;
+        std::size_t       idx_ = 0;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline std::ostream &operator<<(std::ostream &out, const DenseArray &arr) {
+        return Util::printContainer(out,
+                                    arr,
+                                    [](std::ostream &os, const auto &item) { os << item; },
+                                    '[',
+                                    ']');
+    }
+
+    inline bool DenseArray::operator!=(const DenseArray &rhs) const {
+        return !(*this == rhs);
+    }
+
+    inline bool DenseArray::operator<(const DenseArray &rhs) const {
+        return elements() < rhs.elements();
+    }
+
+    inline bool DenseArray::operator>(const DenseArray &rhs) const {
+        return elements() > rhs.elements();
+    }
+
+    inline bool DenseArray::operator<=(const DenseArray &rhs) const {
+        return elements() <= rhs.elements();
+    }
+
+    inline bool DenseArray::operator>=(const DenseArray &rhs) const {
+        return elements() >= rhs.elements();
+    }
+
+    inline std::size_t DenseArray::size() const noexcept {
+        return shape_.front();
+    }
+
+    inline bool DenseArray::empty() const noexcept {
+        return size() == 0;
+    }
+
+    inline std::size_t DenseArray::elements() const noexcept {
+        return product(shape_);
+    }
+
+    inline std::size_t DenseArray::rank() const noexcept {
+        return shape_.size();
+    }
+
+    inline auto DenseArray::shape() const noexcept -> const Shape & {
+        return shape_;
+    }
+
+    inline auto DenseArray::begin() const noexcept -> ConstIterator {
+        return ConstIterator(this, 0);
+    }
+
+    inline auto DenseArray::end() const noexcept -> ConstIterator {
+        return ConstIterator(this, size());
+    }
+
+}
+
+#endif // ISHLANG_DENSE_ARRAY_H
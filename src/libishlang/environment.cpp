@@ -1,15 +1,28 @@
 #include "environment.h"
 
+#include <algorithm>
+
 using namespace Ishlang;
 
 IdenTable Environment::idenTable_ = IdenTable();
 
-Environment::Environment(SharedPtr parent)
+Environment::Environment(SharedPtr parent, ScopeLayout::SharedPtr layout)
     : parent_(parent)
+    , layout_(layout)
+    , numSlots_(layout ? layout->size() : 0)
+    , inlineSlots_()
+    , heapSlots_(numSlots_ > MaxInlineSlots ? std::make_unique<Slot[]>(numSlots_) : HeapSlots())
+    , slots_(heapSlots_ ? heapSlots_.get() : inlineSlots_.data())
     , table_()
 {}
 
 const Value &Environment::def(IdenType iden, const Value &value) {
+    if (layout_) {
+        if (auto slot = layout_->find(iden)) {
+            return defAt(*slot, value);
+        }
+    }
+
     auto [iter, success] = table_.emplace(iden, value);
     if (!success) {
         throw DuplicateDef(idenTable_.getName(iden));
@@ -18,25 +31,52 @@ const Value &Environment::def(IdenType iden, const Value &value) {
 }
 
 const Value &Environment::set(IdenType iden, const Value &value) {
-    auto iter = table_.find(iden);
-    if (iter == table_.end()) {
-        if (parent_) {
-            return parent_->set(iden, value);
+    if (!table_.empty()) {
+        auto iter = table_.find(iden);
+        if (iter != table_.end()) {
+            return iter->second = value;
         }
-        throw UnknownSymbol(idenTable_.getName(iden));
     }
-    else {
-        return iter->second = value;
+    if (auto entry = findSlot(iden)) {
+        return entry->value = value;
     }
+    return setOuter(iden, value);
 }
 
 const Value &Environment::get(IdenType iden) const {
-    auto iter = table_.find(iden);
-    if (iter == table_.end()) {
-        if (parent_) {
-            return parent_->get(iden);
+    if (!table_.empty()) {
+        auto iter = table_.find(iden);
+        if (iter != table_.end()) {
+            return iter->second;
         }
-        throw UnknownSymbol(idenTable_.getName(iden));
     }
-    return iter->second;
+    if (auto entry = findSlot(iden)) {
+        return entry->value;
+    }
+    return getOuter(iden);
+}
+
+Environment::SharedPtr Environment::capture(const SharedPtr &env) {
+    if (!env || !env->parent_) {
+        return env;
+    }
+
+    auto frame = make(capture(env->parent_), env->layout_);
+    std::copy_n(env->slots_, env->numSlots_, frame->slots_);
+    frame->table_ = env->table_;
+    return frame;
+}
+
+const Value &Environment::setOuter(IdenType iden, const Value &value) {
+    if (parent_) {
+        return parent_->set(iden, value);
+    }
+    throw UnknownSymbol(idenTable_.getName(iden));
+}
+
+const Value &Environment::getOuter(IdenType iden) const {
+    if (parent_) {
+        return parent_->get(iden);
+    }
+    throw UnknownSymbol(idenTable_.getName(iden));
 }
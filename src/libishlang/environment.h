@@ -1,13 +1,18 @@
 #ifndef ISHLANG_ENVIRONMENT_H
 #define ISHLANG_ENVIRONMENT_H
 
+#include <array>
 #include <concepts>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "exception.h"
+#include "frame_pool.h"
 #include "iden_table.h"
+#include "scope_layout.h"
 #include "value.h"
 
 namespace Ishlang {
@@ -20,12 +25,19 @@ namespace Ishlang {
         using SharedPtr = std::shared_ptr<Environment>;
 
     public:
-        Environment(SharedPtr parent=SharedPtr());
+        Environment(SharedPtr parent=SharedPtr(), ScopeLayout::SharedPtr layout=ScopeLayout::SharedPtr());
+
+        Environment(const Environment &) = delete;
+        Environment &operator=(const Environment &) = delete;
 
         const Value &def(IdenType iden, const Value &value);
         const Value &set(IdenType iden, const Value &value);
         const Value &get(IdenType iden) const;
 
+        inline const Value &defAt(std::size_t slot, const Value &value);
+        inline const Value &setAt(const VarAddress &address, IdenType iden, const Value &value);
+        inline const Value &getAt(const VarAddress &address, IdenType iden) const;
+
         inline const Value &defByName(const std::string &name, const Value &value);
         inline const Value &setByName(const std::string &name, const Value &value);
         inline const Value &getByName(const std::string &name) const;
@@ -40,18 +52,50 @@ namespace Ishlang {
         inline void foreach(EnvForeachInvocable auto && ftn) const;
 
     public:
-        static inline SharedPtr make(SharedPtr parent=SharedPtr());
+        static inline SharedPtr make(SharedPtr parent=SharedPtr(), ScopeLayout::SharedPtr layout=ScopeLayout::SharedPtr());
+        static inline SharedPtr makeScope(const SharedPtr &parent, const ScopeLayout::SharedPtr &layout);
+
+        // Copy of the frames from env up to its root, holding the values
+        // they have now. The root, global or module frame, is shared.
+        static SharedPtr capture(const SharedPtr &env);
 
         static inline IdenTable & idenTable();
 
     private:
+        friend class GarbageCollector;
+
         static IdenTable idenTable_;
 
     private:
-        using Table = std::unordered_map<IdenType, Value>;
+        struct Slot {
+            Value value;
+            bool  defined = false;
+        };
 
-        SharedPtr parent_;
-        Table     table_;
+        inline const Environment &frameAt(std::uint32_t depth) const noexcept;
+        inline Environment &frameAt(std::uint32_t depth) noexcept;
+        inline const Slot *findSlot(IdenType iden) const noexcept;
+        inline Slot *findSlot(IdenType iden) noexcept;
+
+        const Value &setOuter(IdenType iden, const Value &value);
+        const Value &getOuter(IdenType iden) const;
+
+    private:
+        // Frames with few slots keep them inline, so together with the
+        // frame pool a call allocates no memory for its environment.
+        static constexpr std::size_t MaxInlineSlots = 4;
+
+        using Table       = std::unordered_map<IdenType, Value>;
+        using InlineSlots = std::array<Slot, MaxInlineSlots>;
+        using HeapSlots   = std::unique_ptr<Slot[]>;
+
+        SharedPtr              parent_;
+        ScopeLayout::SharedPtr layout_;
+        std::size_t            numSlots_;
+        InlineSlots            inlineSlots_;
+        HeapSlots              heapSlots_;
+        Slot                  *slots_;
+        Table                  table_;
     };
 
     // --------------------------------------------------------------------------------
@@ -69,8 +113,29 @@ namespace Ishlang {
         return get(idenTable_.mapName(name));
     }
 
+    inline const Value &Environment::defAt(std::size_t slot, const Value &value) {
+        auto &entry = slots_[slot];
+        if (entry.defined) {
+            throw DuplicateDef(idenTable_.getName(layout_->iden(slot)));
+        }
+        entry.defined = true;
+        return entry.value = value;
+    }
+
+    inline const Value &Environment::setAt(const VarAddress &address, IdenType iden, const Value &value) {
+        auto &frame = frameAt(address.depth);
+        auto &entry = frame.slots_[address.slot];
+        return entry.defined ? (entry.value = value) : frame.setOuter(iden, value);
+    }
+
+    inline const Value &Environment::getAt(const VarAddress &address, IdenType iden) const {
+        const auto &frame = frameAt(address.depth);
+        const auto &entry = frame.slots_[address.slot];
+        return entry.defined ? entry.value : frame.getOuter(iden);
+    }
+
     inline bool Environment::exists(IdenType iden) const noexcept {
-        return table_.find(iden) != table_.end();
+        return table_.find(iden) != table_.end() || findSlot(iden) != nullptr;
     }
 
     inline bool Environment::exists(const std::string &name) const noexcept {
@@ -78,26 +143,67 @@ namespace Ishlang {
     }
 
     inline bool Environment::empty() const noexcept {
-        return table_.empty();
+        return size() == 0;
     }
 
     inline std::size_t Environment::size() const noexcept {
-        return table_.size();
+        std::size_t count = table_.size();
+        for (std::size_t slot = 0; slot < numSlots_; ++slot) {
+            if (slots_[slot].defined) { ++count; }
+        }
+        return count;
     }
 
     inline void Environment::clear() noexcept {
         // Do not clear parent
         table_.clear();
+        for (std::size_t slot = 0; slot < numSlots_; ++slot) {
+            slots_[slot] = Slot();
+        }
     }
 
     inline void Environment::foreach(EnvForeachInvocable auto && ftn) const {
         for (const auto & nameValue : table_) {
             ftn(idenTable_.getName(nameValue.first), nameValue.second);
         }
+        for (std::size_t slot = 0; slot < numSlots_; ++slot) {
+            if (slots_[slot].defined) {
+                ftn(idenTable_.getName(layout_->iden(slot)), slots_[slot].value);
+            }
+        }
+    }
+
+    inline auto Environment::make(SharedPtr parent, ScopeLayout::SharedPtr layout) -> SharedPtr {
+        return std::allocate_shared<Environment>(FrameAllocator<Environment>(), parent, layout);
+    }
+
+    inline auto Environment::makeScope(const SharedPtr &parent, const ScopeLayout::SharedPtr &layout) -> SharedPtr {
+        return ScopeLayout::elides(layout) ? parent : make(parent, layout);
+    }
+
+    inline const Environment &Environment::frameAt(std::uint32_t depth) const noexcept {
+        const Environment *frame = this;
+        for (; depth > 0; --depth) { frame = frame->parent_.get(); }
+        return *frame;
+    }
+
+    inline Environment &Environment::frameAt(std::uint32_t depth) noexcept {
+        Environment *frame = this;
+        for (; depth > 0; --depth) { frame = frame->parent_.get(); }
+        return *frame;
+    }
+
+    inline auto Environment::findSlot(IdenType iden) const noexcept -> const Slot * {
+        if (layout_) {
+            if (auto slot = layout_->find(iden); slot && slots_[*slot].defined) {
+                return &slots_[*slot];
+            }
+        }
+        return nullptr;
     }
 
-    inline auto Environment::make(SharedPtr parent) -> SharedPtr {
-        return std::make_shared<Environment>(parent);
+    inline auto Environment::findSlot(IdenType iden) noexcept -> Slot * {
+        return const_cast<Slot *>(std::as_const(*this).findSlot(iden));
     }
 
     inline IdenTable & Environment::idenTable() {
@@ -1,6 +1,12 @@
 #include "file_io.h"
 
 #include <cassert>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace Ishlang;
 
@@ -10,6 +16,7 @@ FileMode FileModeNS::fromChar(char c) {
         case 'r':
         case 'w':
         case 'a':
+        case 'm':
             return static_cast<FileMode>(c);
 
         default:
@@ -24,14 +31,90 @@ std::ios_base::openmode FileModeNS::toOpenMode(FileMode mode) {
         case FileMode::Read:   return std::ios_base::in;
         case FileMode::Write:  return std::ios_base::out;
         case FileMode::Append: return std::ios_base::app;
+        case FileMode::Map:    return std::ios_base::in;
         default:               break;
     }
     assert(false);
     return std::ios_base::in;
 }
 
+// -------------------------------------------------------------
+MappedFile::~MappedFile() {
+    close();
+}
+
+// -------------------------------------------------------------
+bool MappedFile::open(const std::string &filename) {
+    close();
+
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ == 0) {
+            open_ = true;
+        }
+        else if (void *addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0); addr != MAP_FAILED) {
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char *>(addr);
+            open_ = true;
+        }
+    }
+
+    ::close(fd);
+    if (!open_) { size_ = 0; }
+    return open_;
+}
+
+// -------------------------------------------------------------
+void MappedFile::close() noexcept {
+    if (data_) {
+        ::munmap(const_cast<char *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    pos_ = 0;
+    open_ = false;
+}
+
+// -------------------------------------------------------------
+std::optional<char> MappedFile::read() {
+    if (pos_ < size_) {
+        return std::make_optional<char>(data_[pos_++]);
+    }
+    return std::nullopt;
+}
+
+// -------------------------------------------------------------
+std::optional<std::string_view> MappedFile::readln() {
+    if (pos_ >= size_) {
+        return std::nullopt;
+    }
+    const char *begin = data_ + pos_;
+    const std::size_t remaining = size_ - pos_;
+    const auto *newline = static_cast<const char *>(std::memchr(begin, '\n', remaining));
+    const std::size_t len = newline ? static_cast<std::size_t>(newline - begin) : remaining;
+    pos_ += newline ? len + 1 : len;
+    return std::make_optional<std::string_view>(begin, len);
+}
+
+// -------------------------------------------------------------
+std::string_view MappedFile::readAll() {
+    const std::string_view rest(data_ + pos_, size_ - pos_);
+    pos_ = size_;
+    return rest;
+}
+
 // -------------------------------------------------------------
 std::optional<char> FileStruct::read() {
+    if (params_.mode == FileMode::Map) {
+        return map_.read();
+    }
+
     char c = '\0';
     if (fs_.get(c)) {
         return std::make_optional<char>(c);
@@ -41,6 +124,13 @@ std::optional<char> FileStruct::read() {
 
 // -------------------------------------------------------------
 std::optional<std::string> FileStruct::readln() {
+    if (params_.mode == FileMode::Map) {
+        if (auto line = map_.readln()) {
+            return std::make_optional<std::string>(*line);
+        }
+        return std::nullopt;
+    }
+
     std::string line;
     if (std::getline(fs_, line)) {
         return std::make_optional(std::move(line));
@@ -48,6 +138,44 @@ std::optional<std::string> FileStruct::readln() {
     return std::nullopt;
 }
 
+// -------------------------------------------------------------
+std::optional<std::string_view> FileStruct::readlnView(std::string &scratch) {
+    if (params_.mode == FileMode::Map) {
+        return map_.readln();
+    }
+
+    if (std::getline(fs_, scratch)) {
+        return std::make_optional<std::string_view>(scratch);
+    }
+    return std::nullopt;
+}
+
+// -------------------------------------------------------------
+std::optional<std::string> FileStruct::readAll() {
+    if (params_.mode == FileMode::Map) {
+        if (!map_.isOpen()) {
+            return std::nullopt;
+        }
+        return std::make_optional<std::string>(map_.readAll());
+    }
+
+    if (params_.mode != FileMode::Read || !fs_.is_open()) {
+        return std::nullopt;
+    }
+
+    std::string text;
+    const auto start = fs_.tellg();
+    if (start >= 0 && fs_.seekg(0, std::ios_base::end)) {
+        const auto end = fs_.tellg();
+        fs_.seekg(start);
+        text.resize(static_cast<std::size_t>(end - start));
+        fs_.read(text.data(), static_cast<std::streamsize>(text.size()));
+        text.resize(static_cast<std::size_t>(fs_.gcount()));
+    }
+    fs_.clear();
+    return std::make_optional(std::move(text));
+}
+
 // -------------------------------------------------------------
 void FileStruct::write(char c) {
     if (!fs_.put(c)) {
@@ -3,16 +3,19 @@
 
 #include "exception.h"
 
+#include <cstddef>
 #include <fstream>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace Ishlang {
 
     enum class FileMode : char {
         Read   = 'r',
         Write  = 'w',
-        Append = 'a'
+        Append = 'a',
+        Map    = 'm'
     };
 
     namespace FileModeNS {
@@ -25,6 +28,35 @@ namespace Ishlang {
     struct FileParams {
         std::string filename{};
         FileMode mode{FileMode::Read};
+        std::optional<char> csvDelimiter{}; // foreach yields csv rows
+    };
+
+    // Read only memory mapping of a whole file, read sequentially from the
+    // front. Lines are views of the mapping found with memchr, valid until
+    // the mapping is closed.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        bool open(const std::string &filename);
+        void close() noexcept;
+
+        inline bool isOpen() const noexcept;
+
+        std::optional<char> read();
+        std::optional<std::string_view> readln();
+        std::string_view readAll();
+
+    public:
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+    private:
+        const char  *data_ = nullptr;
+        std::size_t  size_ = 0;
+        std::size_t  pos_  = 0;
+        bool         open_ = false;
     };
 
     class FileStruct {
@@ -36,6 +68,7 @@ namespace Ishlang {
         inline const FileParams &params() const noexcept;
         inline const std::string &filename() const noexcept;
         inline FileMode mode() const noexcept;
+        inline std::optional<char> csvDelimiter() const noexcept;
 
         inline bool isOpen() const noexcept;
 
@@ -45,6 +78,13 @@ namespace Ishlang {
         std::optional<char> read();
         std::optional<std::string> readln();
 
+        // Line viewed in the mapping of mapped files, read into scratch
+        // otherwise. Valid until the next read.
+        std::optional<std::string_view> readlnView(std::string &scratch);
+
+        // Rest of the file, null unless open for reading.
+        std::optional<std::string> readAll();
+
         void write(char c);
         void write(const std::string &s);
         void writeln(char c);
@@ -60,6 +100,7 @@ namespace Ishlang {
     private:
         FileParams params_{};
         std::fstream fs_{};
+        MappedFile map_{};
     };
 
     // --------------------------------------------------------------------------------
@@ -69,10 +110,19 @@ namespace Ishlang {
         return static_cast<char>(mode);
     }
 
+    inline bool MappedFile::isOpen() const noexcept {
+        return open_;
+    }
+
     inline FileStruct::FileStruct(FileParams && params)
         : params_(std::move(params))
-        , fs_(params_.filename.c_str(), FileModeNS::toOpenMode(params_.mode))
     {
+        if (params_.mode == FileMode::Map) {
+            map_.open(params_.filename);
+        }
+        else {
+            fs_.open(params_.filename.c_str(), FileModeNS::toOpenMode(params_.mode));
+        }
         if (!isOpen()) {
             throw FileIOError(params_.filename, "Failed to open file");
         }
@@ -94,12 +144,17 @@ namespace Ishlang {
         return params_.mode;
     }
 
+    inline std::optional<char> FileStruct::csvDelimiter() const noexcept {
+        return params_.csvDelimiter;
+    }
+
     inline bool FileStruct::isOpen() const noexcept {
-        return fs_.is_open();
+        return params_.mode == FileMode::Map ? map_.isOpen() : fs_.is_open();
     }
 
     inline void FileStruct::close() {
-        fs_.close();
+        if (params_.mode == FileMode::Map) { map_.close(); }
+        else                               { fs_.close(); }
     }
 
     inline void FileStruct::flush() {
@@ -0,0 +1,504 @@
+#ifndef ISHLANG_FLAT_HASH_MAP_H
+#define ISHLANG_FLAT_HASH_MAP_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Ishlang {
+
+    // Open addressing hash map in the style of Swiss tables. Entries live in
+    // one flat array with a parallel array of control bytes, one per entry,
+    // holding the low 7 bits of the entry's hash or an empty/deleted marker.
+    // A lookup compares the control bytes of a group of 16 entries at once
+    // and only touches the entries whose byte matches. Groups are probed
+    // quadratically and the table grows at 7/8 load.
+    //
+    // The low 7 bits of the hash go to the control bytes and must be well
+    // mixed. The bits above them select the group, hashes close in those
+    // bits probe neighbouring groups.
+    template <typename Key, typename Mapped, typename Hash, typename KeyEqual = std::equal_to<Key>>
+    class FlatHashMap {
+    public:
+        using key_type    = Key;
+        using mapped_type = Mapped;
+        using value_type  = std::pair<Key, Mapped>;
+        using size_type   = std::size_t;
+
+        template <bool IsConst>
+        class Iterator;
+
+        using iterator       = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+    public:
+        FlatHashMap() noexcept = default;
+        FlatHashMap(const FlatHashMap &other);
+        FlatHashMap(FlatHashMap &&other) noexcept;
+        ~FlatHashMap();
+
+        FlatHashMap &operator=(const FlatHashMap &other);
+        FlatHashMap &operator=(FlatHashMap &&other) noexcept;
+
+        inline iterator find(const Key &key);
+        inline const_iterator find(const Key &key) const;
+
+        inline Mapped &operator[](const Key &key);
+
+        // Inserts when the key is not in the map yet.
+        inline std::pair<iterator, bool> emplace(const Key &key, const Mapped &mapped);
+
+        inline size_type erase(const Key &key);
+        inline void clear();
+
+        inline void reserve(size_type count);
+
+        inline size_type size() const noexcept;
+        inline bool empty() const noexcept;
+        inline size_type capacity() const noexcept;
+
+        inline iterator begin() noexcept;
+        inline iterator end() noexcept;
+        inline const_iterator begin() const noexcept;
+        inline const_iterator end() const noexcept;
+
+    public:
+        template <bool IsConst>
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = FlatHashMap::value_type;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = std::conditional_t<IsConst, const value_type *, value_type *>;
+            using reference         = std::conditional_t<IsConst, const value_type &, value_type &>;
+
+            Iterator() noexcept = default;
+
+            template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+            Iterator(const Iterator<OtherConst> &other) noexcept
+                : ctrl_(other.ctrl_)
+                , end_(other.end_)
+                , slot_(other.slot_)
+            {}
+
+            reference operator*() const noexcept { return *slot_; }
+            pointer operator->() const noexcept { return slot_; }
+
+            Iterator &operator++() noexcept {
+                ++ctrl_;
+                ++slot_;
+                skipFree();
+                return *this;
+            }
+
+            Iterator operator++(int) noexcept {
+                Iterator tmp(*this);
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept { return lhs.slot_ == rhs.slot_; }
+            friend bool operator!=(const Iterator &lhs, const Iterator &rhs) noexcept { return lhs.slot_ != rhs.slot_; }
+
+        private:
+            friend class FlatHashMap;
+            friend class Iterator<!IsConst>;
+
+            Iterator(const std::int8_t *ctrl, const std::int8_t *end, pointer slot) noexcept
+                : ctrl_(ctrl)
+                , end_(end)
+                , slot_(slot)
+            {}
+
+            void skipFree() noexcept {
+                while (ctrl_ != end_ && *ctrl_ < 0) {
+                    ++ctrl_;
+                    ++slot_;
+                }
+            }
+
+        private:
+            const std::int8_t *ctrl_ = nullptr;
+            const std::int8_t *end_ = nullptr;
+            pointer            slot_ = nullptr;
+        };
+
+    private:
+        static constexpr std::int8_t Empty   = -128;
+        static constexpr std::int8_t Deleted = -2;
+
+        static constexpr size_type NoIndex = static_cast<size_type>(-1);
+
+        // Control bytes of consecutive entries compared together. Each match
+        // returns a bit mask with bit i set when byte i matches.
+        class Group {
+        public:
+            static constexpr size_type Width = 16;
+
+            explicit Group(const std::int8_t *ctrl) noexcept
+#if defined(__SSE2__)
+                : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl)))
+#else
+                : ctrl_(ctrl)
+#endif
+            {}
+
+            std::uint32_t match(std::int8_t h2) const noexcept {
+#if defined(__SSE2__)
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+                return matchIf([h2](std::int8_t c) { return c == h2; });
+#endif
+            }
+
+            std::uint32_t matchEmpty() const noexcept {
+                return match(Empty);
+            }
+
+            // Empty and deleted are the only negative control bytes.
+            std::uint32_t matchFree() const noexcept {
+#if defined(__SSE2__)
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+                return matchIf([](std::int8_t c) { return c < 0; });
+#endif
+            }
+
+        private:
+#if defined(__SSE2__)
+            __m128i ctrl_;
+#else
+            template <typename Pred>
+            std::uint32_t matchIf(Pred pred) const noexcept {
+                std::uint32_t mask = 0;
+                for (size_type i = 0; i < Width; ++i) {
+                    mask |= static_cast<std::uint32_t>(pred(ctrl_[i])) << i;
+                }
+                return mask;
+            }
+
+            const std::int8_t *ctrl_;
+#endif
+        };
+
+        static constexpr size_type maxLoad(size_type capacity) noexcept { return capacity - capacity / 8; }
+        static constexpr std::int8_t h2(size_type hash) noexcept { return static_cast<std::int8_t>(hash & 0x7F); }
+
+        inline size_type findIndex(const Key &key, size_type hash) const;
+        inline size_type findFree(size_type hash) const noexcept;
+        inline size_type insertNew(const Key &key, const Mapped &mapped, size_type hash);
+
+        void rehash(size_type newCapacity);
+        void allocate(size_type capacity);
+        void destroy() noexcept;
+
+    private:
+        value_type  *slots_ = nullptr;
+        std::int8_t *ctrl_ = nullptr;
+        size_type    capacity_ = 0;
+        size_type    size_ = 0;
+        size_type    growthLeft_ = 0;
+
+        [[no_unique_address]] Hash     hash_;
+        [[no_unique_address]] KeyEqual equal_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    template <typename K, typename M, typename H, typename E>
+    FlatHashMap<K, M, H, E>::FlatHashMap(const FlatHashMap &other) {
+        if (other.size_ > 0) {
+            allocate(other.capacity_);
+            std::memcpy(ctrl_, other.ctrl_, capacity_);
+            for (size_type i = 0; i < capacity_; ++i) {
+                if (ctrl_[i] >= 0) {
+                    std::construct_at(slots_ + i, other.slots_[i]);
+                }
+            }
+            size_ = other.size_;
+            growthLeft_ = other.growthLeft_;
+        }
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    FlatHashMap<K, M, H, E>::FlatHashMap(FlatHashMap &&other) noexcept
+        : slots_(std::exchange(other.slots_, nullptr))
+        , ctrl_(std::exchange(other.ctrl_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0))
+        , size_(std::exchange(other.size_, 0))
+        , growthLeft_(std::exchange(other.growthLeft_, 0))
+    {}
+
+    template <typename K, typename M, typename H, typename E>
+    FlatHashMap<K, M, H, E>::~FlatHashMap() {
+        destroy();
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    auto FlatHashMap<K, M, H, E>::operator=(const FlatHashMap &other) -> FlatHashMap & {
+        if (this != &other) {
+            FlatHashMap tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    auto FlatHashMap<K, M, H, E>::operator=(FlatHashMap &&other) noexcept -> FlatHashMap & {
+        if (this != &other) {
+            destroy();
+            slots_ = std::exchange(other.slots_, nullptr);
+            ctrl_ = std::exchange(other.ctrl_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
+            size_ = std::exchange(other.size_, 0);
+            growthLeft_ = std::exchange(other.growthLeft_, 0);
+        }
+        return *this;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::find(const K &key) -> iterator {
+        const auto index = findIndex(key, hash_(key));
+        return index != NoIndex ? iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index) : end();
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::find(const K &key) const -> const_iterator {
+        const auto index = findIndex(key, hash_(key));
+        return index != NoIndex ? const_iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index) : end();
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline M &FlatHashMap<K, M, H, E>::operator[](const K &key) {
+        const size_type hash = hash_(key);
+        auto index = findIndex(key, hash);
+        if (index == NoIndex) {
+            index = insertNew(key, M(), hash);
+        }
+        return slots_[index].second;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::emplace(const K &key, const M &mapped) -> std::pair<iterator, bool> {
+        const size_type hash = hash_(key);
+        auto index = findIndex(key, hash);
+        const bool inserted = index == NoIndex;
+        if (inserted) {
+            index = insertNew(key, mapped, hash);
+        }
+        return {iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index), inserted};
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::erase(const K &key) -> size_type {
+        const auto index = findIndex(key, hash_(key));
+        if (index == NoIndex) {
+            return 0;
+        }
+
+        // An entry can go back to empty when its group still has an empty
+        // byte: that group was never full, so no probe went past it.
+        if (Group(ctrl_ + (index & ~(Group::Width - 1))).matchEmpty()) {
+            ctrl_[index] = Empty;
+            ++growthLeft_;
+        }
+        else {
+            ctrl_[index] = Deleted;
+        }
+        --size_;
+        std::destroy_at(slots_ + index);
+        return 1;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline void FlatHashMap<K, M, H, E>::clear() {
+        for (size_type i = 0; i < capacity_; ++i) {
+            if (ctrl_[i] >= 0) {
+                ctrl_[i] = Empty;
+                std::destroy_at(slots_ + i);
+            }
+        }
+        if (capacity_ > 0) {
+            std::memset(ctrl_, static_cast<unsigned char>(Empty), capacity_);
+        }
+        size_ = 0;
+        growthLeft_ = maxLoad(capacity_);
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline void FlatHashMap<K, M, H, E>::reserve(size_type count) {
+        size_type capacity = capacity_ > 0 ? capacity_ : Group::Width;
+        while (maxLoad(capacity) < count) {
+            capacity *= 2;
+        }
+        if (capacity != capacity_) {
+            rehash(capacity);
+        }
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::size() const noexcept -> size_type {
+        return size_;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline bool FlatHashMap<K, M, H, E>::empty() const noexcept {
+        return size_ == 0;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::capacity() const noexcept -> size_type {
+        return capacity_;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::begin() noexcept -> iterator {
+        iterator iter(ctrl_, ctrl_ + capacity_, slots_);
+        iter.skipFree();
+        return iter;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::end() noexcept -> iterator {
+        return iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_);
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::begin() const noexcept -> const_iterator {
+        const_iterator iter(ctrl_, ctrl_ + capacity_, slots_);
+        iter.skipFree();
+        return iter;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::end() const noexcept -> const_iterator {
+        return const_iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_);
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::findIndex(const K &key, size_type hash) const -> size_type {
+        if (size_ == 0) {
+            return NoIndex;
+        }
+
+        const size_type mask = capacity_ / Group::Width - 1;
+        const std::int8_t tag = h2(hash);
+        size_type group = (hash >> 7) & mask;
+        for (size_type step = 1; ; ++step) {
+            const size_type base = group * Group::Width;
+            const Group g(ctrl_ + base);
+            for (auto bits = g.match(tag); bits != 0; bits &= bits - 1) {
+                const size_type index = base + std::countr_zero(bits);
+                if (equal_(slots_[index].first, key)) {
+                    return index;
+                }
+            }
+            if (g.matchEmpty()) {
+                return NoIndex;
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::findFree(size_type hash) const noexcept -> size_type {
+        const size_type mask = capacity_ / Group::Width - 1;
+        size_type group = (hash >> 7) & mask;
+        for (size_type step = 1; ; ++step) {
+            const size_type base = group * Group::Width;
+            if (const auto bits = Group(ctrl_ + base).matchFree(); bits != 0) {
+                return base + std::countr_zero(bits);
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    inline auto FlatHashMap<K, M, H, E>::insertNew(const K &key, const M &mapped, size_type hash) -> size_type {
+        size_type index = capacity_ > 0 ? findFree(hash) : NoIndex;
+        if (index == NoIndex || (growthLeft_ == 0 && ctrl_[index] == Empty)) {
+            // Out of room, grow when live entries fill more than half the
+            // load, otherwise the room was taken by deleted entries.
+            rehash(capacity_ == 0
+                   ? Group::Width
+                   : size_ > maxLoad(capacity_) / 2 ? capacity_ * 2 : capacity_);
+            index = findFree(hash);
+        }
+
+        std::construct_at(slots_ + index, key, mapped);
+        if (ctrl_[index] == Empty) {
+            --growthLeft_;
+        }
+        ctrl_[index] = h2(hash);
+        ++size_;
+        return index;
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    void FlatHashMap<K, M, H, E>::rehash(size_type newCapacity) {
+        value_type *oldSlots = slots_;
+        std::int8_t *oldCtrl = ctrl_;
+        const size_type oldCapacity = capacity_;
+
+        allocate(newCapacity);
+        for (size_type i = 0; i < oldCapacity; ++i) {
+            if (oldCtrl[i] >= 0) {
+                const size_type hash = hash_(oldSlots[i].first);
+                const size_type index = findFree(hash);
+                ctrl_[index] = h2(hash);
+                std::construct_at(slots_ + index, std::move(oldSlots[i]));
+                std::destroy_at(oldSlots + i);
+            }
+        }
+        growthLeft_ = maxLoad(capacity_) - size_;
+
+        if (oldSlots) {
+            ::operator delete(oldSlots);
+        }
+    }
+
+    // Entries and control bytes share one allocation, entries first.
+    template <typename K, typename M, typename H, typename E>
+    void FlatHashMap<K, M, H, E>::allocate(size_type capacity) {
+        static_assert(alignof(value_type) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+        void *memory = ::operator new(capacity * (sizeof(value_type) + 1));
+        slots_ = static_cast<value_type *>(memory);
+        ctrl_ = reinterpret_cast<std::int8_t *>(slots_ + capacity);
+        capacity_ = capacity;
+        growthLeft_ = maxLoad(capacity);
+        std::memset(ctrl_, static_cast<unsigned char>(Empty), capacity);
+    }
+
+    template <typename K, typename M, typename H, typename E>
+    void FlatHashMap<K, M, H, E>::destroy() noexcept {
+        if (slots_) {
+            for (size_type i = 0; i < capacity_; ++i) {
+                if (ctrl_[i] >= 0) {
+                    std::destroy_at(slots_ + i);
+                }
+            }
+            ::operator delete(slots_);
+            slots_ = nullptr;
+            ctrl_ = nullptr;
+            capacity_ = 0;
+            size_ = 0;
+            growthLeft_ = 0;
+        }
+    }
+
+}
+
+#endif	// ISHLANG_FLAT_HASH_MAP_H
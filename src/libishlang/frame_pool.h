@@ -0,0 +1,140 @@
+#ifndef ISHLANG_FRAME_POOL_H
+#define ISHLANG_FRAME_POOL_H
+
+#include <cstddef>
+#include <new>
+
+namespace Ishlang {
+
+    // Per thread free list of fixed size blocks, used to recycle the
+    // storage of short lived frames instead of returning it to the heap
+    // on every call. Blocks released after the owning thread started
+    // tearing down its pools go straight back to the heap.
+    template <std::size_t Size>
+    class FramePool {
+    public:
+        static constexpr std::size_t MaxFree = 256;
+
+    public:
+        static inline void *allocate();
+        static inline void deallocate(void *ptr) noexcept;
+
+        static inline std::size_t freeCount() noexcept;
+
+    private:
+        struct Block {
+            Block *next;
+        };
+
+        struct FreeList {
+            Block       *head = nullptr;
+            std::size_t  count = 0;
+            bool         closed = false;
+        };
+
+        struct Drainer {
+            ~Drainer();
+            bool active = false;
+        };
+
+        static_assert(Size >= sizeof(Block));
+
+        static thread_local FreeList freeList_;
+        static thread_local Drainer  drainer_;
+    };
+
+    // Standard allocator over FramePool, for use with std::allocate_shared.
+    template <typename T>
+    class FrameAllocator {
+    public:
+        using value_type = T;
+
+    public:
+        FrameAllocator() noexcept = default;
+
+        template <typename U>
+        FrameAllocator(const FrameAllocator<U> &) noexcept {}
+
+        inline T *allocate(std::size_t n);
+        inline void deallocate(T *ptr, std::size_t n) noexcept;
+
+        template <typename U>
+        inline bool operator==(const FrameAllocator<U> &) const noexcept { return true; }
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    template <std::size_t Size>
+    thread_local typename FramePool<Size>::FreeList FramePool<Size>::freeList_;
+
+    template <std::size_t Size>
+    thread_local typename FramePool<Size>::Drainer FramePool<Size>::drainer_;
+
+    template <std::size_t Size>
+    FramePool<Size>::Drainer::~Drainer() {
+        auto &list = freeList_;
+        while (list.head) {
+            auto block = list.head;
+            list.head = block->next;
+            ::operator delete(block);
+        }
+        list.count = 0;
+        list.closed = true;
+    }
+
+    template <std::size_t Size>
+    inline void *FramePool<Size>::allocate() {
+        auto &list = freeList_;
+        if (list.head) {
+            auto block = list.head;
+            list.head = block->next;
+            --list.count;
+            return block;
+        }
+        if (!list.closed) {
+            // Registers the drainer for this thread
+            drainer_.active = true;
+        }
+        return ::operator new(Size);
+    }
+
+    template <std::size_t Size>
+    inline void FramePool<Size>::deallocate(void *ptr) noexcept {
+        auto &list = freeList_;
+        if (list.closed || list.count >= MaxFree) {
+            ::operator delete(ptr);
+            return;
+        }
+        auto block = static_cast<Block *>(ptr);
+        block->next = list.head;
+        list.head = block;
+        ++list.count;
+    }
+
+    template <std::size_t Size>
+    inline std::size_t FramePool<Size>::freeCount() noexcept {
+        return freeList_.count;
+    }
+
+    template <typename T>
+    inline T *FrameAllocator<T>::allocate(std::size_t n) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        if (n != 1) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(FramePool<sizeof(T)>::allocate());
+    }
+
+    template <typename T>
+    inline void FrameAllocator<T>::deallocate(T *ptr, std::size_t n) noexcept {
+        if (n != 1) {
+            ::operator delete(ptr);
+            return;
+        }
+        FramePool<sizeof(T)>::deallocate(ptr);
+    }
+
+}
+
+#endif	// ISHLANG_FRAME_POOL_H
@@ -0,0 +1,64 @@
+#include "future.h"
+#include "thread_pool.h"
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+Future::Future(std::shared_ptr<State> state)
+    : state_(std::move(state))
+{}
+
+// -------------------------------------------------------------
+Future Future::spawn(Task task) {
+    auto state = std::make_shared<State>();
+    ThreadPool::instance().submit(
+        [state, task = std::move(task)]() {
+            Value value;
+            std::exception_ptr error;
+            try {
+                value = task();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard lock(state->mutex);
+            state->value = std::move(value);
+            state->error = error;
+            state->ready = true;
+            state->done.notify_all();
+        });
+    return Future(std::move(state));
+}
+
+// -------------------------------------------------------------
+Value Future::await() const {
+    if (!state_) { return Value::Null; }
+
+    auto &state = *state_;
+    auto &pool = ThreadPool::instance();
+    std::unique_lock lock(state.mutex);
+    while (!state.ready) {
+        lock.unlock();
+        const bool helped = pool.help();
+        lock.lock();
+
+        // Nothing left to help with, the task is running on another thread
+        if (!helped && !state.ready) {
+            state.done.wait(lock);
+        }
+    }
+
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+    return state.value;
+}
+
+// -------------------------------------------------------------
+bool Future::ready() const {
+    if (!state_) { return true; }
+
+    std::lock_guard lock(state_->mutex);
+    return state_->ready;
+}
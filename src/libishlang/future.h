@@ -0,0 +1,74 @@
+#ifndef ISHLANG_FUTURE_H
+#define ISHLANG_FUTURE_H
+
+#include "value.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace Ishlang {
+
+    // Result of a task spawned on the thread pool. Copies share the task,
+    // which runs once. Waiting for it runs other queued jobs meanwhile, so
+    // tasks may wait for tasks they spawned without tying up the pool.
+    class Future {
+    public:
+        using Task = std::function<Value ()>;
+
+    public:
+        Future() = default;
+
+        static Future spawn(Task task);
+
+        // Value of the task, or its exception rethrown.
+        Value await() const;
+
+        bool ready() const;
+
+        inline const void *identity() const noexcept;
+
+        inline bool operator==(const Future &rhs) const noexcept;
+        inline bool operator!=(const Future &rhs) const noexcept;
+
+    private:
+        struct State {
+            std::mutex              mutex;
+            std::condition_variable done;
+            bool                    ready = false;
+            Value                   value;
+            std::exception_ptr      error;
+        };
+
+        explicit Future(std::shared_ptr<State> state);
+
+    private:
+        std::shared_ptr<State> state_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline const void *Future::identity() const noexcept {
+        return state_.get();
+    }
+
+    inline bool Future::operator==(const Future &rhs) const noexcept {
+        return state_ == rhs.state_;
+    }
+
+    inline bool Future::operator!=(const Future &rhs) const noexcept {
+        return state_ != rhs.state_;
+    }
+
+    inline std::ostream &operator<<(std::ostream &out, const Future &future) {
+        out << (future.ready() ? "[Future:ready]" : "[Future:pending]");
+        return out;
+    }
+
+}
+
+#endif // ISHLANG_FUTURE_H
@@ -0,0 +1,257 @@
+#include "garbage_collector.h"
+#include "environment.h"
+#include "generic_table.h"
+#include "instance.h"
+#include "lambda.h"
+#include "sequence.h"
+#include "value.h"
+#include "value_pair.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+class GarbageCollector::Collection {
+public:
+    explicit Collection(GarbageCollector &collector) : collector_(collector), nodes_() {}
+
+    std::size_t run();
+
+private:
+    using Box = Value::Box;
+
+    struct Node {
+        std::size_t                refs;
+        Box                       *box;
+        Environment               *env;
+        std::weak_ptr<Environment> envRef;
+        bool                       reachable;
+    };
+
+    void addNodes();
+    void addEnvironments(const Environment::SharedPtr &env);
+    void subtractInternalRefs();
+    void markReachable();
+    std::size_t clearGarbage();
+
+    template <typename Function>
+    void foreachChild(const Node &node, Function &&ftn) const;
+
+    template <typename T>
+    static inline T &object(Box *box) noexcept;
+
+private:
+    GarbageCollector                       &collector_;
+    std::unordered_map<const void *, Node>  nodes_;
+};
+
+// -------------------------------------------------------------
+template <typename T>
+inline T &GarbageCollector::Collection::object(Box *box) noexcept {
+    return *reinterpret_cast<T *>(box + 1);
+}
+
+// -------------------------------------------------------------
+std::size_t GarbageCollector::Collection::run() {
+    addNodes();
+    subtractInternalRefs();
+    markReachable();
+    return clearGarbage();
+}
+
+// -------------------------------------------------------------
+void GarbageCollector::Collection::addNodes() {
+    const auto head = &collector_.head_;
+    nodes_.reserve(2 * collector_.stats_.tracked);
+    for (auto link = head->next; link != head; link = link->next) {
+        auto box = reinterpret_cast<Box *>(link + 1);
+        nodes_.emplace(box, Node{box->refs.count(), box, nullptr, {}, false});
+        if (box->type == Value::eClosure) {
+            addEnvironments(object<Lambda>(box).env_);
+        }
+    }
+}
+
+// -------------------------------------------------------------
+void GarbageCollector::Collection::addEnvironments(const Environment::SharedPtr &env) {
+    // Walk through references, a local copy would add to the counts
+    for (auto ptr = &env; *ptr && !nodes_.contains(ptr->get()); ptr = &(*ptr)->parent_) {
+        nodes_.emplace(ptr->get(), Node{static_cast<std::size_t>(ptr->use_count()), nullptr, ptr->get(), *ptr, false});
+    }
+}
+
+// -------------------------------------------------------------
+void GarbageCollector::Collection::subtractInternalRefs() {
+    for (const auto &[key, node] : nodes_) {
+        foreachChild(node, [this](const void *child) {
+            if (auto iter = nodes_.find(child); iter != nodes_.end()) {
+                --iter->second.refs;
+            }
+        });
+    }
+}
+
+// -------------------------------------------------------------
+void GarbageCollector::Collection::markReachable() {
+    std::vector<Node *> pending;
+    for (auto &[key, node] : nodes_) {
+        if (node.refs > 0) {
+            node.reachable = true;
+            pending.push_back(&node);
+        }
+    }
+
+    while (!pending.empty()) {
+        const auto node = pending.back();
+        pending.pop_back();
+        foreachChild(*node, [this, &pending](const void *child) {
+            if (auto iter = nodes_.find(child); iter != nodes_.end() && !iter->second.reachable) {
+                iter->second.reachable = true;
+                pending.push_back(&iter->second);
+            }
+        });
+    }
+}
+
+// -------------------------------------------------------------
+std::size_t GarbageCollector::Collection::clearGarbage() {
+    // Garbage is kept alive until every cycle is broken, so clearing one
+    // object never frees another one still to be cleared.
+    std::vector<Value> boxes;
+    std::vector<Environment::SharedPtr> envs;
+    for (auto &[key, node] : nodes_) {
+        if (node.reachable) { continue; }
+        if (node.box) {
+            Value held;
+            held.value_.box = node.box;
+            held.type_ = node.box->type;
+            held.heap_ = true;
+            held.retain();
+            boxes.push_back(std::move(held));
+        }
+        else if (auto env = node.envRef.lock()) {
+            envs.push_back(std::move(env));
+        }
+    }
+
+    for (auto &env : envs) {
+        env->clear();
+    }
+    for (auto &value : boxes) {
+        switch (value.type()) {
+        case Value::eUserObject: value.userObject().slots_.clear();   break;
+        case Value::eArray:      value.array().clear();               break;
+        case Value::eHashMap:    value.hashMap().clear();             break;
+        case Value::eOrderedMap: value.orderedMap().clear();          break;
+        default:                                                      break;
+        }
+    }
+
+    return boxes.size() + envs.size();
+}
+
+// -------------------------------------------------------------
+template <typename Function>
+void GarbageCollector::Collection::foreachChild(const Node &node, Function &&ftn) const {
+    auto visit = [&ftn](const Value &value) {
+        if (value.heap_ && Value::tracked(value.type_)) {
+            ftn(value.value_.box);
+        }
+    };
+
+    if (node.env) {
+        const auto &env = *node.env;
+        if (env.parent_) { ftn(env.parent_.get()); }
+        for (const auto &[iden, value] : env.table_) {
+            visit(value);
+        }
+        for (std::size_t slot = 0; slot < env.numSlots_; ++slot) {
+            visit(env.slots_[slot].value);
+        }
+        return;
+    }
+
+    switch (node.box->type) {
+    case Value::ePair: {
+        const auto &pair = object<ValuePair>(node.box);
+        visit(pair.first());
+        visit(pair.second());
+        break;
+    }
+    case Value::eClosure: {
+        const auto &env = object<Lambda>(node.box).env_;
+        if (env) { ftn(env.get()); }
+        break;
+    }
+    case Value::eUserObject:
+        for (const auto &value : object<Instance>(node.box).slots_) {
+            visit(value);
+        }
+        break;
+    case Value::eArray:
+        if (const auto &arr = object<Sequence>(node.box); arr.packing() == Sequence::Boxed) {
+            std::ranges::for_each(arr, visit);
+        }
+        break;
+    case Value::eHashMap:
+        for (const auto &[key, value] : object<Hashtable>(node.box)) {
+            visit(key);
+            visit(value);
+        }
+        break;
+    case Value::eOrderedMap:
+        for (const auto &[key, value] : object<OrderedTable>(node.box)) {
+            visit(key);
+            visit(value);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// -------------------------------------------------------------
+constinit GarbageCollector GarbageCollector::process_;
+
+// -------------------------------------------------------------
+GarbageCollector::~GarbageCollector() {
+    release();
+}
+
+// -------------------------------------------------------------
+std::size_t GarbageCollector::collect() {
+    if (shared()) { return 0; }
+
+    collecting_ = true;
+    std::size_t reclaimed = 0;
+    try {
+        reclaimed = Collection(*this).run();
+    }
+    catch (...) {
+        collecting_ = false;
+        throw;
+    }
+    collecting_ = false;
+
+    ++stats_.collections;
+    stats_.reclaimed += reclaimed;
+    stats_.threshold = std::max(MinThreshold, stats_.tracked);
+    allocations_ = 0;
+    return reclaimed;
+}
+
+// -------------------------------------------------------------
+void GarbageCollector::release() noexcept {
+    for (auto link = head_.next; link != &head_;) {
+        const auto next = link->next;
+        link->prev = link->next = link;
+        link = next;
+    }
+    head_.prev = head_.next = &head_;
+    stats_.tracked = 0;
+    allocations_ = 0;
+}
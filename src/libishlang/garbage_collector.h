@@ -0,0 +1,188 @@
+#ifndef ISHLANG_GARBAGE_COLLECTOR_H
+#define ISHLANG_GARBAGE_COLLECTOR_H
+
+#include "ref_count.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace Ishlang {
+
+    // List link placed in front of heap objects that can take part in a
+    // reference cycle.
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) GcLink {
+        GcLink *prev;
+        GcLink *next;
+    };
+
+    // Frees reference cycles, which counting alone never reclaims: a
+    // closure defined into the environment it captures, or a container
+    // holding itself. Pairs, closures, instances, arrays and maps are
+    // tracked from allocation, environments are reached through the
+    // closures capturing them.
+    //
+    // A collection uses trial deletion. References coming from tracked
+    // objects are subtracted from each object's count. Objects left with
+    // outside references, and everything they reach, are alive. The rest
+    // is garbage, its containers and environments are cleared to break the
+    // cycles and the objects are freed by their counts.
+    //
+    // Collections run at safe points, function calls and loop iterations,
+    // once the number of tracked objects grew enough since the last one.
+    // Objects freed by their counts before then do not count, so loops
+    // creating short lived pairs or closures do not trigger collections.
+    //
+    // Each interpreter context has its own collector, installed on the
+    // threads evaluating its code. Code run outside of any context uses
+    // one for the whole process. Objects must be released under the
+    // collector that tracks them.
+    //
+    // Collections are paused while pool threads run interpreted code for
+    // the context, objects are then linked into and out of the list under
+    // a lock.
+    class GarbageCollector {
+    public:
+        static constexpr std::size_t MinThreshold = 10000;
+
+        struct Stats {
+            std::size_t collections = 0;
+            std::size_t reclaimed   = 0;
+            std::size_t tracked     = 0;
+            std::size_t threshold   = MinThreshold;
+        };
+
+        class Pause;
+
+    public:
+        constexpr GarbageCollector() noexcept;
+        ~GarbageCollector();
+
+        GarbageCollector(const GarbageCollector &) = delete;
+        GarbageCollector &operator=(const GarbageCollector &) = delete;
+
+        // Returns the number of objects reclaimed, none while paused.
+        std::size_t collect();
+
+        inline void safePoint();
+        inline const Stats &stats() const noexcept;
+
+        inline void track(GcLink *link) noexcept;
+        inline void untrack(GcLink *link) noexcept;
+
+    public:
+        // Collector installed on this thread, or the process one.
+        static inline GarbageCollector &current() noexcept;
+
+    private:
+        friend class Context;
+
+        class Collection;
+
+        inline bool shared() const noexcept;
+        inline void insert(GcLink *link) noexcept;
+        inline void remove(GcLink *link) noexcept;
+
+        // Unlinks the objects still tracked, they are left to their counts.
+        void release() noexcept;
+
+    private:
+        GcLink                   head_;
+        Stats                    stats_;
+        std::size_t              allocations_;
+        bool                     collecting_;
+        std::atomic<std::size_t> paused_;
+        std::mutex               mutex_;
+
+        static GarbageCollector process_;
+        static constinit inline thread_local GarbageCollector *current_ = nullptr;
+    };
+
+    // Holds off collections of the current collector for its lifetime.
+    class GarbageCollector::Pause {
+    public:
+        Pause() noexcept : collector_(current()) { collector_.paused_.fetch_add(1, std::memory_order_relaxed); }
+        ~Pause() { collector_.paused_.fetch_sub(1, std::memory_order_release); }
+
+        Pause(const Pause &) = delete;
+        Pause &operator=(const Pause &) = delete;
+
+    private:
+        GarbageCollector &collector_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    constexpr GarbageCollector::GarbageCollector() noexcept
+        : head_{&head_, &head_}
+        , stats_()
+        , allocations_(0)
+        , collecting_(false)
+        , paused_(0)
+        , mutex_()
+    {}
+
+    inline GarbageCollector &GarbageCollector::current() noexcept {
+        return current_ ? *current_ : process_;
+    }
+
+    inline void GarbageCollector::safePoint() {
+        if (!shared() && allocations_ >= stats_.threshold && !collecting_) {
+            collect();
+        }
+    }
+
+    inline auto GarbageCollector::stats() const noexcept -> const Stats & {
+        return stats_;
+    }
+
+    inline void GarbageCollector::track(GcLink *link) noexcept {
+        if (shared()) {
+            std::lock_guard lock(mutex_);
+            insert(link);
+        }
+        else {
+            insert(link);
+        }
+    }
+
+    inline void GarbageCollector::untrack(GcLink *link) noexcept {
+        if (shared()) {
+            std::lock_guard lock(mutex_);
+            remove(link);
+        }
+        else {
+            remove(link);
+        }
+    }
+
+    // Pool threads only run code for a context while its collector is
+    // paused, the last one to finish releases its changes to the list
+    inline bool GarbageCollector::shared() const noexcept {
+        return paused_.load(std::memory_order_acquire) > 0;
+    }
+
+    inline void GarbageCollector::insert(GcLink *link) noexcept {
+        link->prev = &head_;
+        link->next = head_.next;
+        head_.next->prev = link;
+        head_.next = link;
+        ++stats_.tracked;
+        ++allocations_;
+    }
+
+    inline void GarbageCollector::remove(GcLink *link) noexcept {
+        if (link->next == link) { return; }
+        link->prev->next = link->next;
+        link->next->prev = link->prev;
+        --stats_.tracked;
+        // Objects allocated before the last collection were not counted
+        // since, freeing them must not let later allocations go uncounted
+        // and push the next collection past the threshold.
+        if (allocations_ > 0) { --allocations_; }
+    }
+
+}
+
+#endif	// ISHLANG_GARBAGE_COLLECTOR_H
@@ -0,0 +1,55 @@
+#include "generator.h"
+#include "code_node.h"
+#include "exception.h"
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+Generator::Generator(CodeNode::SharedPtr body, Environment::SharedPtr env)
+    : state_(std::make_shared<State>())
+{
+    state_->body = body;
+    if (body) {
+        state_->routine = body->generate(env);
+    }
+}
+
+// -------------------------------------------------------------
+std::optional<Value> Generator::next() const {
+    if (!state_ || state_->done) { return std::nullopt; }
+
+    auto &state = *state_;
+    if (state.running) { throw InvalidExpression("generator is already running"); }
+
+    bool yielded = false;
+    state.running = true;
+    try {
+        yielded = state.routine.resume();
+    }
+    catch (const Return::Except &) {
+        // Return outside of statement position ends the body
+    }
+    catch (...) {
+        finish(state);
+        throw;
+    }
+
+    if (yielded) {
+        state.running = false;
+        return state.routine.value();
+    }
+
+    // Return in statement position ends the body
+    if (ControlSignal::pending() == ControlSignal::Return) {
+        ControlSignal::clear();
+    }
+    finish(state);
+    return std::nullopt;
+}
+
+// -------------------------------------------------------------
+void Generator::finish(State &state) noexcept {
+    state.running = false;
+    state.done = true;
+    state.routine = Routine();
+}
@@ -0,0 +1,74 @@
+#ifndef ISHLANG_GENERATOR_H
+#define ISHLANG_GENERATOR_H
+
+#include "code_node_bases.h"
+#include "environment.h"
+#include "routine.h"
+#include "value.h"
+
+#include <memory>
+#include <optional>
+#include <ostream>
+
+namespace Ishlang {
+
+    // Value of a generator function call, its body evaluated in the scope
+    // of the call up to each yield, as items are requested. Copies share
+    // the position, so a generator is consumed once, by one thread at a
+    // time.
+    class Generator {
+    public:
+        Generator() = default;
+        Generator(CodeNode::SharedPtr body, Environment::SharedPtr env);
+
+        // Next value yielded, nullopt once the body finished.
+        std::optional<Value> next() const;
+
+        inline bool done() const noexcept;
+
+        inline const void *identity() const noexcept;
+
+        inline bool operator==(const Generator &rhs) const noexcept;
+        inline bool operator!=(const Generator &rhs) const noexcept;
+
+    private:
+        struct State {
+            CodeNode::SharedPtr body;
+            Routine             routine;
+            bool                running = false;
+            bool                done = false;
+        };
+
+        static void finish(State &state) noexcept;
+
+    private:
+        std::shared_ptr<State> state_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline bool Generator::done() const noexcept {
+        return !state_ || state_->done;
+    }
+
+    inline const void *Generator::identity() const noexcept {
+        return state_.get();
+    }
+
+    inline bool Generator::operator==(const Generator &rhs) const noexcept {
+        return state_ == rhs.state_;
+    }
+
+    inline bool Generator::operator!=(const Generator &rhs) const noexcept {
+        return state_ != rhs.state_;
+    }
+
+    inline std::ostream &operator<<(std::ostream &out, const Generator &generator) {
+        out << (generator.done() ? "[Generator:done]" : "[Generator:active]");
+        return out;
+    }
+
+}
+
+#endif // ISHLANG_GENERATOR_H
@@ -2,10 +2,16 @@
 #define ISHLANG_GENERIC_FUNCTIONS_H
 
 #include "code_node_util.h"
+#include "generator.h"
+#include "iterator.h"
 #include "lambda.h"
+#include "thread_pool.h"
 #include "value.h"
 
+#include <algorithm>
 #include <concepts>
+#include <optional>
+#include <vector>
 
 namespace Ishlang {
 
@@ -29,6 +35,13 @@ namespace Ishlang {
             return Value(Value::Long(obj.size()));
         }
 
+        // Iterators are counted by drawing their items.
+        static inline Value length(const Value::Stream &obj) {
+            Value::Long count = 0;
+            while (obj.next()) { ++count; }
+            return Value(count);
+        }
+
         template <Sizable ObjectType>
         static inline Value empty(const ObjectType &obj) {
             return Value(obj.size() == 0);
@@ -56,6 +69,7 @@ namespace Ishlang {
             else {
                 static_assert(std::is_same_v<ObjectType, Value::Text> ||
                               std::is_same_v<ObjectType, Value::Array> ||
+                              std::is_same_v<ObjectType, Value::NdArray> ||
                               std::is_same_v<ObjectType, Value::Pair>);
 
                 if (!key.isInt()) {
@@ -83,6 +97,17 @@ namespace Ishlang {
             return Value(obj.get(memberName));
         }
 
+        static inline Value get(const Value::UserObject &obj, const std::string &memberName, Struct::SlotHint &slotHint) {
+            return Value(obj.get(memberName, slotHint));
+        }
+
+        static inline Value get(const Value::UserObject &obj, const Value &key, Struct::SlotHint &slotHint) {
+            if (!key.isString()) {
+                throw InvalidOperandType(Value::typeToString(Value::eString), key.typeToString());
+            }
+            return Value(obj.get(key.text(), slotHint));
+        }
+
         template <typename ObjectType>
         static inline void set(ObjectType &obj, const Value &key, const Value &value) {
             if constexpr (std::is_same_v<ObjectType, Value::HashMap> ||
@@ -96,7 +121,9 @@ namespace Ishlang {
                 obj.set(key.text(), value);
             }
             else {
-                static_assert(std::is_same_v<ObjectType, Value::Text> || std::is_same_v<ObjectType, Value::Array>);
+                static_assert(std::is_same_v<ObjectType, Value::Text> ||
+                              std::is_same_v<ObjectType, Value::Array> ||
+                              std::is_same_v<ObjectType, Value::NdArray>);
 
                 if (!key.isInt()) {
                     throw InvalidOperandType(Value::typeToString(Value::eInteger), key.typeToString());
@@ -123,6 +150,17 @@ namespace Ishlang {
             obj.set(memberName, value);
         }
 
+        static inline void set(Value::UserObject &obj, const std::string &memberName, Struct::SlotHint &slotHint, const Value &value) {
+            obj.set(memberName, slotHint, value);
+        }
+
+        static inline void set(Value::UserObject &obj, const Value &key, Struct::SlotHint &slotHint, const Value &value) {
+            if (!key.isString()) {
+                throw InvalidOperandType(Value::typeToString(Value::eString), key.typeToString());
+            }
+            obj.set(key.text(), slotHint, value);
+        }
+
         template <typename ObjectType>
         static inline Value find(const ObjectType &obj, const Value &item, const Value &pos = Value::Zero) {
             if constexpr (std::is_same_v<ObjectType, Value::HashMap> ||
@@ -228,6 +266,9 @@ namespace Ishlang {
                 const auto n = Value::Long(obj.size());
                 return Value(n * ( (Two * obj.begin()) + ((n - One) * obj.step()) ) / Two);
             }
+            else if constexpr (std::is_same_v<ObjectType, Value::NdArray>) {
+                return Value(obj.sum());
+            }
             else if constexpr (std::is_same_v<ObjectType, Value::Pair>) {
                 auto const &f = obj.first();
                 auto const &s = obj.second();
@@ -242,32 +283,31 @@ namespace Ishlang {
             }
             else {
                 static_assert(std::is_same_v<ObjectType, Value::Array>);
+                return obj.sum();
+            }
+        }
 
-                bool anyReal = false;
-                for (const auto &val : obj) {
-                    if (val.isReal()) {
-                        anyReal = true;
-                    }
-                    else if (!val.isInt()) {
-                        throw InvalidExpression("Unexpected non-numeric sum argument");
-                    }
+        // Generators and iterators are summed as their items are drawn.
+        template <typename ObjectType>
+        requires (std::is_same_v<ObjectType, Value::Coroutine> || std::is_same_v<ObjectType, Value::Stream>)
+        static inline Value sum(const ObjectType &obj) {
+            Value::Long intSum = 0;
+            Value::Double realSum = 0.0;
+            bool anyReal = false;
+            foreachItem(obj, [&](const Value &item) {
+                if (item.isInt()) {
+                    intSum += item.integer();
                 }
-
-                if (anyReal) {
-                    return Value(std::accumulate(
-                                     obj.begin() + 1,
-                                     obj.end(),
-                                     obj.begin()->real(),
-                                     [](Value::Double a, const Value & v) { return a + v.real(); }));
+                else if (item.isReal()) {
+                    realSum += item.real();
+                    anyReal = true;
                 }
                 else {
-                    return Value(std::accumulate(
-                                     obj.begin() + 1,
-                                     obj.end(),
-                                     obj.begin()->integer(),
-                                     [](Value::Long a, const Value & v) { return a + v.integer(); }));
+                    throw InvalidExpression("Unexpected non-numeric sum argument");
                 }
-            }
+                return true;
+            });
+            return anyReal ? Value(realSum + static_cast<Value::Double>(intSum)) : Value(intSum);
         }
 
         template <Sizable ObjectType>
@@ -286,7 +326,7 @@ namespace Ishlang {
                 return ftn.exec(ftnArgs);
             }
             else if constexpr (std::is_same_v<ObjectType, Value::Pair>) {
-                Lambda::ArgList ftnArgs = { obj.first(), obj.second() };
+                const Value ftnArgs[] = { obj.first(), obj.second() };
                 return ftn.exec(ftnArgs);
             }
             else {
@@ -296,6 +336,252 @@ namespace Ishlang {
                 return ftn.exec(ftnArgs);
             }
         }
+
+        // Strings map to strings and filter to strings, arrays to arrays,
+        // pairs map to pairs, maps call the function with key value pairs
+        // and map and filter to maps, ranges and generators map and filter
+        // to arrays.
+        template <typename ObjectType>
+        static inline Value map(const ObjectType &obj, const Lambda &ftn) {
+            if constexpr (std::is_same_v<ObjectType, Value::Text>) {
+                Value::Text result;
+                result.reserve(obj.size());
+                for (const auto c : obj) {
+                    const Value item = call(ftn, Value(c));
+                    if (!item.isChar()) {
+                        throw InvalidExpressionType(Value::typeToString(Value::eCharacter), item.typeToString());
+                    }
+                    result.push_back(item.character());
+                }
+                return Value(std::move(result));
+            }
+            else if constexpr (std::is_same_v<ObjectType, Value::Pair>) {
+                return Value(Value::Pair(call(ftn, obj.first()), call(ftn, obj.second())));
+            }
+            else if constexpr (std::is_same_v<ObjectType, Value::HashMap> ||
+                               std::is_same_v<ObjectType, Value::OrderedMap>) {
+                ObjectType result;
+                foreachItem(obj, [&ftn, &result](const Value &item) {
+                    const Value entry = call(ftn, item);
+                    if (!entry.isPair()) {
+                        throw InvalidExpressionType(Value::typeToString(Value::ePair), entry.typeToString());
+                    }
+                    result.set(entry.pair().first(), entry.pair().second());
+                    return true;
+                });
+                return Value(result);
+            }
+            else {
+                static_assert(std::is_same_v<ObjectType, Value::Array> ||
+                              std::is_same_v<ObjectType, Value::Range> ||
+                              std::is_same_v<ObjectType, Value::Coroutine> ||
+                              std::is_same_v<ObjectType, Value::Stream>);
+
+                Sequence::Vector result;
+                if constexpr (Sizable<ObjectType>) {
+                    result.reserve(obj.size());
+                }
+                foreachItem(obj, [&ftn, &result](const Value &item) {
+                    result.push_back(call(ftn, item));
+                    return true;
+                });
+                return Value(Sequence(std::move(result)));
+            }
+        }
+
+        template <typename ObjectType>
+        static inline Value filter(const ObjectType &obj, const Lambda &pred) {
+            if constexpr (std::is_same_v<ObjectType, Value::Text>) {
+                Value::Text result;
+                for (const auto c : obj) {
+                    if (test(pred, Value(c))) { result.push_back(c); }
+                }
+                return Value(std::move(result));
+            }
+            else if constexpr (std::is_same_v<ObjectType, Value::HashMap> ||
+                               std::is_same_v<ObjectType, Value::OrderedMap>) {
+                ObjectType result;
+                for (const auto &[key, value] : obj) {
+                    if (test(pred, Value(Value::Pair(key, value)))) { result.set(key, value); }
+                }
+                return Value(result);
+            }
+            else {
+                static_assert(std::is_same_v<ObjectType, Value::Array> ||
+                              std::is_same_v<ObjectType, Value::Range> ||
+                              std::is_same_v<ObjectType, Value::Coroutine> ||
+                              std::is_same_v<ObjectType, Value::Stream>);
+
+                Sequence::Vector result;
+                foreachItem(obj, [&pred, &result](const Value &item) {
+                    if (test(pred, item)) { result.push_back(item); }
+                    return true;
+                });
+                return Value(Sequence(std::move(result)));
+            }
+        }
+
+        template <typename ObjectType>
+        static inline Value reduce(const ObjectType &obj, const Value &init, const Lambda &ftn) {
+            Value result = init;
+            foreachItem(obj, [&ftn, &result](const Value &item) {
+                const Value ftnArgs[] = { result, item };
+                result = ftn.exec(ftnArgs);
+                return true;
+            });
+            return result;
+        }
+
+        template <typename ObjectType>
+        static inline Value all(const ObjectType &obj, const Lambda &pred) {
+            return Value(foreachItem(obj, [&pred](const Value &item) { return test(pred, item); }));
+        }
+
+        template <typename ObjectType>
+        static inline Value any(const ObjectType &obj, const Lambda &pred) {
+            return Value(!foreachItem(obj, [&pred](const Value &item) { return !test(pred, item); }));
+        }
+
+        // Arrays and ranges are split in chunks run on the thread pool,
+        // results keep the order of the items. The reduce function must be
+        // associative, each chunk is reduced from its first item and the
+        // chunk results are reduced from init in order.
+        template <typename ObjectType>
+        static inline Value pmap(const ObjectType &obj, const Lambda &ftn) {
+            Sequence::Vector result(obj.size());
+            parallelChunks(obj.size(), [&](std::size_t, std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) {
+                    result[i] = call(ftn, itemAt(obj, i));
+                }
+            });
+            return Value(Sequence(std::move(result)));
+        }
+
+        template <typename ObjectType>
+        static inline Value pfilter(const ObjectType &obj, const Lambda &pred) {
+            std::vector<Sequence::Vector> kept(chunkCount(obj.size()));
+            parallelChunks(obj.size(), [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) {
+                    Value item = itemAt(obj, i);
+                    if (test(pred, item)) { kept[chunk].push_back(std::move(item)); }
+                }
+            });
+
+            Sequence::Vector result;
+            for (auto &chunk : kept) {
+                std::ranges::move(chunk, std::back_inserter(result));
+            }
+            return Value(Sequence(std::move(result)));
+        }
+
+        template <typename ObjectType>
+        static inline Value preduce(const ObjectType &obj, const Value &init, const Lambda &ftn) {
+            std::vector<std::optional<Value>> partial(chunkCount(obj.size()));
+            parallelChunks(obj.size(), [&](std::size_t chunk, std::size_t first, std::size_t last) {
+                Value acc = itemAt(obj, first);
+                for (std::size_t i = first + 1; i < last; ++i) {
+                    const Value ftnArgs[] = { acc, itemAt(obj, i) };
+                    acc = ftn.exec(ftnArgs);
+                }
+                partial[chunk] = std::move(acc);
+            });
+
+            Value result = init;
+            for (const auto &acc : partial) {
+                const Value ftnArgs[] = { result, *acc };
+                result = ftn.exec(ftnArgs);
+            }
+            return result;
+        }
+
+    private:
+        static constexpr std::size_t ChunksPerThread = 4;
+
+        static inline Value call(const Lambda &ftn, const Value &item) {
+            const Value ftnArgs[] = { item };
+            return ftn.exec(ftnArgs);
+        }
+
+        static inline bool test(const Lambda &pred, const Value &item) {
+            const Value result = call(pred, item);
+            if (!result.isBool()) {
+                throw InvalidExpressionType(Value::typeToString(Value::eBoolean), result.typeToString());
+            }
+            return result.boolean();
+        }
+
+        // Calls ftn on each item until it returns false, returns false if
+        // stopped early.
+        template <typename ObjectType, typename Ftn>
+        static inline bool foreachItem(const ObjectType &obj, Ftn &&ftn) {
+            if constexpr (std::is_same_v<ObjectType, Value::Text>) {
+                return std::ranges::all_of(obj, [&ftn](char c) { return ftn(Value(c)); });
+            }
+            else if constexpr (std::is_same_v<ObjectType, Value::Pair>) {
+                return ftn(obj.first()) && ftn(obj.second());
+            }
+            else if constexpr (std::is_same_v<ObjectType, Value::HashMap> ||
+                               std::is_same_v<ObjectType, Value::OrderedMap>) {
+                for (const auto &[key, value] : obj) {
+                    if (!ftn(Value(Value::Pair(key, value)))) { return false; }
+                }
+                return true;
+            }
+            else if constexpr (std::is_same_v<ObjectType, Value::Range>) {
+                auto gen = obj.generator();
+                while (auto i = gen.next()) {
+                    if (!ftn(Value(*i))) { return false; }
+                }
+                return true;
+            }
+            else if constexpr (std::is_same_v<ObjectType, Value::Coroutine> ||
+                               std::is_same_v<ObjectType, Value::Stream>) {
+                while (auto item = obj.next()) {
+                    if (!ftn(*item)) { return false; }
+                }
+                return true;
+            }
+            else {
+                static_assert(std::is_same_v<ObjectType, Value::Array>);
+                return std::ranges::all_of(obj, ftn);
+            }
+        }
+
+        template <typename ObjectType>
+        static inline Value itemAt(const ObjectType &obj, std::size_t index) {
+            if constexpr (std::is_same_v<ObjectType, Value::Range>) {
+                return Value(obj.begin() + static_cast<Value::Long>(index) * obj.step());
+            }
+            else {
+                static_assert(std::is_same_v<ObjectType, Value::Array>);
+                return obj.get(index);
+            }
+        }
+
+        static inline std::size_t chunkCount(std::size_t size) {
+            return size < 2 ? size : std::min(size, ThreadPool::instance().concurrency() * ChunksPerThread);
+        }
+
+        // Calls ftn(chunk, first, last) for consecutive chunks of indices.
+        template <typename Ftn>
+        static inline void parallelChunks(std::size_t size, Ftn &&ftn) {
+            const auto chunks = chunkCount(size);
+            if (chunks == 0) { return; }
+
+            const auto chunkSize = size / chunks;
+            const auto remainder = size % chunks;
+            const auto begin = [chunkSize, remainder](std::size_t chunk) {
+                return chunk * chunkSize + std::min(chunk, remainder);
+            };
+
+            if (chunks == 1) {
+                ftn(0, 0, size);
+                return;
+            }
+            ThreadPool::instance().run(chunks, [&ftn, &begin](std::size_t chunk) {
+                ftn(chunk, begin(chunk), begin(chunk + 1));
+            });
+        }
     };
 
 }
@@ -1,15 +1,16 @@
 #ifndef ISHLANG_GENERIC_TABLE_H
 #define ISHLANG_GENERIC_TABLE_H
 
+#include "btree_map.h"
+#include "flat_hash_map.h"
 #include "sequence.h"
 #include "util.h"
 #include "value.h"
 #include "value_pair.h"
 
 #include <algorithm>
-#include <map>
+#include <iterator>
 #include <ostream>
-#include <unordered_map>
 
 namespace Ishlang {
 
@@ -65,6 +66,9 @@ namespace Ishlang {
                                         '}');
         }
 
+    protected:
+        inline const Table &table() const noexcept;
+
     private:
         static inline bool tableEqual(const Table &lhs, const Table &rhs);
 
@@ -72,16 +76,27 @@ namespace Ishlang {
         Table table_;
     };
 
-    class Hashtable : public GenericTable<std::unordered_map<Value, Value, Value::Hash>> {};
+    class Hashtable : public GenericTable<FlatHashMap<Value, Value, Value::Hash>> {};
 
-    class OrderedTable : public GenericTable<std::map<Value, Value>> {};
+    class OrderedTable : public GenericTable<BTreeMap<Value, Value>> {
+    public:
+        // Nearest keys, floor <= key, ceiling >= key, lower < key and
+        // higher > key. Null when there is no such key.
+        inline const Value &floor(const Value &key) const;
+        inline const Value &ceiling(const Value &key) const;
+        inline const Value &lower(const Value &key) const;
+        inline const Value &higher(const Value &key) const;
+
+        // Items with keys in [lo, hi).
+        inline Sequence range(const Value &lo, const Value &hi) const;
+    };
 
     // --------------------------------------------------------------------------------
     // INLINE
 
     template <typename TableType>
     inline GenericTable<TableType>::GenericTable(Table && table)
-        : table_(table)
+        : table_(std::move(table))
     {}
 
     template <typename TableType>
@@ -232,11 +247,44 @@ namespace Ishlang {
         return table_.end();
     }
 
+    template <typename TableType>
+    inline auto GenericTable<TableType>::table() const noexcept -> const Table & {
+        return table_;
+    }
+
     template <typename TableType>
     inline bool GenericTable<TableType>::tableEqual(const Table &lhs, const Table &rhs) {
         return Util::isEqualMapping(lhs, rhs);
     }
 
+    inline const Value &OrderedTable::floor(const Value &key) const {
+        const auto iter = table().upper_bound(key);
+        return iter != table().begin() ? std::prev(iter)->first : Value::Null;
+    }
+
+    inline const Value &OrderedTable::ceiling(const Value &key) const {
+        const auto iter = table().lower_bound(key);
+        return iter != table().end() ? iter->first : Value::Null;
+    }
+
+    inline const Value &OrderedTable::lower(const Value &key) const {
+        const auto iter = table().lower_bound(key);
+        return iter != table().begin() ? std::prev(iter)->first : Value::Null;
+    }
+
+    inline const Value &OrderedTable::higher(const Value &key) const {
+        const auto iter = table().upper_bound(key);
+        return iter != table().end() ? iter->first : Value::Null;
+    }
+
+    inline Sequence OrderedTable::range(const Value &lo, const Value &hi) const {
+        Sequence::Vector items;
+        for (auto iter = table().lower_bound(lo); iter != table().end() && iter->first < hi; ++iter) {
+            items.emplace_back(Value(ValuePair(iter->first, iter->second)));
+        }
+        return Sequence(std::move(items));
+    }
+
 }
 
 #endif // ISHLANG_GENERIC_TABLE_H
@@ -5,6 +5,20 @@
 using namespace Ishlang;
 
 IdenType IdenTable::mapName(const std::string & name) {
+    if (RefCount::atomic()) {
+        {
+            std::shared_lock lock(mutex_);
+            if (auto iter = table_.find(name); iter != table_.end()) {
+                return iter->second;
+            }
+        }
+        std::lock_guard lock(mutex_);
+        return insert(name);
+    }
+    return insert(name);
+}
+
+IdenType IdenTable::insert(const std::string & name) {
     auto iter = table_.find(name);
     if (iter == table_.end()) {
         std::tie(iter, std::ignore) = table_.emplace(name, nextIden());
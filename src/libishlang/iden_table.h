@@ -1,7 +1,11 @@
 #ifndef ISH_IDEN_TABLE_H
 #define ISH_IDEN_TABLE_H
 
+#include "ref_count.h"
+
 #include <cstdint>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 
@@ -9,6 +13,11 @@ namespace Ishlang {
 
     using IdenType = uint64_t;
 
+    // Maps names to identifiers. One table serves every interpreter in the
+    // process, so parsed code can be shared between them. Names are mapped
+    // while parsing, evaluation goes through resolved identifiers and only
+    // looks names up for errors. Once reference counts are atomic lookups
+    // take a shared lock and new names an exclusive one.
     class IdenTable {
     public:
         IdenType mapName(const std::string & name);
@@ -23,7 +32,10 @@ namespace Ishlang {
     private:
         inline IdenType nextIden() noexcept;
 
+        IdenType insert(const std::string & name);
+
     private:
+        mutable std::shared_mutex mutex_;
         IdenType nextIden_ = 0;
         std::unordered_map<std::string, IdenType> table_;
         std::unordered_map<IdenType, std::string> reverseTable_;
@@ -33,13 +45,18 @@ namespace Ishlang {
     // INLINE
 
     inline const std::string & IdenTable::getName(IdenType iden) const {
-        static std::string Empty;
+        static const std::string Empty;
+
+        std::shared_lock lock(mutex_, std::defer_lock);
+        if (RefCount::atomic()) { lock.lock(); }
 
         auto iter = reverseTable_.find(iden);
         return iter != reverseTable_.end() ? iter->second : Empty;
     }
 
     inline bool IdenTable::exists(const std::string & name) const noexcept {
+        std::shared_lock lock(mutex_, std::defer_lock);
+        if (RefCount::atomic()) { lock.lock(); }
         return table_.contains(name);
     }
 
@@ -1,53 +1,67 @@
 #include "instance.h"
 #include "exception.h"
+#include "output.h"
 
 #include <iomanip>
+#include <iostream>
 
 using namespace Ishlang;
 
 // -------------------------------------------------------------
-Instance::Instance(const Struct &type, InitArgs const & initArgs)
+Instance::Instance(const Struct &type)
     : type_(type)
-    , members_()
+    , slots_(type.members().size())
+{}
+
+// -------------------------------------------------------------
+Instance::Instance(const Struct &type, InitArgs const & initArgs)
+    : Instance(type)
 {
-    for (const auto &m : type.members()) {
-        members_.emplace(m, initArgOrNull(initArgs, m));
+    for (const auto & [name, value] : initArgs) {
+        const auto slot = type_.slot(name);
+        if (slot != Struct::NoSlot) {
+            slots_[slot] = value;
+        }
     }
 }
 
 // -------------------------------------------------------------
-const Value &Instance::get(const std::string &name) const {
-    auto iter = members_.find(name);
-    if (iter == members_.end()) {
-        throw UnknownMember(type_.name(), name);
-    }
-    return iter->second;
+const Value &Instance::get(const std::string &name, Struct::SlotHint &hint) const {
+    return slots_[slotOrThrow(name, hint)];
+}
+
+// -------------------------------------------------------------
+void Instance::set(const std::string &name, Struct::SlotHint &hint, const Value &value) {
+    slots_[slotOrThrow(name, hint)] = value;
 }
 
 // -------------------------------------------------------------
-void Instance::set(const std::string &name, const Value &value) {
-    auto iter = members_.find(name);
-    if (iter == members_.end()) {
+std::size_t Instance::slotOrThrow(const std::string &name, Struct::SlotHint &hint) const {
+    const auto slot = type_.slot(name, hint.load());
+    if (slot == Struct::NoSlot) {
         throw UnknownMember(type_.name(), name);
     }
-    iter->second = value;
+    hint.store(slot);
+    return slot;
 }
 
 // -------------------------------------------------------------
 void Instance::describe() const {
+    const auto &members = type_.members();
     const auto iter = std::max_element(
-        members_.begin(),
-        members_.end(),
+        members.begin(),
+        members.end(),
         [](const auto &lhs, const auto &rhs) {
-            return lhs.first.size() < rhs.first.size();
+            return lhs.size() < rhs.size();
         });
-    const std::size_t width = iter != members_.end()
-        ? iter->first.size()
+    const std::size_t width = iter != members.end()
+        ? iter->size()
         : 0;
 
-    std::cout << "Instance of " << type_.name();
-    for (const auto & [mem, val] : members_) {
-        std::cout << "\n  " << std::setw(width) << mem << ": " << val;
+    auto &out = Output::stream();
+    out << "Instance of " << type_.name();
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        out << "\n  " << std::setw(width) << members[i] << ": " << slots_[i];
     }
-    std::cout << std::endl;
+    Output::newline();
 }
@@ -3,22 +3,27 @@
 
 #include "struct.h"
 #include "value.h"
-#include "util.h"
 
 #include <algorithm>
 #include <ostream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace Ishlang {
 
+    // Instance members are kept in a flat array indexed by the slots of the
+    // struct layout. Lookups by name take an optional slot hint, code nodes
+    // pass the slot found on their previous execution so that repeated
+    // accesses on instances of the same struct skip the name search.
     class Instance {
     public:
-        using MemberTable = std::unordered_map<std::string, Value>;
+        using SlotTable = std::vector<Value>;
         using InitArgs = std::unordered_map<std::string, Value>;
 
         Instance() = default;
-        Instance(const Struct &type, InitArgs const & initArgs = InitArgs());
+        Instance(const Struct &type);
+        Instance(const Struct &type, InitArgs const & initArgs);
 
         inline bool operator==(const Instance &rhs) const;
         inline bool operator!=(const Instance &rhs) const;
@@ -30,8 +35,15 @@ namespace Ishlang {
 
         inline const Struct &type() const;
 
-        const Value &get(const std::string &name) const;
-        void set(const std::string &name, const Value &value);
+        inline const Value &get(const std::string &name) const;
+        inline void set(const std::string &name, const Value &value);
+
+        // Lookups updating the slot hint.
+        const Value &get(const std::string &name, Struct::SlotHint &hint) const;
+        void set(const std::string &name, Struct::SlotHint &hint, const Value &value);
+
+        inline const Value &getSlot(std::size_t slot) const;
+        inline void setSlot(std::size_t slot, const Value &value);
 
         void describe() const;
 
@@ -42,52 +54,62 @@ namespace Ishlang {
         }
 
     private:
-        static inline bool membersEqual(const MemberTable &lhs, const MemberTable &rhs);
-        static inline const Value &initArgOrNull(InitArgs const & initArgs, const std::string &name);
-        
+        friend class GarbageCollector;
+
+        std::size_t slotOrThrow(const std::string &name, Struct::SlotHint &hint) const;
+
     private:
-        Struct type_;
-        MemberTable  members_;
+        Struct    type_;
+        SlotTable slots_;
     };
 
     // --------------------------------------------------------------------------------
     // INLINE
 
     inline bool Instance::operator==(const Instance &rhs) const {
-        return type_ == rhs.type_ && membersEqual(members_, rhs.members_);
+        return type_ == rhs.type_ && slots_ == rhs.slots_;
     }
 
     inline bool Instance::operator!=(const Instance &rhs) const {
-        return type_ != rhs.type_ || !membersEqual(members_, rhs.members_);
+        return !(*this == rhs);
     }
 
     inline bool Instance::operator<(const Instance &rhs) const {
-        return members_.size() < rhs.members_.size();
+        return slots_.size() < rhs.slots_.size();
     }
 
     inline bool Instance::operator>(const Instance &rhs) const {
-        return members_.size() > rhs.members_.size();
+        return slots_.size() > rhs.slots_.size();
     }
 
     inline bool Instance::operator<=(const Instance &rhs) const {
-        return members_.size() <= rhs.members_.size();
+        return slots_.size() <= rhs.slots_.size();
     }
 
     inline bool Instance::operator>=(const Instance &rhs) const {
-        return members_.size() >= rhs.members_.size();
+        return slots_.size() >= rhs.slots_.size();
     }
 
     inline const Struct &Instance::type() const {
         return type_;
     }
 
-    inline bool Instance::membersEqual(const MemberTable &lhs, const MemberTable &rhs) {
-        return Util::isEqualMapping(lhs, rhs);
+    inline const Value &Instance::get(const std::string &name) const {
+        Struct::SlotHint hint;
+        return get(name, hint);
+    }
+
+    inline void Instance::set(const std::string &name, const Value &value) {
+        Struct::SlotHint hint;
+        set(name, hint, value);
+    }
+
+    inline const Value &Instance::getSlot(std::size_t slot) const {
+        return slots_[slot];
     }
 
-    inline const Value &Instance::initArgOrNull(InitArgs const & initArgs, const std::string &name) {
-        auto const iter = initArgs.find(name);
-        return iter == initArgs.end() ? Value::Null : iter->second;
+    inline void Instance::setSlot(std::size_t slot, const Value &value) {
+        slots_[slot] = value;
     }
 
 }
@@ -10,6 +10,7 @@ IntegerRange::IntegerRange(Long end)
     , step_(1)
 {
     checkValid();
+    computeSize();
 }
 
 IntegerRange::IntegerRange(Long begin, Long end, Long step)
@@ -18,6 +19,7 @@ IntegerRange::IntegerRange(Long begin, Long end, Long step)
     , step_(step)
 {
     checkValid();
+    computeSize();
 
     if (step_ < 0) {
         pred_ = std::greater<Long>();
@@ -25,8 +27,6 @@ IntegerRange::IntegerRange(Long begin, Long end, Long step)
 }
 
 void IntegerRange::checkValid() {
-    assert(!size_.has_value());
-
     if (step_ == 0) {
         throw Exception("Range step 0");
     }
@@ -36,6 +36,11 @@ void IntegerRange::checkValid() {
     }
 }
 
+// Computed up front, ranges are shared between threads and never modified
+void IntegerRange::computeSize() noexcept {
+    size_ = std::ceil((std::max(begin_, end_) - std::min(begin_, end_)) / static_cast<double>(std::abs(step_)));
+}
+
 IntegerRange::Generator::Generator(const IntegerRange & rng)
     : rng_(rng)
     , next_(rng.start())
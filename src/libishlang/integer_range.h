@@ -41,6 +41,7 @@ namespace Ishlang {
 
     private:
         void checkValid();
+        void computeSize() noexcept;
 
     public:
         class Generator {
@@ -67,7 +68,7 @@ namespace Ishlang {
         Long end_ = 0;
         Long step_ = 1;
         Predicate pred_ = std::less<Long>();
-        mutable std::optional<std::size_t> size_;
+        std::size_t size_ = 0;
     };
 
     // --------------------------------------------------------------------------------
@@ -110,10 +111,7 @@ namespace Ishlang {
     }
 
     inline std::size_t IntegerRange::size() const noexcept {
-        if (!size_) {
-            size_ = std::ceil((std::max(begin_, end_) - std::min(begin_, end_)) / static_cast<double>(std::abs(step_)));
-        }
-        return *size_;
+        return size_;
     }
 
     inline auto IntegerRange::predicate() const -> const Predicate & {
@@ -0,0 +1,156 @@
+#include "iterator.h"
+#include "code_node_util.h"
+#include "csv_reader.h"
+#include "dense_array.h"
+#include "exception.h"
+#include "file_io.h"
+#include "generator.h"
+#include "lambda.h"
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+Iterator::Iterator(Source source)
+    : state_(std::make_shared<State>())
+{
+    state_->source = std::move(source);
+    state_->done = !state_->source;
+}
+
+// -------------------------------------------------------------
+Iterator Iterator::from(Value container) {
+    switch (container.type()) {
+    case Value::eString:
+        return Iterator([container, i = std::size_t(0)]() mutable -> std::optional<Value> {
+            const auto &text = container.text();
+            return i < text.size() ? std::make_optional(Value(text[i++])) : std::nullopt;
+        });
+
+    case Value::eArray:
+        return Iterator([container, i = std::size_t(0)]() mutable -> std::optional<Value> {
+            const auto &array = container.array();
+            return i < array.size() ? std::make_optional(array.get(i++)) : std::nullopt;
+        });
+
+    case Value::eNdArray:
+        return Iterator([container, i = std::size_t(0)]() mutable -> std::optional<Value> {
+            const auto &array = container.ndArray();
+            return i < array.size() ? std::make_optional(array.get(i++)) : std::nullopt;
+        });
+
+    case Value::eHashMap:
+        return Iterator([container, iter = container.hashMap().begin()]() mutable -> std::optional<Value> {
+            if (iter == container.hashMap().end()) { return std::nullopt; }
+            const auto &[key, value] = *iter++;
+            return Value(ValuePair(key, value));
+        });
+
+    case Value::eOrderedMap:
+        return Iterator([container, iter = container.orderedMap().begin()]() mutable -> std::optional<Value> {
+            if (iter == container.orderedMap().end()) { return std::nullopt; }
+            const auto &[key, value] = *iter++;
+            return Value(ValuePair(key, value));
+        });
+
+    case Value::eRange:
+        return Iterator([range = container.range(), i = std::size_t(0)]() mutable -> std::optional<Value> {
+            if (i >= range.size()) { return std::nullopt; }
+            return Value(range.begin() + static_cast<Value::Long>(i++) * range.step());
+        });
+
+    case Value::eFile:
+        if (const auto delimiter = container.file().csvDelimiter()) {
+            auto reader = std::make_shared<CsvReader>(container.file(), *delimiter);
+            return Iterator([container, reader]() -> std::optional<Value> {
+                auto row = reader->readRow();
+                return row ? std::make_optional(Value(std::move(*row))) : std::nullopt;
+            });
+        }
+        return Iterator([container]() mutable -> std::optional<Value> {
+            auto line = container.file().readln();
+            return line ? std::make_optional(Value(std::move(*line))) : std::nullopt;
+        });
+
+    case Value::eGenerator:
+        return Iterator([generator = container.generator()]() { return generator.next(); });
+
+    case Value::eIterator:
+        return container.iterator();
+
+    default:
+        throw InvalidExpressionType(
+            typesToString(Value::eString, Value::eArray, Value::eHashMap, Value::eOrderedMap, Value::eRange, Value::eFile, Value::eNdArray, Value::eGenerator, Value::eIterator),
+            container.typeToString());
+    }
+}
+
+// -------------------------------------------------------------
+std::optional<Value> Iterator::next() const {
+    if (!state_ || state_->done) { return std::nullopt; }
+
+    auto item = state_->source();
+    if (!item) {
+        // Release the source, and the containers it holds, once exhausted
+        state_->done = true;
+        state_->source = Source();
+    }
+    return item;
+}
+
+// -------------------------------------------------------------
+Iterator Iterator::map(const Lambda &ftn) const {
+    return Iterator([source = *this, ftn]() -> std::optional<Value> {
+        auto item = source.next();
+        if (!item) { return std::nullopt; }
+
+        const Value ftnArgs[] = { *item };
+        return ftn.exec(ftnArgs);
+    });
+}
+
+// -------------------------------------------------------------
+Iterator Iterator::filter(const Lambda &pred) const {
+    return Iterator([source = *this, pred]() -> std::optional<Value> {
+        while (auto item = source.next()) {
+            const Value ftnArgs[] = { *item };
+            const Value result = pred.exec(ftnArgs);
+            if (!result.isBool()) {
+                throw InvalidExpressionType(Value::typeToString(Value::eBoolean), result.typeToString());
+            }
+            if (result.boolean()) { return item; }
+        }
+        return std::nullopt;
+    });
+}
+
+// -------------------------------------------------------------
+Iterator Iterator::take(std::size_t count) const {
+    return Iterator([source = *this, count]() mutable -> std::optional<Value> {
+        if (count == 0) { return std::nullopt; }
+        --count;
+        return source.next();
+    });
+}
+
+// -------------------------------------------------------------
+Iterator Iterator::zip(const Iterator &other) const {
+    return Iterator([first = *this, second = other]() -> std::optional<Value> {
+        auto firstItem = first.next();
+        if (!firstItem) { return std::nullopt; }
+
+        auto secondItem = second.next();
+        if (!secondItem) { return std::nullopt; }
+
+        return Value(ValuePair(*firstItem, *secondItem));
+    });
+}
+
+// -------------------------------------------------------------
+Iterator Iterator::enumerate() const {
+    return Iterator([source = *this, index = Value::Long(0)]() mutable -> std::optional<Value> {
+        auto item = source.next();
+        if (!item) { return std::nullopt; }
+
+        return Value(ValuePair(Value(index++), *item));
+    });
+}
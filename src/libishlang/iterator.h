@@ -0,0 +1,85 @@
+#ifndef ISHLANG_ITERATOR_H
+#define ISHLANG_ITERATOR_H
+
+#include "value.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+
+namespace Ishlang {
+
+    class Lambda;
+
+    // Lazy sequence of values drawn one at a time from a container or a
+    // generator. Adapters wrap the iterator they are applied to, so a chain
+    // of them runs in a single pass over the source without building
+    // intermediate arrays. Copies share the position, so items are consumed
+    // once, by one thread at a time.
+    class Iterator {
+    public:
+        using Source = std::function<std::optional<Value> ()>;
+
+    public:
+        Iterator() = default;
+        explicit Iterator(Source source);
+
+        // Items of a string, array, ndarray, hashmap, orderedmap, range,
+        // file or generator. An iterator is returned as is.
+        static Iterator from(Value container);
+
+        // Next item, nullopt once the source is exhausted.
+        std::optional<Value> next() const;
+
+        inline bool done() const noexcept;
+
+        Iterator map(const Lambda &ftn) const;
+        Iterator filter(const Lambda &pred) const;
+        Iterator take(std::size_t count) const;
+        Iterator zip(const Iterator &other) const;
+        Iterator enumerate() const;
+
+        inline const void *identity() const noexcept;
+
+        inline bool operator==(const Iterator &rhs) const noexcept;
+        inline bool operator!=(const Iterator &rhs) const noexcept;
+
+    private:
+        struct State {
+            Source source;
+            bool   done = false;
+        };
+
+    private:
+        std::shared_ptr<State> state_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline bool Iterator::done() const noexcept {
+        return !state_ || state_->done;
+    }
+
+    inline const void *Iterator::identity() const noexcept {
+        return state_.get();
+    }
+
+    inline bool Iterator::operator==(const Iterator &rhs) const noexcept {
+        return state_ == rhs.state_;
+    }
+
+    inline bool Iterator::operator!=(const Iterator &rhs) const noexcept {
+        return state_ != rhs.state_;
+    }
+
+    inline std::ostream &operator<<(std::ostream &out, const Iterator &iterator) {
+        out << (iterator.done() ? "[Iterator:done]" : "[Iterator:active]");
+        return out;
+    }
+
+}
+
+#endif // ISHLANG_ITERATOR_H
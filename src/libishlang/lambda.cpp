@@ -1,30 +1,153 @@
 #include "lambda.h"
+#include "garbage_collector.h"
+#include "generator.h"
+#include "virtual_machine.h"
+
+#include <exception>
+#include <vector>
 
 using namespace Ishlang;
 
 // -------------------------------------------------------------
-Lambda::Lambda(const ParamList &params, CodeNode::SharedPtr body, Environment::SharedPtr env)
+Lambda::Lambda(const ParamList &params,
+               CodeNode::SharedPtr body,
+               Environment::SharedPtr env,
+               ScopeLayout::SharedPtr layout,
+               ByteCode::SharedPtr code)
+    : params_()
+    , body_(body)
+    , env_(env)
+    , layout_(layout)
+    , code_(code)
+{
+    params_.reserve(params.size());
+    for (const auto &param : params) {
+        params_.push_back(Environment::idenTable().mapName(param));
+    }
+}
+
+Lambda::Lambda(const IdenList &params,
+               CodeNode::SharedPtr body,
+               Environment::SharedPtr env,
+               ScopeLayout::SharedPtr layout,
+               ByteCode::SharedPtr code)
     : params_(params)
     , body_(body)
     , env_(env)
+    , layout_(layout)
+    , code_(code)
 {}
 
+Lambda Lambda::generator(const IdenList &params,
+                         CodeNode::SharedPtr body,
+                         Environment::SharedPtr env,
+                         ScopeLayout::SharedPtr layout) {
+    Lambda lambda(params, body, env, layout);
+    lambda.generator_ = true;
+    return lambda;
+}
+
 // -------------------------------------------------------------
-Value Lambda::exec(const ArgList &args) const {
+namespace {
+
+    // Arguments keep their capacity, so deferring a call allocates no
+    // memory once the thread made a few.
+    struct DeferredCall {
+        Value              closure;
+        std::vector<Value> args;
+        bool               pending = false;
+    };
+
+    thread_local DeferredCall deferred;
+
+    // Drops the deferred call when a body raises, so its arguments do not
+    // keep objects alive until the thread defers another call.
+    class DeferredGuard {
+    public:
+        DeferredGuard() : exceptions_(std::uncaught_exceptions()) {}
+
+        ~DeferredGuard() {
+            if (std::uncaught_exceptions() > exceptions_) {
+                deferred.pending = false;
+                deferred.closure = Value::Null;
+                deferred.args.clear();
+            }
+        }
+
+        DeferredGuard(const DeferredGuard &) = delete;
+        DeferredGuard &operator=(const DeferredGuard &) = delete;
+
+    private:
+        int exceptions_;
+    };
+
+}
+
+// -------------------------------------------------------------
+Value Lambda::exec(Args args) const {
+    DeferredGuard guard;
+    Value result = run(args);
+
+    if (deferred.pending) {
+        // Each deferred call replaces the body that deferred it. Its
+        // arguments are bound before its body runs and may defer the next.
+        do {
+            deferred.pending = false;
+            const Value closure = std::move(deferred.closure);
+            result = closure.closure().run(deferred.args);
+        } while (deferred.pending);
+        deferred.args.clear();
+    }
+    return result;
+}
+
+// -------------------------------------------------------------
+void Lambda::deferCall(const Value &closure, Args args) {
+    deferred.closure = closure;
+    deferred.args.assign(args.begin(), args.end());
+    deferred.pending = true;
+}
+
+// -------------------------------------------------------------
+Value Lambda::run(Args args) const {
     if (body_) {
         if (params_.size() != args.size()) {
             throw InvalidArgsSize(params_.size(), args.size());
         }
 
-        auto lambdaEnv = Environment::make(env_);
+        GarbageCollector::current().safePoint();
 
-        ParamList::const_iterator pIter = params_.begin();
-        ArgList::const_iterator aIter = args.begin();
-        for (; pIter != params_.end() && aIter != args.end(); ++pIter, ++aIter) {
-            lambdaEnv->defByName(*pIter, *aIter);
+        auto lambdaEnv = Environment::makeScope(env_, layout_);
+
+        if (layout_) {
+            // Parameters occupy the leading slots of a resolved lambda scope
+            for (std::size_t slot = 0; slot < args.size(); ++slot) {
+                lambdaEnv->defAt(slot, args[slot]);
+            }
+        }
+        else {
+            for (std::size_t i = 0; i < args.size(); ++i) {
+                lambdaEnv->def(params_[i], args[i]);
+            }
+        }
+
+        if (generator_) {
+            return Value(Generator(body_, lambdaEnv));
         }
 
-        return body_->eval(lambdaEnv);
+        Value result;
+        try {
+            result = code_ ? VirtualMachine::run(*code_, lambdaEnv) : body_->eval(lambdaEnv);
+        }
+        catch (const Return::Except &ret) {
+            return ret.value;
+        }
+
+        // Return in statement position leaves its value as the body result
+        if (ControlSignal::pending() == ControlSignal::Return) {
+            ControlSignal::clear();
+        }
+        return result;
     }
     return Value::Null;
 }
@@ -1,11 +1,14 @@
 #ifndef ISHLANG_LAMBDA_H
 #define ISHLANG_LAMBDA_H
 
+#include "byte_code.h"
 #include "code_node.h"
 #include "environment.h"
 #include "value.h"
 
 #include <algorithm>
+#include <array>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -14,15 +17,44 @@ namespace Ishlang {
     class Lambda {
     public:
         using ParamList = std::vector<std::string>;
+        using IdenList  = ScopeLayout::IdenList;
         using ArgList   = std::vector<Value>;
+        using Args      = std::span<const Value>;
+
+        class ArgBuffer;
 
     public:
         Lambda() = default;
-        Lambda(const ParamList &params, CodeNode::SharedPtr body, Environment::SharedPtr env);
+        Lambda(const ParamList &params,
+               CodeNode::SharedPtr body,
+               Environment::SharedPtr env,
+               ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr(),
+               ByteCode::SharedPtr code = ByteCode::SharedPtr());
+        Lambda(const IdenList &params,
+               CodeNode::SharedPtr body,
+               Environment::SharedPtr env,
+               ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr(),
+               ByteCode::SharedPtr code = ByteCode::SharedPtr());
+
+        // Closure whose calls return a generator over the body in the
+        // scope of the call, instead of evaluating it.
+        static Lambda generator(const IdenList &params,
+                                CodeNode::SharedPtr body,
+                                Environment::SharedPtr env,
+                                ScopeLayout::SharedPtr layout = ScopeLayout::SharedPtr());
 
         inline std::size_t paramsSize() const noexcept;
+        inline bool isGenerator() const noexcept;
+        inline const CodeNode::SharedPtr &body() const noexcept;
+
+        // Calls may run on several threads at once, each in its own scope
+        // over the captured environment.
+        Value exec(Args args) const;
 
-        Value exec(const ArgList &args) const;
+        // Defers a call made in tail position of a function body to the
+        // lambda running that body, which makes it once the body returned
+        // instead of nesting it. Tail calls thereby run in constant stack.
+        static void deferCall(const Value &closure, Args args);
 
         inline bool operator==(const Lambda &rhs) const;
         inline bool operator!=(const Lambda &rhs) const;
@@ -33,21 +65,67 @@ namespace Ishlang {
         inline bool operator>=(const Lambda &rhs) const;
 
     private:
-        static inline bool paramEqual(const ParamList &lhs, const ParamList &rhs);
+        friend class GarbageCollector;
+
+        static inline bool paramEqual(const IdenList &lhs, const IdenList &rhs);
+
+        // Evaluates the body, leaving calls it deferred to exec.
+        Value run(Args args) const;
 
     private:
-        ParamList                      params_;
+        IdenList                       params_;
         CodeNode::SharedPtr            body_;
         mutable Environment::SharedPtr env_;
+        ScopeLayout::SharedPtr         layout_;
+        ByteCode::SharedPtr            code_;
+        bool                           generator_ = false;
+    };
+
+    // Call arguments evaluated by the caller, small arities are kept inline
+    // so a call does not allocate an argument vector.
+    class Lambda::ArgBuffer {
+    public:
+        static constexpr std::size_t InlineSize = 6;
+
+    public:
+        explicit ArgBuffer(std::size_t size)
+            : size_(size)
+            , inline_()
+            , heap_(size > InlineSize ? size : 0)
+        {}
+
+        inline Value &operator[](std::size_t index) noexcept;
+        inline Args args() const noexcept;
+
+    private:
+        std::size_t                      size_;
+        std::array<Value, InlineSize>    inline_;
+        std::vector<Value>               heap_;
     };
 
     // --------------------------------------------------------------------------------
     // INLINE
 
+    inline Value &Lambda::ArgBuffer::operator[](std::size_t index) noexcept {
+        return size_ > InlineSize ? heap_[index] : inline_[index];
+    }
+
+    inline auto Lambda::ArgBuffer::args() const noexcept -> Args {
+        return Args(size_ > InlineSize ? heap_.data() : inline_.data(), size_);
+    }
+
     inline std::size_t Lambda::paramsSize() const noexcept {
         return params_.size();
     }
 
+    inline bool Lambda::isGenerator() const noexcept {
+        return generator_;
+    }
+
+    inline auto Lambda::body() const noexcept -> const CodeNode::SharedPtr & {
+        return body_;
+    }
+
     inline bool Lambda::operator==(const Lambda &rhs) const {
         return paramEqual(params_, rhs.params_) && body_ == rhs.body_ && env_ == rhs.env_;
     }
@@ -72,7 +150,7 @@ namespace Ishlang {
         return params_.size() >= rhs.params_.size();
     }
 
-    inline bool Lambda::paramEqual(const ParamList &lhs, const ParamList &rhs) {
+    inline bool Lambda::paramEqual(const IdenList &lhs, const IdenList &rhs) {
         return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
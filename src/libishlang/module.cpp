@@ -1,4 +1,5 @@
 #include "module.h"
+#include "context.h"
 #include "exception.h"
 #include "util.h"
 
@@ -8,9 +9,6 @@ using namespace Ishlang;
 // MODULE
 // -------------------------------------------------------------
 
-// -------------------------------------------------------------
-Parser Module::parser_ = Parser();
-
 // -------------------------------------------------------------
 Module::Module(const std::string &name, const std::string &sourceFile)
     : name_(name)
@@ -22,7 +20,7 @@ Module::Module(const std::string &name, const std::string &sourceFile)
 // -------------------------------------------------------------
 Value Module::load() {
     if (env_->empty()) {
-        parser_.readFile(sourceFile_, [this](CodeNode::SharedPtr &code) { parserCallback(code); });
+        Context::modules().parser().readFile(sourceFile_, [this](CodeNode::SharedPtr &code) { parserCallback(code); });
         return Value::True;
     }
     return Value::False;
@@ -31,10 +29,11 @@ Value Module::load() {
 // -------------------------------------------------------------
 Value Module::loadFromString(const std::string &expr) {
     if (env_->empty() && sourceFile_.empty()) {
-        parser_.readMulti(expr, [this](CodeNode::SharedPtr &code) { parserCallback(code); });
+        auto &parser = Context::modules().parser();
+        parser.readMulti(expr, [this](CodeNode::SharedPtr &code) { parserCallback(code); });
 
-        if (parser_.hasIncompleteExpr()) {
-            parser_.clearIncompleteExpr();
+        if (parser.hasIncompleteExpr()) {
+            parser.clearIncompleteExpr();
             throw IncompleteExpression("Module '" + name_ + "' loadFromString");
         }
         return Value::True;
@@ -85,8 +84,12 @@ void Module::parserCallback(CodeNode::SharedPtr & code) {
 // -------------------------------------------------------------
 
 // -------------------------------------------------------------
-std::vector<std::string> ModuleStorage::paths_;
-std::unordered_map<std::string, Module::SharedPtr> ModuleStorage::storage_;
+ModuleStorage::ModuleStorage()
+    : paths_()
+    , storage_()
+    , parser_()
+{
+}
 
 // -------------------------------------------------------------
 bool ModuleStorage::addPath(const std::string &path) {
@@ -137,7 +140,7 @@ Module::SharedPtr ModuleStorage::add(const std::string &name, const std::string
 }
 
 // -------------------------------------------------------------
-Module::SharedPtr ModuleStorage::get(const std::string &name) {
+Module::SharedPtr ModuleStorage::get(const std::string &name) const {
     auto iter = storage_.find(name);
     if (iter == storage_.end()) {
         throw ModuleError(name, "Failed to find module in module storage");
@@ -147,7 +150,7 @@ Module::SharedPtr ModuleStorage::get(const std::string &name) {
 }
 
 // -------------------------------------------------------------
-std::string ModuleStorage::findModuleFile(const std::string &name) {
+std::string ModuleStorage::findModuleFile(const std::string &name) const {
     const auto filename = name + ".ish";
     auto filePath = Util::findFilePath(Util::currentPath(), filename);
 
@@ -35,9 +35,6 @@ namespace Ishlang {
     private:
         void parserCallback(CodeNode::SharedPtr & code);
 
-    private:
-        static Parser parser_;
-
     private:
         std::string name_;
         std::string sourceFile_;
@@ -45,26 +42,39 @@ namespace Ishlang {
     };
 
     // --------------------------------------------------------------------------------
+    // Modules loaded by one interpreter context, see Context::modules.
     class ModuleStorage {
+    public:
+        ModuleStorage();
+
+        ModuleStorage(const ModuleStorage &) = delete;
+        ModuleStorage &operator=(const ModuleStorage &) = delete;
+
     public: // Path
-        static bool addPath(const std::string &path);
-        static bool addPaths(const std::string &path);
+        bool addPath(const std::string &path);
+        bool addPaths(const std::string &path);
 
-        static inline const std::vector<std::string> &paths() noexcept;
+        inline const std::vector<std::string> &paths() const noexcept;
 
     public: // Storage
-        static Module::SharedPtr getOrCreate(const std::string &name);
-        static Module::SharedPtr add(const std::string &name, const std::string &sourceFile);
-        static Module::SharedPtr get(const std::string &name);
+        Module::SharedPtr getOrCreate(const std::string &name);
+        Module::SharedPtr add(const std::string &name, const std::string &sourceFile);
+        Module::SharedPtr get(const std::string &name) const;
 
-        static inline bool exists(const std::string &name) noexcept;
+        inline bool exists(const std::string &name) const noexcept;
+        inline void clear() noexcept;
+
+        // Parser reading module source, apart from the one reading the
+        // code that imports them.
+        inline Parser &parser() noexcept;
 
     private:
-        static std::string findModuleFile(const std::string &name);
+        std::string findModuleFile(const std::string &name) const;
 
     private:
-        static std::vector<std::string> paths_;
-        static std::unordered_map<std::string, Module::SharedPtr> storage_;
+        std::vector<std::string> paths_;
+        std::unordered_map<std::string, Module::SharedPtr> storage_;
+        Parser parser_;
     };
 
     // --------------------------------------------------------------------------------
@@ -78,14 +88,22 @@ namespace Ishlang {
         return sourceFile_;
     }
 
-    inline const std::vector<std::string> &ModuleStorage::paths() noexcept {
+    inline const std::vector<std::string> &ModuleStorage::paths() const noexcept {
         return paths_;
     }
 
-    inline bool ModuleStorage::exists(const std::string &name) noexcept {
+    inline bool ModuleStorage::exists(const std::string &name) const noexcept {
         return storage_.find(name) != storage_.end();
     }
 
+    inline void ModuleStorage::clear() noexcept {
+        storage_.clear();
+    }
+
+    inline Parser &ModuleStorage::parser() noexcept {
+        return parser_;
+    }
+
 }
 
 #endif // ISHLANG_MODULE_H
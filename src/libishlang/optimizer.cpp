@@ -0,0 +1,738 @@
+#include "optimizer.h"
+#include "code_node.h"
+#include "exception.h"
+
+#include <algorithm>
+#include <cxxabi.h>
+#include <cstdlib>
+#include <memory>
+#include <ranges>
+#include <string_view>
+#include <typeinfo>
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+//                          OPTIMIZER
+// -------------------------------------------------------------
+
+// -------------------------------------------------------------
+Optimizer::Optimizer(unsigned level)
+    : level_(std::min(level, MaxLevel))
+    , functions_()
+    , params_(nullptr)
+    , inlineSize_(0)
+{}
+
+// -------------------------------------------------------------
+void Optimizer::setLevel(unsigned level) noexcept {
+    level_ = std::min(level, MaxLevel);
+    if (level_ < 2) { functions_.clear(); }
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Optimizer::optimize(CodeNode::SharedPtr code) {
+    if (level_ > 0) {
+        optimizeNode(code);
+    }
+    return code;
+}
+
+// -------------------------------------------------------------
+void Optimizer::dump(const CodeNode::SharedPtr &code, std::ostream &out) {
+    if (code) { code->dump(out); }
+    else      { out << "null"; }
+}
+
+// -------------------------------------------------------------
+void Optimizer::optimizeNode(CodeNode::SharedPtr &node) {
+    if (node) {
+        if (auto replacement = node->optimize(*this)) {
+            node = std::move(replacement);
+        }
+    }
+}
+
+// -------------------------------------------------------------
+void Optimizer::optimizeNodes(CodeNode::SharedPtrList &nodes) {
+    for (auto &node : nodes) {
+        optimizeNode(node);
+    }
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Optimizer::literal(const Value &value) {
+    return CodeNode::make<Literal>(value);
+}
+
+// -------------------------------------------------------------
+void Optimizer::defineFunction(IdenType iden, const ScopeLayout::IdenList &params, const CodeNode::SharedPtr &body) {
+    if (level_ < 2 || !body) { return; }
+
+    params_ = &params;
+    inlineSize_ = 0;
+    auto inlined = inlineCopy(body);
+    params_ = nullptr;
+
+    if (inlined) {
+        functions_[iden] = Inlinable{ body, std::move(inlined), params.size() };
+    }
+}
+
+// -------------------------------------------------------------
+void Optimizer::forgetFunction(IdenType iden) {
+    functions_.erase(iden);
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Optimizer::inlineCall(const FunctionApp &call, IdenType iden, std::size_t numArgs) const {
+    if (level_ >= 2) {
+        const auto iter = functions_.find(iden);
+        if (iter != functions_.end() && iter->second.numParams == numArgs) {
+            return CodeNode::make<InlinedCall>(call, iter->second.callee, iter->second.body);
+        }
+    }
+    return CodeNode::SharedPtr();
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Optimizer::inlineCopy(const CodeNode::SharedPtr &node) {
+    if (!node || ++inlineSize_ > MaxInlineSize) {
+        return CodeNode::SharedPtr();
+    }
+    return node->inlineCopy(*this);
+}
+
+// -------------------------------------------------------------
+bool Optimizer::inlineCopy(const CodeNode::SharedPtrList &nodes, CodeNode::SharedPtrList &copies) {
+    copies.reserve(nodes.size());
+    for (const auto &node : nodes) {
+        auto copy = inlineCopy(node);
+        if (!copy) { return false; }
+        copies.push_back(std::move(copy));
+    }
+    return true;
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Optimizer::inlineParam(IdenType iden, const VarAddress &address) const {
+    if (params_) {
+        const auto param = std::ranges::find(*params_, iden);
+        if (param != params_->end()) {
+            // Parameters occupy the leading slots of the function scope
+            const auto index = static_cast<std::size_t>(param - params_->begin());
+            if (!address.isLexical() || (address.depth == 0 && address.slot == index)) {
+                return CodeNode::make<InlineParam>(iden, index);
+            }
+        }
+    }
+    return CodeNode::SharedPtr();
+}
+
+// -------------------------------------------------------------
+//                        NODE REWRITES
+// -------------------------------------------------------------
+
+namespace {
+
+    void dumpNodes(std::ostream &out, const CodeNode::SharedPtrList &nodes) {
+        for (const auto &node : nodes) {
+            out << ' ';
+            Optimizer::dump(node, out);
+        }
+    }
+
+    void dumpParams(std::ostream &out, const ScopeLayout::IdenList &params) {
+        out << '(';
+        for (std::size_t i = 0; i < params.size(); ++i) {
+            out << (i > 0 ? " " : "") << Environment::idenTable().getName(params[i]);
+        }
+        out << ')';
+    }
+
+    bool isBoolLiteral(const CodeNode::SharedPtr &node) {
+        return node && node->isLiteral() && node->literalValue().isBool();
+    }
+
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr CodeNode::optimize(Optimizer &/*optimizer*/) {
+    return SharedPtr();
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr CodeNode::inlineCopy(Optimizer &/*optimizer*/) const {
+    return SharedPtr();
+}
+
+// -------------------------------------------------------------
+void CodeNode::dump(std::ostream &out) const {
+    const char *mangled = typeid(*this).name();
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled(abi::__cxa_demangle(mangled, nullptr, nullptr, &status), &std::free);
+
+    std::string_view name(status == 0 ? demangled.get() : mangled);
+    if (name.starts_with("Ishlang::")) { name.remove_prefix(9); }
+    out << '<' << name << '>';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr UnaryOp::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(operand_);
+    return CodeNode::SharedPtr();
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr BinaryOp::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(lhs_);
+    optimizer.optimizeNode(rhs_);
+    return CodeNode::SharedPtr();
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr VariadicOp::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNodes(operands_);
+    return CodeNode::SharedPtr();
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr FileOp::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(file_);
+    return CodeNode::SharedPtr();
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Literal::inlineCopy(Optimizer &/*optimizer*/) const {
+    return CodeNode::make<Literal>(*this);
+}
+
+void Literal::dump(std::ostream &out) const {
+    out << value_;
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Variable::inlineCopy(Optimizer &optimizer) const {
+    return optimizer.inlineParam(iden_, address_);
+}
+
+void Variable::dump(std::ostream &out) const {
+    out << identifierName();
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Define::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(code_);
+    if (!address_.isLexical()) { optimizer.forgetFunction(iden_); }
+    return CodeNode::SharedPtr();
+}
+
+void Define::dump(std::ostream &out) const {
+    out << "(var " << Environment::idenTable().getName(iden_) << ' ';
+    Optimizer::dump(code_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Assign::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(code_);
+    if (!address_.isLexical()) { optimizer.forgetFunction(iden_); }
+    return CodeNode::SharedPtr();
+}
+
+void Assign::dump(std::ostream &out) const {
+    out << "(= " << Environment::idenTable().getName(iden_) << ' ';
+    Optimizer::dump(code_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr ArithOp::fold(Optimizer &optimizer) {
+    optimizer.optimizeNodes(operands_);
+
+    const bool numbers = std::ranges::all_of(
+        operands_,
+        [](const auto &operand) {
+            return operand->isLiteral() && (operand->literalValue().isInt() || operand->literalValue().isReal());
+        });
+    if (numbers) {
+        std::vector<Value> values;
+        values.reserve(operands_.size());
+        for (const auto &operand : operands_) {
+            values.push_back(operand->literalValue());
+        }
+
+        try {
+            return Optimizer::literal(apply(type_, values));
+        }
+        catch (const Exception &) {
+            // Left to raise when evaluated
+        }
+    }
+    return CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr ArithOp::optimize(Optimizer &optimizer) {
+    if (auto folded = fold(optimizer)) {
+        return folded;
+    }
+    return operands_.size() == 2 ? CodeNode::make<BinaryArithOp>(type_, operands_) : CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr ArithOp::inlineCopy(Optimizer &optimizer) const {
+    CodeNode::SharedPtrList operands;
+    if (!optimizer.inlineCopy(operands_, operands)) {
+        return CodeNode::SharedPtr();
+    }
+    return operands.size() == 2 ? CodeNode::make<BinaryArithOp>(type_, operands) : CodeNode::make<ArithOp>(type_, operands);
+}
+
+void ArithOp::dump(std::ostream &out) const {
+    out << '(' << static_cast<char>(type_);
+    dumpNodes(out, operands_);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr BinaryArithOp::optimize(Optimizer &optimizer) {
+    return fold(optimizer);
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr ArithAssignOp::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(delta_);
+    return CodeNode::SharedPtr();
+}
+
+void ArithAssignOp::dump(std::ostream &out) const {
+    out << '(' << static_cast<char>(type_) << "= " << Environment::idenTable().getName(iden_) << ' ';
+    Optimizer::dump(delta_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr CompOp::optimize(Optimizer &optimizer) {
+    BinaryOp::optimize(optimizer);
+
+    if (lhs_ && rhs_ && lhs_->isLiteral() && rhs_->isLiteral()) {
+        try {
+            return Optimizer::literal(apply(type_, lhs_->literalValue(), rhs_->literalValue()));
+        }
+        catch (const Exception &) {
+            // Left to raise when evaluated
+        }
+    }
+    return CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr CompOp::inlineCopy(Optimizer &optimizer) const {
+    auto lhs = optimizer.inlineCopy(lhs_);
+    auto rhs = optimizer.inlineCopy(rhs_);
+    return lhs && rhs ? CodeNode::make<CompOp>(type_, lhs, rhs) : CodeNode::SharedPtr();
+}
+
+void CompOp::dump(std::ostream &out) const {
+    out << '(' << op2str(type_) << ' ';
+    Optimizer::dump(lhs_, out);
+    out << ' ';
+    Optimizer::dump(rhs_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr LogicOp::optimize(Optimizer &optimizer) {
+    VariadicOp::optimize(optimizer);
+
+    // A literal false in a conjunction, or true in a disjunction, decides
+    // the result and later operands never run. Other literals do not
+    // change it. Operands of other types are left to raise when evaluated.
+    const bool conjunction = type_ == Conjunction;
+    CodeNode::SharedPtrList operands;
+    for (auto &operand : operands_) {
+        if (isBoolLiteral(operand)) {
+            if (operand->literalValue().boolean() == conjunction) { continue; }
+            if (operands.empty()) { return Optimizer::literal(Value(!conjunction)); }
+            operands.push_back(operand);
+            break;
+        }
+        operands.push_back(operand);
+    }
+
+    if (operands.empty()) {
+        return Optimizer::literal(Value(conjunction));
+    }
+    operands_ = std::move(operands);
+    return CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr LogicOp::inlineCopy(Optimizer &optimizer) const {
+    CodeNode::SharedPtrList operands;
+    if (!optimizer.inlineCopy(operands_, operands)) {
+        return CodeNode::SharedPtr();
+    }
+    return CodeNode::make<LogicOp>(type_, operands);
+}
+
+void LogicOp::dump(std::ostream &out) const {
+    out << (type_ == Conjunction ? "(and" : "(or");
+    dumpNodes(out, operands_);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Not::optimize(Optimizer &optimizer) {
+    UnaryOp::optimize(optimizer);
+    return isBoolLiteral(operand_) ? Optimizer::literal(Value(!operand_->literalValue().boolean())) : CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr Not::inlineCopy(Optimizer &optimizer) const {
+    auto operand = optimizer.inlineCopy(operand_);
+    return operand ? CodeNode::make<Not>(operand) : CodeNode::SharedPtr();
+}
+
+void Not::dump(std::ostream &out) const {
+    out << "(not ";
+    Optimizer::dump(operand_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr NegativeOf::optimize(Optimizer &optimizer) {
+    UnaryOp::optimize(optimizer);
+    if (operand_ && operand_->isLiteral()) {
+        const auto &value = operand_->literalValue();
+        if (value.isInt())  { return Optimizer::literal(Value(-value.integer())); }
+        if (value.isReal()) { return Optimizer::literal(Value(-value.real())); }
+    }
+    return CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr NegativeOf::inlineCopy(Optimizer &optimizer) const {
+    auto operand = optimizer.inlineCopy(operand_);
+    return operand ? CodeNode::make<NegativeOf>(operand) : CodeNode::SharedPtr();
+}
+
+void NegativeOf::dump(std::ostream &out) const {
+    out << "(neg ";
+    Optimizer::dump(operand_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr ProgN::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNodes(exprs_);
+
+    // Literals only give the value of the last expression
+    if (exprs_.size() > 1) {
+        const auto last = std::prev(exprs_.end());
+        exprs_.erase(std::remove_if(exprs_.begin(), last, [](const auto &expr) { return expr->isLiteral(); }), last);
+    }
+    yields_ = std::ranges::any_of(exprs_, [](const auto &expr) { return expr && expr->yields(); });
+    return CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr ProgN::inlineCopy(Optimizer &optimizer) const {
+    CodeNode::SharedPtrList exprs;
+    if (!optimizer.inlineCopy(exprs_, exprs)) {
+        return CodeNode::SharedPtr();
+    }
+    return CodeNode::make<ProgN>(exprs);
+}
+
+void ProgN::dump(std::ostream &out) const {
+    out << "(progn";
+    dumpNodes(out, exprs_);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Block::inlineCopy(Optimizer &optimizer) const {
+    // Without a frame of its own a block evaluates like progn
+    return ScopeLayout::elides(layout_) ? ProgN::inlineCopy(optimizer) : CodeNode::SharedPtr();
+}
+
+void Block::dump(std::ostream &out) const {
+    out << "(block";
+    dumpNodes(out, exprs_);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr If::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(pred_);
+    optimizer.optimizeNode(tCode_);
+    optimizer.optimizeNode(fCode_);
+    yields_ = (tCode_ && tCode_->yields()) || (fCode_ && fCode_->yields());
+
+    // Branches evaluate in the scope of the if, unless it is elided
+    if (isBoolLiteral(pred_) && ScopeLayout::elides(layout_)) {
+        const auto &code = pred_->literalValue().boolean() ? tCode_ : fCode_;
+        return code ? code : Optimizer::literal(Value::Null);
+    }
+    return CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr If::inlineCopy(Optimizer &optimizer) const {
+    if (!ScopeLayout::elides(layout_)) {
+        return CodeNode::SharedPtr();
+    }
+
+    auto pred = optimizer.inlineCopy(pred_);
+    auto tCode = optimizer.inlineCopy(tCode_);
+    auto fCode = fCode_ ? optimizer.inlineCopy(fCode_) : CodeNode::SharedPtr();
+    if (!pred || !tCode || (fCode_ && !fCode)) {
+        return CodeNode::SharedPtr();
+    }
+    return CodeNode::make<If>(pred, tCode, fCode, layout_);
+}
+
+void If::dump(std::ostream &out) const {
+    out << "(if ";
+    Optimizer::dump(pred_, out);
+    out << ' ';
+    Optimizer::dump(tCode_, out);
+    if (fCode_) {
+        out << ' ';
+        Optimizer::dump(fCode_, out);
+    }
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Cond::optimize(Optimizer &optimizer) {
+    CodeNode::SharedPtrPairs cases;
+    for (auto &[pred, code] : cases_) {
+        optimizer.optimizeNode(pred);
+        optimizer.optimizeNode(code);
+
+        if (isBoolLiteral(pred)) {
+            if (!pred->literalValue().boolean()) { continue; }
+
+            // Later cases are never reached
+            if (cases.empty()) { return code ? code : Optimizer::literal(Value::Null); }
+            cases.emplace_back(pred, code);
+            break;
+        }
+        cases.emplace_back(pred, code);
+    }
+
+    if (cases.empty()) {
+        return Optimizer::literal(Value::Null);
+    }
+    cases_ = std::move(cases);
+    yields_ = std::ranges::any_of(cases_, [](const auto &c) { return c.second && c.second->yields(); });
+    return CodeNode::SharedPtr();
+}
+
+CodeNode::SharedPtr Cond::inlineCopy(Optimizer &optimizer) const {
+    CodeNode::SharedPtrPairs cases;
+    for (const auto &[pred, code] : cases_) {
+        auto predCopy = optimizer.inlineCopy(pred);
+        auto codeCopy = code ? optimizer.inlineCopy(code) : CodeNode::SharedPtr();
+        if (!predCopy || (code && !codeCopy)) {
+            return CodeNode::SharedPtr();
+        }
+        cases.emplace_back(predCopy, codeCopy);
+    }
+    return CodeNode::make<Cond>(cases);
+}
+
+void Cond::dump(std::ostream &out) const {
+    out << "(cond";
+    for (const auto &[pred, code] : cases_) {
+        out << " (";
+        Optimizer::dump(pred, out);
+        out << ' ';
+        Optimizer::dump(code, out);
+        out << ')';
+    }
+    out << ')';
+}
+
+// -------------------------------------------------------------
+void Break::dump(std::ostream &out) const {
+    out << "(break)";
+}
+
+// -------------------------------------------------------------
+void Continue::dump(std::ostream &out) const {
+    out << "(continue)";
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Return::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(expr_);
+    return CodeNode::SharedPtr();
+}
+
+void Return::dump(std::ostream &out) const {
+    out << "(return";
+    if (expr_) {
+        out << ' ';
+        Optimizer::dump(expr_, out);
+    }
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Yield::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(expr_);
+    return CodeNode::SharedPtr();
+}
+
+void Yield::dump(std::ostream &out) const {
+    out << "(yield ";
+    Optimizer::dump(expr_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Loop::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(decl_);
+    optimizer.optimizeNode(cond_);
+    optimizer.optimizeNode(next_);
+    optimizer.optimizeNode(body_);
+    return CodeNode::SharedPtr();
+}
+
+void Loop::dump(std::ostream &out) const {
+    out << "(loop";
+    for (const auto &node : { decl_, cond_, next_, body_ }) {
+        if (node) {
+            out << ' ';
+            node->dump(out);
+        }
+    }
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr While::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(cond_);
+    optimizer.optimizeNode(body_);
+    return CodeNode::SharedPtr();
+}
+
+void While::dump(std::ostream &out) const {
+    out << "(while ";
+    Optimizer::dump(cond_, out);
+    out << ' ';
+    Optimizer::dump(body_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Foreach::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(container_);
+    optimizer.optimizeNode(body_);
+    return CodeNode::SharedPtr();
+}
+
+void Foreach::dump(std::ostream &out) const {
+    out << "(foreach " << Environment::idenTable().getName(iden_) << ' ';
+    Optimizer::dump(container_, out);
+    out << ' ';
+    Optimizer::dump(body_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr LambdaExpr::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(body_);
+    return CodeNode::SharedPtr();
+}
+
+void LambdaExpr::dump(std::ostream &out) const {
+    out << "(lambda ";
+    dumpParams(out, params_);
+    out << ' ';
+    Optimizer::dump(body_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+void GeneratorExpr::dump(std::ostream &out) const {
+    out << "(generator ";
+    dumpParams(out, params_);
+    out << ' ';
+    Optimizer::dump(body_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr LambdaApp::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNode(closure_);
+    optimizer.optimizeNodes(argExprs_);
+    return CodeNode::SharedPtr();
+}
+
+void LambdaApp::dump(std::ostream &out) const {
+    out << '(';
+    Optimizer::dump(closure_, out);
+    dumpNodes(out, argExprs_);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr FunctionExpr::optimize(Optimizer &optimizer) {
+    // Calls in the body to an earlier function of the same name are not
+    // inlined, that function is being replaced
+    optimizer.forgetFunction(iden_);
+    LambdaExpr::optimize(optimizer);
+    if (!address_.isLexical()) {
+        optimizer.defineFunction(iden_, params_, body_);
+    }
+    return CodeNode::SharedPtr();
+}
+
+void FunctionExpr::dump(std::ostream &out) const {
+    out << "(defun " << Environment::idenTable().getName(iden_) << ' ';
+    dumpParams(out, params_);
+    out << ' ';
+    Optimizer::dump(body_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr FunctionApp::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNodes(argExprs_);
+
+    // Local functions are not inlined
+    return address_.isLexical() ? CodeNode::SharedPtr() : optimizer.inlineCall(*this, iden_, argExprs_.size());
+}
+
+void FunctionApp::dump(std::ostream &out) const {
+    out << '(' << Environment::idenTable().getName(iden_);
+    dumpNodes(out, argExprs_);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+void InlineParam::dump(std::ostream &out) const {
+    out << Environment::idenTable().getName(iden_);
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr InlinedCall::optimize(Optimizer &/*optimizer*/) {
+    return CodeNode::SharedPtr();
+}
+
+void InlinedCall::dump(std::ostream &out) const {
+    out << "(inline ";
+    FunctionApp::dump(out);
+    out << ' ';
+    Optimizer::dump(body_, out);
+    out << ')';
+}
+
+// -------------------------------------------------------------
+CodeNode::SharedPtr Print::optimize(Optimizer &optimizer) {
+    optimizer.optimizeNodes(exprs_);
+    return CodeNode::SharedPtr();
+}
+
+void Print::dump(std::ostream &out) const {
+    out << (newline_ ? "(println" : "(print");
+    dumpNodes(out, exprs_);
+    out << ')';
+}
@@ -0,0 +1,85 @@
+#ifndef ISHLANG_OPTIMIZER_H
+#define ISHLANG_OPTIMIZER_H
+
+#include "code_node_bases.h"
+#include "iden_table.h"
+#include "scope_layout.h"
+
+#include <cstddef>
+#include <ostream>
+#include <unordered_map>
+
+namespace Ishlang {
+
+    class FunctionApp;
+
+    // Rewrites CodeNode trees between parsing and evaluation. Nodes optimize
+    // themselves through CodeNode::optimize, anything without a dedicated
+    // rewrite is kept as parsed.
+    //
+    // Level 1 folds operations on literals, removes branches of if and cond
+    // with literal predicates and specializes two operand arithmetic. Level
+    // 2 also inlines calls to small functions defined at the top level,
+    // whose bodies only combine their parameters with the operations above.
+    // Functions are remembered across forms, for calls made by later ones.
+    class Optimizer {
+    public:
+        static constexpr unsigned    MaxLevel      = 2;
+        static constexpr std::size_t MaxInlineSize = 16;
+
+    public:
+        explicit Optimizer(unsigned level = 0);
+
+        inline unsigned level() const noexcept;
+        void setLevel(unsigned level) noexcept;
+
+        // Optimized form, the one given when the level is 0.
+        CodeNode::SharedPtr optimize(CodeNode::SharedPtr code);
+
+        // Prints a form as an expression.
+        static void dump(const CodeNode::SharedPtr &code, std::ostream &out);
+
+    public:
+        void optimizeNode(CodeNode::SharedPtr &node);
+        void optimizeNodes(CodeNode::SharedPtrList &nodes);
+
+        static CodeNode::SharedPtr literal(const Value &value);
+
+        // Called by function definitions and by definitions or assignments
+        // that may replace one.
+        void defineFunction(IdenType iden, const ScopeLayout::IdenList &params, const CodeNode::SharedPtr &body);
+        void forgetFunction(IdenType iden);
+
+        // Call of a function defined by defineFunction, null when the
+        // function was not inlinable or arguments do not match.
+        CodeNode::SharedPtr inlineCall(const FunctionApp &call, IdenType iden, std::size_t numArgs) const;
+
+        // Used by inlineCopy, null when some node can not be inlined.
+        CodeNode::SharedPtr inlineCopy(const CodeNode::SharedPtr &node);
+        bool inlineCopy(const CodeNode::SharedPtrList &nodes, CodeNode::SharedPtrList &copies);
+        CodeNode::SharedPtr inlineParam(IdenType iden, const VarAddress &address) const;
+
+    private:
+        struct Inlinable {
+            CodeNode::SharedPtr callee;
+            CodeNode::SharedPtr body;
+            std::size_t         numParams;
+        };
+
+    private:
+        unsigned                                level_;
+        std::unordered_map<IdenType, Inlinable> functions_;
+        const ScopeLayout::IdenList            *params_;
+        std::size_t                             inlineSize_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline unsigned Optimizer::level() const noexcept {
+        return level_;
+    }
+
+}
+
+#endif	// ISHLANG_OPTIMIZER_H
@@ -0,0 +1,203 @@
+#include "output.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace Ishlang;
+
+namespace {
+
+    // -------------------------------------------------------------
+    class StdOutBuffer : public std::streambuf {
+    public:
+        static constexpr std::size_t Size = 64 * 1024;
+
+    public:
+        StdOutBuffer()
+            : buffer_(Size)
+        {
+            reset();
+        }
+
+        virtual ~StdOutBuffer() {
+            sync();
+        }
+
+        // Room for count characters at pptr(), written by the caller and
+        // committed with commit.
+        char *reserve(std::size_t count) {
+            if (static_cast<std::size_t>(epptr() - pptr()) < count) { sync(); }
+            return pptr();
+        }
+
+        void commit(const char *end) {
+            pbump(static_cast<int>(end - pptr()));
+        }
+
+    protected:
+        virtual int_type overflow(int_type c) override {
+            if (sync() != 0) { return traits_type::eof(); }
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        virtual std::streamsize xsputn(const char *s, std::streamsize count) override {
+            const auto size = static_cast<std::size_t>(count);
+            if (static_cast<std::size_t>(epptr() - pptr()) < size) {
+                if (sync() != 0) { return 0; }
+                if (size >= buffer_.size()) {
+                    return writeAll(s, size) ? count : 0;
+                }
+            }
+            std::memcpy(pptr(), s, size);
+            pbump(static_cast<int>(size));
+            return count;
+        }
+
+        virtual int sync() override {
+            const bool ok = writeAll(pbase(), static_cast<std::size_t>(pptr() - pbase()));
+            reset();
+            return ok ? 0 : -1;
+        }
+
+    private:
+        void reset() {
+            setp(buffer_.data(), buffer_.data() + buffer_.size());
+        }
+
+        static bool writeAll(const char *data, std::size_t size) {
+            while (size > 0) {
+                const auto written = ::write(STDOUT_FILENO, data, size);
+                if (written < 0) {
+                    if (errno == EINTR) { continue; }
+                    return false;
+                }
+                data += written;
+                size -= static_cast<std::size_t>(written);
+            }
+            return true;
+        }
+
+    private:
+        std::vector<char> buffer_;
+    };
+
+    // -------------------------------------------------------------
+    // Standard streams are tied to the buffered stream so it is flushed
+    // before they are used, and untied again at exit.
+    struct StdOut {
+        StdOutBuffer         buffer;
+        std::ostream         stream;
+        bool                 terminal;
+        std::recursive_mutex mutex;
+
+        StdOut()
+            : buffer()
+            , stream(&buffer)
+            , terminal(::isatty(STDOUT_FILENO) != 0)
+            , mutex()
+        {
+            std::cout.tie(&stream);
+            std::cerr.tie(&stream);
+            std::cin.tie(&stream);
+        }
+
+        ~StdOut() {
+            stream.flush();
+            std::cin.tie(&std::cout);
+            std::cerr.tie(&std::cout);
+            std::cout.tie(nullptr);
+        }
+    };
+
+    StdOut &stdOut() {
+        static StdOut out;
+        return out;
+    }
+
+}
+
+// -------------------------------------------------------------
+std::string_view Output::format(Value::Long i, NumberBuffer &buf) noexcept {
+    const auto result = std::to_chars(buf.data(), buf.data() + buf.size(), i);
+    return std::string_view(buf.data(), result.ptr);
+}
+
+// -------------------------------------------------------------
+std::string_view Output::format(Value::Double r, NumberBuffer &buf) noexcept {
+    const auto result = std::to_chars(buf.data(), buf.data() + buf.size(), r, std::chars_format::general, 6);
+    return std::string_view(buf.data(), result.ptr);
+}
+
+// -------------------------------------------------------------
+std::ostream &Output::stream() {
+    return stdOut().stream;
+}
+
+// -------------------------------------------------------------
+void Output::write(std::string_view text) {
+    Lock lock;
+    stdOut().buffer.sputn(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+// -------------------------------------------------------------
+void Output::write(char c) {
+    Lock lock;
+    stdOut().buffer.sputc(c);
+}
+
+// -------------------------------------------------------------
+void Output::write(Value::Long i) {
+    Lock lock;
+    auto &buffer = stdOut().buffer;
+    char *first = buffer.reserve(std::tuple_size_v<NumberBuffer>);
+    buffer.commit(std::to_chars(first, first + std::tuple_size_v<NumberBuffer>, i).ptr);
+}
+
+// -------------------------------------------------------------
+void Output::write(Value::Double r) {
+    Lock lock;
+    auto &buffer = stdOut().buffer;
+    char *first = buffer.reserve(std::tuple_size_v<NumberBuffer>);
+    buffer.commit(std::to_chars(first, first + std::tuple_size_v<NumberBuffer>, r, std::chars_format::general, 6).ptr);
+}
+
+// -------------------------------------------------------------
+void Output::newline() {
+    Lock lock;
+    auto &out = stdOut();
+    out.buffer.sputc('\n');
+    if (out.terminal) { out.buffer.pubsync(); }
+}
+
+// -------------------------------------------------------------
+void Output::flush() {
+    Lock lock;
+    stdOut().buffer.pubsync();
+}
+
+// -------------------------------------------------------------
+bool Output::terminal() {
+    return stdOut().terminal;
+}
+
+// -------------------------------------------------------------
+Output::Lock::Lock()
+    : locked_(RefCount::atomic())
+{
+    if (locked_) { stdOut().mutex.lock(); }
+}
+
+Output::Lock::~Lock() {
+    if (locked_) { stdOut().mutex.unlock(); }
+}
@@ -0,0 +1,57 @@
+#ifndef ISHLANG_OUTPUT_H
+#define ISHLANG_OUTPUT_H
+
+#include "value.h"
+
+#include <array>
+#include <ostream>
+#include <string_view>
+
+namespace Ishlang {
+
+    // Buffered standard output used by print, println and the REPL. The
+    // buffer is written out when full, on flush, at exit, before reading
+    // standard input or writing standard error, and after every line when
+    // standard output is a terminal. Numbers are formatted with to_chars,
+    // reals as %g with six digits like the stream defaults.
+    class Output {
+    public:
+        using NumberBuffer = std::array<char, 32>;
+
+        class Lock;
+
+    public:
+        static std::string_view format(Value::Long i, NumberBuffer &buf) noexcept;
+        static std::string_view format(Value::Double r, NumberBuffer &buf) noexcept;
+
+        // Stream over the buffer, for values printed through operator<<.
+        static std::ostream &stream();
+
+        static void write(std::string_view text);
+        static void write(char c);
+        static void write(Value::Long i);
+        static void write(Value::Double r);
+
+        static void newline();
+        static void flush();
+
+        static bool terminal();
+    };
+
+    // Keeps other threads from writing while held, once reference counts
+    // are atomic. Writes take it themselves, print holds it for a line.
+    class Output::Lock {
+    public:
+        Lock();
+        ~Lock();
+
+        Lock(const Lock &) = delete;
+        Lock &operator=(const Lock &) = delete;
+
+    private:
+        bool locked_;
+    };
+
+}
+
+#endif // ISHLANG_OUTPUT_H
@@ -15,6 +15,8 @@ using namespace Ishlang;
 // -------------------------------------------------------------
 Parser::Parser()
     : lexer_()
+    , resolver_()
+    , literals_()
 {
     initAppFtns();
 }
@@ -22,6 +24,7 @@ Parser::Parser()
 // -------------------------------------------------------------
 CodeNode::SharedPtr Parser::read(const std::string &expr) {
     lexer_.read(expr);
+    resolver_.reset();
     return readExpr();
 }
 
@@ -52,6 +55,7 @@ void Parser::readMulti(const std::string &expr, CallBack callback) {
             return;
         }
 
+        resolver_.reset();
         auto code = readExpr();
         if (code) {
             callback(code);
@@ -117,8 +121,11 @@ CodeNode::SharedPtr Parser::readExpr() {
             case Lexer::Null:
                 return makeLiteral(token.type, token.text);
 
-            case Lexer::Symbol:
-                return CodeNode::make<Variable>(token.text);
+            case Lexer::Symbol: {
+                auto var(std::make_shared<Variable>(token.text));
+                resolver_.reference(*var);
+                return var;
+            }
 
             case Lexer::Unknown:
                 throw UnknownTokenType(token.text, static_cast<char>(token.type));
@@ -137,7 +144,7 @@ CodeNode::SharedPtr Parser::makeLiteral(Lexer::TokenType type, const std::string
         return CodeNode::make<Literal>(Value(text[1]));
 
     case Lexer::String:
-        return CodeNode::make<Literal>(Value(std::string(text.c_str() + 1, text.size() - 2)));
+        return CodeNode::make<Literal>(internText(std::string(text.c_str() + 1, text.size() - 2)));
 
     case Lexer::Int:
         return CodeNode::make<Literal>(Value(Value::Long(std::stoll(text, 0, 10))));
@@ -155,6 +162,17 @@ CodeNode::SharedPtr Parser::makeLiteral(Lexer::TokenType type, const std::string
     return CodeNode::make<Literal>(Value::Null);
 }
 
+// -------------------------------------------------------------
+const Value &Parser::internText(std::string &&text) {
+    // Equal string literals share one immutable buffer
+    auto iter = literals_.find(text);
+    if (iter == literals_.end()) {
+        auto value = Value::immutableText(text);
+        iter = literals_.emplace(std::move(text), std::move(value)).first;
+    }
+    return iter->second;
+}
+
 // -------------------------------------------------------------
 CodeNode::SharedPtr Parser::readApp(const std::string &expected) {
     if (!lexer_.empty()) {
@@ -173,7 +191,9 @@ CodeNode::SharedPtr Parser::readApp(const std::string &expected) {
                 if (token.type == Lexer::Symbol) {
                     const auto & name(token.text);
                     auto args(readExprList());
-                    return CodeNode::make<FunctionApp>(name, args);
+                    auto app(std::make_shared<FunctionApp>(name, args));
+                    resolver_.reference(*app);
+                    return app;
                 }
                 else {
                     throw UnknownSymbol(token.text);
@@ -348,6 +368,21 @@ CodeNode::ParamList Parser::readParams() {
     return params;
 }
 
+// -------------------------------------------------------------
+void Parser::declareParams(const CodeNode::ParamList &params) {
+    // Parameters are bound to the leading slots of the lambda scope,
+    // repeated names keep the dynamic binding and its duplicate error.
+    for (const auto &param : params) {
+        if (std::ranges::count(params, param) > 1) {
+            resolver_.makeDynamic();
+            return;
+        }
+    }
+    for (const auto &param : params) {
+        resolver_.declare(Environment::idenTable().mapName(param));
+    }
+}
+
 // -------------------------------------------------------------
 bool Parser::ignoreLeftP(bool allowRightP) {
     auto token = lexer_.next();
@@ -393,6 +428,7 @@ void Parser::initAppFtns() {
         { "import",
           [this]() {
               const auto nameAndAsList = readNameAndAsList();
+              resolver_.makeDynamic();
               if (nameAndAsList.size() == 1) {
                   return CodeNode::make<ImportModule>(nameAndAsList[0].first,
                                                       nameAndAsList[0].second ? *nameAndAsList[0].second : "");
@@ -412,6 +448,7 @@ void Parser::initAppFtns() {
               }
 
               const auto nameAndAsList = readNameAndAsList();
+              resolver_.makeDynamic();
               if (nameAndAsList.size() > 0) {
                   return CodeNode::make<FromModuleImport>(name, nameAndAsList);
               }
@@ -425,7 +462,9 @@ void Parser::initAppFtns() {
           [this]() {
               const auto name(readName());
               auto expr(readAndCheckExprList("var", 1));
-              return CodeNode::make<Define>(name, expr[0]);
+              auto def(std::make_shared<Define>(name, expr[0]));
+              resolver_.define(*def);
+              return def;
           }
         },
 
@@ -433,7 +472,9 @@ void Parser::initAppFtns() {
           [this]() {
               const auto name(readName());
               auto expr(readAndCheckExprList("=", 1));
-              return CodeNode::make<Assign>(name, expr[0]);
+              auto assign(std::make_shared<Assign>(name, expr[0]));
+              resolver_.reference(*assign);
+              return assign;
           }
         },
 
@@ -441,6 +482,7 @@ void Parser::initAppFtns() {
           [this]() {
               const auto name(readName());
               ignoreRightP();
+              resolver_.keepFrame();
               return CodeNode::make<Exists>(name);
           }
         },
@@ -499,19 +541,23 @@ void Parser::initAppFtns() {
 
         { "block",
           [this]() {
+              resolver_.pushScope();
               auto exprs(readExprList());
-              return CodeNode::make<Block>(exprs);
+              auto layout(resolver_.popScope());
+              return CodeNode::make<Block>(exprs, layout);
           }
         },
 
         { "if",
           [this]() {
+              resolver_.pushScope();
               auto exprs(readExprList());
+              auto layout(resolver_.popScope());
               if (exprs.size() == 2) {
-                  return CodeNode::make<If>(exprs[0], exprs[1]);
+                  return CodeNode::make<If>(exprs[0], exprs[1], layout);
               }
               else if (exprs.size() == 3) {
-                  return CodeNode::make<If>(exprs[0], exprs[1], exprs[2]);
+                  return CodeNode::make<If>(exprs[0], exprs[1], exprs[2], layout);
               }
               else {
                   throw TooManyOrFewForms("if");
@@ -521,15 +567,19 @@ void Parser::initAppFtns() {
 
         { "when",
           [this]() {
+              resolver_.pushScope();
               auto exprs(readAndCheckExprList("when", 2));
-              return CodeNode::make<If>(exprs[0], exprs[1]);
+              auto layout(resolver_.popScope());
+              return CodeNode::make<If>(exprs[0], exprs[1], layout);
           }
         },
 
         { "unless",
           [this]() {
+              resolver_.pushScope();
               auto exprs(readAndCheckExprList("unless", 2));
-              return CodeNode::make<If>(CodeNode::make<Not>(exprs[0]), exprs[1]);
+              auto layout(resolver_.popScope());
+              return CodeNode::make<If>(CodeNode::make<Not>(exprs[0]), exprs[1], layout);
           }
         },
 
@@ -547,22 +597,47 @@ void Parser::initAppFtns() {
           }
         },
 
+        { "continue",
+          [this]() {
+              ignoreRightP();
+              return CodeNode::make<Continue>();
+          }
+        },
+
+        { "return",
+          [this]() {
+              if (!resolver_.inFunction()) { throw InvalidExpression("return outside of function"); }
+              auto exprs(readAndCheckRangeExprList("return", 0, 1));
+              return CodeNode::make<Return>(exprs.empty() ? CodeNode::SharedPtr() : exprs[0]);
+          }
+        },
+
+        { "yield",
+          [this]() {
+              if (!resolver_.inGenerator()) { throw InvalidExpression("yield outside of generator"); }
+              auto exprs(readAndCheckExprList("yield", 1));
+              return CodeNode::make<Yield>(exprs[0]);
+          }
+        },
+
         { "loop",
           [this]() {
+              resolver_.pushScope();
               auto forms(readExprList());
+              auto layout(resolver_.popScope());
               if (forms.size() == 4) {
                   auto iter = forms.begin();
                   auto decl(*iter++);
                   auto cond(*iter++);
                   auto next(*iter++);
                   auto body(*iter++);
-                  return CodeNode::make<Loop>(decl, cond, next, body);
+                  return CodeNode::make<Loop>(decl, cond, next, body, layout);
               }
               else if (forms.size() == 2) {
                   auto iter = forms.begin();
                   auto cond(*iter++);
                   auto body(*iter++);
-                  return CodeNode::make<Loop>(cond, body);
+                  return CodeNode::make<Loop>(cond, body, layout);
               }
               else {
                   throw TooManyOrFewForms("loop");
@@ -572,27 +647,49 @@ void Parser::initAppFtns() {
 
         { "while",
           [this]() {
+              resolver_.pushScope();
               auto forms(readAndCheckExprList("while", 2));
-              return CodeNode::make<While>(forms[0], forms[1]);
+              auto layout(resolver_.popScope());
+              return CodeNode::make<While>(forms[0], forms[1], layout);
           }
         },
 
         { "foreach",
           [this]() {
               const auto name(readName());
+              resolver_.pushScope();
+              resolver_.declare(Environment::idenTable().mapName(name));
               auto forms(readAndCheckExprList("foreach", 2));
-              return CodeNode::make<Foreach>(name, forms[0], forms[1]);
+              auto layout(resolver_.popScope());
+              return CodeNode::make<Foreach>(name, forms[0], forms[1], layout);
           }
         },
 
         { "lambda",
           [this]() {
               auto params(readParams());
+              resolver_.pushScope(true);
+              declareParams(params);
+              auto exprs(readExprList());
+              auto layout(resolver_.popScope());
+              auto body(exprs.size() == 1
+                        ? exprs[0]
+                        : CodeNode::make<ProgN>(exprs));
+              return CodeNode::make<LambdaExpr>(params, body, layout);
+          }
+        },
+
+        { "generator",
+          [this]() {
+              auto params(readParams());
+              resolver_.pushScope(true, true);
+              declareParams(params);
               auto exprs(readExprList());
+              auto layout(resolver_.popScope());
               auto body(exprs.size() == 1
                         ? exprs[0]
                         : CodeNode::make<ProgN>(exprs));
-              return CodeNode::make<LambdaExpr>(params, body);
+              return CodeNode::make<GeneratorExpr>(params, body, layout);
           }
         },
 
@@ -600,11 +697,16 @@ void Parser::initAppFtns() {
           [this]() {
               const auto name(readName());
               auto params(readParams());
+              resolver_.pushScope(true);
+              declareParams(params);
               auto exprs(readExprList());
+              auto layout(resolver_.popScope());
               auto body(exprs.size() == 1
                         ? exprs[0]
                         : CodeNode::make<ProgN>(exprs));
-              return CodeNode::make<FunctionExpr>(name, params, body);
+              auto ftn(std::make_shared<FunctionExpr>(name, params, body, layout));
+              resolver_.define(*ftn);
+              return ftn;
           }
         },
 
@@ -682,6 +784,7 @@ void Parser::initAppFtns() {
               const auto name(readName());
               const auto members(readParams());
               ignoreRightP();
+              resolver_.declare(Environment::idenTable().mapName(name));
               return CodeNode::make<StructExpr>(name, members);
           }
         },
@@ -929,6 +1032,13 @@ void Parser::initAppFtns() {
           }
         },
 
+        { "arrbsearch",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("arrbsearch", 2, 3));
+              return CodeNode::make<ArrayBinarySearch>(exprs[0], exprs[1], exprs.size() == 3 ? exprs[2] : CodeNode::SharedPtr());
+          }
+        },
+
         { "arrrev",
           [this] {
               auto exprs(readAndCheckExprList("arrrev", 1));
@@ -1172,6 +1282,41 @@ void Parser::initAppFtns() {
           }
         },
 
+        { "omfloor",
+          [this]() {
+              auto exprs(readAndCheckExprList("omfloor", 2));
+              return CodeNode::make<OrderedMapNearest>(OrderedMapNearest::Floor, exprs[0], exprs[1]);
+          }
+        },
+
+        { "omceil",
+          [this]() {
+              auto exprs(readAndCheckExprList("omceil", 2));
+              return CodeNode::make<OrderedMapNearest>(OrderedMapNearest::Ceiling, exprs[0], exprs[1]);
+          }
+        },
+
+        { "omlower",
+          [this]() {
+              auto exprs(readAndCheckExprList("omlower", 2));
+              return CodeNode::make<OrderedMapNearest>(OrderedMapNearest::Lower, exprs[0], exprs[1]);
+          }
+        },
+
+        { "omhigher",
+          [this]() {
+              auto exprs(readAndCheckExprList("omhigher", 2));
+              return CodeNode::make<OrderedMapNearest>(OrderedMapNearest::Higher, exprs[0], exprs[1]);
+          }
+        },
+
+        { "omrange",
+          [this]() {
+              auto exprs(readAndCheckExprList("omrange", 3));
+              return CodeNode::make<OrderedMapRange>(exprs[0], exprs[1], exprs[2]);
+          }
+        },
+
         { "pair",
           [this]() {
               auto exprs(readAndCheckExprList("pair", 2));
@@ -1233,6 +1378,87 @@ void Parser::initAppFtns() {
           }
         },
 
+        { "ndarray",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("ndarray", 1, 2));
+              return CodeNode::make<MakeNdArray>(exprs[0], exprs.size() == 2 ? exprs[1] : CodeNode::SharedPtr());
+          }
+        },
+
+        { "ndfill",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("ndfill", 1, 2));
+              return CodeNode::make<NdArrayFill>(exprs[0], exprs.size() == 2 ? exprs[1] : CodeNode::SharedPtr());
+          }
+        },
+
+        { "ndshape",
+          [this]() {
+              auto exprs(readAndCheckExprList("ndshape", 1));
+              return CodeNode::make<NdArrayShape>(exprs[0]);
+          }
+        },
+
+        { "ndreshape",
+          [this]() {
+              auto exprs(readAndCheckExprList("ndreshape", 2));
+              return CodeNode::make<NdArrayReshape>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "ndtranspose",
+          [this]() {
+              auto exprs(readAndCheckExprList("ndtranspose", 1));
+              return CodeNode::make<NdArrayTranspose>(exprs[0]);
+          }
+        },
+
+        { "ndslice",
+          [this]() {
+              auto exprs(readAndCheckExprList("ndslice", 4));
+              return CodeNode::make<NdArraySlice>(exprs[0], exprs[1], exprs[2], exprs[3]);
+          }
+        },
+
+        { "ndget",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("ndget", 2, std::nullopt));
+              auto arrExpr(exprs.front());
+              exprs.erase(exprs.begin());
+              return CodeNode::make<NdArrayGet>(arrExpr, exprs);
+          }
+        },
+
+        { "ndset",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("ndset", 3, std::nullopt));
+              auto arrExpr(exprs.front());
+              auto valueExpr(exprs.back());
+              return CodeNode::make<NdArraySet>(arrExpr, CodeNode::SharedPtrList(exprs.begin() + 1, exprs.end() - 1), valueExpr);
+          }
+        },
+
+        { "ndmatmul",
+          [this]() {
+              auto exprs(readAndCheckExprList("ndmatmul", 2));
+              return CodeNode::make<NdArrayMatMul>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "ndsum",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("ndsum", 1, 2));
+              return CodeNode::make<NdArraySum>(exprs[0], exprs.size() == 2 ? exprs[1] : CodeNode::SharedPtr());
+          }
+        },
+
+        { "ndtoarray",
+          [this]() {
+              auto exprs(readAndCheckExprList("ndtoarray", 1));
+              return CodeNode::make<NdArrayToArray>(exprs[0]);
+          }
+        },
+
         { "expand",
           [this]() {
               auto exprs(readAndCheckRangeExprList("expand", 1, std::nullopt));
@@ -1317,12 +1543,165 @@ void Parser::initAppFtns() {
           }
         },
 
+        { "map",
+          [this]() {
+              auto exprs(readAndCheckExprList("map", 2));
+              return CodeNode::make<GenericMap>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "filter",
+          [this]() {
+              auto exprs(readAndCheckExprList("filter", 2));
+              return CodeNode::make<GenericFilter>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "reduce",
+          [this]() {
+              auto exprs(readAndCheckExprList("reduce", 3));
+              return CodeNode::make<GenericReduce>(exprs[0], exprs[1], exprs[2]);
+          }
+        },
+
+        { "all",
+          [this]() {
+              auto exprs(readAndCheckExprList("all", 2));
+              return CodeNode::make<GenericAll>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "any",
+          [this]() {
+              auto exprs(readAndCheckExprList("any", 2));
+              return CodeNode::make<GenericAny>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "pmap",
+          [this]() {
+              auto exprs(readAndCheckExprList("pmap", 2));
+              return CodeNode::make<GenericMap>(exprs[0], exprs[1], true);
+          }
+        },
+
+        { "pfilter",
+          [this]() {
+              auto exprs(readAndCheckExprList("pfilter", 2));
+              return CodeNode::make<GenericFilter>(exprs[0], exprs[1], true);
+          }
+        },
+
+        { "preduce",
+          [this]() {
+              auto exprs(readAndCheckExprList("preduce", 3));
+              return CodeNode::make<GenericReduce>(exprs[0], exprs[1], exprs[2], true);
+          }
+        },
+
+        { "iter",
+          [this]() {
+              auto exprs(readAndCheckExprList("iter", 1));
+              return CodeNode::make<MakeIterator>(exprs[0]);
+          }
+        },
+
+        { "imap",
+          [this]() {
+              auto exprs(readAndCheckExprList("imap", 2));
+              return CodeNode::make<IteratorMap>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "ifilter",
+          [this]() {
+              auto exprs(readAndCheckExprList("ifilter", 2));
+              return CodeNode::make<IteratorFilter>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "itake",
+          [this]() {
+              auto exprs(readAndCheckExprList("itake", 2));
+              return CodeNode::make<IteratorTake>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "izip",
+          [this]() {
+              auto exprs(readAndCheckExprList("izip", 2));
+              return CodeNode::make<IteratorZip>(exprs[0], exprs[1]);
+          }
+        },
+
+        { "ienumerate",
+          [this]() {
+              auto exprs(readAndCheckExprList("ienumerate", 1));
+              return CodeNode::make<IteratorEnumerate>(exprs[0]);
+          }
+        },
+
+        { "collect",
+          [this]() {
+              auto exprs(readAndCheckExprList("collect", 1));
+              return CodeNode::make<IteratorCollect>(exprs[0]);
+          }
+        },
+
         { "timeit",
           [this]() {
-              auto exprs(readAndCheckRangeExprList("timeit", 1, 3));
-              return CodeNode::make<TimeIt>(exprs[0],
-                                            exprs.size() >= 2 ? exprs[1] : CodeNode::SharedPtr(),
-                                            exprs.size() == 3 ? exprs[2] : CodeNode::SharedPtr());
+              // Only the timed expression is evaluated in the timeit scope
+              resolver_.pushScope();
+              auto expr(readExpr());
+              auto layout(resolver_.popScope());
+              if (!expr) { throw TooManyOrFewForms("timeit"); }
+
+              auto exprs(readAndCheckRangeExprList("timeit", 0, 2));
+              return CodeNode::make<TimeIt>(expr,
+                                            exprs.size() >= 1 ? exprs[0] : CodeNode::SharedPtr(),
+                                            exprs.size() == 2 ? exprs[1] : CodeNode::SharedPtr(),
+                                            layout);
+          }
+        },
+
+        { "spawn",
+          [this]() {
+              // The spawned expression is evaluated in its own scope
+              resolver_.pushScope();
+              auto expr(readExpr());
+              auto layout(resolver_.popScope());
+              if (!expr) { throw TooManyOrFewForms("spawn"); }
+
+              readAndCheckExprList("spawn", 0);
+              return CodeNode::make<Spawn>(expr, layout);
+          }
+        },
+
+        { "await",
+          [this]() {
+              auto exprs(readAndCheckExprList("await", 1));
+              return CodeNode::make<Await>(exprs[0]);
+          }
+        },
+
+        { "awaitall",
+          [this]() {
+              auto exprs(readAndCheckExprList("awaitall", 1));
+              return CodeNode::make<AwaitAll>(exprs[0]);
+          }
+        },
+
+        { "gc",
+          [this]() {
+              ignoreRightP();
+              return CodeNode::make<GarbageCollect>();
+          }
+        },
+
+        { "gcstats",
+          [this]() {
+              ignoreRightP();
+              return CodeNode::make<GarbageStats>();
           }
         },
 
@@ -1342,8 +1721,8 @@ void Parser::initAppFtns() {
 
         { "fflush",
           [this]() {
-              auto exprs(readAndCheckExprList("fflush", 1));
-              return CodeNode::make<FileFlush>(exprs[0]);
+              auto exprs(readAndCheckRangeExprList("fflush", 0, 1));
+              return CodeNode::make<FileFlush>(exprs.empty() ? CodeNode::SharedPtr() : exprs[0]);
           }
         },
 
@@ -1382,6 +1761,13 @@ void Parser::initAppFtns() {
           }
         },
 
+        { "freadall",
+          [this]() {
+              auto exprs(readAndCheckExprList("freadall", 1));
+              return CodeNode::make<FileReadAll>(exprs[0]);
+          }
+        },
+
         { "fwrite",
           [this]() {
               auto exprs(readAndCheckExprList("fwrite", 2));
@@ -1410,11 +1796,46 @@ void Parser::initAppFtns() {
           }
         },
 
+        { "csvopen",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("csvopen", 1, 2));
+              return CodeNode::make<CsvOpen>(exprs[0], exprs.size() == 2 ? exprs[1] : CodeNode::SharedPtr());
+          }
+        },
+
+        { "csvreadrow",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("csvreadrow", 1, 2));
+              return CodeNode::make<CsvRead>(CsvRead::Row, exprs[0], exprs.size() == 2 ? exprs[1] : CodeNode::SharedPtr());
+          }
+        },
+
+        { "csvrows",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("csvrows", 1, 2));
+              return CodeNode::make<CsvRead>(CsvRead::Rows, exprs[0], exprs.size() == 2 ? exprs[1] : CodeNode::SharedPtr());
+          }
+        },
+
+        { "csvcols",
+          [this]() {
+              auto exprs(readAndCheckRangeExprList("csvcols", 1, 2));
+              return CodeNode::make<CsvRead>(CsvRead::Columns, exprs[0], exprs.size() == 2 ? exprs[1] : CodeNode::SharedPtr());
+          }
+        },
+
         { "withfile",
           [this]() {
+              // The file expression is evaluated before the withfile scope
               const auto name(readName());
-              auto exprs(readAndCheckExprList("withfile", 2));
-              return CodeNode::make<WithFile>(name, exprs[0], exprs[1]);
+              auto file(readExpr());
+              if (!file) { throw TooManyOrFewForms("withfile"); }
+
+              resolver_.pushScope();
+              resolver_.declare(Environment::idenTable().mapName(name));
+              auto exprs(readAndCheckExprList("withfile", 1));
+              auto layout(resolver_.popScope());
+              return CodeNode::make<WithFile>(name, file, exprs[0], layout);
           }
         },
 
@@ -1427,14 +1848,14 @@ void Parser::initAppFtns() {
 
         { "min",
           [this]() {
-              auto exprs(readAndCheckRangeExprList("min", 2, std::nullopt));
+              auto exprs(readAndCheckRangeExprList("min", 1, std::nullopt));
               return CodeNode::make<MathFunction>(MathFunction::Min, exprs);
           }
         },
 
         { "max",
           [this]() {
-              auto exprs(readAndCheckRangeExprList("max", 2, std::nullopt));
+              auto exprs(readAndCheckRangeExprList("max", 1, std::nullopt));
               return CodeNode::make<MathFunction>(MathFunction::Max, exprs);
           }
         },
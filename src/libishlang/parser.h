@@ -3,6 +3,7 @@
 
 #include "code_node.h"
 #include "lexer.h"
+#include "resolver.h"
 
 #include <forward_list>
 #include <functional>
@@ -30,6 +31,7 @@ namespace Ishlang {
     private:
         CodeNode::SharedPtr readExpr();
         CodeNode::SharedPtr makeLiteral(Lexer::TokenType type, const std::string &text);
+        const Value &internText(std::string &&text);
         CodeNode::SharedPtr readApp(const std::string &expected="");
         CodeNode::SharedPtrList readExprList();
         CodeNode::SharedPtrList readAndCheckExprList(const char *name, std::size_t expectedSize);
@@ -40,6 +42,7 @@ namespace Ishlang {
         std::vector<std::string> readNames(const char *listName, std::size_t minExpectedSize);
         CodeNode::NameAndAsList readNameAndAsList();
         std::vector<std::string> readParams();
+        void declareParams(const CodeNode::ParamList &params);
         bool ignoreLeftP(bool allowRightP);
         void ignoreRightP();
         bool peekRightP() const;
@@ -58,7 +61,7 @@ namespace Ishlang {
             inline CodeNode::SharedPtr operator()();
 
         private:
-            const std::string &name_;
+            const std::string name_;
             Parser &parser_;
             ExprOp exprOp_;
         };
@@ -87,7 +90,7 @@ namespace Ishlang {
             inline CodeNode::SharedPtr operator()();
 
         private:
-            const std::string &name_;
+            const std::string name_;
             Parser &parser_;
             ExprOp exprOp_;
         };
@@ -102,13 +105,15 @@ namespace Ishlang {
             inline CodeNode::SharedPtr operator()();
 
         private:
-            const std::string &name_;
+            const std::string name_;
             Parser &parser_;
             OpType opType_;
         };
 
     private:
         Lexer lexer_;
+        Resolver resolver_;
+        std::unordered_map<std::string, Value> literals_;
         std::unordered_map<std::string, std::function<CodeNode::SharedPtr ()>> appFtns_;
     };
 
@@ -147,7 +152,9 @@ namespace Ishlang {
     inline CodeNode::SharedPtr Parser::MakeUpdateExpression<ExprType>::operator()() {
         const auto varName(parser_.readName());
         auto exprs(parser_.readAndCheckExprList(name_.c_str(), 1));
-        return CodeNode::make<ExprType>(exprOp_, varName, exprs[0]);
+        auto node(std::make_shared<ExprType>(exprOp_, varName, exprs[0]));
+        parser_.resolver_.reference(*node);
+        return node;
     }
 
     template <typename ExprType>
@@ -0,0 +1,77 @@
+#ifndef ISHLANG_REF_COUNT_H
+#define ISHLANG_REF_COUNT_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace Ishlang {
+
+    // Intrusive reference count embedded in heap objects. The interpreter
+    // runs single threaded until it first starts another thread, counts are
+    // updated with plain arithmetic until then and atomically afterwards.
+    class RefCount {
+    public:
+        RefCount() noexcept = default;
+
+        RefCount(const RefCount &) = delete;
+        RefCount &operator=(const RefCount &) = delete;
+
+        inline void retain() noexcept;
+
+        // Returns true when the last reference was released.
+        inline bool release() noexcept;
+
+        inline std::size_t count() const noexcept;
+
+    public:
+        static inline bool atomic() noexcept;
+
+        // Switches all counts to atomic updates. Must be called before the
+        // first additional thread is started, there is no way back.
+        static inline void enableAtomic() noexcept;
+
+    private:
+        using AtomicRef = std::atomic_ref<std::size_t>;
+
+        alignas(AtomicRef::required_alignment) std::size_t count_ = 1;
+
+        static inline bool atomic_ = false;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline void RefCount::retain() noexcept {
+        if (atomic_) {
+            AtomicRef(count_).fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            ++count_;
+        }
+    }
+
+    inline bool RefCount::release() noexcept {
+        if (atomic_) {
+            return AtomicRef(count_).fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+        return --count_ == 0;
+    }
+
+    inline std::size_t RefCount::count() const noexcept {
+        if (atomic_) {
+            return AtomicRef(const_cast<std::size_t &>(count_)).load(std::memory_order_relaxed);
+        }
+        return count_;
+    }
+
+    inline bool RefCount::atomic() noexcept {
+        return atomic_;
+    }
+
+    inline void RefCount::enableAtomic() noexcept {
+        atomic_ = true;
+    }
+
+}
+
+#endif	// ISHLANG_REF_COUNT_H
@@ -0,0 +1,129 @@
+#include "resolver.h"
+
+#include <algorithm>
+
+using namespace Ishlang;
+
+// -------------------------------------------------------------
+Resolver::Resolver()
+    : scopes_()
+    , references_()
+    , current_(NoScope)
+{}
+
+// -------------------------------------------------------------
+void Resolver::reset() noexcept {
+    scopes_.clear();
+    references_.clear();
+    current_ = NoScope;
+}
+
+// -------------------------------------------------------------
+void Resolver::pushScope(bool function, bool generator) {
+    scopes_.push_back(Scope{current_, {}, false, false, false, function, generator});
+    current_ = scopes_.size() - 1;
+}
+
+// -------------------------------------------------------------
+ScopeLayout::SharedPtr Resolver::popScope() {
+    static const auto Elided = ScopeLayout::make({});
+
+    auto &scope = scopes_[current_];
+    current_ = scope.parent;
+
+    ScopeLayout::SharedPtr layout;
+    if (!scope.dynamic) {
+        if (!scope.idens.empty()) {
+            layout = ScopeLayout::make(scope.idens);
+        }
+        else if (!scope.keepFrame) {
+            scope.elided = true;
+            layout = Elided;
+        }
+    }
+
+    if (current_ == NoScope) {
+        resolve();
+    }
+    return layout;
+}
+
+// -------------------------------------------------------------
+void Resolver::declare(IdenType iden) {
+    if (current_ != NoScope) {
+        auto &idens = scopes_[current_].idens;
+        if (std::ranges::find(idens, iden) == idens.end()) {
+            idens.push_back(iden);
+        }
+    }
+}
+
+// -------------------------------------------------------------
+void Resolver::define(IdenType iden, VarAddress &address) {
+    declare(iden);
+    reference(iden, address);
+}
+
+// -------------------------------------------------------------
+void Resolver::reference(IdenType iden, VarAddress &address) {
+    address = VarAddress();
+    if (current_ != NoScope) {
+        references_.push_back(Reference{iden, &address, current_});
+    }
+}
+
+// -------------------------------------------------------------
+void Resolver::keepFrame() noexcept {
+    if (current_ != NoScope) {
+        scopes_[current_].keepFrame = true;
+    }
+}
+
+// -------------------------------------------------------------
+void Resolver::makeDynamic() noexcept {
+    if (current_ != NoScope) {
+        scopes_[current_].dynamic = true;
+    }
+}
+
+// -------------------------------------------------------------
+bool Resolver::inFunction() const noexcept {
+    for (auto index = current_; index != NoScope; index = scopes_[index].parent) {
+        if (scopes_[index].function) { return true; }
+    }
+    return false;
+}
+
+// -------------------------------------------------------------
+bool Resolver::inGenerator() const noexcept {
+    for (auto index = current_; index != NoScope; index = scopes_[index].parent) {
+        if (scopes_[index].function) { return scopes_[index].generator; }
+    }
+    return false;
+}
+
+// -------------------------------------------------------------
+void Resolver::resolve() {
+    for (auto &ref : references_) {
+        resolve(ref);
+    }
+    reset();
+}
+
+// -------------------------------------------------------------
+void Resolver::resolve(Reference &ref) const {
+    std::uint32_t depth = 0;
+    for (auto index = ref.scope; index != NoScope; index = scopes_[index].parent) {
+        const auto &scope = scopes_[index];
+        if (scope.dynamic) { return; }
+
+        const auto iter = std::ranges::find(scope.idens, ref.iden);
+        if (iter != scope.idens.end()) {
+            ref.address->depth = depth;
+            ref.address->slot = static_cast<std::uint32_t>(iter - scope.idens.begin());
+            return;
+        }
+
+        if (!scope.elided) { ++depth; }
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef ISHLANG_RESOLVER_H
+#define ISHLANG_RESOLVER_H
+
+#include "iden_table.h"
+#include "scope_layout.h"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Ishlang {
+
+    // Tracks the scopes opened by the parser and assigns lexical addresses
+    // to variable references. Addresses are fixed once the outermost scope
+    // is closed, when all definitions and elided frames are known.
+    //
+    // A reference resolves to the innermost scope defining its name, an
+    // unset slot at run time falls back to a lookup from the parent frame,
+    // which keeps definitions evaluated later in a scope behaving as they
+    // did with a dynamic lookup. Names not defined in any enclosing scope,
+    // and names crossing a scope with an import, stay dynamic.
+    class Resolver {
+    public:
+        Resolver();
+
+        void reset() noexcept;
+
+        void pushScope(bool function = false, bool generator = false);
+        ScopeLayout::SharedPtr popScope();
+
+        void declare(IdenType iden);
+        void define(IdenType iden, VarAddress &address);
+        void reference(IdenType iden, VarAddress &address);
+
+        void keepFrame() noexcept;
+        void makeDynamic() noexcept;
+
+        template <typename Node>
+        inline void define(Node &node);
+
+        template <typename Node>
+        inline void reference(Node &node);
+
+        inline bool inScope() const noexcept;
+        bool inFunction() const noexcept;
+        bool inGenerator() const noexcept;
+
+    private:
+        static constexpr std::size_t NoScope = std::numeric_limits<std::size_t>::max();
+
+        struct Scope {
+            std::size_t           parent;
+            ScopeLayout::IdenList idens;
+            bool                  keepFrame;
+            bool                  dynamic;
+            bool                  elided;
+            bool                  function;
+            bool                  generator;
+        };
+
+        struct Reference {
+            IdenType    iden;
+            VarAddress *address;
+            std::size_t scope;
+        };
+
+        void resolve();
+        void resolve(Reference &ref) const;
+
+    private:
+        std::vector<Scope>     scopes_;
+        std::vector<Reference> references_;
+        std::size_t            current_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    template <typename Node>
+    inline void Resolver::define(Node &node) {
+        define(node.iden(), node.address());
+    }
+
+    template <typename Node>
+    inline void Resolver::reference(Node &node) {
+        reference(node.iden(), node.address());
+    }
+
+    inline bool Resolver::inScope() const noexcept {
+        return current_ != NoScope;
+    }
+
+}
+
+#endif	// ISHLANG_RESOLVER_H
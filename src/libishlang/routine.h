@@ -0,0 +1,98 @@
+#ifndef ISHLANG_ROUTINE_H
+#define ISHLANG_ROUTINE_H
+
+#include "value.h"
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace Ishlang {
+
+    // Coroutine running statements of a generator body, suspended at each
+    // yielded value. It starts suspended and runs on resume. A statement
+    // nesting yielding statements runs them as nested routines and yields
+    // their values again.
+    class Routine {
+    public:
+        struct promise_type {
+            Value              value;
+            std::exception_ptr error;
+
+            Routine get_return_object() noexcept {
+                return Routine(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+
+            std::suspend_always yield_value(const Value &yielded) noexcept {
+                value = yielded;
+                return {};
+            }
+
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { error = std::current_exception(); }
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+    public:
+        Routine() = default;
+        inline Routine(Routine &&other) noexcept;
+        inline Routine &operator=(Routine &&other) noexcept;
+        inline ~Routine();
+
+        Routine(const Routine &) = delete;
+        Routine &operator=(const Routine &) = delete;
+
+        // Runs up to the next yield, returns false once the routine
+        // finished. An error raised by the routine is rethrown here.
+        inline bool resume();
+
+        // Last value yielded.
+        inline const Value &value() const noexcept;
+
+    private:
+        explicit Routine(Handle handle) noexcept : handle_(handle) {}
+
+    private:
+        Handle handle_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline Routine::Routine(Routine &&other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr))
+    {}
+
+    inline Routine &Routine::operator=(Routine &&other) noexcept {
+        if (this != &other) {
+            if (handle_) { handle_.destroy(); }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    inline Routine::~Routine() {
+        if (handle_) { handle_.destroy(); }
+    }
+
+    inline bool Routine::resume() {
+        if (!handle_ || handle_.done()) { return false; }
+
+        handle_.resume();
+        if (auto error = std::exchange(handle_.promise().error, nullptr)) {
+            std::rethrow_exception(error);
+        }
+        return !handle_.done();
+    }
+
+    inline const Value &Routine::value() const noexcept {
+        return handle_.promise().value;
+    }
+
+}
+
+#endif // ISHLANG_ROUTINE_H
@@ -0,0 +1,81 @@
+#ifndef ISHLANG_SCOPE_LAYOUT_H
+#define ISHLANG_SCOPE_LAYOUT_H
+
+#include "iden_table.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace Ishlang {
+
+    // Slot layout of a scope creating construct, computed by the parser.
+    // A layout without slots elides the frame altogether, the construct
+    // then evaluates directly in its enclosing environment.
+    class ScopeLayout {
+    public:
+        using SharedPtr = std::shared_ptr<const ScopeLayout>;
+        using IdenList  = std::vector<IdenType>;
+
+    public:
+        ScopeLayout(IdenList idens) : idens_(std::move(idens)) {}
+
+        inline bool elided() const noexcept;
+        inline std::size_t size() const noexcept;
+        inline IdenType iden(std::size_t slot) const;
+        inline std::optional<std::size_t> find(IdenType iden) const noexcept;
+
+    public:
+        static inline SharedPtr make(IdenList idens);
+        static inline bool elides(const SharedPtr &layout) noexcept;
+
+    private:
+        IdenList idens_;
+    };
+
+    // Lexical address of a variable reference: number of frames to walk
+    // up from the current environment and the slot within that frame.
+    struct VarAddress {
+        static constexpr std::uint32_t Dynamic = std::numeric_limits<std::uint32_t>::max();
+
+        std::uint32_t depth = Dynamic;
+        std::uint32_t slot  = 0;
+
+        inline bool isLexical() const noexcept { return depth != Dynamic; }
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline bool ScopeLayout::elided() const noexcept {
+        return idens_.empty();
+    }
+
+    inline std::size_t ScopeLayout::size() const noexcept {
+        return idens_.size();
+    }
+
+    inline IdenType ScopeLayout::iden(std::size_t slot) const {
+        return idens_[slot];
+    }
+
+    inline std::optional<std::size_t> ScopeLayout::find(IdenType iden) const noexcept {
+        for (std::size_t slot = 0; slot < idens_.size(); ++slot) {
+            if (idens_[slot] == iden) { return slot; }
+        }
+        return std::nullopt;
+    }
+
+    inline auto ScopeLayout::make(IdenList idens) -> SharedPtr {
+        return std::make_shared<const ScopeLayout>(std::move(idens));
+    }
+
+    inline bool ScopeLayout::elides(const SharedPtr &layout) noexcept {
+        return layout && layout->elided();
+    }
+
+}
+
+#endif	// ISHLANG_SCOPE_LAYOUT_H
@@ -1,60 +1,256 @@
 #include "sequence.h"
+#include "array_kernels.h"
 #include "exception.h"
 
 #include <algorithm>
 #include <functional>
+#include <numeric>
+#include <type_traits>
 
 using namespace Ishlang;
 
+namespace {
+
+    template <typename Elements>
+    inline typename Elements::value_type elementOf(const Value &value) {
+        if constexpr (std::is_same_v<Elements, Sequence::Integers>) { return value.integer(); }
+        else if constexpr (std::is_same_v<Elements, Sequence::Reals>) { return value.real(); }
+        else                                                          { return value; }
+    }
+
+    template <typename Iterator, typename Item>
+    inline std::optional<std::size_t> searchSorted(Iterator first, Iterator last, const Item &item, bool descending) {
+        const auto iter = descending
+            ? std::lower_bound(first, last, item, std::greater<Item>())
+            : std::lower_bound(first, last, item);
+        if (iter != last && *iter == item) {
+            return std::distance(first, iter);
+        }
+        return std::nullopt;
+    }
+
+}
+
 // -------------------------------------------------------------
 Sequence::Sequence(Vector && vec)
-    : vector_(vec)
-{}
+    : storage_(std::move(vec))
+{
+    const auto &elems = as<Vector>();
+    if (elems.empty()) {
+        return;
+    }
+
+    const auto packs = packingOf(elems.front());
+    if (packs == Boxed || !std::ranges::all_of(elems, [packs](const Value &v) { return packingOf(v) == packs; })) {
+        return;
+    }
+
+    if (packs == PackedIntegers) {
+        Integers ints(elems.size());
+        std::ranges::transform(elems, ints.begin(), [](const Value &v) { return v.integer(); });
+        storage_ = std::move(ints);
+    }
+    else {
+        Reals reals(elems.size());
+        std::ranges::transform(elems, reals.begin(), [](const Value &v) { return v.real(); });
+        storage_ = std::move(reals);
+    }
+}
 
 // -------------------------------------------------------------
 Sequence::Sequence(std::size_t size, const Value &value)
-    : vector_(size, value)
-{}
+{
+    switch (packingOf(value)) {
+    case PackedIntegers: storage_.emplace<Integers>(size, value.integer()); break;
+    case PackedReals:    storage_.emplace<Reals>(size, value.real());       break;
+    case Boxed:          storage_.emplace<Vector>(size, value);             break;
+    }
+}
+
+// -------------------------------------------------------------
+Sequence Sequence::packed(Integers &&ints) {
+    Sequence seq;
+    seq.storage_ = std::move(ints);
+    return seq;
+}
+
+Sequence Sequence::packed(Reals &&reals) {
+    Sequence seq;
+    seq.storage_ = std::move(reals);
+    return seq;
+}
+
+// -------------------------------------------------------------
+bool Sequence::operator==(const Sequence &rhs) const {
+    if (size() != rhs.size()) {
+        return false;
+    }
+
+    if (packing() == rhs.packing()) {
+        return visit([&rhs](const auto &elems) {
+            return elems == rhs.as<std::remove_cvref_t<decltype(elems)>>();
+        });
+    }
+    return std::equal(begin(), end(), rhs.begin());
+}
 
 // -------------------------------------------------------------
 void Sequence::insert(std::size_t pos, const Value &value) {
-    auto iter = vector_.begin();
-    iter += pos;
-    vector_.insert(iter, value);
+    adopt(value);
+    visit([pos, &value](auto &elems) {
+        elems.insert(elems.begin() + pos, elementOf<std::remove_cvref_t<decltype(elems)>>(value));
+    });
 }
 
 // -------------------------------------------------------------
 void Sequence::erase(std::size_t pos) {
-    auto iter = vector_.begin();
-    iter += pos;
-    vector_.erase(iter);
+    visit([pos](auto &elems) { elems.erase(elems.begin() + pos); });
 }
 
 // -------------------------------------------------------------
 std::optional<std::size_t> Sequence::find(const Value &val, std::size_t pos) const {
-    auto iter = std::find(vector_.begin() + pos, vector_.end(), val);
-    if (iter != vector_.end()) {
-        return std::distance(vector_.begin(), iter);
+    switch (packing()) {
+    case PackedIntegers:
+        if (val.isInt()) { return ArrayKernels::find(integers(), val.integer(), pos); }
+        break;
+
+    case PackedReals:
+        if (val.isReal()) { return ArrayKernels::find(reals(), val.real(), pos); }
+        break;
+
+    case Boxed: {
+        const auto &elems = as<Vector>();
+        auto iter = std::find(elems.begin() + pos, elems.end(), val);
+        if (iter != elems.end()) {
+            return std::distance(elems.begin(), iter);
+        }
+        return std::nullopt;
+    }
+    }
+
+    if (val.isNumber()) {
+        for (auto i = pos; i < size(); ++i) {
+            if (get(i) == val) {
+                return i;
+            }
+        }
     }
     return std::nullopt;
 }
 
+// -------------------------------------------------------------
+std::optional<std::size_t> Sequence::binarySearch(const Value &val, bool descending) const {
+    if (packing() == PackedIntegers && val.isInt()) {
+        const auto ints = integers();
+        return searchSorted(ints.begin(), ints.end(), val.integer(), descending);
+    }
+    else if (packing() == PackedReals && val.isReal()) {
+        const auto reals = this->reals();
+        return searchSorted(reals.begin(), reals.end(), val.real(), descending);
+    }
+    return searchSorted(begin(), end(), val, descending);
+}
+
 // -------------------------------------------------------------
 std::size_t Sequence::count(const Value &value) const {
-    return std::count(vector_.begin(), vector_.end(), value);
+    switch (packing()) {
+    case PackedIntegers:
+        if (value.isInt()) { return ArrayKernels::count(integers(), value.integer()); }
+        break;
+
+    case PackedReals:
+        if (value.isReal()) { return ArrayKernels::count(reals(), value.real()); }
+        break;
+
+    case Boxed:
+        return std::count(as<Vector>().begin(), as<Vector>().end(), value);
+    }
+
+    return value.isNumber() ? std::count(begin(), end(), value) : 0;
 }
 
 // -------------------------------------------------------------
 void Sequence::sort(bool descending) {
-    if (descending) {
-        std::sort(vector_.begin(), vector_.end(), std::greater<Value>());
+    visit([descending](auto &elems) {
+        if (descending) {
+            std::sort(elems.begin(), elems.end(), std::greater<>());
+        }
+        else {
+            std::sort(elems.begin(), elems.end());
+        }
+    });
+}
+
+// -------------------------------------------------------------
+void Sequence::reverse() {
+    visit([](auto &elems) { std::reverse(elems.begin(), elems.end()); });
+}
+
+// -------------------------------------------------------------
+Value Sequence::sum() const {
+    switch (packing()) {
+    case PackedIntegers: return Value(ArrayKernels::sum(integers()));
+    case PackedReals:    return Value(ArrayKernels::sum(reals()));
+    case Boxed:          break;
+    }
+
+    const auto &elems = as<Vector>();
+    if (elems.empty()) {
+        return Value::Zero;
+    }
+
+    bool anyReal = false;
+    for (const auto &val : elems) {
+        if (val.isReal()) {
+            anyReal = true;
+        }
+        else if (!val.isInt()) {
+            throw InvalidExpression("Unexpected non-numeric sum argument");
+        }
+    }
+
+    if (anyReal) {
+        return Value(std::accumulate(
+                         elems.begin() + 1,
+                         elems.end(),
+                         elems.front().real(),
+                         [](Value::Double a, const Value & v) { return a + v.real(); }));
     }
     else {
-        std::sort(vector_.begin(), vector_.end());
+        return Value(std::accumulate(
+                         elems.begin() + 1,
+                         elems.end(),
+                         elems.front().integer(),
+                         [](Value::Long a, const Value & v) { return a + v.integer(); }));
     }
 }
 
 // -------------------------------------------------------------
-void Sequence::reverse() {
-    std::reverse(vector_.begin(), vector_.end());
+Value Sequence::min() const {
+    return minmax(false);
+}
+
+Value Sequence::max() const {
+    return minmax(true);
+}
+
+Value Sequence::minmax(bool max) const {
+    if (size() == 0) {
+        return Value::Null;
+    }
+
+    if (packing() == Boxed && !std::ranges::all_of(as<Vector>(), [](const Value &v) { return v.isNumber(); })) {
+        throw InvalidExpression(max ? "Unexpected non-numeric max argument" : "Unexpected non-numeric min argument");
+    }
+
+    return visit([max](const auto &elems) {
+        return Value(max ? *std::max_element(elems.begin(), elems.end()) : *std::min_element(elems.begin(), elems.end()));
+    });
+}
+
+// -------------------------------------------------------------
+void Sequence::unpack() {
+    if (packing() != Boxed) {
+        storage_ = visit([](const auto &elems) { return Vector(elems.begin(), elems.end()); });
+    }
 }
@@ -5,22 +5,43 @@
 #include "value.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <optional>
 #include <ostream>
+#include <span>
+#include <variant>
 #include <vector>
 
 namespace Ishlang {
 
+    // Arrays holding only integers or only reals are packed into plain
+    // buffers of numbers, half the size of boxed values and scanned without
+    // type checks. Writing another type of value into a packed array boxes
+    // its elements. An empty array packs by the first value added to it.
     class Sequence {
     public:
-        using Vector = std::vector<Value>;
+        using Vector   = std::vector<Value>;
+        using Integers = std::vector<Value::Long>;
+        using Reals    = std::vector<Value::Double>;
+
+        enum Packing {
+            Boxed,
+            PackedIntegers,
+            PackedReals,
+        };
+
+        class ConstIterator;
 
     public:
         Sequence() = default;
         Sequence(Vector && vec);
         Sequence(std::size_t size, const Value &value);
 
-        inline bool operator==(const Sequence &rhs) const;
+        static Sequence packed(Integers &&ints);
+        static Sequence packed(Reals &&reals);
+
+        bool operator==(const Sequence &rhs) const;
         inline bool operator!=(const Sequence &rhs) const;
 
         inline bool operator<(const Sequence &rhs) const;
@@ -28,7 +49,7 @@ namespace Ishlang {
         inline bool operator<=(const Sequence &rhs) const;
         inline bool operator>=(const Sequence &rhs) const;
 
-        inline const Value &get(std::size_t idx) const;
+        inline Value get(std::size_t idx) const;
         inline void set(std::size_t idx, const Value &value);
         inline void push(const Value &value);
         inline void pop();
@@ -37,93 +58,229 @@ namespace Ishlang {
         void insert(std::size_t pos, const Value & value);
         void erase(std::size_t pos);
         std::optional<std::size_t> find(const Value &val, std::size_t pos = 0) const;
+
+        // Binary search of a sequence sorted in the given order.
+        std::optional<std::size_t> binarySearch(const Value &val, bool descending) const;
+
         std::size_t count(const Value &value) const;
         void sort(bool descending);
         void reverse();
 
+        // Numeric reductions, throw on non-numeric elements. Min and max
+        // of an empty sequence are null.
+        Value sum() const;
+        Value min() const;
+        Value max() const;
+
         inline std::size_t size() const;
+        inline bool empty() const;
+
+        inline Packing packing() const noexcept;
+
+        // Packed elements, empty unless packed as such.
+        inline std::span<const Value::Long> integers() const noexcept;
+        inline std::span<const Value::Double> reals() const noexcept;
 
-        inline Vector::const_iterator begin() const noexcept;
-        inline Vector::const_iterator end() const noexcept;
+        inline ConstIterator begin() const noexcept;
+        inline ConstIterator end() const noexcept;
 
     public:
-        friend std::ostream &operator<<(std::ostream &out, const Sequence &sequence) {
-            return Util::printContainer(out,
-                                        sequence.vector_,
-                                        [](std::ostream &os, const auto &value) { os << value; },
-                                        '[',
-                                        ']');
-        }
+        friend inline std::ostream &operator<<(std::ostream &out, const Sequence &sequence);
 
     public:
         static inline Sequence generate(std::size_t size, auto && ftn);
 
     private:
-        static inline bool vectorEqual(const Vector &lhs, const Vector &rhs);
+        using Storage = std::variant<Vector, Integers, Reals>;
+
+        template <typename Elements>
+        inline Elements &as() noexcept;
+
+        template <typename Elements>
+        inline const Elements &as() const noexcept;
+
+        inline bool accepts(const Value &value) const noexcept;
+        inline void adopt(const Value &value);
+        void unpack();
+
+        template <typename Ftn>
+        inline decltype(auto) visit(Ftn &&ftn);
+
+        template <typename Ftn>
+        inline decltype(auto) visit(Ftn &&ftn) const;
+
+        Value minmax(bool max) const;
+
+        static inline Packing packingOf(const Value &value) noexcept;
+
+    private:
+        Storage storage_;
+    };
+
+    // -------------------------------------------------------------
+    class Sequence::ConstIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using iterator_concept  = std::random_access_iterator_tag;
+        using value_type        = Value;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = Value;
+
+    public:
+        ConstIterator() = default;
+        ConstIterator(const Sequence *sequence, std::size_t idx) : sequence_(sequence), idx_(idx) {}
+
+        Value operator*() const { return sequence_->get(idx_); }
+        Value operator[](difference_type n) const { return sequence_->get(idx_ + n); }
+
+        ConstIterator &operator++() { ++idx_; return *this; }
+        ConstIterator &operator--() { --idx_; return *this; }
+        ConstIterator operator++(int) { auto tmp = *this; ++idx_; return tmp; }
+        ConstIterator operator--(int) { auto tmp = *this; --idx_; return tmp; }
+
+        ConstIterator &operator+=(difference_type n) { idx_ += n; return *this; }
+        ConstIterator &operator-=(difference_type n) { idx_ -= n; return *this; }
+
+        friend ConstIterator operator+(ConstIterator iter, difference_type n) { return iter += n; }
+        friend ConstIterator operator+(difference_type n, ConstIterator iter) { return iter += n; }
+        friend ConstIterator operator-(ConstIterator iter, difference_type n) { return iter -= n; }
+        friend difference_type operator-(const ConstIterator &lhs, const ConstIterator &rhs) {
+            return static_cast<difference_type>(lhs.idx_) - static_cast<difference_type>(rhs.idx_);
+        }
+
+        friend bool operator==(const ConstIterator &lhs, const ConstIterator &rhs) { return lhs.idx_ == rhs.idx_; }
+        friend auto operator<=>(const ConstIterator &lhs, const ConstIterator &rhs) { return lhs.idx_ <=> rhs.idx_; }
 
     private:
-        Vector vector_;
+        const Sequence *sequence_ = nullptr;
+        std::size_t     idx_ = 0;
     };
 
     // --------------------------------------------------------------------------------
     // INLINE
 
-    inline bool Sequence::operator==(const Sequence &rhs) const {
-        return vectorEqual(vector_, rhs.vector_);
+    template <typename Elements>
+    inline Elements &Sequence::as() noexcept {
+        return *std::get_if<Elements>(&storage_);
+    }
+
+    template <typename Elements>
+    inline const Elements &Sequence::as() const noexcept {
+        return *std::get_if<Elements>(&storage_);
+    }
+
+    template <typename Ftn>
+    inline decltype(auto) Sequence::visit(Ftn &&ftn) {
+        switch (packing()) {
+        case PackedIntegers: return ftn(as<Integers>());
+        case PackedReals:    return ftn(as<Reals>());
+        case Boxed:          break;
+        }
+        return ftn(as<Vector>());
+    }
+
+    template <typename Ftn>
+    inline decltype(auto) Sequence::visit(Ftn &&ftn) const {
+        switch (packing()) {
+        case PackedIntegers: return ftn(as<Integers>());
+        case PackedReals:    return ftn(as<Reals>());
+        case Boxed:          break;
+        }
+        return ftn(as<Vector>());
+    }
+
+    inline std::ostream &operator<<(std::ostream &out, const Sequence &sequence) {
+        return Util::printContainer(out,
+                                    sequence,
+                                    [](std::ostream &os, const auto &value) { os << value; },
+                                    '[',
+                                    ']');
     }
 
     inline bool Sequence::operator!=(const Sequence &rhs) const {
-        return !vectorEqual(vector_, rhs.vector_);
+        return !(*this == rhs);
     }
 
     inline bool Sequence::operator<(const Sequence &rhs) const {
-        return vector_.size() < rhs.vector_.size();
+        return size() < rhs.size();
     }
 
     inline bool Sequence::operator>(const Sequence &rhs) const {
-        return vector_.size() > rhs.vector_.size();
+        return size() > rhs.size();
     }
 
     inline bool Sequence::operator<=(const Sequence &rhs) const {
-        return vector_.size() <= rhs.vector_.size();
+        return size() <= rhs.size();
     }
 
     inline bool Sequence::operator>=(const Sequence &rhs) const {
-        return vector_.size() >= rhs.vector_.size();
+        return size() >= rhs.size();
     }
 
-    inline const Value &Sequence::get(std::size_t idx) const {
-        return vector_[idx];
+    inline Value Sequence::get(std::size_t idx) const {
+        switch (packing()) {
+        case PackedIntegers: return Value(as<Integers>()[idx]);
+        case PackedReals:    return Value(as<Reals>()[idx]);
+        case Boxed:          break;
+        }
+        return as<Vector>()[idx];
     }
 
     inline void Sequence::set(std::size_t idx, const Value &value) {
-        vector_[idx] = value;
+        if (!accepts(value)) { unpack(); }
+        switch (packing()) {
+        case PackedIntegers: as<Integers>()[idx] = value.integer(); break;
+        case PackedReals:    as<Reals>()[idx] = value.real();       break;
+        case Boxed:          as<Vector>()[idx] = value;             break;
+        }
     }
 
     inline void Sequence::push(const Value &value) {
-        vector_.push_back(value);
+        adopt(value);
+        switch (packing()) {
+        case PackedIntegers: as<Integers>().push_back(value.integer()); break;
+        case PackedReals:    as<Reals>().push_back(value.real());       break;
+        case Boxed:          as<Vector>().push_back(value);             break;
+        }
     }
 
     inline void Sequence::pop() {
-        if (!vector_.empty()) {
-            vector_.pop_back();
-        }
+        visit([](auto &vec) { if (!vec.empty()) { vec.pop_back(); } });
     }
 
     inline void Sequence::clear() {
-        vector_.clear();
+        storage_ = Vector();
     }
 
     inline std::size_t Sequence::size() const {
-        return vector_.size();
+        return visit([](const auto &vec) { return vec.size(); });
     }
 
-    inline auto Sequence::begin() const noexcept -> Vector::const_iterator {
-        return vector_.begin();
+    inline bool Sequence::empty() const {
+        return size() == 0;
     }
 
-    inline auto Sequence::end() const noexcept -> Vector::const_iterator {
-        return vector_.end();
+    inline auto Sequence::packing() const noexcept -> Packing {
+        return static_cast<Packing>(storage_.index());
+    }
+
+    inline std::span<const Value::Long> Sequence::integers() const noexcept {
+        const auto *ints = std::get_if<Integers>(&storage_);
+        return ints ? std::span<const Value::Long>(*ints) : std::span<const Value::Long>();
+    }
+
+    inline std::span<const Value::Double> Sequence::reals() const noexcept {
+        const auto *reals = std::get_if<Reals>(&storage_);
+        return reals ? std::span<const Value::Double>(*reals) : std::span<const Value::Double>();
+    }
+
+    inline auto Sequence::begin() const noexcept -> ConstIterator {
+        return ConstIterator(this, 0);
+    }
+
+    inline auto Sequence::end() const noexcept -> ConstIterator {
+        return ConstIterator(this, size());
     }
 
     inline Sequence Sequence::generate(std::size_t size, auto && ftn) {
@@ -132,8 +289,26 @@ namespace Ishlang {
         return Sequence(std::move(vec));
     }
 
-    inline bool Sequence::vectorEqual(const Vector &lhs, const Vector &rhs) {
-        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    inline bool Sequence::accepts(const Value &value) const noexcept {
+        const auto current = packing();
+        return current == Boxed || current == packingOf(value);
+    }
+
+    inline void Sequence::adopt(const Value &value) {
+        if (size() == 0) {
+            switch (packingOf(value)) {
+            case PackedIntegers: storage_.emplace<Integers>(); break;
+            case PackedReals:    storage_.emplace<Reals>();    break;
+            case Boxed:          storage_.emplace<Vector>();   break;
+            }
+        }
+        else if (!accepts(value)) {
+            unpack();
+        }
+    }
+
+    inline auto Sequence::packingOf(const Value &value) noexcept -> Packing {
+        return value.isInt() ? PackedIntegers : value.isReal() ? PackedReals : Boxed;
     }
 
 }
@@ -1,20 +1,27 @@
 #include "struct.h"
-
-#include <iostream>
+#include "output.h"
 
 using namespace Ishlang;
 
+// -------------------------------------------------------------
+Struct::Struct()
+    : layout_()
+{
+    static const auto empty = std::make_shared<const Layout>();
+    layout_ = empty;
+}
+
 // -------------------------------------------------------------
 Struct::Struct(const std::string &name, const MemberList &members)
-    : name_(name)
-    , members_(members)
+    : layout_(std::make_shared<const Layout>(Layout{name, members}))
 {}
 
 // -------------------------------------------------------------
 void Struct::describe() const {
-    std::cout << "Struct " << name_;
-    for (const auto &mem : members_) {
-        std::cout << "\n  " << mem;
+    auto &out = Output::stream();
+    out << "Struct " << name();
+    for (const auto &mem : members()) {
+        out << "\n  " << mem;
     }
-    std::cout << std::endl;
+    Output::newline();
 }
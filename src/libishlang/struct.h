@@ -2,17 +2,27 @@
 #define ISHLANG_STRUCT_H
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <vector>
 
 namespace Ishlang {
 
+    // A struct is a handle to an immutable layout shared by the struct value
+    // and all its instances. Members are stored by instances in layout order,
+    // a member's position in the layout is its slot.
     class Struct {
     public:
         using MemberList = std::vector<std::string>;
 
-        Struct() = default;
+        static constexpr std::size_t NoSlot = static_cast<std::size_t>(-1);
+
+        class SlotHint;
+
+        Struct();
         Struct(const std::string &name, const MemberList &members);
 
         inline bool operator==(const Struct &rhs) const;
@@ -26,6 +36,10 @@ namespace Ishlang {
         inline const std::string &name() const;
         inline const MemberList &members() const;
 
+        // Returns the slot of the named member, or NoSlot. The hint, usually
+        // the slot found by a previous lookup, is checked first.
+        inline std::size_t slot(const std::string &name, std::size_t hint = NoSlot) const;
+
         void describe() const;
 
     public:
@@ -35,46 +49,83 @@ namespace Ishlang {
         }
 
     private:
+        struct Layout {
+            std::string name;
+            MemberList  members;
+        };
+
         static inline bool membersEqual(const MemberList &lhs, const MemberList &rhs);
-        
+
     private:
-        std::string name_;
-        MemberList  members_;
+        std::shared_ptr<const Layout> layout_;
+    };
+
+    // Slot found by a previous lookup, kept by code nodes that may run on
+    // several threads at once. Hints are checked before use, so they are
+    // read and written without ordering.
+    class Struct::SlotHint {
+    public:
+        SlotHint() noexcept = default;
+
+        inline std::size_t load() const noexcept;
+        inline void store(std::size_t slot) noexcept;
+
+    private:
+        using AtomicRef = std::atomic_ref<std::size_t>;
+
+        alignas(AtomicRef::required_alignment) std::size_t slot_ = NoSlot;
     };
 
     // --------------------------------------------------------------------------------
     // INLINE
 
+    inline std::size_t Struct::SlotHint::load() const noexcept {
+        return AtomicRef(const_cast<std::size_t &>(slot_)).load(std::memory_order_relaxed);
+    }
+
+    inline void Struct::SlotHint::store(std::size_t slot) noexcept {
+        AtomicRef(slot_).store(slot, std::memory_order_relaxed);
+    }
+
     inline bool Struct::operator==(const Struct &rhs) const {
-        return name_ == rhs.name_ && membersEqual(members_, rhs.members_);
+        return layout_ == rhs.layout_ || (name() == rhs.name() && membersEqual(members(), rhs.members()));
     }
 
     inline bool Struct::operator!=(const Struct &rhs) const {
-        return name_ != rhs.name_ || !membersEqual(members_, rhs.members_);
+        return !(*this == rhs);
     }
 
     inline bool Struct::operator<(const Struct &rhs) const {
-        return members_.size() < rhs.members_.size();
+        return members().size() < rhs.members().size();
     }
 
     inline bool Struct::operator>(const Struct &rhs) const {
-        return members_.size() > rhs.members_.size();
+        return members().size() > rhs.members().size();
     }
 
     inline bool Struct::operator<=(const Struct &rhs) const {
-        return members_.size() <= rhs.members_.size();
+        return members().size() <= rhs.members().size();
     }
 
     inline bool Struct::operator>=(const Struct &rhs) const {
-        return members_.size() >= rhs.members_.size();
+        return members().size() >= rhs.members().size();
     }
 
     inline const std::string &Struct::name() const {
-        return name_;
+        return layout_->name;
     }
 
     inline auto Struct::members() const -> const MemberList & {
-        return members_;
+        return layout_->members;
+    }
+
+    inline std::size_t Struct::slot(const std::string &name, std::size_t hint) const {
+        const auto &mems = members();
+        if (hint < mems.size() && mems[hint] == name) {
+            return hint;
+        }
+        const auto iter = std::find(mems.begin(), mems.end(), name);
+        return iter != mems.end() ? static_cast<std::size_t>(iter - mems.begin()) : NoSlot;
     }
 
     inline bool Struct::membersEqual(const MemberList &lhs, const MemberList &rhs) {
@@ -0,0 +1,249 @@
+#include "thread_pool.h"
+#include "context.h"
+#include "garbage_collector.h"
+#include "ref_count.h"
+
+#include <algorithm>
+#include <exception>
+
+using namespace Ishlang;
+
+namespace {
+    // Pool and deque of the worker running on this thread
+    constinit thread_local const ThreadPool *workerPool = nullptr;
+    constinit thread_local std::size_t workerIndex = 0;
+}
+
+// -------------------------------------------------------------
+struct ThreadPool::Batch {
+    const Function          *ftn;
+    Context                 *context;
+    std::size_t              pending;
+    std::exception_ptr       error;
+    std::mutex               mutex;
+    std::condition_variable  done;
+};
+
+// -------------------------------------------------------------
+struct ThreadPool::Submitted {
+    Task                    ftn;
+    Context                *context;
+    GarbageCollector::Pause pause;
+};
+
+// -------------------------------------------------------------
+std::atomic<std::size_t> ThreadPool::configured_ = 0;
+std::atomic<ThreadPool *> ThreadPool::installed_ = nullptr;
+
+// -------------------------------------------------------------
+ThreadPool &ThreadPool::instance() {
+    if (auto *pool = installed_.load()) {
+        return *pool;
+    }
+
+    static ThreadPool pool([]() -> std::size_t {
+        const std::size_t concurrency = configured_.load();
+        return std::max<std::size_t>(concurrency > 0 ? concurrency : std::thread::hardware_concurrency(), 1) - 1;
+    }());
+    return pool;
+}
+
+// -------------------------------------------------------------
+ThreadPool::Scope::Scope(ThreadPool &pool) noexcept
+    : previous_(installed_.exchange(&pool))
+{}
+
+// -------------------------------------------------------------
+ThreadPool::Scope::~Scope() {
+    installed_.store(previous_);
+}
+
+// -------------------------------------------------------------
+void ThreadPool::configure(std::size_t concurrency) noexcept {
+    configured_.store(concurrency);
+}
+
+// -------------------------------------------------------------
+ThreadPool::ThreadPool(std::size_t workers)
+    : workers_()
+    , next_(0)
+    , queued_(0)
+    , idleMutex_()
+    , idle_()
+    , stop_(false)
+{
+    if (workers > 0) { RefCount::enableAtomic(); }
+
+    workers_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < workers; ++i) {
+        workers_[i]->thread = std::thread([this, i]() { work(i); });
+    }
+}
+
+// -------------------------------------------------------------
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(idleMutex_);
+        stop_ = true;
+    }
+    idle_.notify_all();
+    for (auto &worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+// -------------------------------------------------------------
+void ThreadPool::run(std::size_t count, const Function &ftn) {
+    if (count == 0) { return; }
+
+    if (workers_.empty() || inWorker()) {
+        for (std::size_t i = 0; i < count; ++i) {
+            ftn(i);
+        }
+        return;
+    }
+
+    GarbageCollector::Pause pause;
+
+    Batch batch{&ftn, Context::installed(), count, nullptr, {}, {}};
+    for (std::size_t i = 0; i < count; ++i) {
+        auto &worker = *workers_[i % workers_.size()];
+        std::lock_guard lock(worker.mutex);
+        worker.jobs.push_back(Job{&batch, i, nullptr});
+    }
+    {
+        std::lock_guard lock(idleMutex_);
+        queued_ += count;
+    }
+    idle_.notify_all();
+
+    // Help with the batch, then wait for jobs still running on workers
+    while (help()) {}
+    {
+        std::unique_lock lock(batch.mutex);
+        batch.done.wait(lock, [&batch]() { return batch.pending == 0; });
+    }
+
+    if (batch.error) {
+        std::rethrow_exception(batch.error);
+    }
+}
+
+// -------------------------------------------------------------
+void ThreadPool::submit(Task task) {
+    if (workers_.empty()) {
+        task();
+        return;
+    }
+
+    auto submitted = std::make_shared<Submitted>(std::move(task), Context::installed());
+    push(self() < workers_.size() ? self() : next_++ % workers_.size(), Job{nullptr, 0, std::move(submitted)});
+}
+
+// -------------------------------------------------------------
+bool ThreadPool::help() {
+    if (auto job = take(self())) {
+        execute(*job);
+        return true;
+    }
+    return false;
+}
+
+// -------------------------------------------------------------
+bool ThreadPool::inWorker() noexcept {
+    return workerPool != nullptr;
+}
+
+// -------------------------------------------------------------
+void ThreadPool::push(std::size_t target, Job &&job) {
+    {
+        auto &worker = *workers_[target];
+        std::lock_guard lock(worker.mutex);
+        worker.jobs.push_back(std::move(job));
+    }
+    {
+        std::lock_guard lock(idleMutex_);
+        ++queued_;
+    }
+    idle_.notify_one();
+}
+
+// -------------------------------------------------------------
+std::size_t ThreadPool::self() const noexcept {
+    return workerPool == this ? workerIndex : workers_.size();
+}
+
+// -------------------------------------------------------------
+void ThreadPool::work(std::size_t self) {
+    workerPool = this;
+    workerIndex = self;
+    while (true) {
+        if (auto job = take(self)) {
+            execute(*job);
+            continue;
+        }
+
+        std::unique_lock lock(idleMutex_);
+        idle_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+        if (stop_) { return; }
+    }
+}
+
+// -------------------------------------------------------------
+auto ThreadPool::take(std::size_t self) -> std::optional<Job> {
+    const auto size = workers_.size();
+    if (self < size) {
+        auto &own = *workers_[self];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty()) {
+            auto job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            --queued_;
+            return job;
+        }
+    }
+
+    for (std::size_t i = 1; i <= size; ++i) {
+        auto &victim = *workers_[(self + i) % size];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            auto job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            --queued_;
+            return job;
+        }
+    }
+    return std::nullopt;
+}
+
+// -------------------------------------------------------------
+void ThreadPool::execute(Job &job) {
+    if (job.task) {
+        // Values held by the task are released under its context, its
+        // collections resume once the job is dropped
+        Context::Scope scope(job.task->context);
+        job.task->ftn();
+        job.task->ftn = nullptr;
+        return;
+    }
+
+    auto &batch = *job.batch;
+
+    std::exception_ptr error;
+    try {
+        Context::Scope scope(batch.context);
+        (*batch.ftn)(job.index);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    // The waiting thread returns once it sees no pending jobs under the
+    // lock, the batch is not touched after unlocking
+    std::lock_guard lock(batch.mutex);
+    if (error && !batch.error) { batch.error = error; }
+    if (--batch.pending == 0) { batch.done.notify_all(); }
+}
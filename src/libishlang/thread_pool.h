@@ -0,0 +1,123 @@
+#ifndef ISHLANG_THREAD_POOL_H
+#define ISHLANG_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Ishlang {
+
+    // Work stealing pool running the chunks of parallel builtins and
+    // spawned tasks. Each worker owns a deque of jobs, it takes jobs from
+    // the back of its own deque and steals from the front of the others
+    // once it runs dry. Threads waiting for a batch or a task run jobs
+    // too. Workers are started on first use, which switches reference
+    // counts to atomic updates. Jobs run under the context of the thread
+    // submitting them, and its collections are paused until they finish.
+    class ThreadPool {
+    public:
+        using Function = std::function<void (std::size_t)>;
+        using Task     = std::function<void ()>;
+
+    public:
+        class Scope;
+
+    public:
+        // Pool sized to the cores of the machine, or as configured, unless
+        // a scope installed another.
+        static ThreadPool &instance();
+
+        // Threads used by the pool instance, workers and the caller, zero
+        // for the cores of the machine. Only takes effect before first use.
+        static void configure(std::size_t concurrency) noexcept;
+
+        explicit ThreadPool(std::size_t workers);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // Threads running a batch, the workers and the caller.
+        inline std::size_t concurrency() const noexcept;
+
+        // Runs ftn(0) to ftn(count - 1) and returns once all have finished.
+        // The first exception thrown is rethrown. Called from a worker the
+        // jobs run in order on that worker.
+        void run(std::size_t count, const Function &ftn);
+
+        // Queues task and returns, the task must not throw. Submitted from
+        // a worker it goes to the back of the worker's own deque. Without
+        // workers it runs before returning.
+        void submit(Task task);
+
+        // Runs one queued job on the calling thread, false if none is queued.
+        bool help();
+
+        static bool inWorker() noexcept;
+
+    private:
+        struct Batch;
+        struct Submitted;
+
+        struct Job {
+            Batch                      *batch;
+            std::size_t                 index;
+            std::shared_ptr<Submitted>  task;
+        };
+
+        struct Worker {
+            std::mutex      mutex;
+            std::deque<Job> jobs;
+            std::thread     thread;
+        };
+
+    private:
+        void work(std::size_t self);
+        void push(std::size_t target, Job &&job);
+        std::size_t self() const noexcept;
+        std::optional<Job> take(std::size_t self);
+        static void execute(Job &job);
+
+    private:
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::atomic<std::size_t>             next_;
+        std::atomic<std::size_t>             queued_;
+        std::mutex                           idleMutex_;
+        std::condition_variable              idle_;
+        bool                                 stop_;
+
+        static std::atomic<std::size_t>      configured_;
+        static std::atomic<ThreadPool *>     installed_;
+    };
+
+    // Installs a pool as the instance for its lifetime, on all threads,
+    // and restores the previous one afterwards.
+    class ThreadPool::Scope {
+    public:
+        explicit Scope(ThreadPool &pool) noexcept;
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        ThreadPool *previous_;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline std::size_t ThreadPool::concurrency() const noexcept {
+        return workers_.size() + 1;
+    }
+
+}
+
+#endif // ISHLANG_THREAD_POOL_H
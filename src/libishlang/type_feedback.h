@@ -0,0 +1,116 @@
+#ifndef ISHLANG_TYPE_FEEDBACK_H
+#define ISHLANG_TYPE_FEEDBACK_H
+
+#include "value.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace Ishlang {
+
+    // Operand type seen by a code node, kept so the node can quicken to a
+    // path specialized for it. The node records the type of every generic
+    // evaluation, and is quickened once Warmup evaluations in a row saw the
+    // same type. A quickened node checks the type before taking its fast
+    // path and deoptimizes when it differs, after which it warms up again.
+    // Nodes deoptimized MaxDeopts times stay generic.
+    //
+    // Like Struct::SlotHint, feedback is read and written without ordering,
+    // since nodes may run on several threads at once. Feedback lost to a
+    // race only delays quickening.
+    class TypeFeedback {
+    public:
+        static constexpr unsigned Warmup    = 8;
+        static constexpr unsigned MaxDeopts = 4;
+
+    public:
+        TypeFeedback() noexcept = default;
+
+        // Type the node is quickened for, eNone when generic.
+        inline Value::Type quickened() const noexcept;
+
+        inline void record(Value::Type type) noexcept;
+        inline void deoptimize() noexcept;
+
+        inline unsigned deopts() const noexcept;
+
+    private:
+        using State     = std::uint32_t;
+        using AtomicRef = std::atomic_ref<State>;
+
+        // Type in the low byte, then count of evaluations in a row, then
+        // deoptimizations, and the quickened flag.
+        static constexpr State TypeMask    = 0xff;
+        static constexpr State CountShift  = 8;
+        static constexpr State DeoptShift  = 16;
+        static constexpr State Quickened   = 1u << 24;
+
+        inline State load() const noexcept;
+        inline void store(State state) noexcept;
+
+        static inline State make(Value::Type type, unsigned count, unsigned deopts) noexcept;
+        static inline unsigned count(State state) noexcept;
+        static inline unsigned deopts(State state) noexcept;
+
+    private:
+        alignas(AtomicRef::required_alignment) State state_ = 0;
+    };
+
+    // --------------------------------------------------------------------------------
+    // INLINE
+
+    inline Value::Type TypeFeedback::quickened() const noexcept {
+        const auto state = load();
+        return state & Quickened ? static_cast<Value::Type>(state & TypeMask) : Value::eNone;
+    }
+
+    inline void TypeFeedback::record(Value::Type type) noexcept {
+        const auto state = load();
+        const auto numDeopts = deopts(state);
+        if (numDeopts >= MaxDeopts) {
+            return;
+        }
+
+        State next = make(type, 1, numDeopts);
+        if (type != Value::eNone && static_cast<State>(type) == (state & TypeMask)) {
+            const auto numSeen = count(state) + 1;
+            next = numSeen >= Warmup ? make(type, Warmup, numDeopts) | Quickened : make(type, numSeen, numDeopts);
+        }
+
+        // Sites seeing types that are never quickened are not written again
+        if (next != state) {
+            store(next);
+        }
+    }
+
+    inline void TypeFeedback::deoptimize() noexcept {
+        store(make(Value::eNone, 0, deopts(load()) + 1));
+    }
+
+    inline unsigned TypeFeedback::deopts() const noexcept {
+        return deopts(load());
+    }
+
+    inline TypeFeedback::State TypeFeedback::load() const noexcept {
+        return AtomicRef(const_cast<State &>(state_)).load(std::memory_order_relaxed);
+    }
+
+    inline void TypeFeedback::store(State state) noexcept {
+        AtomicRef(state_).store(state, std::memory_order_relaxed);
+    }
+
+    inline TypeFeedback::State TypeFeedback::make(Value::Type type, unsigned count, unsigned deopts) noexcept {
+        return static_cast<State>(type) | (static_cast<State>(count) << CountShift) | (static_cast<State>(deopts) << DeoptShift);
+    }
+
+    inline unsigned TypeFeedback::count(State state) noexcept {
+        return (state >> CountShift) & 0xff;
+    }
+
+    inline unsigned TypeFeedback::deopts(State state) noexcept {
+        return (state >> DeoptShift) & 0xff;
+    }
+
+}
+
+#endif	// ISHLANG_TYPE_FEEDBACK_H
@@ -2,13 +2,22 @@
 #include "value_pair.h"
 #include "exception.h"
 #include "file_io.h"
+#include "garbage_collector.h"
+#include "dense_array.h"
+#include "future.h"
+#include "generator.h"
 #include "generic_table.h"
 #include "instance.h"
 #include "integer_range.h"
+#include "iterator.h"
 #include "lambda.h"
+#include "output.h"
 #include "sequence.h"
 #include "struct.h"
 
+#include <memory>
+#include <new>
+
 using namespace Ishlang;
 
 // -------------------------------------------------------------
@@ -31,78 +40,262 @@ Hashtable    Value::NullHashtable;
 OrderedTable Value::NullOrderedTable;
 IntegerRange Value::NullIntegerRange;
 FileStruct   Value::NullFileStruct;
+DenseArray   Value::NullDenseArray;
+Future       Value::NullFuture;
+Generator    Value::NullGenerator;
+Iterator     Value::NullIterator;
+
+// -------------------------------------------------------------
+template <typename T, typename ...Args>
+void Value::emplace(Args &&...args) {
+    static_assert(alignof(T) <= alignof(Box));
+    const bool gc = tracked(type_);
+    const std::size_t linkSize = gc ? sizeof(GcLink) : 0;
+    void *mem = ::operator new(linkSize + sizeof(Box) + sizeof(T));
+    auto box = new (static_cast<char *>(mem) + linkSize) Box{RefCount(), type_};
+    try {
+        new (box + 1) T(std::forward<Args>(args)...);
+    }
+    catch (...) {
+        ::operator delete(mem);
+        throw;
+    }
+    if (gc) { GarbageCollector::current().track(static_cast<GcLink *>(mem)); }
+    value_.box = box;
+    heap_ = true;
+}
+
+// -------------------------------------------------------------
+void Value::destroy() noexcept {
+    switch (type_) {
+    case ePair:       std::destroy_at(&object<Pair>());       break;
+    case eString:     std::destroy_at(&object<Text>());       break;
+    case eClosure:    std::destroy_at(&object<Func>());       break;
+    case eUserType:   std::destroy_at(&object<UserType>());   break;
+    case eUserObject: std::destroy_at(&object<UserObject>()); break;
+    case eArray:      std::destroy_at(&object<Array>());      break;
+    case eHashMap:    std::destroy_at(&object<HashMap>());    break;
+    case eOrderedMap: std::destroy_at(&object<OrderedMap>()); break;
+    case eRange:      std::destroy_at(&object<Range>());      break;
+    case eFile:       std::destroy_at(&object<File>());       break;
+    case eNdArray:    std::destroy_at(&object<NdArray>());    break;
+    case eFuture:     std::destroy_at(&object<Task>());       break;
+    case eGenerator:  std::destroy_at(&object<Coroutine>());  break;
+    case eIterator:   std::destroy_at(&object<Stream>());     break;
+    default:                                                break;
+    }
+    value_.box->~Box();
+    if (tracked(type_)) {
+        auto link = reinterpret_cast<GcLink *>(value_.box) - 1;
+        GarbageCollector::current().untrack(link);
+        ::operator delete(link);
+    }
+    else {
+        ::operator delete(value_.box);
+    }
+}
 
 // -------------------------------------------------------------
 Value::Value(const Pair &p)
-    : type_(ePair)
-    , value_(std::make_shared<Pair>(p))
-{}
+    : value_{.box = nullptr}
+    , type_(ePair)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Pair>(p);
+}
 
 // -------------------------------------------------------------
 Value::Value(const char *t)
-    : type_(eString)
-    , value_(std::make_shared<std::string>(t))
-{}
+    : value_{.box = nullptr}
+    , type_(eString)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Text>(t);
+}
 
 // -------------------------------------------------------------
 Value::Value(const std::string &t)
-    : type_(eString)
-    , value_(std::make_shared<std::string>(t))
-{}
+    : value_{.box = nullptr}
+    , type_(eString)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Text>(t);
+}
 
 // -------------------------------------------------------------
 Value::Value(std::string &&t)
-    : type_(eString)
-    , value_(std::make_shared<std::string>(std::move(t)))
-{}
+    : value_{.box = nullptr}
+    , type_(eString)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Text>(std::move(t));
+}
+
+// -------------------------------------------------------------
+Value Value::immutableText(const std::string &t) {
+    Value value(t);
+    value.immutable_ = true;
+    return value;
+}
+
+// -------------------------------------------------------------
+void Value::detachText() {
+    *this = Value(object<Text>());
+}
 
 // -------------------------------------------------------------
 Value::Value(const Lambda &f)
-    : type_(eClosure)
-    , value_(std::make_shared<Lambda>(f))
-{}
+    : value_{.box = nullptr}
+    , type_(eClosure)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Lambda>(f);
+}
 
 // -------------------------------------------------------------
 Value::Value(const Struct &s)
-    : type_(eUserType)
-    , value_(std::make_shared<Struct>(s))
-{}
+    : value_{.box = nullptr}
+    , type_(eUserType)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Struct>(s);
+}
 
 // -------------------------------------------------------------
 Value::Value(const Instance &o)
-    : type_(eUserObject)
-    , value_(std::make_shared<Instance>(o))
-{}
+    : value_{.box = nullptr}
+    , type_(eUserObject)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Instance>(o);
+}
+
+// -------------------------------------------------------------
+Value::Value(Instance &&o)
+    : value_{.box = nullptr}
+    , type_(eUserObject)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Instance>(std::move(o));
+}
 
 // -------------------------------------------------------------
 Value::Value(const Sequence &s)
-    : type_(eArray)
-    , value_(std::make_shared<Sequence>(s))
-{}
+    : value_{.box = nullptr}
+    , type_(eArray)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Sequence>(s);
+}
+
+Value::Value(Sequence &&s)
+    : value_{.box = nullptr}
+    , type_(eArray)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Sequence>(std::move(s));
+}
 
 // -------------------------------------------------------------
 Value::Value(const Hashtable &h)
-    : type_(eHashMap)
-    , value_(std::make_shared<Hashtable>(h))
-{}
+    : value_{.box = nullptr}
+    , type_(eHashMap)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Hashtable>(h);
+}
 
 // -------------------------------------------------------------
 Value::Value(const OrderedTable &h)
-    : type_(eOrderedMap)
-    , value_(std::make_shared<OrderedTable>(h))
-{}
+    : value_{.box = nullptr}
+    , type_(eOrderedMap)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<OrderedTable>(h);
+}
 
 // -------------------------------------------------------------
 Value::Value(const IntegerRange &r)
-    : type_(eRange)
-    , value_(std::make_shared<IntegerRange>(r))
-{}
+    : value_{.box = nullptr}
+    , type_(eRange)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<IntegerRange>(r);
+}
 
 // -------------------------------------------------------------
 Value::Value(FileParams && fp)
-    : type_(eFile)
-    , value_(std::make_shared<FileStruct>(std::move(fp)))
-{}
+    : value_{.box = nullptr}
+    , type_(eFile)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<FileStruct>(std::move(fp));
+}
+
+// -------------------------------------------------------------
+Value::Value(const DenseArray &a)
+    : value_{.box = nullptr}
+    , type_(eNdArray)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<DenseArray>(a);
+}
+
+Value::Value(DenseArray &&a)
+    : value_{.box = nullptr}
+    , type_(eNdArray)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<DenseArray>(std::move(a));
+}
+
+// -------------------------------------------------------------
+Value::Value(const Future &f)
+    : value_{.box = nullptr}
+    , type_(eFuture)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Future>(f);
+}
+
+// -------------------------------------------------------------
+Value::Value(const Generator &g)
+    : value_{.box = nullptr}
+    , type_(eGenerator)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Generator>(g);
+}
+
+// -------------------------------------------------------------
+Value::Value(const Iterator &i)
+    : value_{.box = nullptr}
+    , type_(eIterator)
+    , heap_(false)
+    , immutable_(false)
+{
+    emplace<Iterator>(i);
+}
+
+static_assert(sizeof(Value) == 16);
 
 // -------------------------------------------------------------
 Value Value::asInt() const {
@@ -203,20 +396,24 @@ Value Value::asString() const {
 bool Value::operator==(const Value &rhs) const {
     if (type_ == rhs.type_) {
         switch (type_) {
-        case eInteger:    return std::get<Long>(value_) == std::get<Long>(rhs.value_);
-        case eReal:       return std::get<Double>(value_) == std::get<Double>(rhs.value_);
-        case eCharacter:  return std::get<Char>(value_) == std::get<Char>(rhs.value_);
-        case eBoolean:    return std::get<Bool>(value_) == std::get<Bool>(rhs.value_);
-        case ePair:       return *std::get<PairPtr>(value_) == *std::get<PairPtr>(rhs.value_);
-        case eString:     return *std::get<StringPtr>(value_) == *std::get<StringPtr>(rhs.value_);
-        case eClosure:    return *std::get<LambdaPtr>(value_) == *std::get<LambdaPtr>(rhs.value_);
-        case eUserType:   return *std::get<StructPtr>(value_) == *std::get<StructPtr>(rhs.value_);
-        case eUserObject: return *std::get<InstancePtr>(value_) == *std::get<InstancePtr>(rhs.value_);
-        case eArray:      return *std::get<SequencePtr>(value_) == *std::get<SequencePtr>(rhs.value_);
-        case eHashMap:    return *std::get<HashtablePtr>(value_) == *std::get<HashtablePtr>(rhs.value_);
-        case eOrderedMap: return *std::get<OrderedTablePtr>(value_) == *std::get<OrderedTablePtr>(rhs.value_);
-        case eRange:      return *std::get<IntegerRangePtr>(value_) == *std::get<IntegerRangePtr>(rhs.value_);
-        case eFile:       return *std::get<FileStructPtr>(value_) == *std::get<FileStructPtr>(rhs.value_);
+        case eInteger:    return value_.i == rhs.value_.i;
+        case eReal:       return value_.r == rhs.value_.r;
+        case eCharacter:  return value_.c == rhs.value_.c;
+        case eBoolean:    return value_.b == rhs.value_.b;
+        case ePair:       return object<Pair>() == rhs.object<Pair>();
+        case eString:     return object<Text>() == rhs.object<Text>();
+        case eClosure:    return object<Func>() == rhs.object<Func>();
+        case eUserType:   return object<UserType>() == rhs.object<UserType>();
+        case eUserObject: return object<UserObject>() == rhs.object<UserObject>();
+        case eArray:      return object<Array>() == rhs.object<Array>();
+        case eHashMap:    return object<HashMap>() == rhs.object<HashMap>();
+        case eOrderedMap: return object<OrderedMap>() == rhs.object<OrderedMap>();
+        case eRange:      return object<Range>() == rhs.object<Range>();
+        case eNdArray:    return object<NdArray>() == rhs.object<NdArray>();
+        case eFuture:     return object<Task>() == rhs.object<Task>();
+        case eGenerator:  return object<Coroutine>() == rhs.object<Coroutine>();
+        case eIterator:   return object<Stream>() == rhs.object<Stream>();
+        case eFile:       return object<File>() == rhs.object<File>();
         case eNone:       return true;
         }
     }
@@ -230,20 +427,24 @@ bool Value::operator==(const Value &rhs) const {
 bool Value::operator!=(const Value &rhs) const {
     if (type_ == rhs.type_) {
         switch (type_) {
-        case eInteger:    return std::get<Long>(value_) != std::get<Long>(rhs.value_);
-        case eReal:       return std::get<Double>(value_) != std::get<Double>(rhs.value_);
-        case eCharacter:  return std::get<Char>(value_) != std::get<Char>(rhs.value_);
-        case eBoolean:    return std::get<Bool>(value_) != std::get<Bool>(rhs.value_);
-        case ePair:       return *std::get<PairPtr>(value_) != *std::get<PairPtr>(rhs.value_);
-        case eString:     return *std::get<StringPtr>(value_) != *std::get<StringPtr>(rhs.value_);
-        case eClosure:    return *std::get<LambdaPtr>(value_) != *std::get<LambdaPtr>(rhs.value_);
-        case eUserType:   return *std::get<StructPtr>(value_) != *std::get<StructPtr>(rhs.value_);
-        case eUserObject: return *std::get<InstancePtr>(value_) != *std::get<InstancePtr>(rhs.value_);
-        case eArray:      return *std::get<SequencePtr>(value_) != *std::get<SequencePtr>(rhs.value_);
-        case eHashMap:    return *std::get<HashtablePtr>(value_) != *std::get<HashtablePtr>(rhs.value_);
-        case eOrderedMap: return *std::get<OrderedTablePtr>(value_) != *std::get<OrderedTablePtr>(rhs.value_);
-        case eRange:      return *std::get<IntegerRangePtr>(value_) != *std::get<IntegerRangePtr>(rhs.value_);
-        case eFile:       return *std::get<FileStructPtr>(value_) != *std::get<FileStructPtr>(rhs.value_);
+        case eInteger:    return value_.i != rhs.value_.i;
+        case eReal:       return value_.r != rhs.value_.r;
+        case eCharacter:  return value_.c != rhs.value_.c;
+        case eBoolean:    return value_.b != rhs.value_.b;
+        case ePair:       return object<Pair>() != rhs.object<Pair>();
+        case eString:     return object<Text>() != rhs.object<Text>();
+        case eClosure:    return object<Func>() != rhs.object<Func>();
+        case eUserType:   return object<UserType>() != rhs.object<UserType>();
+        case eUserObject: return object<UserObject>() != rhs.object<UserObject>();
+        case eArray:      return object<Array>() != rhs.object<Array>();
+        case eHashMap:    return object<HashMap>() != rhs.object<HashMap>();
+        case eOrderedMap: return object<OrderedMap>() != rhs.object<OrderedMap>();
+        case eRange:      return object<Range>() != rhs.object<Range>();
+        case eNdArray:    return object<NdArray>() != rhs.object<NdArray>();
+        case eFuture:     return object<Task>() != rhs.object<Task>();
+        case eGenerator:  return object<Coroutine>() != rhs.object<Coroutine>();
+        case eIterator:   return object<Stream>() != rhs.object<Stream>();
+        case eFile:       return object<File>() != rhs.object<File>();
         case eNone:       return false;
         }
     }
@@ -257,20 +458,24 @@ bool Value::operator!=(const Value &rhs) const {
 bool Value::operator<(const Value &rhs) const {
     if (type_ == rhs.type_) {
         switch (type_) {
-        case eInteger:    return std::get<Long>(value_) < std::get<Long>(rhs.value_);
-        case eReal:       return std::get<Double>(value_) < std::get<Double>(rhs.value_);
-        case eCharacter:  return std::get<Char>(value_) < std::get<Char>(rhs.value_);
-        case eBoolean:    return std::get<Bool>(value_) < std::get<Bool>(rhs.value_);
-        case ePair:       return *std::get<PairPtr>(value_) < *std::get<PairPtr>(rhs.value_);
-        case eString:     return *std::get<StringPtr>(value_) < *std::get<StringPtr>(rhs.value_);
+        case eInteger:    return value_.i < rhs.value_.i;
+        case eReal:       return value_.r < rhs.value_.r;
+        case eCharacter:  return value_.c < rhs.value_.c;
+        case eBoolean:    return value_.b < rhs.value_.b;
+        case ePair:       return object<Pair>() < rhs.object<Pair>();
+        case eString:     return object<Text>() < rhs.object<Text>();
         case eClosure:    return false;
         case eUserType:   return false;
         case eUserObject: return false;
-        case eArray:      return *std::get<SequencePtr>(value_) < *std::get<SequencePtr>(rhs.value_);
-        case eHashMap:    return *std::get<HashtablePtr>(value_) < *std::get<HashtablePtr>(rhs.value_);
-        case eOrderedMap: return *std::get<OrderedTablePtr>(value_) < *std::get<OrderedTablePtr>(rhs.value_);
-        case eRange:      return *std::get<IntegerRangePtr>(value_) < *std::get<IntegerRangePtr>(rhs.value_);
+        case eArray:      return object<Array>() < rhs.object<Array>();
+        case eHashMap:    return object<HashMap>() < rhs.object<HashMap>();
+        case eOrderedMap: return object<OrderedMap>() < rhs.object<OrderedMap>();
+        case eRange:      return object<Range>() < rhs.object<Range>();
+        case eNdArray:    return object<NdArray>() < rhs.object<NdArray>();
         case eFile:       return false;
+        case eFuture:     return false;
+        case eGenerator:  return false;
+        case eIterator:   return false;
         case eNone:       return false;
         }
     }
@@ -284,20 +489,24 @@ bool Value::operator<(const Value &rhs) const {
 bool Value::operator>(const Value &rhs) const {
     if (type_ == rhs.type_) {
         switch (type_) {
-        case eInteger:    return std::get<Long>(value_) > std::get<Long>(rhs.value_);
-        case eReal:       return std::get<Double>(value_) > std::get<Double>(rhs.value_);
-        case eCharacter:  return std::get<Char>(value_) > std::get<Char>(rhs.value_);
-        case eBoolean:    return std::get<Bool>(value_) > std::get<Bool>(rhs.value_);
-        case ePair:       return *std::get<PairPtr>(value_) > *std::get<PairPtr>(rhs.value_);
-        case eString:     return *std::get<StringPtr>(value_) > *std::get<StringPtr>(rhs.value_);
+        case eInteger:    return value_.i > rhs.value_.i;
+        case eReal:       return value_.r > rhs.value_.r;
+        case eCharacter:  return value_.c > rhs.value_.c;
+        case eBoolean:    return value_.b > rhs.value_.b;
+        case ePair:       return object<Pair>() > rhs.object<Pair>();
+        case eString:     return object<Text>() > rhs.object<Text>();
         case eClosure:    return false;
         case eUserType:   return false;
         case eUserObject: return false;
-        case eArray:      return *std::get<SequencePtr>(value_) > *std::get<SequencePtr>(rhs.value_);
-        case eHashMap:    return *std::get<HashtablePtr>(value_) > *std::get<HashtablePtr>(rhs.value_);
-        case eOrderedMap: return *std::get<OrderedTablePtr>(value_) > *std::get<OrderedTablePtr>(rhs.value_);
-        case eRange:      return *std::get<IntegerRangePtr>(value_) > *std::get<IntegerRangePtr>(rhs.value_);
+        case eArray:      return object<Array>() > rhs.object<Array>();
+        case eHashMap:    return object<HashMap>() > rhs.object<HashMap>();
+        case eOrderedMap: return object<OrderedMap>() > rhs.object<OrderedMap>();
+        case eRange:      return object<Range>() > rhs.object<Range>();
+        case eNdArray:    return object<NdArray>() > rhs.object<NdArray>();
         case eFile:       return false;
+        case eFuture:     return false;
+        case eGenerator:  return false;
+        case eIterator:   return false;
         case eNone:       return false;
         }
     }
@@ -311,20 +520,24 @@ bool Value::operator>(const Value &rhs) const {
 bool Value::operator<=(const Value &rhs) const {
     if (type_ == rhs.type_) {
         switch (type_) {
-        case eInteger:    return std::get<Long>(value_) <= std::get<Long>(rhs.value_);
-        case eReal:       return std::get<Double>(value_) <= std::get<Double>(rhs.value_);
-        case eCharacter:  return std::get<Char>(value_) <= std::get<Char>(rhs.value_);
-        case eBoolean:    return std::get<Bool>(value_) <= std::get<Bool>(rhs.value_);
-        case ePair:       return *std::get<PairPtr>(value_) <= *std::get<PairPtr>(rhs.value_);
-        case eString:     return *std::get<StringPtr>(value_) <= *std::get<StringPtr>(rhs.value_);
+        case eInteger:    return value_.i <= rhs.value_.i;
+        case eReal:       return value_.r <= rhs.value_.r;
+        case eCharacter:  return value_.c <= rhs.value_.c;
+        case eBoolean:    return value_.b <= rhs.value_.b;
+        case ePair:       return object<Pair>() <= rhs.object<Pair>();
+        case eString:     return object<Text>() <= rhs.object<Text>();
         case eClosure:    return false;
         case eUserType:   return false;
         case eUserObject: return false;
-        case eArray:      return *std::get<SequencePtr>(value_) <= *std::get<SequencePtr>(rhs.value_);
-        case eHashMap:    return *std::get<HashtablePtr>(value_) <= *std::get<HashtablePtr>(rhs.value_);
-        case eOrderedMap: return *std::get<OrderedTablePtr>(value_) <= *std::get<OrderedTablePtr>(rhs.value_);
-        case eRange:      return *std::get<IntegerRangePtr>(value_) <= *std::get<IntegerRangePtr>(rhs.value_);
+        case eArray:      return object<Array>() <= rhs.object<Array>();
+        case eHashMap:    return object<HashMap>() <= rhs.object<HashMap>();
+        case eOrderedMap: return object<OrderedMap>() <= rhs.object<OrderedMap>();
+        case eRange:      return object<Range>() <= rhs.object<Range>();
+        case eNdArray:    return object<NdArray>() <= rhs.object<NdArray>();
         case eFile:       return false;
+        case eFuture:     return false;
+        case eGenerator:  return false;
+        case eIterator:   return false;
         case eNone:       return false;
         }
     }
@@ -338,20 +551,24 @@ bool Value::operator<=(const Value &rhs) const {
 bool Value::operator>=(const Value &rhs) const {
     if (type_ == rhs.type_) {
         switch (type_) {
-        case eInteger:    return std::get<Long>(value_) >= std::get<Long>(rhs.value_);
-        case eReal:       return std::get<Double>(value_) >= std::get<Double>(rhs.value_);
-        case eCharacter:  return std::get<Char>(value_) >= std::get<Char>(rhs.value_);
-        case eBoolean:    return std::get<Bool>(value_) >= std::get<Bool>(rhs.value_);
-        case ePair:       return *std::get<PairPtr>(value_) >= *std::get<PairPtr>(rhs.value_);
-        case eString:     return *std::get<StringPtr>(value_) >= *std::get<StringPtr>(rhs.value_);
+        case eInteger:    return value_.i >= rhs.value_.i;
+        case eReal:       return value_.r >= rhs.value_.r;
+        case eCharacter:  return value_.c >= rhs.value_.c;
+        case eBoolean:    return value_.b >= rhs.value_.b;
+        case ePair:       return object<Pair>() >= rhs.object<Pair>();
+        case eString:     return object<Text>() >= rhs.object<Text>();
         case eClosure:    return false;
         case eUserType:   return false;
         case eUserObject: return false;
-        case eArray:      return *std::get<SequencePtr>(value_) >= *std::get<SequencePtr>(rhs.value_);
-        case eHashMap:    return *std::get<HashtablePtr>(value_) >= *std::get<HashtablePtr>(rhs.value_);
-        case eOrderedMap: return *std::get<OrderedTablePtr>(value_) >= *std::get<OrderedTablePtr>(rhs.value_);
-        case eRange:      return *std::get<IntegerRangePtr>(value_) >= *std::get<IntegerRangePtr>(rhs.value_);
+        case eArray:      return object<Array>() >= rhs.object<Array>();
+        case eHashMap:    return object<HashMap>() >= rhs.object<HashMap>();
+        case eOrderedMap: return object<OrderedMap>() >= rhs.object<OrderedMap>();
+        case eRange:      return object<Range>() >= rhs.object<Range>();
+        case eNdArray:    return object<NdArray>() >= rhs.object<NdArray>();
         case eFile:       return false;
+        case eFuture:     return false;
+        case eGenerator:  return false;
+        case eIterator:   return false;
         case eNone:       return false;
         }
     }
@@ -379,6 +596,10 @@ std::string Value::typeToString(Type type) {
         case eOrderedMap: return "orderedmap";
         case eRange:      return "range";
         case eFile:       return "file";
+        case eNdArray:    return "ndarray";
+        case eFuture:     return "future";
+        case eGenerator:  return "generator";
+        case eIterator:   return "iterator";
     }
     return "unknown";
 }
@@ -400,6 +621,10 @@ Value::Type Value::stringToType(const std::string &str) {
     else if (str == "orderedmap") { return Value::eOrderedMap; }
     else if (str == "range")      { return Value::eRange; }
     else if (str == "file")       { return Value::eFile; }
+    else if (str == "ndarray")    { return Value::eNdArray; }
+    else if (str == "future")     { return Value::eFuture; }
+    else if (str == "generator")  { return Value::eGenerator; }
+    else if (str == "iterator")   { return Value::eIterator; }
     throw InvalidExpression("unknown value type", str);
     return Value::eNone;
 }
@@ -419,32 +644,47 @@ Value Value::clone() const {
         return *this;
 
     case eString:
-        return Value(*std::get<StringPtr>(value_));
+        return Value(object<Text>());
 
     case eClosure:
-        return Value(*std::get<LambdaPtr>(value_));
+        return Value(object<Func>());
 
     case eUserType:
-        return Value(*std::get<StructPtr>(value_));
+        return Value(object<UserType>());
 
     case eUserObject:
-        return Value(*std::get<InstancePtr>(value_));
+        return Value(object<UserObject>());
 
     case eArray:
-        return Value(*std::get<SequencePtr>(value_));
+        return Value(object<Array>());
 
     case eHashMap:
-        return Value(*std::get<HashtablePtr>(value_));
+        return Value(object<HashMap>());
 
     case eOrderedMap:
-        return Value(*std::get<OrderedTablePtr>(value_));
+        return Value(object<OrderedMap>());
 
     case eRange:
-        return Value(*std::get<IntegerRangePtr>(value_));
+        return Value(object<Range>());
+
+    case eNdArray:
+        return Value(object<NdArray>().copy());
 
     case eFile:
         throw InvalidExpression("cannot clone file");
         break;
+
+    case eFuture:
+        // The task runs once, copies share its result
+        return *this;
+
+    case eGenerator:
+        // Copies share the position of the body
+        return *this;
+
+    case eIterator:
+        // Copies share the position of the source
+        return *this;
     }
 
     return Value::Null;
@@ -473,6 +713,10 @@ Value Value::asType(Type otherType) const {
     case eOrderedMap:
     case eRange:
     case eFile:
+    case eNdArray:
+    case eFuture:
+    case eGenerator:
+    case eIterator:
         break;
     }
 
@@ -482,63 +726,78 @@ Value Value::asType(Type otherType) const {
 
 // -------------------------------------------------------------
 void Value::printC(std::ostream &out, const Value &value) {
+    Output::NumberBuffer buf;
     switch (value.type_) {
     case Value::eNone:       out << "null";                                                       break;
-    case Value::eInteger:    out << std::get<Long>(value.value_);                                 break;
-    case Value::eReal:       out << std::get<Double>(value.value_);                               break;
-    case Value::eCharacter:  out << '\'' << std::get<Char>(value.value_) << '\'';                 break;
-    case Value::eBoolean:    out << (std::get<Bool>(value.value_) ? "true" : "false");            break;
-    case Value::ePair:       out << *std::get<PairPtr>(value.value_);                             break;
-    case Value::eString:     out << '"' << *std::get<StringPtr>(value.value_) << '"';             break;
+    case Value::eInteger:    out << Output::format(value.value_.i, buf);            break;
+    case Value::eReal:       out << Output::format(value.value_.r, buf);            break;
+    case Value::eCharacter:  out << '\'' << value.value_.c << '\'';                 break;
+    case Value::eBoolean:    out << (value.value_.b ? "true" : "false");            break;
+    case Value::ePair:       out << value.object<Pair>();                             break;
+    case Value::eString:     out << '"' << value.object<Text>() << '"';             break;
     case Value::eClosure:    out << "[Lambda]";                                                   break;
-    case Value::eUserType:   out << *std::get<StructPtr>(value.value_);                           break;
-    case Value::eUserObject: out << *std::get<InstancePtr>(value.value_);                         break;
-    case Value::eArray:      out << *std::get<SequencePtr>(value.value_);                         break;
-    case Value::eHashMap:    out << *std::get<HashtablePtr>(value.value_);                        break;
-    case Value::eOrderedMap: out << *std::get<OrderedTablePtr>(value.value_);                     break;
-    case Value::eRange:      out << *std::get<IntegerRangePtr>(value.value_);                     break;
-    case Value::eFile:       out << "File:" << std::get<FileStructPtr>(value.value_)->filename(); break;
+    case Value::eUserType:   out << value.object<UserType>();                           break;
+    case Value::eUserObject: out << value.object<UserObject>();                         break;
+    case Value::eArray:      out << value.object<Array>();                         break;
+    case Value::eHashMap:    out << value.object<HashMap>();                        break;
+    case Value::eOrderedMap: out << value.object<OrderedMap>();                     break;
+    case Value::eRange:      out << value.object<Range>();                     break;
+    case Value::eFile:       out << "File:" << value.object<File>().filename(); break;
+    case Value::eNdArray:    out << value.object<NdArray>();                   break;
+    case Value::eFuture:     out << value.object<Task>();                      break;
+    case Value::eGenerator:  out << value.object<Coroutine>();                 break;
+    case Value::eIterator:   out << value.object<Stream>();                    break;
     }
 }
 
 // -------------------------------------------------------------
 void Value::print(const Value &value) {
+    Output::Lock lock;
+    auto &out = Output::stream();
     switch (value.type_) {
-    case Value::eNone:       std::cout << "null";                                                       break;
-    case Value::eInteger:    std::cout << std::get<Long>(value.value_);                                 break;
-    case Value::eReal:       std::cout << std::get<Double>(value.value_);                               break;
-    case Value::eCharacter:  std::cout << std::get<Char>(value.value_);                                 break;
-    case Value::eBoolean:    std::cout << (std::get<Bool>(value.value_) ? "true" : "false");            break;
-    case Value::ePair:       std::cout << *std::get<PairPtr>(value.value_);                             break;
-    case Value::eString:     std::cout << *std::get<StringPtr>(value.value_);                           break;
-    case Value::eClosure:    std::cout << "[Lambda]";                                                   break;
-    case Value::eUserType:   std::cout << *std::get<StructPtr>(value.value_);                           break;
-    case Value::eUserObject: std::cout << *std::get<InstancePtr>(value.value_);                         break;
-    case Value::eArray:      std::cout << *std::get<SequencePtr>(value.value_);                         break;
-    case Value::eHashMap:    std::cout << *std::get<HashtablePtr>(value.value_);                        break;
-    case Value::eOrderedMap: std::cout << *std::get<OrderedTablePtr>(value.value_);                     break;
-    case Value::eRange:      std::cout << *std::get<IntegerRangePtr>(value.value_);                     break;
-    case Value::eFile:       std::cout << "File:" << std::get<FileStructPtr>(value.value_)->filename(); break;
+    case Value::eNone:       Output::write("null");                                    break;
+    case Value::eInteger:    Output::write(value.value_.i);                            break;
+    case Value::eReal:       Output::write(value.value_.r);                            break;
+    case Value::eCharacter:  Output::write(value.value_.c);                            break;
+    case Value::eBoolean:    Output::write(value.value_.b ? "true" : "false");         break;
+    case Value::ePair:       out << value.object<Pair>();                              break;
+    case Value::eString:     Output::write(value.object<Text>());                      break;
+    case Value::eClosure:    Output::write("[Lambda]");                                break;
+    case Value::eUserType:   out << value.object<UserType>();                          break;
+    case Value::eUserObject: out << value.object<UserObject>();                        break;
+    case Value::eArray:      out << value.object<Array>();                             break;
+    case Value::eHashMap:    out << value.object<HashMap>();                           break;
+    case Value::eOrderedMap: out << value.object<OrderedMap>();                        break;
+    case Value::eRange:      out << value.object<Range>();                             break;
+    case Value::eFile:       out << "File:" << value.object<File>().filename();        break;
+    case Value::eNdArray:    out << value.object<NdArray>();                           break;
+    case Value::eFuture:     out << value.object<Task>();                              break;
+    case Value::eGenerator:  out << value.object<Coroutine>();                         break;
+    case Value::eIterator:   out << value.object<Stream>();                            break;
     }
 }
 
 // -------------------------------------------------------------
 std::size_t Value::Hash::operator()(const Value &value) const noexcept {
     switch (value.type_) {
-    case Value::eInteger:    return std::hash<Value::Long>{}(value.integer());
-    case Value::eReal:       return std::hash<Value::Double>{}(value.real());
-    case Value::eCharacter:  return std::hash<Value::Char>{}(value.character());
-    case Value::eBoolean:    return std::hash<Value::Bool>{}(value.boolean());
+    case Value::eInteger:    return mixInteger(value.integer());
+    case Value::eReal:       return mix(std::hash<Value::Double>{}(value.real()));
+    case Value::eCharacter:  return mix(std::hash<Value::Char>{}(value.character()));
+    case Value::eBoolean:    return mix(std::hash<Value::Bool>{}(value.boolean()));
     case Value::ePair:       return operator()(value.pair());
-    case Value::eString:     return std::hash<Value::Text>{}(value.text());
-    case Value::eClosure:    return std::hash<const Value::Func *>{}(&value.closure());
-    case Value::eUserType:   return std::hash<const Value::UserType *>{}(&value.userType());
-    case Value::eUserObject: return std::hash<const Value::UserObject *>{}(&value.userObject());
-    case Value::eArray:      return std::hash<const Value::Array *>{}(&value.array());
-    case Value::eHashMap:    return std::hash<const Value::HashMap *>{}(&value.hashMap());
-    case Value::eOrderedMap: return std::hash<const Value::OrderedMap *>{}(&value.orderedMap());
+    case Value::eString:     return mix(std::hash<Value::Text>{}(value.text()));
+    case Value::eClosure:    return mix(std::hash<const Value::Func *>{}(&value.closure()));
+    case Value::eUserType:   return mix(std::hash<const Value::UserType *>{}(&value.userType()));
+    case Value::eUserObject: return mix(std::hash<const Value::UserObject *>{}(&value.userObject()));
+    case Value::eArray:      return mix(std::hash<const Value::Array *>{}(&value.array()));
+    case Value::eHashMap:    return mix(std::hash<const Value::HashMap *>{}(&value.hashMap()));
+    case Value::eOrderedMap: return mix(std::hash<const Value::OrderedMap *>{}(&value.orderedMap()));
     case Value::eRange:      return operator()(value.range());
-    case Value::eFile:       return std::hash<std::string>{}(value.file().filename());
+    case Value::eFile:       return mix(std::hash<std::string>{}(value.file().filename()));
+    case Value::eNdArray:    return mix(std::hash<const Value::NdArray *>{}(&value.ndArray()));
+    case Value::eFuture:     return mix(std::hash<const void *>{}(value.future().identity()));
+    case Value::eGenerator:  return mix(std::hash<const void *>{}(value.generator().identity()));
+    case Value::eIterator:   return mix(std::hash<const void *>{}(value.iterator().identity()));
     case Value::eNone:       break;
     }
 
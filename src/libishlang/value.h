@@ -1,11 +1,13 @@
 #ifndef ISHLANG_VALUE_H
 #define ISHLANG_VALUE_H
 
+#include "ref_count.h"
+
 #include <cassert>
+#include <cstddef>
 #include <iostream>
-#include <memory>
 #include <string>
-#include <variant>
+#include <utility>
 #include <vector>
 
 namespace Ishlang {
@@ -17,21 +19,16 @@ namespace Ishlang {
     class Hashtable;
     class OrderedTable;
     class IntegerRange;
+    class DenseArray;
     class FileStruct;
+    class Future;
+    class Generator;
+    class Iterator;
 
     struct FileParams;
 
-    using PairPtr = std::shared_ptr<ValuePair>;
-    using StringPtr = std::shared_ptr<std::string>;
-    using LambdaPtr = std::shared_ptr<Lambda>;
-    using StructPtr = std::shared_ptr<Struct>;
-    using InstancePtr = std::shared_ptr<Instance>;
-    using SequencePtr = std::shared_ptr<Sequence>;
-    using HashtablePtr = std::shared_ptr<Hashtable>;
-    using OrderedTablePtr = std::shared_ptr<OrderedTable>;
-    using IntegerRangePtr = std::shared_ptr<IntegerRange>;
-    using FileStructPtr = std::shared_ptr<FileStruct>;
-
+    // Scalars are stored inline, heap alternatives behind a single pointer
+    // to a reference counted box holding the object, 16 bytes in all.
     struct Value {
     public:
         static const Value True;
@@ -52,7 +49,11 @@ namespace Ishlang {
         static Hashtable    NullHashtable;
         static OrderedTable NullOrderedTable;
         static IntegerRange NullIntegerRange;
+        static DenseArray   NullDenseArray;
         static FileStruct   NullFileStruct;
+        static Future       NullFuture;
+        static Generator    NullGenerator;
+        static Iterator     NullIterator;
         
     public:
         enum Type {
@@ -71,6 +72,10 @@ namespace Ishlang {
             eOrderedMap = 'M',
             eRange      = 'G',
             eFile       = 'L',
+            eNdArray    = 'N',
+            eFuture     = 'T',
+            eGenerator  = 'Y',
+            eIterator   = 'E',
         };
         using TypeList = std::vector<Type>;
 
@@ -88,6 +93,10 @@ namespace Ishlang {
         using OrderedMap = OrderedTable;
         using Range      = IntegerRange;
         using File       = FileStruct;
+        using NdArray    = DenseArray;
+        using Task       = Future;
+        using Coroutine  = Generator;
+        using Stream     = Iterator;
         
     public:
         inline Value();
@@ -102,11 +111,29 @@ namespace Ishlang {
         Value(const Lambda &f);
         Value(const Struct &s);
         Value(const Instance &o);
+        Value(Instance &&o);
         Value(const Sequence &s);
+        Value(Sequence &&s);
         Value(const Hashtable &h);
         Value(const OrderedTable &m);
         Value(const IntegerRange &r);
         Value(FileParams && fp);
+        Value(const DenseArray &a);
+        Value(DenseArray &&a);
+        Value(const Future &f);
+        Value(const Generator &g);
+        Value(const Iterator &i);
+
+        inline Value(const Value &other) noexcept;
+        inline Value(Value &&other) noexcept;
+        inline ~Value();
+
+        inline Value &operator=(const Value &other) noexcept;
+        inline Value &operator=(Value &&other) noexcept;
+
+        // String sharing its storage with other values, the first write
+        // through text() gives this value a private copy.
+        static Value immutableText(const std::string &t);
 
         inline Type type() const;
         
@@ -125,8 +152,16 @@ namespace Ishlang {
         inline bool isOrderedMap() const;
         inline bool isRange() const;
         inline bool isFile() const;
+        inline bool isNdArray() const;
+        inline bool isFuture() const;
+        inline bool isGenerator() const;
+        inline bool isIterator() const;
         
         inline bool isNumber() const;
+        inline bool isImmutable() const;
+
+        // Values sharing the heap object, 0 for values stored inline.
+        inline std::size_t useCount() const noexcept;
         
         inline Long integer() const;
         inline Double real() const;
@@ -149,6 +184,11 @@ namespace Ishlang {
         inline Range &range();
         inline const File& file() const;
         inline File &file();
+        inline const NdArray &ndArray() const;
+        inline NdArray &ndArray();
+        inline const Task &future() const;
+        inline const Coroutine &generator() const;
+        inline const Stream &iterator() const;
 
         Value asInt() const;
         Value asReal() const;
@@ -186,59 +226,180 @@ namespace Ishlang {
 
     public:
         struct Hash {
+            // Futures, generators and iterators hash by identity(), the
+            // state all copies of one share.
             std::size_t operator()(const Value &value) const noexcept;
             std::size_t operator()(const ValuePair &value) const noexcept;
             std::size_t operator()(const IntegerRange &rng) const noexcept;
 
+            // Hash tables take their probe position and tag from different
+            // bits, so every hash is finalized to spread all input bits.
+            static inline std::size_t mix(std::size_t hash);
+            static inline std::size_t mixInteger(Long value);
             static inline std::size_t combine(std::size_t hash1, std::size_t hash2);
         };
 
     private:
-        using VariantValue = std::variant<Long,
-                                          Double,
-                                          Char,
-                                          Bool,
-                                          PairPtr,
-                                          StringPtr,
-                                          LambdaPtr,
-                                          StructPtr,
-                                          InstancePtr,
-                                          SequencePtr,
-                                          HashtablePtr,
-                                          OrderedTablePtr,
-                                          IntegerRangePtr,
-                                          FileStructPtr>;
-
-        Type type_;
-        VariantValue value_;
+        friend class GarbageCollector;
+
+        // Header of a heap alternative, the object follows it in the same
+        // allocation. Alternatives tracked by the garbage collector are
+        // preceded by their GcLink.
+        struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Box {
+            RefCount refs;
+            Type     type;
+        };
+
+        union Payload {
+            Long   i;
+            Double r;
+            Char   c;
+            Bool   b;
+            Box   *box;
+        };
+
+        template <typename T, typename ...Args>
+        void emplace(Args &&...args);
+
+        template <typename T>
+        inline T &object() const noexcept;
+
+        inline void retain() const noexcept;
+        inline void release() noexcept;
+        void destroy() noexcept;
+
+        static inline bool tracked(Type type) noexcept;
+
+        void detachText();
+
+        Payload value_;
+        Type    type_;
+        bool    heap_;
+        bool    immutable_;
     };
 
     // --------------------------------------------------------------------------------
     // INLINE
 
     inline Value::Value()
-        : type_(eNone)
+        : value_{.i = 0}
+        , type_(eNone)
+        , heap_(false)
+        , immutable_(false)
     {}
 
     inline Value::Value(Long i)
-        : type_(eInteger)
-        , value_(i)
+        : value_{.i = i}
+        , type_(eInteger)
+        , heap_(false)
+        , immutable_(false)
     {}
 
     inline Value::Value(Double r)
-        : type_(eReal)
-        , value_(r)
+        : value_{.r = r}
+        , type_(eReal)
+        , heap_(false)
+        , immutable_(false)
     {}
 
     inline Value::Value(Char c)
-        : type_(eCharacter)
-        , value_(c)
-    {}
+        : value_{.i = 0}
+        , type_(eCharacter)
+        , heap_(false)
+        , immutable_(false)
+    {
+        value_.c = c;
+    }
 
     inline Value::Value(Bool b)
-        : type_(eBoolean)
-        , value_(b)
-    {}
+        : value_{.i = 0}
+        , type_(eBoolean)
+        , heap_(false)
+        , immutable_(false)
+    {
+        value_.b = b;
+    }
+
+    inline Value::Value(const Value &other) noexcept
+        : value_(other.value_)
+        , type_(other.type_)
+        , heap_(other.heap_)
+        , immutable_(other.immutable_)
+    {
+        retain();
+    }
+
+    inline Value::Value(Value &&other) noexcept
+        : value_(other.value_)
+        , type_(other.type_)
+        , heap_(other.heap_)
+        , immutable_(other.immutable_)
+    {
+        other.value_.i = 0;
+        other.type_ = eNone;
+        other.heap_ = false;
+        other.immutable_ = false;
+    }
+
+    inline Value::~Value() {
+        release();
+    }
+
+    inline Value &Value::operator=(const Value &other) noexcept {
+        other.retain();
+        release();
+        value_ = other.value_;
+        type_ = other.type_;
+        heap_ = other.heap_;
+        immutable_ = other.immutable_;
+        return *this;
+    }
+
+    inline Value &Value::operator=(Value &&other) noexcept {
+        if (this != &other) {
+            release();
+            value_ = other.value_;
+            type_ = other.type_;
+            heap_ = other.heap_;
+            immutable_ = other.immutable_;
+            other.value_.i = 0;
+            other.type_ = eNone;
+            other.heap_ = false;
+            other.immutable_ = false;
+        }
+        return *this;
+    }
+
+    template <typename T>
+    inline T &Value::object() const noexcept {
+        return *reinterpret_cast<T *>(value_.box + 1);
+    }
+
+    inline void Value::retain() const noexcept {
+        if (heap_) {
+            value_.box->refs.retain();
+        }
+    }
+
+    inline void Value::release() noexcept {
+        if (heap_ && value_.box->refs.release()) {
+            destroy();
+        }
+    }
+
+    inline bool Value::tracked(Type type) noexcept {
+        switch (type) {
+        case ePair:
+        case eClosure:
+        case eUserObject:
+        case eArray:
+        case eHashMap:
+        case eOrderedMap:
+            return true;
+        default:
+            return false;
+        }
+    }
 
     inline auto Value::type() const -> Type {
         return type_;
@@ -304,92 +465,138 @@ namespace Ishlang {
         return type_ == eFile;
     }
 
+    inline bool Value::isNdArray() const {
+        return type_ == eNdArray;
+    }
+
+    inline bool Value::isFuture() const {
+        return type_ == eFuture;
+    }
+
+    inline bool Value::isGenerator() const {
+        return type_ == eGenerator;
+    }
+
+    inline bool Value::isIterator() const {
+        return type_ == eIterator;
+    }
+
     inline bool Value::isNumber() const {
         return type_ == eInteger || type_ == eReal;
     }
 
+    inline bool Value::isImmutable() const {
+        return immutable_;
+    }
+
+    inline std::size_t Value::useCount() const noexcept {
+        return heap_ ? value_.box->refs.count() : 0;
+    }
+
     inline auto Value::integer() const -> Long {
-        return isInt() ? std::get<Long>(value_) : 0;
+        return isInt() ? value_.i : 0;
     }
 
     inline auto Value::real() const -> Double {
-        return isReal() ? std::get<Double>(value_) : (isInt() ? (Double)std::get<Long>(value_) : 0.0);
+        return isReal() ? value_.r : (isInt() ? (Double)value_.i : 0.0);
     }
 
     inline auto Value::character() const -> Char {
-        return isChar() ? std::get<Char>(value_) : '\0';
+        return isChar() ? value_.c : '\0';
     }
 
     inline auto Value::boolean() const -> Bool {
-        return isBool() ? std::get<Bool>(value_) : false;
+        return isBool() ? value_.b : false;
     }
 
     inline auto Value::pair() const -> const Pair & {
-        return isPair() ? *std::get<PairPtr>(value_) : NullPair;
+        return isPair() ? object<Pair>() : NullPair;
     }
 
     inline auto Value::text() const -> const Text & {
-        return isString() ? *std::get<StringPtr>(value_) : NullText;
+        return isString() ? object<Text>() : NullText;
     }
 
     inline auto Value::text() -> Text & {
-        return isString() ? *std::get<StringPtr>(value_) : NullText;
+        if (!isString()) { return NullText; }
+        if (immutable_) { detachText(); }
+        return object<Text>();
     }
 
     inline auto Value::closure() const -> const Func & {
-        return isClosure() ? *std::get<LambdaPtr>(value_) : NullFunc;
+        return isClosure() ? object<Func>() : NullFunc;
     }
 
     inline auto Value::userType() const -> const UserType & {
-        return isUserType() ? *std::get<StructPtr>(value_) : NullUserType;
+        return isUserType() ? object<UserType>() : NullUserType;
     }
 
     inline auto Value::userObject() const -> const UserObject & {
-        return isUserObject() ? *std::get<InstancePtr>(value_) : NullObject;
+        return isUserObject() ? object<UserObject>() : NullObject;
     }
 
     inline auto Value::userObject() -> UserObject & {
-        return isUserObject() ? *std::get<InstancePtr>(value_) : NullObject;
+        return isUserObject() ? object<UserObject>() : NullObject;
     }
 
     inline auto Value::array() const -> const Array & {
-        return isArray() ? *std::get<SequencePtr>(value_) : NullSequence;
+        return isArray() ? object<Array>() : NullSequence;
     }
 
     inline auto Value::array() -> Array & {
-        return isArray() ? *std::get<SequencePtr>(value_) : NullSequence;
+        return isArray() ? object<Array>() : NullSequence;
     }
 
     inline auto Value::hashMap() const -> const HashMap & {
-        return isHashMap() ? *std::get<HashtablePtr>(value_) : NullHashtable;
+        return isHashMap() ? object<HashMap>() : NullHashtable;
     }
 
     inline auto Value::hashMap() -> HashMap & {
-        return isHashMap() ? *std::get<HashtablePtr>(value_) : NullHashtable;
+        return isHashMap() ? object<HashMap>() : NullHashtable;
     }
 
     inline auto Value::orderedMap() const -> const OrderedMap & {
-        return isOrderedMap() ? *std::get<OrderedTablePtr>(value_) : NullOrderedTable;
+        return isOrderedMap() ? object<OrderedMap>() : NullOrderedTable;
     }
 
     inline auto Value::orderedMap() -> OrderedMap & {
-        return isOrderedMap() ? *std::get<OrderedTablePtr>(value_) : NullOrderedTable;
+        return isOrderedMap() ? object<OrderedMap>() : NullOrderedTable;
     }
 
     inline auto Value::range() const -> const Range & {
-        return isRange() ? *std::get<IntegerRangePtr>(value_) : NullIntegerRange;
+        return isRange() ? object<Range>() : NullIntegerRange;
     }
 
     inline auto Value::range() -> Range & {
-        return isRange() ? *std::get<IntegerRangePtr>(value_) : NullIntegerRange;
+        return isRange() ? object<Range>() : NullIntegerRange;
     }
 
     inline auto Value::file() const -> const File & {
-        return isFile() ? *std::get<FileStructPtr>(value_) : NullFileStruct;
+        return isFile() ? object<File>() : NullFileStruct;
     }
 
     inline auto Value::file() -> File & {
-        return isFile() ? *std::get<FileStructPtr>(value_) : NullFileStruct;
+        return isFile() ? object<File>() : NullFileStruct;
+    }
+
+    inline auto Value::ndArray() const -> const NdArray & {
+        return isNdArray() ? object<NdArray>() : NullDenseArray;
+    }
+
+    inline auto Value::ndArray() -> NdArray & {
+        return isNdArray() ? object<NdArray>() : NullDenseArray;
+    }
+
+    inline auto Value::future() const -> const Task & {
+        return isFuture() ? object<Task>() : NullFuture;
+    }
+
+    inline auto Value::generator() const -> const Coroutine & {
+        return isGenerator() ? object<Coroutine>() : NullGenerator;
+    }
+
+    inline auto Value::iterator() const -> const Stream & {
+        return isIterator() ? object<Stream>() : NullIterator;
     }
 
     inline std::string Value::typeToString() const {
@@ -412,14 +619,38 @@ namespace Ishlang {
         else if constexpr (std::is_same_v<RawType, OrderedMap>) { return "orderedmap"; }
         else if constexpr (std::is_same_v<RawType, Range>) { return "range"; }
         else if constexpr (std::is_same_v<RawType, File>) { return "file"; }
+        else if constexpr (std::is_same_v<RawType, NdArray>) { return "ndarray"; }
+        else if constexpr (std::is_same_v<RawType, Task>) { return "future"; }
+        else if constexpr (std::is_same_v<RawType, Coroutine>) { return "generator"; }
+        else if constexpr (std::is_same_v<RawType, Stream>) { return "iterator"; }
         else {
             assert(false);
             return "unknown";
         }
     }
 
+    inline std::size_t Value::Hash::mix(std::size_t hash) {
+        static_assert(sizeof(std::size_t) == 8);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // The low 7 bits, the tag of hash tables, are taken from the mixed
+    // value. The bits above them mix blocks of 256 consecutive values and
+    // add a value's place in its block, so consecutive keys probe
+    // neighbouring groups and filling or walking a table with sequential
+    // keys stays in cache.
+    inline std::size_t Value::Hash::mixInteger(Long value) {
+        const auto bits = static_cast<std::size_t>(value);
+        return ((mix(bits >> 8) + (bits & 0xff)) << 7) | (mix(bits) & 0x7f);
+    }
+
     inline std::size_t Value::Hash::combine(std::size_t hash1, std::size_t hash2) {
-        return hash1 ^ (hash2 << 1);
+        return mix(hash1 ^ (mix(hash2) + 0x9e3779b97f4a7c15ULL));
     }
 
 }
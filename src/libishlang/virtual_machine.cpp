@@ -0,0 +1,312 @@
+#include "virtual_machine.h"
+#include "code_node.h"
+#include "code_node_util.h"
+#include "exception.h"
+#include "garbage_collector.h"
+#include "lambda.h"
+
+#include <span>
+#include <vector>
+
+using namespace Ishlang;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ISHLANG_VM_COMPUTED_GOTO
+#endif
+
+namespace {
+
+    // -------------------------------------------------------------
+    struct Handler {
+        std::size_t breakTarget;
+        std::size_t continueTarget;
+        std::size_t envDepth;
+    };
+
+    // -------------------------------------------------------------
+    struct Frame {
+        Frame(const ByteCode &code, Environment::SharedPtr env)
+            : code(code)
+            , regs(code.numRegisters())
+            , env(env)
+            , envStack()
+            , handlers()
+            , pc(0)
+        {}
+
+        const ByteCode                     &code;
+        std::vector<Value>                  regs;
+        Environment::SharedPtr              env;
+        std::vector<Environment::SharedPtr> envStack;
+        std::vector<Handler>                handlers;
+        std::size_t                         pc;
+    };
+
+    // -------------------------------------------------------------
+    // Break or continue raised by a node evaluated through the tree walker,
+    // resume at the exit or next iteration of the enclosing compiled loop.
+    std::size_t unwind(Frame &frame, ControlSignal::Type signal) {
+        const auto handler = frame.handlers.back();
+        while (frame.envStack.size() > handler.envDepth) {
+            frame.env = std::move(frame.envStack.back());
+            frame.envStack.pop_back();
+        }
+        return signal == ControlSignal::Continue ? handler.continueTarget : handler.breakTarget;
+    }
+
+    // -------------------------------------------------------------
+    inline void checkBool(const Value &value, std::uint8_t check) {
+        if (!value.isBool()) {
+            if (check == ByteCode::ExpressionCheck) {
+                throw InvalidExpressionType(Value::typeToString(Value::eBoolean), value.typeToString());
+            }
+            throw InvalidOperandType(Value::typeToString(Value::eBoolean), value.typeToString());
+        }
+    }
+
+    // -------------------------------------------------------------
+    inline void checkNumber(const Value &value) {
+        if (!value.isNumber()) {
+            throw InvalidOperandType(typesToString(Value::eInteger, Value::eReal), value.typeToString());
+        }
+    }
+
+    // -------------------------------------------------------------
+    inline void checkArith(const Value &value) {
+        if (!value.isNumber() && !value.isArray() && !value.isNdArray()) {
+            throw InvalidOperandType(typesToString(Value::eInteger, Value::eReal, Value::eArray, Value::eNdArray), value.typeToString());
+        }
+    }
+
+    // -------------------------------------------------------------
+    inline Value arith(ArithOp::Type type, std::span<const Value> values) {
+        if (values.size() == 2 && values[0].isInt() && values[1].isInt()) {
+            switch (type) {
+            case ArithOp::Add: return Value(values[0].integer() + values[1].integer());
+            case ArithOp::Sub: return Value(values[0].integer() - values[1].integer());
+            case ArithOp::Mul: return Value(values[0].integer() * values[1].integer());
+            default:           break;
+            }
+        }
+        return ArithOp::apply(type, values);
+    }
+
+    // -------------------------------------------------------------
+    Value execute(Frame &frame) {
+        const ByteCode &code = frame.code;
+        const ByteCode::Instruction *const first = code.instructions().data();
+        const ByteCode::Instruction *inst = first + frame.pc;
+        Value *const regs = frame.regs.data();
+
+#ifdef ISHLANG_VM_COMPUTED_GOTO
+#define ISHLANG_VM_LABEL(NAME) &&op_##NAME,
+        static const void *const labels[] = {
+            ISHLANG_BYTE_CODE_OPS(ISHLANG_VM_LABEL)
+        };
+#undef ISHLANG_VM_LABEL
+#define VM_CASE(NAME) op_##NAME:
+#define VM_DISPATCH() goto *labels[inst->op]
+#define VM_NEXT() ++inst; VM_DISPATCH()
+#define VM_JUMP(TARGET) inst = first + (TARGET); VM_DISPATCH()
+        VM_DISPATCH();
+#else
+#define VM_CASE(NAME) case ByteCode::NAME:
+#define VM_NEXT() ++inst; continue
+#define VM_JUMP(TARGET) inst = first + (TARGET); continue
+        for (;;) {
+        switch (inst->op) {
+#endif
+
+        VM_CASE(LoadNull) {
+            regs[inst->a] = Value();
+            VM_NEXT();
+        }
+
+        VM_CASE(LoadBool) {
+            regs[inst->a] = Value(Value::Bool(inst->sub != 0));
+            VM_NEXT();
+        }
+
+        VM_CASE(LoadConst) {
+            regs[inst->a] = code.constant(inst->b);
+            VM_NEXT();
+        }
+
+        VM_CASE(LoadLiteral) {
+            regs[inst->a] = code.constant(inst->b).clone();
+            VM_NEXT();
+        }
+
+        VM_CASE(GetVar) {
+            regs[inst->a] = frame.env->get(code.iden(inst->b));
+            VM_NEXT();
+        }
+
+        VM_CASE(DefVar) {
+            regs[inst->a] = frame.env->def(code.iden(inst->b), regs[inst->a]);
+            VM_NEXT();
+        }
+
+        VM_CASE(SetVar) {
+            regs[inst->a] = frame.env->set(code.iden(inst->b), regs[inst->a]);
+            VM_NEXT();
+        }
+
+        VM_CASE(CheckNumVar) {
+            const Value &nameVal = frame.env->get(code.iden(inst->b));
+            if (!nameVal.isNumber()) {
+                throw InvalidExpressionType(typesToString(Value::eInteger, Value::eReal), nameVal.typeToString());
+            }
+            VM_NEXT();
+        }
+
+        VM_CASE(ArithAssign) {
+            const auto iden = code.iden(inst->b);
+            const Value operands[] = { frame.env->get(iden), regs[inst->a] };
+            regs[inst->a] = frame.env->set(iden, arith(static_cast<ArithOp::Type>(inst->sub), operands));
+            VM_NEXT();
+        }
+
+        VM_CASE(CheckNumber) {
+            checkNumber(regs[inst->a]);
+            VM_NEXT();
+        }
+
+        VM_CASE(CheckArith) {
+            checkArith(regs[inst->a]);
+            VM_NEXT();
+        }
+
+        VM_CASE(Arith) {
+            regs[inst->a] = arith(static_cast<ArithOp::Type>(inst->sub), std::span<const Value>(regs + inst->b, inst->c));
+            VM_NEXT();
+        }
+
+        VM_CASE(Compare) {
+            regs[inst->a] = CompOp::apply(static_cast<CompOp::Type>(inst->sub), regs[inst->b], regs[inst->c]);
+            VM_NEXT();
+        }
+
+        VM_CASE(Not) {
+            checkBool(regs[inst->b], ByteCode::OperandCheck);
+            regs[inst->a] = Value(!regs[inst->b].boolean());
+            VM_NEXT();
+        }
+
+        VM_CASE(Negate) {
+            const Value &operand = regs[inst->b];
+            checkNumber(operand);
+            regs[inst->a] = operand.isInt() ? Value(-operand.integer()) : Value(-operand.real());
+            VM_NEXT();
+        }
+
+        VM_CASE(Jump) {
+            // Backward jumps close loop iterations
+            if (inst->b < static_cast<std::size_t>(inst - first)) { GarbageCollector::current().safePoint(); }
+            VM_JUMP(inst->b);
+        }
+
+        VM_CASE(JumpIfFalse) {
+            checkBool(regs[inst->a], inst->sub);
+            if (!regs[inst->a].boolean()) { VM_JUMP(inst->b); }
+            VM_NEXT();
+        }
+
+        VM_CASE(JumpIfTrue) {
+            checkBool(regs[inst->a], inst->sub);
+            if (regs[inst->a].boolean()) { VM_JUMP(inst->b); }
+            VM_NEXT();
+        }
+
+        VM_CASE(PushEnv) {
+            frame.envStack.push_back(frame.env);
+            frame.env = Environment::make(frame.env, code.layout(inst->b));
+            VM_NEXT();
+        }
+
+        VM_CASE(PopEnv) {
+            frame.env = std::move(frame.envStack.back());
+            frame.envStack.pop_back();
+            VM_NEXT();
+        }
+
+        VM_CASE(PushHandler) {
+            frame.handlers.push_back(Handler{inst->b, inst->c, frame.envStack.size()});
+            VM_NEXT();
+        }
+
+        VM_CASE(PopHandler) {
+            frame.handlers.pop_back();
+            VM_NEXT();
+        }
+
+        VM_CASE(MakeClosure) {
+            const auto &proto = code.proto(inst->b);
+            regs[inst->a] = Value(Lambda(proto.params, proto.body, frame.env, proto.layout, proto.code));
+            VM_NEXT();
+        }
+
+        VM_CASE(Call) {
+            const Value *args = regs + inst->b + 1;
+            regs[inst->a] = regs[inst->b].closure().exec(Lambda::Args(args, inst->c));
+            VM_NEXT();
+        }
+
+        VM_CASE(TailCall) {
+            // Made by the calling lambda once this body returned
+            const Value *args = regs + inst->b + 1;
+            Lambda::deferCall(regs[inst->b], Lambda::Args(args, inst->c));
+            return Value::Null;
+        }
+
+        VM_CASE(Eval) {
+            regs[inst->a] = code.node(inst->b)->eval(frame.env);
+            if (const auto signal = ControlSignal::pending()) {
+                // Return is consumed by the calling lambda
+                if (signal == ControlSignal::Return) { return std::move(regs[inst->a]); }
+                ControlSignal::clear();
+                VM_JUMP(unwind(frame, signal));
+            }
+            VM_NEXT();
+        }
+
+        VM_CASE(Return) {
+            return std::move(regs[inst->a]);
+        }
+
+#ifndef ISHLANG_VM_COMPUTED_GOTO
+        case ByteCode::NumOpCodes:
+            return Value::Null;
+        }
+        }
+#endif
+
+#undef VM_CASE
+#undef VM_DISPATCH
+#undef VM_NEXT
+#undef VM_JUMP
+
+        return Value::Null;
+    }
+
+}
+
+// -------------------------------------------------------------
+Value VirtualMachine::run(const ByteCode &code, Environment::SharedPtr env) {
+    if (!env) { throw NullEnvironment(); }
+
+    Frame frame(code, env);
+    for (;;) {
+        try {
+            return execute(frame);
+        }
+        catch (const Break::Except &) {
+            if (frame.handlers.empty()) { throw; }
+            frame.pc = unwind(frame, ControlSignal::Break);
+        }
+        catch (const Continue::Except &) {
+            if (frame.handlers.empty()) { throw; }
+            frame.pc = unwind(frame, ControlSignal::Continue);
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef ISHLANG_VIRTUAL_MACHINE_H
+#define ISHLANG_VIRTUAL_MACHINE_H
+
+#include "byte_code.h"
+#include "environment.h"
+#include "value.h"
+
+namespace Ishlang {
+
+    // Register machine executing ByteCode produced by the Compiler.
+    // Each run owns its register file, environment stack and the break
+    // handlers installed by compiled loops.
+    class VirtualMachine {
+    public:
+        static Value run(const ByteCode &code, Environment::SharedPtr env);
+    };
+
+}
+
+#endif	// ISHLANG_VIRTUAL_MACHINE_H
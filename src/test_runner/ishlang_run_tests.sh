@@ -69,23 +69,28 @@ do
     expect_file=$(echo "${scenario}.expect")
     out_file=$(echo "${scenario}.out")
 
-    ${ishlang} -p ${tests} -f ${code_file} > ${out_file}
-    if [ ${?} -ne 0 ]; then
-        echo "Terminating tests ... failed running ${code_file}"
-        exit 1
-    fi
+    # Run with the default threads, then with several so spawned tasks
+    # run concurrently on any machine
+    for threads in "" "-j 4"
+    do
+        ${ishlang} ${threads} -p ${tests} -f ${code_file} > ${out_file}
+        if [ ${?} -ne 0 ]; then
+            echo "Terminating tests ... failed running ${code_file} ${threads}"
+            exit 1
+        fi
 
-    diff_result=$(diff ${out_file} ${expect_file})
-    if [ "${diff_result}" == "" ]; then
-        if [ ${verbose} -eq 1 ]; then
-            echo "${scenario}: OK"
+        diff_result=$(diff ${out_file} ${expect_file})
+        if [ "${diff_result}" == "" ]; then
+            if [ ${verbose} -eq 1 ]; then
+                echo "${scenario} ${threads}: OK"
+            fi
+        else
+            echo "${scenario} ${threads}: Failed"
+            echo ""
+            echo "${diff_result}"
+            exit 1
         fi
-    else
-        echo "${scenario}: Failed"
-        echo ""
-        echo "${diff_result}"
-        exit 1
-    fi
+    done
 
     rm ${code_file} ${expect_file} ${out_file}
 done
@@ -1,6 +1,9 @@
 #include "unit_test.h"
-#include "module.h"
+#include "compiler.h"
+#include "context.h"
+#include "virtual_machine.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace Ishlang;
@@ -11,7 +14,7 @@ UnitTest::UnitTest()
     , verbose_(false)
     , tests_()
 {
-    ModuleStorage::addPath(Util::temporaryPath());
+    Context::modules().addPath(Util::temporaryPath());
 }
 
 // -------------------------------------------------------------
@@ -25,7 +28,7 @@ bool UnitTest::run(const std::string &test) {
     }
     else {
         std::cout << "\n***** Running unit test " << test << '\n';
-        Tests::iterator iter = tests_.find(test);
+        Tests::const_iterator iter = find(test);
         if (iter == tests_.end()) {
             std::cerr << "Unknown test - " << test << '\n';
             return false;
@@ -53,10 +56,15 @@ void UnitTest::setVerbose(bool flag) {
 
 // -------------------------------------------------------------
 void UnitTest::addTest(const char *name, Function ftn) {
-    const auto [_, success] = tests_.emplace(name, ftn);
-    if (!success) {
+    if (find(name) != tests_.end()) {
         throw std::runtime_error(std::string("Failed to add duplicate test '") + name + "'");
     }
+    tests_.emplace_back(name, ftn);
+}
+
+// -------------------------------------------------------------
+UnitTest::Tests::const_iterator UnitTest::find(const std::string &name) const {
+    return std::ranges::find_if(tests_, [&name](const auto &test) { return test.first == name; });
 }
 
 // -------------------------------------------------------------
@@ -113,6 +121,41 @@ bool UnitTest::parserTest(Parser &parser,
     return false;
 }
 
+// -------------------------------------------------------------
+bool UnitTest::vmTest(Parser &parser,
+                      Environment::SharedPtr env,
+                      const std::string &expr,
+                      const Value &value,
+                      bool success) {
+    try {
+        CodeNode::SharedPtr code(parser.read(expr));
+        if (code) {
+            Value result = VirtualMachine::run(*Compiler::compile(code), env);
+            if (result.type() != value.type()) {
+                std::cerr << "VM - " << expr << ": type expected=" << value.typeToString() << " actual=" << result.typeToString() << '\n';
+                return false;
+            }
+            if (result != value) {
+                std::cerr << "VM - " << expr << ": value expected=" << value << " actual=" << result << '\n';
+                return false;
+            }
+            return true;
+        }
+    }
+    catch (const std::exception &ex) {
+        if (parser.hasIncompleteExpr()) {
+            parser.clearIncompleteExpr();
+        }
+
+        if (success) {
+            std::cerr << "VM - " << expr << ": error " << ex.what() << '\n';
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
 // -------------------------------------------------------------
 void UnitTest::runTest(const std::string &name, Function ftn) {
     if (verbose_) { std::cout << "Testing: " << name << '\n'; }
@@ -8,13 +8,15 @@
 #include "value.h"
 
 #include <functional>
-#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 class UnitTest {
 public:
     using Function = std::function<void ()>;
-    using Tests    = std::map<std::string, Function>;
+    // Run in the order they were added
+    using Tests    = std::vector<std::pair<std::string, Function>>;
         
 public:
     UnitTest();
@@ -38,7 +40,14 @@ public: // Test function interface
                     const Ishlang::Value &value,
                     bool success);
 
+    bool vmTest(Ishlang::Parser &parser,
+                Ishlang::Environment::SharedPtr env,
+                const std::string &expr,
+                const Ishlang::Value &value,
+                bool success);
+
 private:
+    Tests::const_iterator find(const std::string &name) const;
     void runTest(const std::string &name, Function ftn);
 
 private:
@@ -25,6 +25,14 @@ namespace UnitTestFtn {
             return unitTest_.parserTest(parser, env, expr, value, success);
         }
 
+        inline bool vmTest(Ishlang::Parser &parser,
+                           Ishlang::Environment::SharedPtr env,
+                           const std::string &expr,
+                           const Ishlang::Value &value,
+                           bool success) {
+            return unitTest_.vmTest(parser, env, expr, value, success);
+        }
+
         static inline Ishlang::Value arrval(const auto &... vs) {
             return Ishlang::Value(Ishlang::Sequence({vs...}));
         }